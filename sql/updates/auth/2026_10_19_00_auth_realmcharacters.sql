@@ -0,0 +1,3 @@
+ALTER TABLE `realmcharacters`
+  ADD COLUMN `changed` int(10) unsigned NOT NULL DEFAULT '0' COMMENT 'Time of the last count update by the worldserver',
+  ADD KEY `changed` (`changed`);
@@ -0,0 +1,4 @@
+DELETE FROM `command` WHERE `name` = 'debug visibility';
+
+INSERT INTO `command` (`name`, `security`, `help`) VALUES
+('debug visibility', 3, 'Syntax: .debug visibility\n Shows visibility work (full and incremental passes, cells and objects checked, objects created and destroyed at clients) done on your map during the last map update.');
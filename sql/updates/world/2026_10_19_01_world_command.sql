@@ -0,0 +1,4 @@
+DELETE FROM `command` WHERE `name` = 'debug navbench';
+
+INSERT INTO `command` (`name`, `security`, `help`) VALUES
+('debug navbench', 3, 'Syntax: .debug navbench [$count [$radius]]\n Runs $count (default 100) path searches from your position to random points within $radius yards (default 60), twice, and shows query latency with a cold and a warm path cache.');
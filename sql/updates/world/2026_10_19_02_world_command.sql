@@ -0,0 +1,4 @@
+DELETE FROM `command` WHERE `name` = 'debug splines';
+
+INSERT INTO `command` (`name`, `security`, `help`) VALUES
+('debug splines', 3, 'Syntax: .debug splines\n Shows splines launched per second on your map, and how many chase and follow replans were skipped or coalesced.');
@@ -0,0 +1,4 @@
+DELETE FROM `command` WHERE `name` = 'debug smartai';
+
+INSERT INTO `command` (`name`, `security`, `help`) VALUES
+('debug smartai', 3, 'Syntax: .debug smartai\n Shows the memory used by the shared SmartAI programs, and for the selected SmartAI creature the memory of its own event state compared to a private copy of its script.');
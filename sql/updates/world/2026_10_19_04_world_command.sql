@@ -0,0 +1,4 @@
+DELETE FROM `command` WHERE `name` = 'debug condbench';
+
+INSERT INTO `command` (`name`, `security`, `help`) VALUES
+('debug condbench', 3, 'Syntax: .debug condbench [#count]\n Evaluates the gossip menu conditions and fills the loot of the selected creature #count times (default 10000) for your character and shows the time taken.');
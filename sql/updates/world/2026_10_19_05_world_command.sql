@@ -0,0 +1,4 @@
+DELETE FROM `command` WHERE `name` = 'lfg bench';
+
+INSERT INTO `command` (`name`, `security`, `help`) VALUES
+('lfg bench', 3, 'Syntax: .lfg bench [#players]\n Runs a simulated dungeon finder queue where #players (default 2000) join and shows the proposals formed per second. Real queues and players are not affected.');
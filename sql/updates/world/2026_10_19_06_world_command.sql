@@ -0,0 +1,4 @@
+DELETE FROM `command` WHERE `name` = 'debug matchmaking';
+
+INSERT INTO `command` (`name`, `security`, `help`) VALUES
+('debug matchmaking', 3, 'Syntax: .debug matchmaking\n Shows for every dungeon finder queue and battleground queue bracket how many are queued, how long matching takes and how long it takes for its results to be applied.');
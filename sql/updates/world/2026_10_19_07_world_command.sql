@@ -0,0 +1,4 @@
+DELETE FROM `command` WHERE `name` = 'debug scripthooks';
+
+INSERT INTO `command` (`name`, `security`, `help`) VALUES
+('debug scripthooks', 3, 'Syntax: .debug scripthooks\n Shows for every world, player and group script hook how many scripts are subscribed to it, how many times it was called and how long its scripts took.');
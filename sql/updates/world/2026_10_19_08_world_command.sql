@@ -0,0 +1,4 @@
+DELETE FROM `command` WHERE `name` = 'debug scriptprofile';
+
+INSERT INTO `command` (`name`, `security`, `help`) VALUES
+('debug scriptprofile', 3, 'Syntax: .debug scriptprofile [#count|on|off|reset|export $file]\n Without argument shows the #count (20 by default) creature AI, instance, spell, aura and SmartAI scripts which took the most time, per map. on and off start and stop profiling, reset clears the profile and export writes it to $file as folded stacks for flamegraph.pl.');
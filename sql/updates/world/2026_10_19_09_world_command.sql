@@ -0,0 +1,4 @@
+DELETE FROM `command` WHERE `name` = 'server opcodes';
+
+INSERT INTO `command` (`name`, `security`, `help`) VALUES
+('server opcodes', 3, 'Syntax: .server opcodes [#count|reset]\n Shows the #count (20 by default) client opcodes with the most handling time, with their calls and handling time histogram, merged from every thread handling packets. reset clears the stats. Also available from the console and RA.');
@@ -0,0 +1,4 @@
+DELETE FROM `command` WHERE `name` = 'debug dormancy';
+
+INSERT INTO `command` (`name`, `security`, `help`) VALUES
+('debug dormancy', 3, 'Syntax: .debug dormancy\n Shows how many creatures of the active cells of your map were updated and how many were left dormant by the last map update, and whether the selected creature is dormant.');
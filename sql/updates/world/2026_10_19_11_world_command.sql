@@ -0,0 +1,4 @@
+DELETE FROM `command` WHERE `name` = 'wordfilter benchmark';
+
+INSERT INTO `command` (`name`, `security`, `help`) VALUES
+('wordfilter benchmark', 3, 'Syntax: .wordfilter benchmark $file [$repeat]\n Times the bad word search of every line of $file, $repeat times, against the previous linear search and reports the lines they disagree on.');
@@ -33,11 +33,15 @@
 #include "Database/DatabaseEnv.h"
 #include "Configuration/Config.h"
 #include "Log.h"
+#include "OpenSSLCrypto.h"
 #include "SystemConfig.h"
 #include "Util.h"
+#include "Timer.h"
 #include "SignalHandler.h"
 #include "RealmList.h"
 #include "RealmAcceptor.h"
+#include "RealmReactorPool.h"
+#include "LogonInfoCache.h"
 
 #ifndef _TRINITY_REALM_CONFIG
 # define _TRINITY_REALM_CONFIG  "authserver.conf"
@@ -45,6 +49,7 @@
 
 bool StartDB();
 void StopDB();
+void ClearExpiredBans();
 
 bool stopEvent = false;                                     // Setting it to true stops the server
 
@@ -108,6 +113,7 @@ extern int main(int argc, char **argv)
     sLog->outInfo(LOG_FILTER_AUTHSERVER, "Using configuration file %s.", cfg_file);
 
     sLog->outWarn(LOG_FILTER_AUTHSERVER, "%s (Library: %s)", OPENSSL_VERSION_TEXT, SSLeay_version(SSLEAY_VERSION));
+    OpenSSLCrypto::ThreadsSetup();
 
 #if defined (ACE_HAS_EVENT_POLL) || defined (ACE_HAS_DEV_POLL)
     ACE_Reactor::instance(new ACE_Reactor(new ACE_Dev_Poll_Reactor(ACE::max_handles(), 1), 1), true);
@@ -136,6 +142,9 @@ extern int main(int argc, char **argv)
 
     sLog->SetRealmID(0);                                               // ensure we've set realm to 0 (authserver realmid)
 
+    ClearExpiredBans();
+    sLogonInfoCache->Initialize(ConfigMgr::GetIntDefault("LogonInfoCacheTime", 10) * IN_MILLISECONDS);
+
     // Get the list of realms for the server
     sRealmList->Initialize(ConfigMgr::GetIntDefault("RealmsStateUpdateDelay", 20));
     if (sRealmList->size() == 0)
@@ -164,6 +173,17 @@ extern int main(int argc, char **argv)
         return 1;
     }
 
+    // Connections are handled by the network threads, the acceptor stays on the main reactor
+    int32 networkThreads = ConfigMgr::GetIntDefault("Network.Threads", 1);
+    if (networkThreads < 0)
+    {
+        sLog->outError(LOG_FILTER_AUTHSERVER, "Network.Threads can't be negative, set to 1.");
+        networkThreads = 1;
+    }
+
+    if (!sRealmReactorPool->Start(uint32(networkThreads)))
+        return 1;
+
     // Initialise the signal handlers
     AuthServerSignalHandler SignalINT, SignalTERM;
 
@@ -214,6 +234,10 @@ extern int main(int argc, char **argv)
     uint32 numLoops = (ConfigMgr::GetIntDefault("MaxPingTime", 30) * (MINUTE * 1000000 / 100000));
     uint32 loopCounter = 0;
 
+    // expired bans are cleared here instead of by every logon challenge
+    uint32 banExpiryCheckInterval = ConfigMgr::GetIntDefault("BanExpiryCheckInterval", 60) * IN_MILLISECONDS;
+    uint32 banExpiryCheckTime = getMSTime();
+
     // Wait for termination signal
     while (!stopEvent)
     {
@@ -229,8 +253,21 @@ extern int main(int argc, char **argv)
             sLog->outInfo(LOG_FILTER_AUTHSERVER, "Ping MySQL to keep connection alive");
             LoginDatabase.KeepAlive();
         }
+
+        // the network threads only read the realm list
+        sRealmList->UpdateIfNeed();
+
+        if (banExpiryCheckInterval && GetMSTimeDiffToNow(banExpiryCheckTime) >= banExpiryCheckInterval)
+        {
+            banExpiryCheckTime = getMSTime();
+            ClearExpiredBans();
+            sLogonInfoCache->RemoveExpired();
+        }
     }
 
+    sRealmReactorPool->Stop();
+    OpenSSLCrypto::ThreadsCleanup();
+
     // Close the Database Pool and library
     StopDB();
 
@@ -257,14 +294,14 @@ bool StartDB()
         worker_threads = 1;
     }
 
-    int32 synch_threads = ConfigMgr::GetIntDefault("LoginDatabase.SynchThreads", 1);
+    // every network thread runs its own logon queries
+    int32 synch_threads = ConfigMgr::GetIntDefault("LoginDatabase.SynchThreads", std::max(ConfigMgr::GetIntDefault("Network.Threads", 1), 1));
     if (synch_threads < 1 || synch_threads > 32)
     {
         sLog->outError(LOG_FILTER_AUTHSERVER, "Improper value specified for LoginDatabase.SynchThreads, defaulting to 1.");
         synch_threads = 1;
     }
 
-    // NOTE: While authserver is singlethreaded you should keep synch_threads == 1. Increasing it is just silly since only 1 will be used ever.
     if (!LoginDatabase.Open(dbstring.c_str(), uint8(worker_threads), uint8(synch_threads)))
     {
         sLog->outError(LOG_FILTER_AUTHSERVER, "Cannot connect to database");
@@ -282,3 +319,11 @@ void StopDB()
     LoginDatabase.Close();
     MySQL::Library_End();
 }
+
+/// Remove the ip bans and deactivate the account bans which expired
+void ClearExpiredBans()
+{
+    LoginDatabase.Execute(LoginDatabase.GetPreparedStatement(LOGIN_DEL_EXPIRED_IP_BANS));
+    LoginDatabase.Execute(LoginDatabase.GetPreparedStatement(LOGIN_UPD_EXPIRED_ACCOUNT_BANS));
+    LoginDatabase.Execute(LoginDatabase.GetPreparedStatement(LOGIN_UPD_ACCOUNT_PREMIUM));
+}
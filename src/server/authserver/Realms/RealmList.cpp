@@ -16,11 +16,29 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <ace/Guard_T.h>
+
 #include "Common.h"
 #include "RealmList.h"
+#include "AuthCodes.h"
 #include "Database/DatabaseEnv.h"
 
-RealmList::RealmList() : m_UpdateInterval(0), m_NextUpdateTime(time(NULL)) { }
+// keeps the cached character counts of the accounts which did not log in again bounded
+#define CHARACTER_COUNTS_CACHE_TIME HOUR
+
+enum RealmListCmd
+{
+    REALM_LIST                                   = 0x10
+};
+
+static bool IsSameRealm(Realm const& left, Realm const& right)
+{
+    return left.m_ID == right.m_ID && left.address == right.address && left.icon == right.icon && left.flag == right.flag &&
+        left.timezone == right.timezone && left.allowedSecurityLevel == right.allowedSecurityLevel &&
+        left.populationLevel == right.populationLevel && left.gamebuild == right.gamebuild;
+}
+
+RealmList::RealmList() : m_version(0), m_UpdateInterval(0), m_NextUpdateTime(time(NULL)), m_charactersGeneration(0), m_charactersCheckTime(time(NULL)) { }
 
 // Load the realm list from the database
 void RealmList::Initialize(uint32 updateInterval)
@@ -31,10 +49,10 @@ void RealmList::Initialize(uint32 updateInterval)
     UpdateRealms(true);
 }
 
-void RealmList::UpdateRealm(uint32 ID, const std::string& name, const std::string& address, uint16 port, uint8 icon, RealmFlags flag, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, uint32 build)
+void RealmList::UpdateRealm(RealmMap& realms, uint32 ID, const std::string& name, const std::string& address, uint16 port, uint8 icon, RealmFlags flag, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, uint32 build)
 {
     // Create new if not exist or update existed
-    Realm& realm = m_realms[name];
+    Realm& realm = realms[name];
 
     realm.m_ID = ID;
     realm.name = name;
@@ -59,20 +77,20 @@ void RealmList::UpdateIfNeed()
 
     m_NextUpdateTime = time(NULL) + m_UpdateInterval;
 
-    // Clears Realm list
-    m_realms.clear();
-
     // Get the content of the realmlist table in the database
     UpdateRealms();
+    UpdateCharacterCounts();
 }
 
 void RealmList::UpdateRealms(bool init)
 {
-    sLog->outInfo(LOG_FILTER_AUTHSERVER, "Updating Realm List...");
+    sLog->outDebug(LOG_FILTER_AUTHSERVER, "Updating Realm List...");
 
     PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_REALMLIST);
     PreparedQueryResult result = LoginDatabase.Query(stmt);
 
+    RealmMap realms;
+
     // Circle through results and add them to the realm map
     if (result)
     {
@@ -90,11 +108,229 @@ void RealmList::UpdateRealms(bool init)
             float pop                  = fields[8].GetFloat();
             uint32 build               = fields[9].GetUInt32();
 
-            UpdateRealm(realmId, name, address, port, icon, flag, timezone, (allowedSecurityLevel <= SEC_ADMINISTRATOR ? AccountTypes(allowedSecurityLevel) : SEC_ADMINISTRATOR), pop, build);
+            UpdateRealm(realms, realmId, name, address, port, icon, flag, timezone, (allowedSecurityLevel <= SEC_ADMINISTRATOR ? AccountTypes(allowedSecurityLevel) : SEC_ADMINISTRATOR), pop, build);
 
             if (init)
                 sLog->outInfo(LOG_FILTER_AUTHSERVER, "Added realm \"%s\".", fields[1].GetCString());
         }
         while (result->NextRow());
     }
+
+    // the built packets are kept as long as no realm row changed
+    bool changed = realms.size() != m_realms.size();
+    for (RealmMap::const_iterator itr = realms.begin(), current = m_realms.begin(); !changed && itr != realms.end(); ++itr, ++current)
+        changed = itr->first != current->first || !IsSameRealm(itr->second, current->second);
+
+    if (!changed)
+        return;
+
+    ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, guard, m_lock);
+
+    m_realms.swap(realms);
+    m_packets.clear();
+    ++m_version;
+
+    if (!init)
+        sLog->outInfo(LOG_FILTER_AUTHSERVER, "Realm list changed, now at version %u.", m_version);
+}
+
+void RealmList::UpdateCharacterCounts()
+{
+    // the worldservers stamp the rows they change, drop the counts of these accounts
+    time_t now = time(NULL);
+    PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_REALM_CHARACTERS_CHANGED);
+    stmt->setUInt32(0, uint32(now - m_charactersCheckTime) + 1);
+    PreparedQueryResult result = LoginDatabase.Query(stmt);
+    m_charactersCheckTime = now;
+
+    ACE_Guard<ACE_Thread_Mutex> guard(m_charactersLock);
+    ++m_charactersGeneration;
+
+    if (result)
+    {
+        do
+            m_characters.erase((*result)[0].GetUInt32());
+        while (result->NextRow());
+    }
+
+    for (AccountCharactersMap::iterator itr = m_characters.begin(); itr != m_characters.end();)
+    {
+        if (itr->second.loadTime + CHARACTER_COUNTS_CACHE_TIME <= now)
+            m_characters.erase(itr++);
+        else
+            ++itr;
+    }
+}
+
+void RealmList::GetCharacterCounts(uint32 accountId, RealmCharacterCounts& counts)
+{
+    // without realm list updates the changes would never be seen
+    bool useCache = m_UpdateInterval != 0;
+    uint32 generation = 0;
+    if (useCache)
+    {
+        ACE_Guard<ACE_Thread_Mutex> guard(m_charactersLock);
+        AccountCharactersMap::const_iterator itr = m_characters.find(accountId);
+        if (itr != m_characters.end())
+        {
+            counts = itr->second.counts;
+            return;
+        }
+
+        generation = m_charactersGeneration;
+    }
+
+    PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_REALM_CHARACTER_COUNTS);
+    stmt->setUInt32(0, accountId);
+    if (PreparedQueryResult result = LoginDatabase.Query(stmt))
+    {
+        do
+        {
+            Field* fields = result->Fetch();
+            counts[fields[0].GetUInt32()] = fields[1].GetUInt8();
+        }
+        while (result->NextRow());
+    }
+
+    if (!useCache)
+        return;
+
+    // a change reported while querying may not be in the result
+    ACE_Guard<ACE_Thread_Mutex> guard(m_charactersLock);
+    if (generation != m_charactersGeneration)
+        return;
+
+    AccountCharacters& characters = m_characters[accountId];
+    characters.counts = counts;
+    characters.loadTime = time(NULL);
+}
+
+void RealmList::GetRealmListPacket(uint16 build, RealmListPacket& packet)
+{
+    {
+        ACE_READ_GUARD(ACE_RW_Thread_Mutex, guard, m_lock);
+        RealmListPacketMap::const_iterator itr = m_packets.find(build);
+        if (itr != m_packets.end())
+        {
+            packet = itr->second;
+            return;
+        }
+    }
+
+    ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, guard, m_lock);
+    RealmListPacketMap::iterator itr = m_packets.find(build);
+    if (itr == m_packets.end())
+    {
+        itr = m_packets.insert(RealmListPacketMap::value_type(build, RealmListPacket())).first;
+        BuildRealmListPacket(build, itr->second);
+    }
+
+    packet = itr->second;
+}
+
+void RealmList::BuildRealmListPacket(uint16 build, RealmListPacket& packet) const
+{
+    uint8 expversion = uint8(AuthHelper::IsPostBCAcceptedClientBuild(build) ? POST_BC_EXP_FLAG : (AuthHelper::IsPreBCAcceptedClientBuild(build) ? PRE_BC_EXP_FLAG : NO_VALID_EXP_FLAG));
+
+    packet.version = m_version;
+    packet.accountFields.clear();
+
+    ByteBuffer pkt;
+    size_t RealmListSize = 0;
+    for (RealmMap::const_iterator i = m_realms.begin(); i != m_realms.end(); ++i)
+    {
+        // don't work with realms which not compatible with the client
+        bool okBuild = ((expversion & POST_BC_EXP_FLAG) && i->second.gamebuild == build) || ((expversion & PRE_BC_EXP_FLAG) && !AuthHelper::IsPreBCAcceptedClientBuild(i->second.gamebuild));
+
+        // No SQL injection. id of realm is controlled by the database.
+        uint32 flag = i->second.flag;
+        RealmBuildInfo const* buildInfo = AuthHelper::GetBuildInfo(i->second.gamebuild);
+        if (!okBuild)
+        {
+            if (!buildInfo)
+                continue;
+
+            flag |= REALM_FLAG_OFFLINE | REALM_FLAG_SPECIFYBUILD;   // tell the client what build the realm is for
+        }
+
+        if (!buildInfo)
+            flag &= ~REALM_FLAG_SPECIFYBUILD;
+
+        std::string name = i->first;
+        if (expversion & PRE_BC_EXP_FLAG && flag & REALM_FLAG_SPECIFYBUILD)
+        {
+            std::ostringstream ss;
+            ss << name << " (" << buildInfo->MajorVersion << '.' << buildInfo->MinorVersion << '.' << buildInfo->BugfixVersion << ')';
+            name = ss.str();
+        }
+
+        // positions in the realm entries, the header is added in front of them below
+        RealmListPacket::AccountField field;
+        field.lockPos = 0;
+        field.realmId = i->second.m_ID;
+        field.allowedSecurityLevel = i->second.allowedSecurityLevel;
+
+        pkt << i->second.icon;                              // realm type
+        if (expversion & POST_BC_EXP_FLAG)                  // only 2.x and 3.x clients
+        {
+            field.lockPos = pkt.wpos();
+            pkt << uint8(0);                                // if 1, then realm locked
+        }
+        pkt << uint8(flag);                                 // RealmFlags
+        pkt << name;
+        pkt << i->second.address;
+        pkt << i->second.populationLevel;
+        field.charCountPos = pkt.wpos();
+        pkt << uint8(0);                                    // AmountOfCharacters
+        pkt << i->second.timezone;                          // realm category
+        if (expversion & POST_BC_EXP_FLAG)                  // 2.x and 3.x clients
+            pkt << uint8(0x2C);                             // unk, may be realm number/id?
+        else
+            pkt << uint8(0x0);                              // 1.12.1 and 1.12.2 clients
+
+        if (expversion & POST_BC_EXP_FLAG && flag & REALM_FLAG_SPECIFYBUILD)
+        {
+            pkt << uint8(buildInfo->MajorVersion);
+            pkt << uint8(buildInfo->MinorVersion);
+            pkt << uint8(buildInfo->BugfixVersion);
+            pkt << uint16(buildInfo->Build);
+        }
+
+        packet.accountFields.push_back(field);
+        ++RealmListSize;
+    }
+
+    if (expversion & POST_BC_EXP_FLAG)                      // 2.x and 3.x clients
+    {
+        pkt << uint8(0x10);
+        pkt << uint8(0x00);
+    }
+    else                                                    // 1.12.1 and 1.12.2 clients
+    {
+        pkt << uint8(0x00);
+        pkt << uint8(0x02);
+    }
+
+    // make a ByteBuffer which stores the RealmList's size
+    ByteBuffer RealmListSizeBuffer;
+    RealmListSizeBuffer << uint32(0);
+    if (expversion & POST_BC_EXP_FLAG)                      // only 2.x and 3.x clients
+        RealmListSizeBuffer << uint16(RealmListSize);
+    else
+        RealmListSizeBuffer << uint32(RealmListSize);
+
+    packet.data.clear();
+    packet.data << uint8(REALM_LIST);
+    packet.data << uint16(pkt.size() + RealmListSizeBuffer.size());
+    packet.data.append(RealmListSizeBuffer);                // append RealmList's size buffer
+
+    size_t offset = packet.data.wpos();
+    packet.data.append(pkt);                                // append realms in the realmlist
+
+    for (std::vector<RealmListPacket::AccountField>::iterator itr = packet.accountFields.begin(); itr != packet.accountFields.end(); ++itr)
+    {
+        if (itr->lockPos)
+            itr->lockPos += offset;
+        itr->charCountPos += offset;
+    }
 }
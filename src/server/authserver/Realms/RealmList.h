@@ -21,7 +21,9 @@
 
 #include <ace/Singleton.h>
 #include <ace/Null_Mutex.h>
+#include <ace/RW_Thread_Mutex.h>
 #include "Common.h"
+#include "ByteBuffer.h"
 
 enum RealmFlags
 {
@@ -50,6 +52,27 @@ struct Realm
     uint32 gamebuild;
 };
 
+/// Realm list packet built for one client build, shared by all its clients
+struct RealmListPacket
+{
+    /// Byte of a realm entry set per account
+    struct AccountField
+    {
+        size_t lockPos;                                     // 0 if the client has no realm lock byte
+        size_t charCountPos;
+        uint32 realmId;
+        AccountTypes allowedSecurityLevel;
+    };
+
+    RealmListPacket() : version(0) { }
+
+    uint32 version;                                         // realm list version it was built from
+    ByteBuffer data;                                        // whole packet, header included
+    std::vector<AccountField> accountFields;
+};
+
+typedef std::map<uint32, uint8> RealmCharacterCounts;      // character count by realm id
+
 /// Storage object for the list of realms on the server
 class RealmList
 {
@@ -61,6 +84,7 @@ public:
 
     void Initialize(uint32 updateInterval);
 
+    // main thread only, the network threads read the realms with GetRealmListPacket
     void UpdateIfNeed();
 
     void AddRealm(Realm NewRealm) {m_realms[NewRealm.name] = NewRealm;}
@@ -69,13 +93,37 @@ public:
     RealmMap::const_iterator end() const { return m_realms.end(); }
     uint32 size() const { return m_realms.size(); }
 
+    /// Serialized realm list for the client build, only rebuilt once a realm changed
+    void GetRealmListPacket(uint16 build, RealmListPacket& packet);
+    /// Characters of the account on each realm, cached until the worldserver reports a change
+    void GetCharacterCounts(uint32 accountId, RealmCharacterCounts& counts);
+
 private:
+    struct AccountCharacters
+    {
+        RealmCharacterCounts counts;
+        time_t loadTime;
+    };
+
+    typedef std::map<uint16, RealmListPacket> RealmListPacketMap;
+    typedef std::map<uint32, AccountCharacters> AccountCharactersMap;
+
     void UpdateRealms(bool init=false);
-    void UpdateRealm(uint32 ID, const std::string& name, const std::string& address, uint16 port, uint8 icon, RealmFlags flag, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, uint32 build);
+    void UpdateCharacterCounts();
+    void BuildRealmListPacket(uint16 build, RealmListPacket& packet) const;
+    void UpdateRealm(RealmMap& realms, uint32 ID, const std::string& name, const std::string& address, uint16 port, uint8 icon, RealmFlags flag, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, uint32 build);
 
     RealmMap m_realms;
+    RealmListPacketMap m_packets;                           // by client build
+    uint32 m_version;                                       // increased when a realm changes
+    ACE_RW_Thread_Mutex m_lock;
     uint32   m_UpdateInterval;
     time_t   m_NextUpdateTime;
+
+    AccountCharactersMap m_characters;
+    uint32 m_charactersGeneration;                          // increased when changed accounts are dropped
+    time_t m_charactersCheckTime;
+    ACE_Thread_Mutex m_charactersLock;
 };
 
 #define sRealmList ACE_Singleton<RealmList, ACE_Null_Mutex>::instance()
@@ -25,6 +25,7 @@
 #include "Configuration/Config.h"
 #include "Log.h"
 #include "RealmList.h"
+#include "LogonInfoCache.h"
 #include "AuthSocket.h"
 #include "AuthCodes.h"
 #include "SHA1.h"
@@ -201,6 +202,7 @@ AuthSocket::AuthSocket(RealmSocket& socket) : pPatch(NULL), socket_(socket)
     N.SetHexStr("894B645E89E1535BBDAD5B8B290650530801B18EBFBF5E8FAB3C82872A3E9BB7");
     g.SetDword(7);
     _authed = false;
+    _accountId = 0;
     _accountSecurityLevel = SEC_PLAYER;
 }
 
@@ -290,6 +292,9 @@ void AuthSocket::_SetVSFields(const std::string& rI)
     stmt->setString(2, _login);
     LoginDatabase.Execute(stmt);
 
+    // The cached info still has the old values
+    sLogonInfoCache->Remove(_login);
+
     OPENSSL_free((void*)v_hex);
     OPENSSL_free((void*)s_hex);
 }
@@ -355,152 +360,160 @@ bool AuthSocket::_HandleLogonChallenge()
     pkt << uint8(AUTH_LOGON_CHALLENGE);
     pkt << uint8(0x00);
 
-    // Verify that this IP is not in the ip_banned table
-    LoginDatabase.Execute(LoginDatabase.GetPreparedStatement(LOGIN_DEL_EXPIRED_IP_BANS));
-
+    // Expired bans are cleared by the main thread every BanExpiryCheckInterval, the query skips them meanwhile
     std::string const& ip_address = socket().getRemoteAddress();
-    PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_IP_BANNED);
-    stmt->setString(0, ip_address);
-    PreparedQueryResult result = LoginDatabase.Query(stmt);
-    if (result)
+    LogonInfo info;
+    if (!sLogonInfoCache->Get(_login, ip_address, info))
+    {
+        // Get the ip ban, account details and account ban in one query
+        // No SQL injection (prepared statement)
+        PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_LOGONCHALLENGE);
+        stmt->setString(0, ip_address);
+        stmt->setString(1, _login);
+        if (PreparedQueryResult result = LoginDatabase.Query(stmt))
+        {
+            Field* fields = result->Fetch();
+            info.ipBanned = fields[0].GetUInt64() != 0;
+            if (!fields[2].IsNull())
+            {
+                info.passHash = fields[1].GetString();
+                info.accountId = fields[2].GetUInt32();
+                info.locked = fields[3].GetUInt8() == 1;
+                info.lastIp = fields[4].GetString();
+                info.securityLevel = fields[5].GetUInt8();
+                info.v = fields[6].GetString();
+                info.s = fields[7].GetString();
+                info.banned = !fields[8].IsNull();
+                info.permanentBan = info.banned && fields[8].GetUInt32() == fields[9].GetUInt32();
+            }
+        }
+
+        sLogonInfoCache->Add(_login, ip_address, info);
+    }
+
+    if (info.ipBanned)
     {
         pkt << uint8(WOW_FAIL_BANNED);
         sLog->outDebug(LOG_FILTER_AUTHSERVER, "'%s:%d' [AuthChallenge] Banned ip tries to login!",socket().getRemoteAddress().c_str(), socket().getRemotePort());
     }
-    else
+    else if (info.accountId)
     {
-        // Get the account details from the account table
-        // No SQL injection (prepared statement)
-        stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_LOGONCHALLENGE);
-        stmt->setString(0, _login);
-
-        PreparedQueryResult res2 = LoginDatabase.Query(stmt);
-        if (res2)
+        // If the IP is 'locked', check that the player comes indeed from the correct IP address
+        bool locked = false;
+        if (info.locked)                                    // if ip is locked
         {
-            Field* fields = res2->Fetch();
+            sLog->outDebug(LOG_FILTER_AUTHSERVER, "[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), info.lastIp.c_str());
+            sLog->outDebug(LOG_FILTER_AUTHSERVER, "[AuthChallenge] Player address is '%s'", ip_address.c_str());
 
-            // If the IP is 'locked', check that the player comes indeed from the correct IP address
-            bool locked = false;
-            if (fields[2].GetUInt8() == 1)                  // if ip is locked
+            if (info.lastIp != ip_address)
             {
-                sLog->outDebug(LOG_FILTER_AUTHSERVER, "[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), fields[3].GetCString());
-                sLog->outDebug(LOG_FILTER_AUTHSERVER, "[AuthChallenge] Player address is '%s'", ip_address.c_str());
-
-                if (strcmp(fields[3].GetCString(), ip_address.c_str()))
-                {
-                    sLog->outDebug(LOG_FILTER_AUTHSERVER, "[AuthChallenge] Account IP differs");
-                    pkt << (uint8) WOW_FAIL_SUSPENDED;
-                    locked = true;
-                }
-                else
-                    sLog->outDebug(LOG_FILTER_AUTHSERVER, "[AuthChallenge] Account IP matches");
+                sLog->outDebug(LOG_FILTER_AUTHSERVER, "[AuthChallenge] Account IP differs");
+                pkt << (uint8) WOW_FAIL_SUSPENDED;
+                locked = true;
             }
             else
-                sLog->outDebug(LOG_FILTER_AUTHSERVER, "[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
+                sLog->outDebug(LOG_FILTER_AUTHSERVER, "[AuthChallenge] Account IP matches");
+        }
+        else
+            sLog->outDebug(LOG_FILTER_AUTHSERVER, "[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
 
-            if (!locked)
+        if (!locked)
+        {
+            // If the account is banned, reject the logon attempt
+            if (info.banned)
             {
-                //set expired bans to inactive
-                LoginDatabase.Execute(LoginDatabase.GetPreparedStatement(LOGIN_UPD_EXPIRED_ACCOUNT_BANS));
-                LoginDatabase.Execute(LoginDatabase.GetPreparedStatement(LOGIN_UPD_ACCOUNT_PREMIUM));
-
-                // If the account is banned, reject the logon attempt
-                stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_ACCOUNT_BANNED);
-                stmt->setUInt32(0, fields[1].GetUInt32());
-                PreparedQueryResult banresult = LoginDatabase.Query(stmt);
-                if (banresult)
+                if (info.permanentBan)
                 {
-                    if ((*banresult)[0].GetUInt32() == (*banresult)[1].GetUInt32())
-                    {
-                        pkt << uint8(WOW_FAIL_BANNED);
-                        sLog->outDebug(LOG_FILTER_AUTHSERVER, "'%s:%d' [AuthChallenge] Banned account %s tried to login!", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str ());
-                    }
-                    else
-                    {
-                        pkt << uint8(WOW_FAIL_SUSPENDED);
-                        sLog->outDebug(LOG_FILTER_AUTHSERVER, "'%s:%d' [AuthChallenge] Temporarily banned account %s tried to login!", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str ());
-                    }
+                    pkt << uint8(WOW_FAIL_BANNED);
+                    sLog->outDebug(LOG_FILTER_AUTHSERVER, "'%s:%d' [AuthChallenge] Banned account %s tried to login!", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str ());
                 }
                 else
                 {
-                    // Get the password from the account table, upper it, and make the SRP6 calculation
-                    std::string rI = fields[0].GetString();
+                    pkt << uint8(WOW_FAIL_SUSPENDED);
+                    sLog->outDebug(LOG_FILTER_AUTHSERVER, "'%s:%d' [AuthChallenge] Temporarily banned account %s tried to login!", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str ());
+                }
+            }
+            else
+            {
+                // Get the password from the account table, upper it, and make the SRP6 calculation
+                std::string const& rI = info.passHash;
 
-                    // Don't calculate (v, s) if there are already some in the database
-                    std::string databaseV = fields[5].GetString();
-                    std::string databaseS = fields[6].GetString();
+                // Don't calculate (v, s) if there are already some in the database
+                std::string const& databaseV = info.v;
+                std::string const& databaseS = info.s;
 
-                    sLog->outDebug(LOG_FILTER_NETWORKIO, "database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
+                sLog->outDebug(LOG_FILTER_NETWORKIO, "database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
 
-                    // multiply with 2 since bytes are stored as hexstring
-                    if (databaseV.size() != s_BYTE_SIZE * 2 || databaseS.size() != s_BYTE_SIZE * 2)
-                        _SetVSFields(rI);
-                    else
-                    {
-                        s.SetHexStr(databaseS.c_str());
-                        v.SetHexStr(databaseV.c_str());
-                    }
+                // multiply with 2 since bytes are stored as hexstring
+                if (databaseV.size() != s_BYTE_SIZE * 2 || databaseS.size() != s_BYTE_SIZE * 2)
+                    _SetVSFields(rI);
+                else
+                {
+                    s.SetHexStr(databaseS.c_str());
+                    v.SetHexStr(databaseV.c_str());
+                }
 
-                    b.SetRand(19 * 8);
-                    BigNumber gmod = g.ModExp(b, N);
-                    B = ((v * 3) + gmod) % N;
+                b.SetRand(19 * 8);
+                BigNumber gmod = g.ModExp(b, N);
+                B = ((v * 3) + gmod) % N;
 
-                    ASSERT(gmod.GetNumBytes() <= 32);
+                ASSERT(gmod.GetNumBytes() <= 32);
 
-                    BigNumber unk3;
-                    unk3.SetRand(16 * 8);
+                BigNumber unk3;
+                unk3.SetRand(16 * 8);
 
-                    // Fill the response packet with the result
-                    if (AuthHelper::IsAcceptedClientBuild(_build))
-                        pkt << uint8(WOW_SUCCESS);
-                    else
-                        pkt << uint8(WOW_FAIL_VERSION_INVALID);
+                // Fill the response packet with the result
+                if (AuthHelper::IsAcceptedClientBuild(_build))
+                    pkt << uint8(WOW_SUCCESS);
+                else
+                    pkt << uint8(WOW_FAIL_VERSION_INVALID);
+
+                // B may be calculated < 32B so we force minimal length to 32B
+                pkt.append(B.AsByteArray(32), 32);      // 32 bytes
+                pkt << uint8(1);
+                pkt.append(g.AsByteArray(), 1);
+                pkt << uint8(32);
+                pkt.append(N.AsByteArray(32), 32);
+                pkt.append(s.AsByteArray(), s.GetNumBytes());   // 32 bytes
+                pkt.append(unk3.AsByteArray(16), 16);
+                uint8 securityFlags = 0;
+                pkt << uint8(securityFlags);            // security flags (0x0...0x04)
+
+                if (securityFlags & 0x01)               // PIN input
+                {
+                    pkt << uint32(0);
+                    pkt << uint64(0) << uint64(0);      // 16 bytes hash?
+                }
 
-                    // B may be calculated < 32B so we force minimal length to 32B
-                    pkt.append(B.AsByteArray(32), 32);      // 32 bytes
-                    pkt << uint8(1);
-                    pkt.append(g.AsByteArray(), 1);
-                    pkt << uint8(32);
-                    pkt.append(N.AsByteArray(32), 32);
-                    pkt.append(s.AsByteArray(), s.GetNumBytes());   // 32 bytes
-                    pkt.append(unk3.AsByteArray(16), 16);
-                    uint8 securityFlags = 0;
-                    pkt << uint8(securityFlags);            // security flags (0x0...0x04)
-
-                    if (securityFlags & 0x01)               // PIN input
-                    {
-                        pkt << uint32(0);
-                        pkt << uint64(0) << uint64(0);      // 16 bytes hash?
-                    }
+                if (securityFlags & 0x02)               // Matrix input
+                {
+                    pkt << uint8(0);
+                    pkt << uint8(0);
+                    pkt << uint8(0);
+                    pkt << uint8(0);
+                    pkt << uint64(0);
+                }
 
-                    if (securityFlags & 0x02)               // Matrix input
-                    {
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint64(0);
-                    }
+                if (securityFlags & 0x04)               // Security token input
+                    pkt << uint8(1);
 
-                    if (securityFlags & 0x04)               // Security token input
-                        pkt << uint8(1);
+                _accountId = info.accountId;
 
-                    uint8 secLevel = fields[4].GetUInt8();
-                    _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
+                uint8 secLevel = info.securityLevel;
+                _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
 
-                    _localizationName.resize(4);
-                    for (int i = 0; i < 4; ++i)
-                        _localizationName[i] = ch->country[4-i-1];
+                _localizationName.resize(4);
+                for (int i = 0; i < 4; ++i)
+                    _localizationName[i] = ch->country[4-i-1];
 
-                    sLog->outDebug(LOG_FILTER_AUTHSERVER, "'%s:%d' [AuthChallenge] account %s is using '%c%c%c%c' locale (%u)", socket().getRemoteAddress().c_str(), socket().getRemotePort(),
-                            _login.c_str (), ch->country[3], ch->country[2], ch->country[1], ch->country[0], GetLocaleByName(_localizationName)
-                        );
-                }
+                sLog->outDebug(LOG_FILTER_AUTHSERVER, "'%s:%d' [AuthChallenge] account %s is using '%c%c%c%c' locale (%u)", socket().getRemoteAddress().c_str(), socket().getRemotePort(),
+                        _login.c_str (), ch->country[3], ch->country[2], ch->country[1], ch->country[0], GetLocaleByName(_localizationName)
+                    );
             }
         }
-        else                                                //no account
-            pkt << (uint8)WOW_FAIL_UNKNOWN_ACCOUNT;
     }
+    else                                                    //no account
+        pkt << (uint8)WOW_FAIL_UNKNOWN_ACCOUNT;
 
     socket().send((char const*)pkt.contents(), pkt.size());
     return true;
@@ -675,6 +688,9 @@ bool AuthSocket::_HandleLogonProof()
                     uint32 WrongPassBanTime = ConfigMgr::GetIntDefault("WrongPass.BanTime", 600);
                     bool WrongPassBanType = ConfigMgr::GetBoolDefault("WrongPass.BanType", false);
 
+                    // Next logon must see the ban
+                    sLogonInfoCache->Remove(_login);
+
                     if (WrongPassBanType)
                     {
                         uint32 acc_id = (*loginfail)[0].GetUInt32();
@@ -764,6 +780,7 @@ bool AuthSocket::_HandleReconnectChallenge()
     std::reverse(_os.begin(), _os.end());
 
     Field* fields = result->Fetch();
+    _accountId = fields[1].GetUInt32();
     uint8 secLevel = fields[2].GetUInt8();
     _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
 
@@ -829,116 +846,32 @@ bool AuthSocket::_HandleRealmList()
 
     socket().recv_skip(5);
 
-    // Get the user id (else close the connection)
-    // No SQL injection (prepared statement)
-    PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_ACCOUNT_ID_BY_NAME);
-    stmt->setString(0, _login);
-    PreparedQueryResult result = LoginDatabase.Query(stmt);
-    if (!result)
+    // The account id is known since the (reconnect) challenge
+    if (!_accountId)
     {
         sLog->outError(LOG_FILTER_AUTHSERVER, "'%s:%d' [ERROR] user %s tried to login but we cannot find him in the database.", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str());
         socket().shutdown();
         return false;
     }
 
-    Field* fields = result->Fetch();
-    uint32 id = fields[0].GetUInt32();
+    // The realm list is built once per client build, only the lock and character count of each realm depend on the account
+    RealmListPacket realmList;
+    sRealmList->GetRealmListPacket(_build, realmList);
 
-    // Update realm list if need
-    sRealmList->UpdateIfNeed();
-
-    // Circle through realms in the RealmList and construct the return packet (including # of user characters in each realm)
-    ByteBuffer pkt;
+    RealmCharacterCounts characterCounts;
+    sRealmList->GetCharacterCounts(_accountId, characterCounts);
 
-    size_t RealmListSize = 0;
-    for (RealmList::RealmMap::const_iterator i = sRealmList->begin(); i != sRealmList->end(); ++i)
+    for (std::vector<RealmListPacket::AccountField>::const_iterator itr = realmList.accountFields.begin(); itr != realmList.accountFields.end(); ++itr)
     {
-        // don't work with realms which not compatible with the client
-        bool okBuild = ((_expversion & POST_BC_EXP_FLAG) && i->second.gamebuild == _build) || ((_expversion & PRE_BC_EXP_FLAG) && !AuthHelper::IsPreBCAcceptedClientBuild(i->second.gamebuild));
-
-        // No SQL injection. id of realm is controlled by the database.
-        uint32 flag = i->second.flag;
-        RealmBuildInfo const* buildInfo = AuthHelper::GetBuildInfo(i->second.gamebuild);
-        if (!okBuild)
-        {
-            if (!buildInfo)
-                continue;
-
-            flag |= REALM_FLAG_OFFLINE | REALM_FLAG_SPECIFYBUILD;   // tell the client what build the realm is for
-        }
+        if (itr->lockPos)
+            realmList.data.put<uint8>(itr->lockPos, itr->allowedSecurityLevel > _accountSecurityLevel ? 1 : 0);
 
-        if (!buildInfo)
-            flag &= ~REALM_FLAG_SPECIFYBUILD;
-
-        std::string name = i->first;
-        if (_expversion & PRE_BC_EXP_FLAG && flag & REALM_FLAG_SPECIFYBUILD)
-        {
-            std::ostringstream ss;
-            ss << name << " (" << buildInfo->MajorVersion << '.' << buildInfo->MinorVersion << '.' << buildInfo->BugfixVersion << ')';
-            name = ss.str();
-        }
-
-        uint8 lock = (i->second.allowedSecurityLevel > _accountSecurityLevel) ? 1 : 0;
-
-        uint8 AmountOfCharacters = 0;
-        stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_NUM_CHARS_ON_REALM);
-        stmt->setUInt32(0, i->second.m_ID);
-        stmt->setUInt32(1, id);
-        result = LoginDatabase.Query(stmt);
-        if (result)
-            AmountOfCharacters = (*result)[0].GetUInt8();
-
-        pkt << i->second.icon;                              // realm type
-        if (_expversion & POST_BC_EXP_FLAG)                 // only 2.x and 3.x clients
-            pkt << lock;                                    // if 1, then realm locked
-        pkt << uint8(flag);                                 // RealmFlags
-        pkt << name;
-        pkt << i->second.address;
-        pkt << i->second.populationLevel;
-        pkt << AmountOfCharacters;
-        pkt << i->second.timezone;                          // realm category
-        if (_expversion & POST_BC_EXP_FLAG)                 // 2.x and 3.x clients
-            pkt << uint8(0x2C);                             // unk, may be realm number/id?
-        else
-            pkt << uint8(0x0);                              // 1.12.1 and 1.12.2 clients
-
-        if (_expversion & POST_BC_EXP_FLAG && flag & REALM_FLAG_SPECIFYBUILD)
-        {
-            pkt << uint8(buildInfo->MajorVersion);
-            pkt << uint8(buildInfo->MinorVersion);
-            pkt << uint8(buildInfo->BugfixVersion);
-            pkt << uint16(buildInfo->Build);
-        }
-
-        ++RealmListSize;
+        RealmCharacterCounts::const_iterator count = characterCounts.find(itr->realmId);
+        if (count != characterCounts.end())
+            realmList.data.put<uint8>(itr->charCountPos, count->second);
     }
 
-    if (_expversion & POST_BC_EXP_FLAG)                     // 2.x and 3.x clients
-    {
-        pkt << uint8(0x10);
-        pkt << uint8(0x00);
-    }
-    else                                                    // 1.12.1 and 1.12.2 clients
-    {
-        pkt << uint8(0x00);
-        pkt << uint8(0x02);
-    }
-
-    // make a ByteBuffer which stores the RealmList's size
-    ByteBuffer RealmListSizeBuffer;
-    RealmListSizeBuffer << uint32(0);
-    if (_expversion & POST_BC_EXP_FLAG)                     // only 2.x and 3.x clients
-        RealmListSizeBuffer << uint16(RealmListSize);
-    else
-        RealmListSizeBuffer << uint32(RealmListSize);
-
-    ByteBuffer hdr;
-    hdr << uint8(REALM_LIST);
-    hdr << uint16(pkt.size() + RealmListSizeBuffer.size());
-    hdr.append(RealmListSizeBuffer);                        // append RealmList's size buffer
-    hdr.append(pkt);                                        // append realms in the realmlist
-
-    socket().send((char const*)hdr.contents(), hdr.size());
+    socket().send((char const*)realmList.data.contents(), realmList.data.size());
 
     return true;
 }
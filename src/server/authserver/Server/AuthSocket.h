@@ -64,6 +64,7 @@ private:
     bool _authed;
 
     std::string _login;
+    uint32 _accountId;
 
     // Since GetLocaleByName() is _NOT_ bijective, we have to store the locale as a string. Otherwise we can't differ
     // between enUS and enGB, which is important for the patch system
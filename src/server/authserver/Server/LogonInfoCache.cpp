@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LogonInfoCache.h"
+#include "Timer.h"
+
+bool LogonInfoCache::Get(std::string const& login, std::string const& ip, LogonInfo& info)
+{
+    if (!_duration)
+        return false;
+
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    EntryMap::const_iterator itr = _entries.find(login);
+    if (itr == _entries.end() || itr->second.ip != ip || GetMSTimeDiffToNow(itr->second.addTime) >= _duration)
+        return false;
+
+    info = itr->second.info;
+    return true;
+}
+
+void LogonInfoCache::Add(std::string const& login, std::string const& ip, LogonInfo const& info)
+{
+    // unknown logins are not kept, anyone can make up any number of them
+    if (!_duration || !info.accountId)
+        return;
+
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    Entry& entry = _entries[login];
+    entry.ip = ip;
+    entry.info = info;
+    entry.addTime = getMSTime();
+}
+
+void LogonInfoCache::Remove(std::string const& login)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    _entries.erase(login);
+}
+
+void LogonInfoCache::RemoveExpired()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    for (EntryMap::iterator itr = _entries.begin(); itr != _entries.end();)
+    {
+        if (GetMSTimeDiffToNow(itr->second.addTime) >= _duration)
+            _entries.erase(itr++);
+        else
+            ++itr;
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LOGONINFOCACHE_H
+#define _LOGONINFOCACHE_H
+
+#include "Common.h"
+#include <ace/Singleton.h>
+#include <ace/Thread_Mutex.h>
+
+/// Account and ban rows checked by the logon challenge
+struct LogonInfo
+{
+    LogonInfo() : ipBanned(false), accountId(0), locked(false), securityLevel(0), banned(false), permanentBan(false) { }
+
+    bool ipBanned;
+    uint32 accountId;                                       // 0 if the account does not exist
+    std::string passHash;
+    bool locked;
+    std::string lastIp;
+    uint8 securityLevel;
+    std::string v;
+    std::string s;
+    bool banned;
+    bool permanentBan;
+};
+
+/// Keeps the logon info of recent logons for a few seconds, clients retrying after a failed or
+/// dropped logon do not query the login database again. Bans and password changes made in the
+/// meantime are seen once the entry expires.
+class LogonInfoCache
+{
+public:
+    LogonInfoCache() : _duration(0) { }
+
+    void Initialize(uint32 duration) { _duration = duration; }
+
+    bool Get(std::string const& login, std::string const& ip, LogonInfo& info);
+    void Add(std::string const& login, std::string const& ip, LogonInfo const& info);
+    void Remove(std::string const& login);
+    void RemoveExpired();
+
+private:
+    struct Entry
+    {
+        std::string ip;                                     // the ip ban and locked account checks depend on it
+        LogonInfo info;
+        uint32 addTime;
+    };
+
+    typedef std::map<std::string, Entry> EntryMap;
+
+    ACE_Thread_Mutex _lock;
+    EntryMap _entries;
+    uint32 _duration;                                       // milliseconds, 0 disables the cache
+};
+
+#define sLogonInfoCache ACE_Singleton<LogonInfoCache, ACE_Thread_Mutex>::instance()
+
+#endif
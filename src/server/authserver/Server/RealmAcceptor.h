@@ -24,6 +24,7 @@
 
 #include "RealmSocket.h"
 #include "AuthSocket.h"
+#include "RealmReactorPool.h"
 
 class RealmAcceptor : public ACE_Acceptor<RealmSocket, ACE_SOCK_Acceptor>
 {
@@ -41,7 +42,12 @@ protected:
         if (sh == 0)
             ACE_NEW_RETURN(sh, RealmSocket, -1);
 
-        sh->reactor(reactor());
+        // handled by a network thread if any, else by the acceptor one
+        if (ACE_Reactor* networkReactor = sRealmReactorPool->GetReactor())
+            sh->reactor(networkReactor);
+        else
+            sh->reactor(reactor());
+
         sh->set_session(new AuthSocket(*sh));
         return 0;
     }
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <ace/Dev_Poll_Reactor.h>
+#include <ace/Guard_T.h>
+#include <ace/TP_Reactor.h>
+#include <ace/Task.h>
+
+#include "RealmReactorPool.h"
+#include "Log.h"
+
+class RealmReactorRunnable : protected ACE_Task_Base
+{
+public:
+    RealmReactorRunnable()
+    {
+        ACE_Reactor_Impl* imp = NULL;
+
+#if defined (ACE_HAS_EVENT_POLL) || defined (ACE_HAS_DEV_POLL)
+        imp = new ACE_Dev_Poll_Reactor();
+        imp->max_notify_iterations(128);
+        imp->restart(1);
+#else
+        imp = new ACE_TP_Reactor();
+        imp->max_notify_iterations(128);
+#endif
+
+        _reactor = new ACE_Reactor(imp, 1);
+    }
+
+    ~RealmReactorRunnable()
+    {
+        Stop();
+        wait();
+
+        delete _reactor;
+    }
+
+    int Start() { return activate(); }
+    void Stop() { _reactor->end_reactor_event_loop(); }
+    void Wait() { wait(); }
+
+    ACE_Reactor* GetReactor() { return _reactor; }
+
+protected:
+    virtual int svc()
+    {
+        sLog->outDebug(LOG_FILTER_AUTHSERVER, "Network thread starting");
+
+        while (!_reactor->reactor_event_loop_done())
+        {
+            // the reactor modifies the interval
+            ACE_Time_Value interval(0, 100000);
+
+            if (_reactor->run_reactor_event_loop(interval) == -1)
+                break;
+        }
+
+        sLog->outDebug(LOG_FILTER_AUTHSERVER, "Network thread exits");
+        return 0;
+    }
+
+private:
+    ACE_Reactor* _reactor;
+};
+
+RealmReactorPool::RealmReactorPool() : _threads(NULL), _threadCount(0), _nextThread(0) { }
+
+RealmReactorPool::~RealmReactorPool()
+{
+    Stop();
+}
+
+bool RealmReactorPool::Start(uint32 threads)
+{
+    if (!threads)
+        return true;
+
+    _threads = new RealmReactorRunnable[threads];
+    _threadCount = threads;
+
+    for (uint32 i = 0; i < _threadCount; ++i)
+    {
+        if (_threads[i].Start() == -1)
+        {
+            sLog->outError(LOG_FILTER_AUTHSERVER, "Cannot start network thread %u", i);
+            return false;
+        }
+    }
+
+    sLog->outInfo(LOG_FILTER_AUTHSERVER, "Started %u network threads", _threadCount);
+    return true;
+}
+
+void RealmReactorPool::Stop()
+{
+    if (!_threads)
+        return;
+
+    for (uint32 i = 0; i < _threadCount; ++i)
+        _threads[i].Stop();
+
+    for (uint32 i = 0; i < _threadCount; ++i)
+        _threads[i].Wait();
+
+    delete[] _threads;
+    _threads = NULL;
+    _threadCount = 0;
+}
+
+ACE_Reactor* RealmReactorPool::GetReactor()
+{
+    if (!_threadCount)
+        return NULL;
+
+    // logon connections are short lived, spreading them in turn is enough
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    ACE_Reactor* reactor = _threads[_nextThread].GetReactor();
+    _nextThread = (_nextThread + 1) % _threadCount;
+    return reactor;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _REALMREACTORPOOL_H
+#define _REALMREACTORPOOL_H
+
+#include "Common.h"
+#include <ace/Singleton.h>
+#include <ace/Thread_Mutex.h>
+
+class ACE_Reactor;
+class RealmReactorRunnable;
+
+/// Network threads handling the client connections, each running its own reactor. The logon
+/// handlers (SRP6 and login database queries) of different connections run in parallel.
+class RealmReactorPool
+{
+public:
+    RealmReactorPool();
+    ~RealmReactorPool();
+
+    bool Start(uint32 threads);
+    void Stop();
+
+    /// Reactor of the network thread a new connection is handled by, NULL without network threads
+    ACE_Reactor* GetReactor();
+
+private:
+    RealmReactorRunnable* _threads;
+    uint32 _threadCount;
+    uint32 _nextThread;
+    ACE_Thread_Mutex _lock;
+};
+
+#define sRealmReactorPool ACE_Singleton<RealmReactorPool, ACE_Thread_Mutex>::instance()
+
+#endif
@@ -67,7 +67,7 @@ class SmartAI : public CreatureAI
 
         InstanceScript* instance;
 
-        void SetScript9(SmartScriptHolder& e, uint32 entry, Unit* invoker);
+        void SetScript9(SmartScriptHolder const& e, uint32 entry, Unit* invoker);
         SmartScript* GetScript() { return &mScript; }
         bool IsEscortInvokerInRange();
 
@@ -259,7 +259,7 @@ class SmartGameObjectAI : public GameObjectAI
         uint32 GetDialogStatus(Player* /*player*/);
         void Destroyed(Player* player, uint32 eventId);
         void SetData(uint32 id, uint32 value);
-        void SetScript9(SmartScriptHolder& e, uint32 entry, Unit* invoker);
+        void SetScript9(SmartScriptHolder const& e, uint32 entry, Unit* invoker);
         void OnGameEvent(bool start, uint16 eventId);
         void OnStateChanged(uint32 state, Unit* unit);
         void EventInform(uint32 eventId);
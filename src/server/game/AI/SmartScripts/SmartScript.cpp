@@ -35,6 +35,7 @@
 #include "Vehicle.h"
 #include "ScriptedGossip.h"
 #include "CreatureTextMgr.h"
+#include "ScriptProfiler.h"
 
 class TrinityStringTextBuilder
 {
@@ -101,10 +102,15 @@ SmartScript::SmartScript()
     goOrigGUID = 0;
     mLastInvoker = 0;
     mScriptType = SMART_SCRIPT_TYPE_CREATURE;
+    mProgram = NULL;
+    mTimedActionListProgram = NULL;
 }
 
 SmartScript::~SmartScript()
 {
+    SetProgramReference(mProgram, NULL);
+    SetProgramReference(mTimedActionListProgram, NULL);
+
     for (ObjectListMap::iterator itr = mTargetStorage->begin(); itr != mTargetStorage->end(); ++itr)
         delete itr->second;
 
@@ -115,9 +121,9 @@ void SmartScript::OnReset()
 {
     SetPhase(0);
     ResetBaseObject();
-    for (SmartAIEventList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
+    for (SmartEventStateList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
     {
-        if (!((*i).event.event_flags & SMART_EVENT_FLAG_DONT_RESET))
+        if (!(i->holder->event.event_flags & SMART_EVENT_FLAG_DONT_RESET))
         {
             InitTimer((*i));
             (*i).runOnce = false;
@@ -129,25 +135,40 @@ void SmartScript::OnReset()
 
 void SmartScript::ProcessEventsFor(SMART_EVENT e, Unit* unit, uint32 var0, uint32 var1, bool bvar, const SpellInfo* spell, GameObject* gob)
 {
-    for (SmartAIEventList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
+    if (e == SMART_EVENT_LINK)//special handling
+        return;
+
+    // events of the program through its jump table, the state of program event i is mEvents[i]
+    size_t programEvents = 0;
+    if (mProgram)
     {
-        SMART_EVENT eventType = SMART_EVENT((*i).GetEventType());
-        if (eventType == SMART_EVENT_LINK)//special handling
-            continue;
+        programEvents = mProgram->Events.size();
+        for (uint16 const* i = mProgram->BeginEventsOfType(e); i != mProgram->EndEventsOfType(e); ++i)
+            ProcessEventIfAllowed(mEvents[*i], unit, var0, var1, bvar, spell, gob);
+    }
 
-        if (eventType == e/* && (!(*i).event.event_phase_mask || IsInPhase((*i).event.event_phase_mask)) && !((*i).event.event_flags & SMART_EVENT_FLAG_NOT_REPEATABLE && (*i).runOnce)*/)
-        {
-            ConditionList conds = sConditionMgr->GetConditionsForSmartEvent((*i).entryOrGuid, (*i).event_id, (*i).source_type);
-            ConditionSourceInfo info = ConditionSourceInfo(unit, GetBaseObject());
+    // events installed at runtime (AI templates) are few, scan them
+    for (size_t i = programEvents; i < mEvents.size(); ++i)
+        if (mEvents[i].holder->GetEventType() == uint32(e))
+            ProcessEventIfAllowed(mEvents[i], unit, var0, var1, bvar, spell, gob);
+}
 
-            if (sConditionMgr->IsObjectMeetToConditions(info, conds))
-                ProcessEvent(*i, unit, var0, var1, bvar, spell, gob);
-        }
+void SmartScript::ProcessEventIfAllowed(SmartEventState& state, Unit* unit, uint32 var0, uint32 var1, bool bvar, const SpellInfo* spell, GameObject* gob)
+{
+    if (ConditionList const* conds = state.holder->conditions)
+    {
+        ConditionSourceInfo info = ConditionSourceInfo(unit, GetBaseObject());
+        if (!sConditionMgr->IsObjectMeetToConditions(info, *conds))
+            return;
     }
+
+    ProcessEvent(state, unit, var0, var1, bvar, spell, gob);
 }
 
-void SmartScript::ProcessAction(SmartScriptHolder& e, Unit* unit, uint32 var0, uint32 var1, bool bvar, const SpellInfo* spell, GameObject* gob)
+void SmartScript::ProcessAction(SmartEventState& state, Unit* unit, uint32 var0, uint32 var1, bool bvar, const SpellInfo* spell, GameObject* gob)
 {
+    SmartScriptHolder const& e = *state.holder;
+
     //calc random
     if (e.GetEventType() != SMART_EVENT_LINK && e.event.event_chance < 100 && e.event.event_chance)
     {
@@ -155,7 +176,10 @@ void SmartScript::ProcessAction(SmartScriptHolder& e, Unit* unit, uint32 var0, u
         if (e.event.event_chance <= rnd)
             return;
     }
-    e.runOnce = true;//used for repeat check
+    state.runOnce = true;//used for repeat check
+
+    WorldObject* baseObject = GetBaseObject();
+    ScriptProfileScope profile(SCRIPT_PROFILE_SMART_ACTION, baseObject ? baseObject->GetMapId() : 0, e.GetActionType());
 
     if (unit)
         mLastInvoker = unit->GetGUID();
@@ -1467,8 +1491,11 @@ void SmartScript::ProcessAction(SmartScriptHolder& e, Unit* unit, uint32 var0, u
             ev.event_id = e.action.timeEvent.id;
             ev.target = e.target;
             ev.action = ac;
-            InitTimer(ev);
-            mStoredEvents.push_back(ev);
+            mOwnedEvents.push_back(ev);
+
+            SmartEventState evState(&mOwnedEvents.back());
+            InitTimer(evState);
+            mStoredEvents.push_back(evState);
             break;
         }
         case SMART_ACTION_TRIGGER_TIMED_EVENT:
@@ -1989,8 +2016,8 @@ void SmartScript::ProcessAction(SmartScriptHolder& e, Unit* unit, uint32 var0, u
 
     if (e.link && e.link != e.event_id)
     {
-        SmartScriptHolder linked = FindLinkedEvent(e.link);
-        if (linked.GetActionType() && linked.GetEventType() == SMART_EVENT_LINK)
+        SmartEventState linked = FindLinkedEvent(e.link);
+        if (linked.holder && linked.holder->GetActionType() && linked.holder->GetEventType() == SMART_EVENT_LINK)
             ProcessEvent(linked, unit, var0, var1, bvar, spell, gob);
         //else
         //    sLog->outError(LOG_FILTER_SQL, "SmartScript::ProcessAction: Entry %d SourceType %u, Event %u, Link Event %u not found or invalid, skipped.", e.entryOrGuid, e.GetScriptType(), e.event_id, e.link);
@@ -2105,7 +2132,6 @@ SmartScriptHolder SmartScript::CreateEvent(SMART_EVENT e, uint32 event_flags, ui
     script.target.raw.param3 = target_param3;
 
     script.source_type = SMART_SCRIPT_TYPE_CREATURE;
-    InitTimer(script);
     return script;
 }
 
@@ -2396,35 +2422,37 @@ ObjectList* SmartScript::GetWorldObjectsInDist(float dist)
     return targets;
 }
 
-void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, uint32 var1, bool bvar, const SpellInfo* spell, GameObject* gob)
+void SmartScript::ProcessEvent(SmartEventState& state, Unit* unit, uint32 var0, uint32 var1, bool bvar, const SpellInfo* spell, GameObject* gob)
 {
-    if (!e.active && e.GetEventType() != SMART_EVENT_LINK)
+    SmartScriptHolder const& e = *state.holder;
+
+    if (!state.active && e.GetEventType() != SMART_EVENT_LINK)
         return;
 
-    if ((e.event.event_phase_mask && !IsInPhase(e.event.event_phase_mask)) || ((e.event.event_flags & SMART_EVENT_FLAG_NOT_REPEATABLE) && e.runOnce))
+    if ((e.event.event_phase_mask && !IsInPhase(e.event.event_phase_mask)) || ((e.event.event_flags & SMART_EVENT_FLAG_NOT_REPEATABLE) && state.runOnce))
         return;
 
     switch (e.GetEventType())
     {
         case SMART_EVENT_LINK://special handling
-            ProcessAction(e, unit, var0, var1, bvar, spell, gob);
+            ProcessAction(state, unit, var0, var1, bvar, spell, gob);
             break;
         //called from Update tick
         case SMART_EVENT_UPDATE:
-            RecalcTimer(e, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
-            ProcessAction(e);
+            RecalcTimer(state, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
+            ProcessAction(state);
             break;
         case SMART_EVENT_UPDATE_OOC:
             if (me && me->isInCombat())
                 return;
-            RecalcTimer(e, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
-            ProcessAction(e);
+            RecalcTimer(state, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
+            ProcessAction(state);
             break;
         case SMART_EVENT_UPDATE_IC:
             if (!me || !me->isInCombat())
                 return;
-            RecalcTimer(e, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
-            ProcessAction(e);
+            RecalcTimer(state, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
+            ProcessAction(state);
             break;
         case SMART_EVENT_HEALT_PCT:
         {
@@ -2433,8 +2461,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
             uint32 perc = (uint32)me->GetHealthPct();
             if (perc > e.event.minMaxRepeat.max || perc < e.event.minMaxRepeat.min)
                 return;
-            RecalcTimer(e, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
-            ProcessAction(e);
+            RecalcTimer(state, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
+            ProcessAction(state);
             break;
         }
         case SMART_EVENT_TARGET_HEALTH_PCT:
@@ -2444,8 +2472,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
             uint32 perc = (uint32)me->getVictim()->GetHealthPct();
             if (perc > e.event.minMaxRepeat.max || perc < e.event.minMaxRepeat.min)
                 return;
-            RecalcTimer(e, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
-            ProcessAction(e, me->getVictim());
+            RecalcTimer(state, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
+            ProcessAction(state, me->getVictim());
             break;
         }
         case SMART_EVENT_MANA_PCT:
@@ -2455,8 +2483,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
             uint32 perc = uint32(100.0f * me->GetPower(POWER_MANA) / me->GetMaxPower(POWER_MANA));
             if (perc > e.event.minMaxRepeat.max || perc < e.event.minMaxRepeat.min)
                 return;
-            RecalcTimer(e, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
-            ProcessAction(e);
+            RecalcTimer(state, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
+            ProcessAction(state);
             break;
         }
         case SMART_EVENT_TARGET_MANA_PCT:
@@ -2466,8 +2494,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
             uint32 perc = uint32(100.0f * me->getVictim()->GetPower(POWER_MANA) / me->getVictim()->GetMaxPower(POWER_MANA));
             if (perc > e.event.minMaxRepeat.max || perc < e.event.minMaxRepeat.min)
                 return;
-            RecalcTimer(e, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
-            ProcessAction(e, me->getVictim());
+            RecalcTimer(state, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
+            ProcessAction(state, me->getVictim());
             break;
         }
         case SMART_EVENT_RANGE:
@@ -2477,8 +2505,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
 
             if (me->IsInRange(me->getVictim(), (float)e.event.minMaxRepeat.min, (float)e.event.minMaxRepeat.max))
             {
-                ProcessAction(e, me->getVictim());
-                RecalcTimer(e, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
+                ProcessAction(state, me->getVictim());
+                RecalcTimer(state, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
             }
             break;
         }
@@ -2486,8 +2514,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
         {
             if (!me || !me->isInCombat() || !me->getVictim() || !me->getVictim()->IsNonMeleeSpellCasted(false, false, true))
                 return;
-            ProcessAction(e, me->getVictim());
-            RecalcTimer(e, e.event.minMax.repeatMin, e.event.minMax.repeatMax);
+            ProcessAction(state, me->getVictim());
+            RecalcTimer(state, e.event.minMax.repeatMin, e.event.minMax.repeatMax);
         }
         case SMART_EVENT_FRIENDLY_HEALTH:
         {
@@ -2497,8 +2525,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
             Unit* target = DoSelectLowestHpFriendly((float)e.event.friendlyHealt.radius, e.event.friendlyHealt.hpDeficit);
             if (!target)
                 return;
-            ProcessAction(e, target);
-            RecalcTimer(e, e.event.friendlyHealt.repeatMin, e.event.friendlyHealt.repeatMax);
+            ProcessAction(state, target);
+            RecalcTimer(state, e.event.friendlyHealt.repeatMin, e.event.friendlyHealt.repeatMax);
             break;
         }
         case SMART_EVENT_FRIENDLY_IS_CC:
@@ -2510,8 +2538,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
             DoFindFriendlyCC(pList, (float)e.event.friendlyCC.radius);
             if (pList.empty())
                 return;
-            ProcessAction(e, *(pList.begin()));
-            RecalcTimer(e, e.event.friendlyCC.repeatMin, e.event.friendlyCC.repeatMax);
+            ProcessAction(state, *(pList.begin()));
+            RecalcTimer(state, e.event.friendlyCC.repeatMin, e.event.friendlyCC.repeatMax);
             break;
         }
         case SMART_EVENT_FRIENDLY_MISSING_BUFF:
@@ -2521,8 +2549,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
 
             if (pList.empty())
                 return;
-            ProcessAction(e, *(pList.begin()));
-            RecalcTimer(e, e.event.missingBuff.repeatMin, e.event.missingBuff.repeatMax);
+            ProcessAction(state, *(pList.begin()));
+            RecalcTimer(state, e.event.missingBuff.repeatMin, e.event.missingBuff.repeatMax);
             break;
         }
         case SMART_EVENT_HAS_AURA:
@@ -2532,8 +2560,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
             uint32 count = me->GetAuraCount(e.event.aura.spell);
             if ((!e.event.aura.count && !count) || (e.event.aura.count && count >= e.event.aura.count))
             {
-                ProcessAction(e);
-                RecalcTimer(e, e.event.aura.repeatMin, e.event.aura.repeatMax);
+                ProcessAction(state);
+                RecalcTimer(state, e.event.aura.repeatMin, e.event.aura.repeatMax);
             }
             break;
         }
@@ -2544,8 +2572,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
             uint32 count = me->getVictim()->GetAuraCount(e.event.aura.spell);
             if (count < e.event.aura.count)
                 return;
-            ProcessAction(e);
-            RecalcTimer(e, e.event.aura.repeatMin, e.event.aura.repeatMax);
+            ProcessAction(state);
+            RecalcTimer(state, e.event.aura.repeatMin, e.event.aura.repeatMax);
             break;
         }
         //no params
@@ -2570,7 +2598,7 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
         case SMART_EVENT_GOSSIP_HELLO:
         case SMART_EVENT_FOLLOW_COMPLETED:
         case SMART_EVENT_ON_SPELLCLICK:
-            ProcessAction(e, unit, var0, var1, bvar, spell, gob);
+            ProcessAction(state, unit, var0, var1, bvar, spell, gob);
             break;
         case SMART_EVENT_IS_BEHIND_TARGET:
             {
@@ -2581,8 +2609,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
                 {
                     if (!victim->HasInArc(static_cast<float>(M_PI), me))
                     {
-                        ProcessAction(e, victim);
-                        RecalcTimer(e, e.event.behindTarget.cooldownMin, e.event.behindTarget.cooldownMax);
+                        ProcessAction(state, victim);
+                        RecalcTimer(state, e.event.behindTarget.cooldownMin, e.event.behindTarget.cooldownMax);
                     }
                 }
                 break;
@@ -2590,8 +2618,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
         case SMART_EVENT_RECEIVE_EMOTE:
             if (e.event.emote.emote == var0)
             {
-                ProcessAction(e, unit);
-                RecalcTimer(e, e.event.emote.cooldownMin, e.event.emote.cooldownMax);
+                ProcessAction(state, unit);
+                RecalcTimer(state, e.event.emote.cooldownMin, e.event.emote.cooldownMax);
             }
             break;
         case SMART_EVENT_KILL:
@@ -2602,8 +2630,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
                 return;
             if (e.event.kill.creature && unit->GetEntry() != e.event.kill.creature)
                 return;
-            ProcessAction(e, unit);
-            RecalcTimer(e, e.event.kill.cooldownMin, e.event.kill.cooldownMax);
+            ProcessAction(state, unit);
+            RecalcTimer(state, e.event.kill.cooldownMin, e.event.kill.cooldownMax);
             break;
         }
         case SMART_EVENT_SPELLHIT_TARGET:
@@ -2614,8 +2642,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
             if ((!e.event.spellHit.spell || spell->Id == e.event.spellHit.spell) &&
                 (!e.event.spellHit.school || (spell->SchoolMask & e.event.spellHit.school)))
                 {
-                    ProcessAction(e, unit, 0, 0, bvar, spell);
-                    RecalcTimer(e, e.event.spellHit.cooldownMin, e.event.spellHit.cooldownMax);
+                    ProcessAction(state, unit, 0, 0, bvar, spell);
+                    RecalcTimer(state, e.event.spellHit.cooldownMin, e.event.spellHit.cooldownMax);
                 }
             break;
         }
@@ -2633,8 +2661,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
                 if ((e.event.los.noHostile && !me->IsHostileTo(unit)) ||
                     (!e.event.los.noHostile && me->IsHostileTo(unit)))
                 {
-                    ProcessAction(e, unit);
-                    RecalcTimer(e, e.event.los.cooldownMin, e.event.los.cooldownMax);
+                    ProcessAction(state, unit);
+                    RecalcTimer(state, e.event.los.cooldownMin, e.event.los.cooldownMax);
                 }
             }
             break;
@@ -2653,8 +2681,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
                 if ((e.event.los.noHostile && !me->IsHostileTo(unit)) ||
                     (!e.event.los.noHostile && me->IsHostileTo(unit)))
                 {
-                    ProcessAction(e, unit);
-                    RecalcTimer(e, e.event.los.cooldownMin, e.event.los.cooldownMax);
+                    ProcessAction(state, unit);
+                    RecalcTimer(state, e.event.los.cooldownMin, e.event.los.cooldownMax);
                 }
             }
             break;
@@ -2667,7 +2695,7 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
                 return;
             if (e.event.respawn.type == SMART_SCRIPT_RESPAWN_CONDITION_AREA && GetBaseObject()->GetZoneId() != e.event.respawn.area)
                 return;
-            ProcessAction(e);
+            ProcessAction(state);
             break;
         }
         case SMART_EVENT_SUMMONED_UNIT:
@@ -2676,8 +2704,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
                 return;
             if (e.event.summoned.creature && unit->GetEntry() != e.event.summoned.creature)
                 return;
-            ProcessAction(e, unit);
-            RecalcTimer(e, e.event.summoned.cooldownMin, e.event.summoned.cooldownMax);
+            ProcessAction(state, unit);
+            RecalcTimer(state, e.event.summoned.cooldownMin, e.event.summoned.cooldownMax);
             break;
         }
         case SMART_EVENT_RECEIVE_HEAL:
@@ -2686,15 +2714,15 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
         {
             if (var0 > e.event.minMaxRepeat.max || var0 < e.event.minMaxRepeat.min)
                 return;
-            ProcessAction(e, unit);
-            RecalcTimer(e, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
+            ProcessAction(state, unit);
+            RecalcTimer(state, e.event.minMaxRepeat.repeatMin, e.event.minMaxRepeat.repeatMax);
             break;
         }
         case SMART_EVENT_MOVEMENTINFORM:
         {
             if ((e.event.movementInform.type && var0 != e.event.movementInform.type) || (e.event.movementInform.id && var1 != e.event.movementInform.id))
                 return;
-            ProcessAction(e, unit, var0, var1);
+            ProcessAction(state, unit, var0, var1);
             break;
         }
         case SMART_EVENT_TRANSPORT_RELOCATE:
@@ -2702,7 +2730,7 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
         {
             if (e.event.waypoint.pathID && var0 != e.event.waypoint.pathID)
                 return;
-            ProcessAction(e, unit, var0);
+            ProcessAction(state, unit, var0);
             break;
         }
         case SMART_EVENT_WAYPOINT_REACHED:
@@ -2713,7 +2741,7 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
         {
             if (!me || (e.event.waypoint.pointID && var0 != e.event.waypoint.pointID) || (e.event.waypoint.pathID && GetPathId() != e.event.waypoint.pathID))
                 return;
-            ProcessAction(e, unit);
+            ProcessAction(state, unit);
             break;
         }
         case SMART_EVENT_SUMMON_DESPAWNED:
@@ -2721,8 +2749,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
         {
             if (e.event.instancePlayerEnter.team && var0 != e.event.instancePlayerEnter.team)
                 return;
-            ProcessAction(e, unit, var0);
-            RecalcTimer(e, e.event.instancePlayerEnter.cooldownMin, e.event.instancePlayerEnter.cooldownMax);
+            ProcessAction(state, unit, var0);
+            RecalcTimer(state, e.event.instancePlayerEnter.cooldownMin, e.event.instancePlayerEnter.cooldownMax);
             break;
         }
         case SMART_EVENT_ACCEPTED_QUEST:
@@ -2730,36 +2758,36 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
         {
             if (e.event.quest.quest && var0 != e.event.quest.quest)
                 return;
-            ProcessAction(e, unit, var0);
+            ProcessAction(state, unit, var0);
             break;
         }
         case SMART_EVENT_TRANSPORT_ADDCREATURE:
         {
             if (e.event.transportAddCreature.creature && var0 != e.event.transportAddCreature.creature)
                 return;
-            ProcessAction(e, unit, var0);
+            ProcessAction(state, unit, var0);
             break;
         }
         case SMART_EVENT_AREATRIGGER_ONTRIGGER:
         {
             if (e.event.areatrigger.id && var0 != e.event.areatrigger.id)
                 return;
-            ProcessAction(e, unit, var0);
+            ProcessAction(state, unit, var0);
             break;
         }
         case SMART_EVENT_TEXT_OVER:
         {
             if (var0 != e.event.textOver.textGroupID || (e.event.textOver.creatureEntry && e.event.textOver.creatureEntry != var1))
                 return;
-            ProcessAction(e, unit, var0);
+            ProcessAction(state, unit, var0);
             break;
         }
         case SMART_EVENT_DATA_SET:
         {
             if (e.event.dataSet.id != var0 || e.event.dataSet.value != var1)
                 return;
-            ProcessAction(e, unit, var0, var1);
-            RecalcTimer(e, e.event.dataSet.cooldownMin, e.event.dataSet.cooldownMax);
+            ProcessAction(state, unit, var0, var1);
+            RecalcTimer(state, e.event.dataSet.cooldownMin, e.event.dataSet.cooldownMax);
             break;
         }
         case SMART_EVENT_PASSENGER_REMOVED:
@@ -2767,28 +2795,28 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
         {
             if (!unit)
                 return;
-            ProcessAction(e, unit);
-            RecalcTimer(e, e.event.minMax.repeatMin, e.event.minMax.repeatMax);
+            ProcessAction(state, unit);
+            RecalcTimer(state, e.event.minMax.repeatMin, e.event.minMax.repeatMax);
             break;
         }
         case SMART_EVENT_TIMED_EVENT_TRIGGERED:
         {
             if (e.event.timedEvent.id == var0)
-                ProcessAction(e, unit);
+                ProcessAction(state, unit);
             break;
         }
         case SMART_EVENT_GOSSIP_SELECT:
         {
             if (e.event.gossip.sender != var0 || e.event.gossip.action != var1)
                 return;
-            ProcessAction(e, unit, var0, var1);
+            ProcessAction(state, unit, var0, var1);
             break;
         }
         case SMART_EVENT_DUMMY_EFFECT:
         {
             if (e.event.dummy.spell != var0 || e.event.dummy.effIndex != var1)
                 return;
-            ProcessAction(e, unit, var0, var1);
+            ProcessAction(state, unit, var0, var1);
             break;
         }
         case SMART_EVENT_GAME_EVENT_START:
@@ -2796,28 +2824,28 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
         {
             if (e.event.gameEvent.gameEventId != var0)
                 return;
-            ProcessAction(e, NULL, var0);
+            ProcessAction(state, NULL, var0);
             break;
         }
         case SMART_EVENT_GO_STATE_CHANGED:
         {
             if (e.event.goStateChanged.state != var0)
                 return;
-            ProcessAction(e, unit, var0, var1);
+            ProcessAction(state, unit, var0, var1);
             break;
         }
         case SMART_EVENT_GO_EVENT_INFORM:
         {
             if (e.event.eventInform.eventId != var0)
                 return;
-            ProcessAction(e, NULL, var0);
+            ProcessAction(state, NULL, var0);
             break;
         }
         case SMART_EVENT_ACTION_DONE:
         {
             if (e.event.doAction.eventId != var0)
                 return;
-            ProcessAction(e, unit, var0);
+            ProcessAction(state, unit, var0);
             break;
         }
         case SMART_EVENT_CHECK_DIST_TO_HOME:
@@ -2828,8 +2856,8 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
             Position const& _homePosition = me->GetHomePosition();
             if (me->GetDistance2d(_homePosition.GetPositionX(), _homePosition.GetPositionY()) > (float)e.event.dist.maxDist)
             {
-                ProcessAction(e, me->getVictim());
-                RecalcTimer(e, e.event.dist.repeatMin, e.event.dist.repeatMax);
+                ProcessAction(state, me->getVictim());
+                RecalcTimer(state, e.event.dist.repeatMin, e.event.dist.repeatMax);
             }
             break;
         }
@@ -2839,34 +2867,38 @@ void SmartScript::ProcessEvent(SmartScriptHolder& e, Unit* unit, uint32 var0, ui
     }
 }
 
-void SmartScript::InitTimer(SmartScriptHolder& e)
+void SmartScript::InitTimer(SmartEventState& state)
 {
+    SmartScriptHolder const& e = *state.holder;
+
     switch (e.GetEventType())
     {
         //set only events which have initial timers
         case SMART_EVENT_UPDATE:
         case SMART_EVENT_UPDATE_IC:
         case SMART_EVENT_UPDATE_OOC:
-            RecalcTimer(e, e.event.minMaxRepeat.min, e.event.minMaxRepeat.max);
+            RecalcTimer(state, e.event.minMaxRepeat.min, e.event.minMaxRepeat.max);
             break;
         case SMART_EVENT_IC_LOS:
         case SMART_EVENT_OOC_LOS:
-            RecalcTimer(e, e.event.los.cooldownMin, e.event.los.cooldownMax);
+            RecalcTimer(state, e.event.los.cooldownMin, e.event.los.cooldownMax);
             break;
         default:
-            e.active = true;
+            state.active = true;
             break;
     }
 }
-void SmartScript::RecalcTimer(SmartScriptHolder& e, uint32 min, uint32 max)
+void SmartScript::RecalcTimer(SmartEventState& state, uint32 min, uint32 max)
 {
     // min/max was checked at loading!
-    e.timer = urand(uint32(min), uint32(max));
-    e.active = e.timer ? false : true;
+    state.timer = urand(uint32(min), uint32(max));
+    state.active = state.timer ? false : true;
 }
 
-void SmartScript::UpdateTimer(SmartScriptHolder& e, uint32 const diff)
+void SmartScript::UpdateTimer(SmartEventState& state, uint32 const diff)
 {
+    SmartScriptHolder const& e = *state.holder;
+
     if (e.GetEventType() == SMART_EVENT_LINK)
         return;
 
@@ -2879,7 +2911,7 @@ void SmartScript::UpdateTimer(SmartScriptHolder& e, uint32 const diff)
     if (e.GetEventType() == SMART_EVENT_UPDATE_OOC && (me && me->isInCombat()))//can be used with me=NULL (go script)
         return;
 
-    if (e.timer < diff)
+    if (state.timer < diff)
     {
         // delay spell cast event if another spell is being casted
         if (e.GetActionType() == SMART_ACTION_CAST)
@@ -2888,13 +2920,13 @@ void SmartScript::UpdateTimer(SmartScriptHolder& e, uint32 const diff)
             {
                 if (me && me->HasUnitState(UNIT_STATE_CASTING))
                 {
-                    e.timer = 1;
+                    state.timer = 1;
                     return;
                 }
             }
         }
 
-        e.active = true;//activate events with cooldown
+        state.active = true;//activate events with cooldown
         switch (e.GetEventType())//process ONLY timed events
         {
             case SMART_EVENT_UPDATE:
@@ -2914,14 +2946,14 @@ void SmartScript::UpdateTimer(SmartScriptHolder& e, uint32 const diff)
             case SMART_EVENT_IS_BEHIND_TARGET:
             case SMART_EVENT_CHECK_DIST_TO_HOME:
             {
-                ProcessEvent(e);
+                ProcessEvent(state);
                 if (e.GetScriptType() == SMART_SCRIPT_TYPE_TIMED_ACTIONLIST)
                 {
-                    e.enableTimed = false;//disable event if it is in an ActionList and was processed once
-                    for (SmartAIEventList::iterator i = mTimedActionList.begin(); i != mTimedActionList.end(); ++i)
+                    state.enableTimed = false;//disable event if it is in an ActionList and was processed once
+                    for (SmartEventStateList::iterator i = mTimedActionList.begin(); i != mTimedActionList.end(); ++i)
                     {
                         //find the first event which is not the current one and enable it
-                        if (i->event_id > e.event_id)
+                        if (i->holder->event_id > e.event_id)
                         {
                             i->enableTimed = true;
                             break;
@@ -2933,12 +2965,12 @@ void SmartScript::UpdateTimer(SmartScriptHolder& e, uint32 const diff)
         }
     }
     else
-        e.timer -= diff;
+        state.timer -= diff;
 }
 
-bool SmartScript::CheckTimer(SmartScriptHolder const& e) const
+bool SmartScript::CheckTimer(SmartEventState const& state) const
 {
-    return e.active;
+    return state.active;
 }
 
 void SmartScript::InstallEvents()
@@ -2946,7 +2978,13 @@ void SmartScript::InstallEvents()
     if (!mInstallEvents.empty())
     {
         for (SmartAIEventList::iterator i = mInstallEvents.begin(); i != mInstallEvents.end(); ++i)
-            mEvents.push_back(*i);//must be before UpdateTimers
+        {
+            mOwnedEvents.push_back(*i);
+
+            SmartEventState state(&mOwnedEvents.back());
+            InitTimer(state);
+            mEvents.push_back(state);//must be before UpdateTimers
+        }
 
         mInstallEvents.clear();
     }
@@ -2959,17 +2997,17 @@ void SmartScript::OnUpdate(uint32 const diff)
 
     InstallEvents();//before UpdateTimers
 
-    for (SmartAIEventList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
+    for (SmartEventStateList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
         UpdateTimer(*i, diff);
 
     if (!mStoredEvents.empty())
-        for (SmartAIEventList::iterator i = mStoredEvents.begin(); i != mStoredEvents.end(); ++i)
+        for (SmartEventStateList::iterator i = mStoredEvents.begin(); i != mStoredEvents.end(); ++i)
              UpdateTimer(*i, diff);
 
     bool needCleanup = true;
     if (!mTimedActionList.empty())
     {
-        for (SmartAIEventList::iterator i = mTimedActionList.begin(); i != mTimedActionList.end(); ++i)
+        for (SmartEventStateList::iterator i = mTimedActionList.begin(); i != mTimedActionList.end(); ++i)
         {
             if ((*i).enableTimed)
             {
@@ -2979,7 +3017,10 @@ void SmartScript::OnUpdate(uint32 const diff)
         }
     }
     if (needCleanup)
+    {
         mTimedActionList.clear();
+        SetProgramReference(mTimedActionListProgram, NULL);
+    }
 
     if (!mRemIDs.empty())
     {
@@ -3003,61 +3044,73 @@ void SmartScript::OnUpdate(uint32 const diff)
     }
 }
 
-void SmartScript::FillScript(SmartAIEventList e, WorldObject* obj, AreaTriggerEntry const* at)
+void SmartScript::FillScript(SmartAIProgram const* program, WorldObject* obj, AreaTriggerEntry const* at)
 {
-    if (e.empty())
+    if (!program)
         return;
 
-    for (SmartAIEventList::iterator i = e.begin(); i != e.end(); ++i)
-    {
-        #ifndef TRINITY_DEBUG
-            if ((*i).event.event_flags & SMART_EVENT_FLAG_DEBUG_ONLY)
-                continue;
-        #endif
+    // the program already holds only the events for this kind of map, see SmartAIMgr::CompileProgram
+    SetProgramReference(mProgram, program);
+    mEvents.reserve(program->Events.size());
+    for (SmartAIEventList::const_iterator i = program->Events.begin(); i != program->Events.end(); ++i)
+        mEvents.push_back(SmartEventState(&(*i)));
 
-        if ((*i).event.event_flags & SMART_EVENT_FLAG_DIFFICULTY_ALL)//if has instance flag add only if in it
-        {
-            if (obj && obj->GetMap()->IsDungeon())
-            {
-                if ((1 << (obj->GetMap()->GetSpawnMode()+1)) & (*i).event.event_flags)
-                {
-                    mEvents.push_back((*i));
-                }
-            }
-            continue;
-        }
-        mEvents.push_back((*i));//NOTE: 'world(0)' events still get processed in ANY instance mode
-    }
     if (mEvents.empty() && obj)
         sLog->outError(LOG_FILTER_SQL, "SmartScript: Entry %u has events but no events added to list because of instance flags.", obj->GetEntry());
     if (mEvents.empty() && at)
         sLog->outError(LOG_FILTER_SQL, "SmartScript: AreaTrigger %u has events but no events added to list because of instance flags. NOTE: triggers can not handle any instance flags.", at->id);
 }
 
+void SmartScript::SetProgramReference(SmartAIProgram const*& ref, SmartAIProgram const* program)
+{
+    if (program)
+        sSmartScriptMgr->AcquireProgram(program);
+    if (ref)
+        sSmartScriptMgr->ReleaseProgram(ref);
+    ref = program;
+}
+
+static uint32 GetProgramVariant(WorldObject const* obj)
+{
+    if (!obj || !obj->GetMap()->IsDungeon() || obj->GetMap()->GetSpawnMode() >= MAX_DIFFICULTY)
+        return SMART_PROGRAM_WORLD;
+
+    return SMART_PROGRAM_DUNGEON + obj->GetMap()->GetSpawnMode();
+}
+
 void SmartScript::GetScript()
 {
-    SmartAIEventList e;
+    SmartAIProgram const* program = NULL;
     if (me)
     {
-        e = sSmartScriptMgr->GetScript(-((int32)me->GetDBTableGUIDLow()), mScriptType);
-        if (e.empty())
-            e = sSmartScriptMgr->GetScript((int32)me->GetEntry(), mScriptType);
-        FillScript(e, me, NULL);
+        uint32 variant = GetProgramVariant(me);
+        program = sSmartScriptMgr->GetProgram(-((int32)me->GetDBTableGUIDLow()), mScriptType, variant);
+        if (!program)
+            program = sSmartScriptMgr->GetProgram((int32)me->GetEntry(), mScriptType, variant);
+        FillScript(program, me, NULL);
     }
     else if (go)
     {
-        e = sSmartScriptMgr->GetScript(-((int32)go->GetDBTableGUIDLow()), mScriptType);
-        if (e.empty())
-            e = sSmartScriptMgr->GetScript((int32)go->GetEntry(), mScriptType);
-        FillScript(e, go, NULL);
+        uint32 variant = GetProgramVariant(go);
+        program = sSmartScriptMgr->GetProgram(-((int32)go->GetDBTableGUIDLow()), mScriptType, variant);
+        if (!program)
+            program = sSmartScriptMgr->GetProgram((int32)go->GetEntry(), mScriptType, variant);
+        FillScript(program, go, NULL);
     }
     else if (trigger)
     {
-        e = sSmartScriptMgr->GetScript((int32)trigger->id, mScriptType);
-        FillScript(e, NULL, trigger);
+        program = sSmartScriptMgr->GetProgram((int32)trigger->id, mScriptType, SMART_PROGRAM_WORLD);
+        FillScript(program, NULL, trigger);
     }
 }
 
+size_t SmartScript::GetMemoryUsage() const
+{
+    size_t size = (mEvents.capacity() + mStoredEvents.capacity() + mTimedActionList.capacity()) * sizeof(SmartEventState);
+    size += (mOwnedEvents.size() + mInstallEvents.capacity()) * sizeof(SmartScriptHolder);
+    return size;
+}
+
 void SmartScript::OnInitialize(WorldObject* obj, AreaTriggerEntry const* at)
 {
     if (obj)//handle object based scripts
@@ -3087,9 +3140,9 @@ void SmartScript::OnInitialize(WorldObject* obj, AreaTriggerEntry const* at)
         return;
     }
 
-    GetScript();//load copy of script
+    GetScript();//load shared program of script
 
-    for (SmartAIEventList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
+    for (SmartEventStateList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
         InitTimer((*i));//calculate timers for first time use
 
     ProcessEventsFor(SMART_EVENT_AI_INIT);
@@ -3167,25 +3220,25 @@ void SmartScript::DoFindFriendlyMissingBuff(std::list<Creature*>& list, float ra
     cell.Visit(p, grid_creature_searcher, *me->GetMap(), *me, range);
 }
 
-void SmartScript::SetScript9(SmartScriptHolder& e, uint32 entry)
+void SmartScript::SetScript9(SmartScriptHolder const& e, uint32 entry)
 {
     mTimedActionList.clear();
-    mTimedActionList = sSmartScriptMgr->GetScript(entry, SMART_SCRIPT_TYPE_TIMED_ACTIONLIST);
-    if (mTimedActionList.empty())
+    SetProgramReference(mTimedActionListProgram, NULL);
+
+    // the program variant already runs its actions as the event type matching the timer type
+    uint32 variant = std::min<uint32>(e.action.timedActionList.timerType, SMART_TIMED_ACTIONLIST_ALWAYS);
+    SmartAIProgram const* program = sSmartScriptMgr->GetProgram(entry, SMART_SCRIPT_TYPE_TIMED_ACTIONLIST, variant);
+    if (!program || program->Events.empty())
         return;
-    for (SmartAIEventList::iterator i = mTimedActionList.begin(); i != mTimedActionList.end(); ++i)
-    {
-        if (i == mTimedActionList.begin())
-        {
-            i->enableTimed = true;//enable processing only for the first action
-        }
-        else i->enableTimed = false;
 
-        if (e.action.timedActionList.timerType == 1)
-            i->event.type = SMART_EVENT_UPDATE_IC;
-        else if (e.action.timedActionList.timerType > 1)
-            i->event.type = SMART_EVENT_UPDATE;
-        InitTimer((*i));
+    SetProgramReference(mTimedActionListProgram, program);
+    mTimedActionList.reserve(program->Events.size());
+    for (SmartAIEventList::const_iterator i = program->Events.begin(); i != program->Events.end(); ++i)
+    {
+        SmartEventState state(&(*i));
+        state.enableTimed = i == program->Events.begin();//enable processing only for the first action
+        InitTimer(state);
+        mTimedActionList.push_back(state);
     }
 }
 
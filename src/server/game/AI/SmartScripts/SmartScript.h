@@ -37,15 +37,15 @@ class SmartScript
 
         void OnInitialize(WorldObject* obj, AreaTriggerEntry const* at = NULL);
         void GetScript();
-        void FillScript(SmartAIEventList e, WorldObject* obj, AreaTriggerEntry const* at);
+        void FillScript(SmartAIProgram const* program, WorldObject* obj, AreaTriggerEntry const* at);
 
         void ProcessEventsFor(SMART_EVENT e, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellInfo* spell = NULL, GameObject* gob = NULL);
-        void ProcessEvent(SmartScriptHolder& e, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellInfo* spell = NULL, GameObject* gob = NULL);
-        bool CheckTimer(SmartScriptHolder const& e) const;
-        void RecalcTimer(SmartScriptHolder& e, uint32 min, uint32 max);
-        void UpdateTimer(SmartScriptHolder& e, uint32 const diff);
-        void InitTimer(SmartScriptHolder& e);
-        void ProcessAction(SmartScriptHolder& e, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellInfo* spell = NULL, GameObject* gob = NULL);
+        void ProcessEvent(SmartEventState& state, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellInfo* spell = NULL, GameObject* gob = NULL);
+        bool CheckTimer(SmartEventState const& state) const;
+        void RecalcTimer(SmartEventState& state, uint32 min, uint32 max);
+        void UpdateTimer(SmartEventState& state, uint32 const diff);
+        void InitTimer(SmartEventState& state);
+        void ProcessAction(SmartEventState& state, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellInfo* spell = NULL, GameObject* gob = NULL);
         ObjectList* GetTargets(SmartScriptHolder const& e, Unit* invoker = NULL);
         ObjectList* GetWorldObjectsInDist(float dist);
         void InstallTemplate(SmartScriptHolder const& e);
@@ -200,8 +200,13 @@ class SmartScript
             meOrigGUID = 0;
         }
 
+        SmartAIProgram const* GetProgram() const { return mProgram; }
+        uint32 GetEventCount() const { return uint32(mEvents.size()); }
+        // event state owned by this script, the shared program is not included
+        size_t GetMemoryUsage() const;
+
         //TIMED_ACTIONLIST (script type 9 aka script9)
-        void SetScript9(SmartScriptHolder& e, uint32 entry);
+        void SetScript9(SmartScriptHolder const& e, uint32 entry);
         Unit* GetLastInvoker();
         uint64 mLastInvoker;
 
@@ -218,9 +223,17 @@ class SmartScript
         bool IsInPhase(uint32 p) const { return (1 << (mEventPhase - 1)) & p; }
         void SetPhase(uint32 p = 0) { mEventPhase = p; }
 
-        SmartAIEventList mEvents;
+        void ProcessEventIfAllowed(SmartEventState& state, Unit* unit, uint32 var0, uint32 var1, bool bvar, const SpellInfo* spell, GameObject* gob);
+        // swaps the program reference held in ref, see SmartAIMgr::AcquireProgram
+        static void SetProgramReference(SmartAIProgram const*& ref, SmartAIProgram const* program);
+
+        // mEvents starts with the events of mProgram in the same order, events installed at runtime follow
+        SmartAIProgram const* mProgram;
+        SmartEventStateList mEvents;
         SmartAIEventList mInstallEvents;
-        SmartAIEventList mTimedActionList;
+        SmartEventStateList mTimedActionList;
+        SmartAIProgram const* mTimedActionListProgram;      // program the events of mTimedActionList belong to
+        std::list<SmartScriptHolder> mOwnedEvents;          // definitions of the events installed at runtime
         Creature* me;
         uint64 meOrigGUID;
         GameObject* go;
@@ -231,7 +244,7 @@ class SmartScript
 
         UNORDERED_MAP<int32, int32> mStoredDecimals;
         uint32 mPathId;
-        SmartAIEventList mStoredEvents;
+        SmartEventStateList mStoredEvents;
         std::list<uint32>mRemIDs;
 
         uint32 mTextTimer;
@@ -247,29 +260,37 @@ class SmartScript
         {
             if (!mStoredEvents.empty())
             {
-                for (SmartAIEventList::iterator i = mStoredEvents.begin(); i != mStoredEvents.end(); ++i)
+                for (SmartEventStateList::iterator i = mStoredEvents.begin(); i != mStoredEvents.end(); ++i)
                 {
-                    if (i->event_id == id)
+                    if (i->holder->event_id == id)
                     {
+                        for (std::list<SmartScriptHolder>::iterator itr = mOwnedEvents.begin(); itr != mOwnedEvents.end(); ++itr)
+                        {
+                            if (&(*itr) == i->holder)
+                            {
+                                mOwnedEvents.erase(itr);
+                                break;
+                            }
+                        }
                         mStoredEvents.erase(i);
                         return;
                     }
                 }
             }
         }
-        SmartScriptHolder FindLinkedEvent (uint32 link)
+        SmartEventState FindLinkedEvent (uint32 link)
         {
             if (!mEvents.empty())
             {
-                for (SmartAIEventList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
+                for (SmartEventStateList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
                 {
-                    if (i->event_id == link)
+                    if (i->holder->event_id == link)
                     {
                         return (*i);
                     }
                 }
             }
-            SmartScriptHolder s;
+            SmartEventState s;
             return s;
         }
 };
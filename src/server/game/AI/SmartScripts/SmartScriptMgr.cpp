@@ -106,12 +106,44 @@ SmartWaypointMgr::~SmartWaypointMgr()
     waypoint_map.clear();
 }
 
+SmartAIMgr::~SmartAIMgr()
+{
+    for (std::vector<SmartAIProgram*>::const_iterator itr = mPrograms.begin(); itr != mPrograms.end(); ++itr)
+        delete *itr;
+
+    for (std::list<SmartAIProgram*>::const_iterator itr = mRetiredPrograms.begin(); itr != mRetiredPrograms.end(); ++itr)
+        delete *itr;
+}
+
+void SmartAIMgr::FreeRetiredPrograms()
+{
+    // no script acquires a retired program, a count of 0 can't go up again
+    for (std::list<SmartAIProgram*>::iterator itr = mRetiredPrograms.begin(); itr != mRetiredPrograms.end();)
+    {
+        if ((*itr)->References.value())
+        {
+            ++itr;
+            continue;
+        }
+
+        delete *itr;
+        itr = mRetiredPrograms.erase(itr);
+    }
+}
+
 void SmartAIMgr::LoadSmartAIFromDB()
 {
     uint32 oldMSTime = getMSTime();
 
+    // scripts already running keep their program, only scripts initialized after the reload pick up the new ones
+    mRetiredPrograms.insert(mRetiredPrograms.end(), mPrograms.begin(), mPrograms.end());
+    mPrograms.clear();
+    FreeRetiredPrograms();
+
     for (uint8 i = 0; i < SMART_SCRIPT_TYPE_MAX; i++)
-        mEventMap[i].clear();  //Drop Existing SmartAI List
+        mProgramMap[i].clear();  //Drop Existing SmartAI List
+
+    SmartAIEventMap eventMap[SMART_SCRIPT_TYPE_MAX];
 
     PreparedStatement* stmt = WorldDatabase.GetPreparedStatement(WORLD_SEL_SMART_SCRIPTS);
     PreparedQueryResult result = WorldDatabase.Query(stmt);
@@ -224,19 +256,135 @@ void SmartAIMgr::LoadSmartAIFromDB()
             continue;
 
         // creature entry / guid not found in storage, create empty event list for it and increase counters
-        if (mEventMap[source_type].find(temp.entryOrGuid) == mEventMap[source_type].end())
+        if (eventMap[source_type].find(temp.entryOrGuid) == eventMap[source_type].end())
         {
             ++count;
             SmartAIEventList eventList;
-            mEventMap[source_type][temp.entryOrGuid] = eventList;
+            eventMap[source_type][temp.entryOrGuid] = eventList;
         }
         // store the new event
-        mEventMap[source_type][temp.entryOrGuid].push_back(temp);
+        eventMap[source_type][temp.entryOrGuid].push_back(temp);
     }
     while (result->NextRow());
 
-    sLog->outInfo(LOG_FILTER_SERVER_LOADING, ">> Loaded %u SmartAI scripts in %u ms", count, GetMSTimeDiffToNow(oldMSTime));
+    CompilePrograms(eventMap);
+
+    sLog->outInfo(LOG_FILTER_SERVER_LOADING, ">> Loaded %u SmartAI scripts (%u programs, " SIZEFMTD " bytes) in %u ms", count, GetProgramCount(), GetProgramsMemoryUsage(), GetMSTimeDiffToNow(oldMSTime));
+
+}
 
+void SmartAIMgr::CompilePrograms(SmartAIEventMap const* eventMap)
+{
+    for (uint8 type = 0; type < SMART_SCRIPT_TYPE_MAX; ++type)
+    {
+        for (SmartAIEventMap::const_iterator itr = eventMap[type].begin(); itr != eventMap[type].end(); ++itr)
+        {
+            SmartAIProgramSet& programs = mProgramMap[type][itr->first];
+            memset(&programs, 0, sizeof(programs));
+
+            if (type == SMART_SCRIPT_TYPE_TIMED_ACTIONLIST)
+            {
+                for (uint32 variant = SMART_TIMED_ACTIONLIST_OOC; variant <= SMART_TIMED_ACTIONLIST_ALWAYS; ++variant)
+                    programs.Variants[variant] = CompileProgram(itr->second, variant, true);
+                continue;
+            }
+
+            bool hasDifficultyEvents = false;
+            for (SmartAIEventList::const_iterator e = itr->second.begin(); e != itr->second.end(); ++e)
+            {
+                if (e->event.event_flags & SMART_EVENT_FLAG_DIFFICULTY_ALL)
+                {
+                    hasDifficultyEvents = true;
+                    break;
+                }
+            }
+
+            // without difficulty flags every kind of map runs the same events
+            if (!hasDifficultyEvents)
+            {
+                SmartAIProgram const* program = CompileProgram(itr->second, SMART_PROGRAM_WORLD, false);
+                for (uint32 variant = SMART_PROGRAM_WORLD; variant < SMART_PROGRAM_VARIANT_MAX; ++variant)
+                    programs.Variants[variant] = program;
+            }
+            else
+            {
+                for (uint32 variant = SMART_PROGRAM_WORLD; variant < SMART_PROGRAM_VARIANT_MAX; ++variant)
+                    programs.Variants[variant] = CompileProgram(itr->second, variant, false);
+            }
+        }
+    }
+}
+
+SmartAIProgram* SmartAIMgr::CompileProgram(SmartAIEventList const& events, uint32 variant, bool timedActionList)
+{
+    SmartAIProgram* program = new SmartAIProgram();
+    program->Events.reserve(events.size());
+
+    for (SmartAIEventList::const_iterator itr = events.begin(); itr != events.end(); ++itr)
+    {
+        if (timedActionList)
+        {
+            program->Events.push_back(*itr);
+            if (variant == SMART_TIMED_ACTIONLIST_IC)
+                program->Events.back().event.type = SMART_EVENT_UPDATE_IC;
+            else if (variant == SMART_TIMED_ACTIONLIST_ALWAYS)
+                program->Events.back().event.type = SMART_EVENT_UPDATE;
+            continue;
+        }
+
+        #ifndef TRINITY_DEBUG
+            if (itr->event.event_flags & SMART_EVENT_FLAG_DEBUG_ONLY)
+                continue;
+        #endif
+
+        if (itr->event.event_flags & SMART_EVENT_FLAG_DIFFICULTY_ALL)//if has instance flag add only if in it
+            if (variant == SMART_PROGRAM_WORLD || !((1 << (variant - SMART_PROGRAM_DUNGEON + 1)) & itr->event.event_flags))
+                continue;
+
+        program->Events.push_back(*itr);//NOTE: 'world(0)' events still get processed in ANY instance mode
+    }
+
+    // jump table, counting sort of the event indexes by event type
+    for (SmartAIEventList::const_iterator itr = program->Events.begin(); itr != program->Events.end(); ++itr)
+        ++program->TypeOffsets[itr->GetEventType() + 1];
+
+    for (uint32 type = 0; type < SMART_EVENT_END; ++type)
+        program->TypeOffsets[type + 1] += program->TypeOffsets[type];
+
+    uint16 next[SMART_EVENT_END];
+    memcpy(next, program->TypeOffsets, sizeof(next));
+
+    program->EventsByType.resize(program->Events.size());
+    for (uint16 i = 0; i < program->Events.size(); ++i)
+        program->EventsByType[next[program->Events[i].GetEventType()]++] = i;
+
+    ResolveConditions(program);
+
+    mPrograms.push_back(program);
+    return program;
+}
+
+void SmartAIMgr::ResolveConditions(SmartAIProgram* program)
+{
+    for (SmartAIEventList::iterator itr = program->Events.begin(); itr != program->Events.end(); ++itr)
+        itr->conditions = sConditionMgr->GetConditionsForSmartEvent(itr->entryOrGuid, itr->event_id, itr->source_type);
+}
+
+void SmartAIMgr::ResolveConditions()
+{
+    for (std::vector<SmartAIProgram*>::const_iterator itr = mPrograms.begin(); itr != mPrograms.end(); ++itr)
+        ResolveConditions(*itr);
+
+    for (std::list<SmartAIProgram*>::const_iterator itr = mRetiredPrograms.begin(); itr != mRetiredPrograms.end(); ++itr)
+        ResolveConditions(*itr);
+}
+
+size_t SmartAIMgr::GetProgramsMemoryUsage() const
+{
+    size_t size = 0;
+    for (std::vector<SmartAIProgram*>::const_iterator itr = mPrograms.begin(); itr != mPrograms.end(); ++itr)
+        size += (*itr)->GetMemoryUsage();
+    return size;
 }
 
 bool SmartAIMgr::IsTargetValid(SmartScriptHolder const& e)
@@ -24,6 +24,8 @@
 #include "Unit.h"
 #include "Spell.h"
 #include "DB2Stores.h"
+#include "ConditionMgr.h"
+#include <ace/Atomic_Op.h>
 
 //#include "SmartScript.h"
 //#include "SmartAI.h"
@@ -1287,8 +1289,7 @@ enum SmartCastFlags
 struct SmartScriptHolder
 {
     SmartScriptHolder() : entryOrGuid(0), source_type(SMART_SCRIPT_TYPE_CREATURE)
-        , event_id(0), link(0), timer(0), active(false), runOnce(false)
-        , enableTimed(false) {}
+        , event_id(0), link(0), conditions(NULL) {}
 
     int32 entryOrGuid;
     SmartScriptType source_type;
@@ -1305,12 +1306,23 @@ struct SmartScriptHolder
         uint32 GetActionType() const { return (uint32)action.type; }
         uint32 GetTargetType() const { return (uint32)target.type; }
 
+    ConditionList const* conditions;                        // resolved by SmartAIMgr, NULL when the event has none
+};
+
+// runtime state of one event of a SmartScript, the definition is shared with every other script running it
+struct SmartEventState
+{
+    explicit SmartEventState(SmartScriptHolder const* e = NULL) : holder(e), timer(0), active(false), runOnce(false), enableTimed(false) {}
+
+    SmartScriptHolder const* holder;
     uint32 timer;
     bool active;
     bool runOnce;
     bool enableTimed;
 };
 
+typedef std::vector<SmartEventState> SmartEventStateList;
+
 typedef UNORDERED_MAP<uint32, WayPoint*> WPPath;
 
 typedef std::list<WorldObject*> ObjectList;
@@ -1342,31 +1354,88 @@ typedef std::vector<SmartScriptHolder> SmartAIEventList;
 // all events for all entries / guids
 typedef UNORDERED_MAP<int32, SmartAIEventList> SmartAIEventMap;
 
+// events of one entry or guid as they run in one kind of map, compiled at load and never changed afterwards
+struct SmartAIProgram
+{
+    SmartAIProgram() { memset(TypeOffsets, 0, sizeof(TypeOffsets)); }
+
+    // events of the given type, in load order
+    uint16 const* BeginEventsOfType(uint32 type) const { return EventsByType.empty() ? NULL : &EventsByType[0] + TypeOffsets[type]; }
+    uint16 const* EndEventsOfType(uint32 type) const { return EventsByType.empty() ? NULL : &EventsByType[0] + TypeOffsets[type + 1]; }
+
+    size_t GetMemoryUsage() const { return sizeof(SmartAIProgram) + Events.capacity() * sizeof(SmartScriptHolder) + EventsByType.capacity() * sizeof(uint16); }
+
+    SmartAIEventList Events;
+    std::vector<uint16> EventsByType;                       // indexes into Events grouped by event type
+    uint16 TypeOffsets[SMART_EVENT_END + 1];                // events of type t are EventsByType[TypeOffsets[t]] up to EventsByType[TypeOffsets[t + 1]]
+
+    mutable ACE_Atomic_Op<ACE_Thread_Mutex, long> References;   // scripts running the program, see SmartAIMgr::AcquireProgram
+};
+
+// events with difficulty flags only run in dungeons of these spawn modes, so an entry may need one program per kind of map
+enum SmartAIProgramVariant
+{
+    SMART_PROGRAM_WORLD             = 0,                    // not a dungeon, events with difficulty flags left out
+    SMART_PROGRAM_DUNGEON           = 1,                    // SMART_PROGRAM_DUNGEON + spawn mode
+    SMART_PROGRAM_VARIANT_MAX       = SMART_PROGRAM_DUNGEON + MAX_DIFFICULTY
+};
+
+// timed action lists are not filtered by map, their variants are the event type the caller asked the actions to run as
+enum SmartTimedActionListVariant
+{
+    SMART_TIMED_ACTIONLIST_OOC      = 0,
+    SMART_TIMED_ACTIONLIST_IC       = 1,
+    SMART_TIMED_ACTIONLIST_ALWAYS   = 2
+};
+
+struct SmartAIProgramSet
+{
+    SmartAIProgram const* Variants[SMART_PROGRAM_VARIANT_MAX];
+};
+
+typedef UNORDERED_MAP<int32, SmartAIProgramSet> SmartAIProgramMap;
+
 class SmartAIMgr
 {
     friend class ACE_Singleton<SmartAIMgr, ACE_Null_Mutex>;
     SmartAIMgr(){};
     public:
-        ~SmartAIMgr(){};
+        ~SmartAIMgr();
 
         void LoadSmartAIFromDB();
 
-        SmartAIEventList GetScript(int32 entry, SmartScriptType type)
+        // re-points the conditions of all programs, needed after conditions are reloaded
+        void ResolveConditions();
+
+        SmartAIProgram const* GetProgram(int32 entry, SmartScriptType type, uint32 variant) const
         {
-            SmartAIEventList temp;
-            if (mEventMap[uint32(type)].find(entry) != mEventMap[uint32(type)].end())
-                return mEventMap[uint32(type)][entry];
-            else
-            {
-                if (entry > 0)//first search is for guid (negative), do not drop error if not found
-                    sLog->outDebug(LOG_FILTER_DATABASE_AI, "SmartAIMgr::GetScript: Could not load Script for Entry %d ScriptType %u.", entry, uint32(type));
-                return temp;
-            }
+            SmartAIProgramMap::const_iterator itr = mProgramMap[uint32(type)].find(entry);
+            if (itr != mProgramMap[uint32(type)].end())
+                return itr->second.Variants[variant];
+
+            if (entry > 0)//first search is for guid (negative), do not drop error if not found
+                sLog->outDebug(LOG_FILTER_DATABASE_AI, "SmartAIMgr::GetProgram: Could not load Script for Entry %d ScriptType %u.", entry, uint32(type));
+            return NULL;
         }
 
+        // scripts hold a reference to the programs they run, a program replaced by a reload is freed once the last one released it
+        void AcquireProgram(SmartAIProgram const* program) { ++program->References; }
+        void ReleaseProgram(SmartAIProgram const* program) { --program->References; }
+        // frees the retired programs no script runs anymore, called between map updates
+        void FreeRetiredPrograms();
+
+        uint32 GetProgramCount() const { return uint32(mPrograms.size()); }
+        size_t GetProgramsMemoryUsage() const;
+
     private:
-        //event stores
-        SmartAIEventMap mEventMap[SMART_SCRIPT_TYPE_MAX];
+        void CompilePrograms(SmartAIEventMap const* eventMap);
+        SmartAIProgram* CompileProgram(SmartAIEventList const& events, uint32 variant, bool timedActionList);
+        void ResolveConditions(SmartAIProgram* program);
+
+        // programs replaced by a reload are kept in mRetiredPrograms while scripts still run them
+        std::vector<SmartAIProgram*> mPrograms;
+        std::list<SmartAIProgram*> mRetiredPrograms;
+        SmartAIProgramMap mProgramMap[SMART_SCRIPT_TYPE_MAX];
 
         bool IsEventValid(SmartScriptHolder& e);
         bool IsTargetValid(SmartScriptHolder const& e);
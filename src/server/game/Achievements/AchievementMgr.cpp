@@ -18,6 +18,7 @@
 
 
 #include "AchievementMgr.h"
+#include "AchievementSaveBuffer.h"
 #include "Common.h"
 #include "DBCEnums.h"
 #include "ObjectMgr.h"
@@ -524,8 +525,10 @@ void AchievementMgr<T>::DeleteFromDB(uint32 /*lowguid*/)
 template<>
 void AchievementMgr<Player>::DeleteFromDB(uint32 lowguid)
 {
+    sAchievementSaveBuffer->Discard(ACHIEVEMENT_OWNER_PLAYER, lowguid);
+
     SQLTransaction trans = CharacterDatabase.BeginTransaction();
-    trans->PAppend("DELETE FROM character_achievement WHERE guid = %u", lowguid);	  	
+    trans->PAppend("DELETE FROM character_achievement WHERE guid = %u", lowguid);
     trans->PAppend("DELETE FROM character_achievement_progress WHERE guid = %u", lowguid);
     CharacterDatabase.CommitTransaction(trans);
 }
@@ -533,6 +536,8 @@ void AchievementMgr<Player>::DeleteFromDB(uint32 lowguid)
 template<>
 void AchievementMgr<Guild>::DeleteFromDB(uint32 lowguid)
 {
+    sAchievementSaveBuffer->Discard(ACHIEVEMENT_OWNER_GUILD, lowguid);
+
     SQLTransaction trans = CharacterDatabase.BeginTransaction();
 
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_ALL_GUILD_ACHIEVEMENTS);
@@ -551,158 +556,76 @@ void AchievementMgr<T>::SaveToDB(SQLTransaction& /*trans*/)
 {
 }
 
+/// Changed rows go to the save buffer, written in trans only when it is disabled
 template<>
 void AchievementMgr<Player>::SaveToDB(SQLTransaction& trans)
 {
-    if (!m_completedAchievements.empty())
+    uint32 lowguid = GetOwner()->GetGUIDLow();
+    for (CompletedAchievementMap::iterator itr = m_completedAchievements.begin(); itr != m_completedAchievements.end(); ++itr)
     {
-        bool need_execute = false;
-        std::ostringstream ssdel;
-        std::ostringstream ssins;
-        for (CompletedAchievementMap::iterator iter = m_completedAchievements.begin(); iter != m_completedAchievements.end(); ++iter)
-        {
-            if (!iter->second.changed)
-                continue;
-
-            /// first new/changed record prefix
-            if (!need_execute)
-            {
-                ssdel << "DELETE FROM character_achievement WHERE guid = " << GetOwner()->GetGUIDLow() << " AND achievement IN (";
-                ssins << "INSERT INTO character_achievement (guid, achievement, date) VALUES ";
-                need_execute = true;
-            }
-            /// next new/changed record prefix
-            else
-            {
-                ssdel << ',';
-                ssins << ',';
-            }
-
-            // new/changed record data
-            ssdel << iter->first;
-            ssins << '(' << GetOwner()->GetGUIDLow() << ',' << iter->first << ',' << uint64(iter->second.date) << ')';
-
-            /// mark as saved in db
-            iter->second.changed = false;
-        }
+        if (!itr->second.changed)
+            continue;
 
-        if (need_execute)
-        {
-            ssdel << ')';
-            trans->Append(ssdel.str().c_str());
-            trans->Append(ssins.str().c_str());
-        }
+        PendingAchievement achievement;
+        achievement.date = uint32(itr->second.date);
+        sAchievementSaveBuffer->AddAchievement(ACHIEVEMENT_OWNER_PLAYER, lowguid, itr->first, achievement);
+        itr->second.changed = false;
     }
 
-    if (!m_criteriaProgress.empty())
+    for (CriteriaProgressMap::iterator itr = m_criteriaProgress.begin(); itr != m_criteriaProgress.end(); ++itr)
     {
-        /// prepare deleting and insert
-        bool need_execute_del = false;
-        bool need_execute_ins = false;
-        std::ostringstream ssdel;
-        std::ostringstream ssins;
-        for (CriteriaProgressMap::iterator iter = m_criteriaProgress.begin(); iter != m_criteriaProgress.end(); ++iter)
-        {
-            if (!iter->second.changed)
-                continue;
-
-            // deleted data (including 0 progress state)
-            {
-                /// first new/changed record prefix (for any counter value)
-                if (!need_execute_del)
-                {
-                    ssdel << "DELETE FROM character_achievement_progress WHERE guid = " << GetOwner()->GetGUIDLow() << " AND criteria IN (";
-                    need_execute_del = true;
-                }
-                /// next new/changed record prefix
-                else
-                    ssdel << ',';
-
-                // new/changed record data
-                ssdel << iter->first;
-            }
-
-            // store data only for real progress
-            if (iter->second.counter != 0)
-            {
-                /// first new/changed record prefix
-                if (!need_execute_ins)
-                {
-                    ssins << "INSERT INTO character_achievement_progress (guid, criteria, counter, date) VALUES ";
-                    need_execute_ins = true;
-                }
-                /// next new/changed record prefix
-                else
-                    ssins << ',';
-
-                // new/changed record data
-                ssins << '(' << GetOwner()->GetGUIDLow() << ',' << iter->first << ',' << iter->second.counter << ',' << iter->second.date << ')';
-            }
-
-            /// mark as updated in db
-            iter->second.changed = false;
-        }
-
-        if (need_execute_del)                                // DELETE ... IN (.... _)_
-            ssdel << ')';
+        if (!itr->second.changed)
+            continue;
 
-        if (need_execute_del || need_execute_ins)
-        {
-            if (need_execute_del)
-                trans->Append(ssdel.str().c_str());
-            if (need_execute_ins)
-                trans->Append(ssins.str().c_str());
-        }
+        PendingCriteria criteria;
+        criteria.counter = itr->second.counter;
+        criteria.date = uint32(itr->second.date);
+        criteria.completedGuid = 0;
+        sAchievementSaveBuffer->AddCriteria(ACHIEVEMENT_OWNER_PLAYER, lowguid, itr->first, criteria);
+        itr->second.changed = false;
     }
+
+    if (!sWorld->getIntConfig(CONFIG_ACHIEVEMENT_SAVE_INTERVAL))
+        sAchievementSaveBuffer->Flush(ACHIEVEMENT_OWNER_PLAYER, lowguid, trans);
 }
 
 template<>
 void AchievementMgr<Guild>::SaveToDB(SQLTransaction& trans)
 {
-    PreparedStatement* stmt;
+    uint32 guildId = GetOwner()->GetId();
     std::ostringstream guidstr;
-    for (CompletedAchievementMap::const_iterator itr = m_completedAchievements.begin(); itr != m_completedAchievements.end(); ++itr)
+    for (CompletedAchievementMap::iterator itr = m_completedAchievements.begin(); itr != m_completedAchievements.end(); ++itr)
     {
-        CompletedAchievementData second = itr->second;
-        if (!second.changed)
+        if (!itr->second.changed)
             continue;
 
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_GUILD_ACHIEVEMENT);
-        stmt->setUInt32(0, GetOwner()->GetId());
-        stmt->setUInt16(1, itr->first);
-        trans->Append(stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_INS_GUILD_ACHIEVEMENT);
-        stmt->setUInt32(0, GetOwner()->GetId());
-        stmt->setUInt16(1, itr->first);
-        stmt->setUInt32(2, second.date);
-        for (std::set<uint64>::const_iterator gItr = second.guids.begin(); gItr != second.guids.end(); ++gItr)
+        for (std::set<uint64>::const_iterator gItr = itr->second.guids.begin(); gItr != itr->second.guids.end(); ++gItr)
             guidstr << GUID_LOPART(*gItr) << ',';
 
-        stmt->setString(3, guidstr.str());
-        trans->Append(stmt);
+        PendingAchievement achievement;
+        achievement.date = uint32(itr->second.date);
+        achievement.guids = guidstr.str();
+        sAchievementSaveBuffer->AddAchievement(ACHIEVEMENT_OWNER_GUILD, guildId, itr->first, achievement);
+        itr->second.changed = false;
 
         guidstr.str("");
     }
 
-    for (CriteriaProgressMap::const_iterator itr = m_criteriaProgress.begin(); itr != m_criteriaProgress.end(); ++itr)
+    for (CriteriaProgressMap::iterator itr = m_criteriaProgress.begin(); itr != m_criteriaProgress.end(); ++itr)
     {
         if (!itr->second.changed)
             continue;
 
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_GUILD_ACHIEVEMENT_CRITERIA);
-        stmt->setUInt32(0, GetOwner()->GetId());
-        stmt->setUInt16(1, itr->first);
-        trans->Append(stmt);
-
-        stmt = CharacterDatabase.GetPreparedStatement(CHAR_INS_GUILD_ACHIEVEMENT_CRITERIA);
-        stmt->setUInt32(0, GetOwner()->GetId());
-        stmt->setUInt16(1, itr->first);
-        stmt->setUInt32(2, itr->second.counter);
-        stmt->setUInt32(3, itr->second.date);
-        stmt->setUInt32(4, GUID_LOPART(itr->second.CompletedGUID));
-        trans->Append(stmt);
+        PendingCriteria criteria;
+        criteria.counter = itr->second.counter;
+        criteria.date = uint32(itr->second.date);
+        criteria.completedGuid = GUID_LOPART(itr->second.CompletedGUID);
+        sAchievementSaveBuffer->AddCriteria(ACHIEVEMENT_OWNER_GUILD, guildId, itr->first, criteria);
+        itr->second.changed = false;
     }
+
+    if (!sWorld->getIntConfig(CONFIG_ACHIEVEMENT_SAVE_INTERVAL))
+        sAchievementSaveBuffer->Flush(ACHIEVEMENT_OWNER_GUILD, guildId, trans);
 }
 
 template<class T>
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AchievementSaveBuffer.h"
+#include "Log.h"
+
+#include <vector>
+
+static CharacterDatabaseStatements const ReplaceAchievementStatements[MAX_ACHIEVEMENT_OWNER_TYPES] =
+{
+    CHAR_REP_CHAR_ACHIEVEMENT, CHAR_REP_GUILD_ACHIEVEMENT
+};
+
+static CharacterDatabaseStatements const ReplaceCriteriaStatements[MAX_ACHIEVEMENT_OWNER_TYPES] =
+{
+    CHAR_REP_CHAR_ACHIEVEMENT_PROGRESS, CHAR_REP_GUILD_ACHIEVEMENT_CRITERIA
+};
+
+static CharacterDatabaseStatements const ReplaceCriteriaBatchStatements[MAX_ACHIEVEMENT_OWNER_TYPES] =
+{
+    CHAR_REP_CHAR_ACHIEVEMENT_PROGRESS_BATCH, CHAR_REP_GUILD_ACHIEVEMENT_CRITERIA_BATCH
+};
+
+static CharacterDatabaseStatements const DeleteCriteriaStatements[MAX_ACHIEVEMENT_OWNER_TYPES] =
+{
+    CHAR_DEL_CHAR_ACHIEVEMENT_PROGRESS_BY_CRITERIA, CHAR_DEL_GUILD_ACHIEVEMENT_CRITERIA
+};
+
+// sets one (owner, criteria, counter, date[, completedGuid]) row of a replace statement
+static void SetCriteriaRow(PreparedStatement* stmt, uint8 index, AchievementOwnerType type, PendingCriteriaMap::const_iterator itr)
+{
+    stmt->setUInt32(index++, itr->first.first);
+    stmt->setUInt16(index++, uint16(itr->first.second));
+    stmt->setUInt32(index++, itr->second.counter);
+    stmt->setUInt32(index++, itr->second.date);
+    if (type == ACHIEVEMENT_OWNER_GUILD)
+        stmt->setUInt32(index, itr->second.completedGuid);
+}
+
+// removes the rows of one owner from pending, moving them to taken if given
+template<class PendingMap>
+static void TakeOwnerRows(PendingMap& pending, uint32 ownerId, PendingMap* taken)
+{
+    typename PendingMap::iterator begin = pending.lower_bound(AchievementSaveKey(ownerId, 0));
+    typename PendingMap::iterator end = begin;
+    while (end != pending.end() && end->first.first == ownerId)
+        ++end;
+
+    if (taken)
+        taken->insert(begin, end);
+    pending.erase(begin, end);
+}
+
+void AchievementSaveBuffer::AddAchievement(AchievementOwnerType type, uint32 ownerId, uint32 achievementId, PendingAchievement const& achievement)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    _achievements[type][AchievementSaveKey(ownerId, achievementId)] = achievement;
+}
+
+void AchievementSaveBuffer::AddCriteria(AchievementOwnerType type, uint32 ownerId, uint32 criteriaId, PendingCriteria const& criteria)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    _criterias[type][AchievementSaveKey(ownerId, criteriaId)] = criteria;
+}
+
+void AchievementSaveBuffer::Flush()
+{
+    SQLTransaction trans = CharacterDatabase.BeginTransaction();
+
+    // committed under the lock, the rows of an owner flushed next are queued after these
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    for (uint8 type = 0; type < MAX_ACHIEVEMENT_OWNER_TYPES; ++type)
+    {
+        _Write(AchievementOwnerType(type), _achievements[type], _criterias[type], trans);
+        _achievements[type].clear();
+        _criterias[type].clear();
+    }
+
+    if (!trans->GetSize())
+        return;
+
+    sLog->outDebug(LOG_FILTER_ACHIEVEMENTSYS, "AchievementSaveBuffer: writing %u achievement and criteria statements", uint32(trans->GetSize()));
+    CharacterDatabase.CommitTransaction(trans);
+}
+
+void AchievementSaveBuffer::Flush(AchievementOwnerType type, uint32 ownerId, SQLTransaction trans)
+{
+    PendingAchievementMap achievements;
+    PendingCriteriaMap criterias;
+
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    TakeOwnerRows(_achievements[type], ownerId, &achievements);
+    TakeOwnerRows(_criterias[type], ownerId, &criterias);
+
+    if (achievements.empty() && criterias.empty())
+        return;
+
+    if (!trans.null())
+    {
+        _Write(type, achievements, criterias, trans);
+        return;
+    }
+
+    trans = CharacterDatabase.BeginTransaction();
+    _Write(type, achievements, criterias, trans);
+    CharacterDatabase.CommitTransaction(trans);
+}
+
+void AchievementSaveBuffer::Discard(AchievementOwnerType type, uint32 ownerId)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    TakeOwnerRows<PendingAchievementMap>(_achievements[type], ownerId, NULL);
+    TakeOwnerRows<PendingCriteriaMap>(_criterias[type], ownerId, NULL);
+}
+
+void AchievementSaveBuffer::_Write(AchievementOwnerType type, PendingAchievementMap const& achievements, PendingCriteriaMap const& criterias, SQLTransaction& trans) const
+{
+    PreparedStatement* stmt;
+    for (PendingAchievementMap::const_iterator itr = achievements.begin(); itr != achievements.end(); ++itr)
+    {
+        stmt = CharacterDatabase.GetPreparedStatement(ReplaceAchievementStatements[type]);
+        stmt->setUInt32(0, itr->first.first);
+        stmt->setUInt16(1, uint16(itr->first.second));
+        stmt->setUInt32(2, itr->second.date);
+        if (type == ACHIEVEMENT_OWNER_GUILD)
+            stmt->setString(3, itr->second.guids);
+        trans->Append(stmt);
+    }
+
+    // criteria without progress are deleted, the others replaced ACHIEVEMENT_SAVE_BATCH_SIZE rows per statement
+    std::vector<PendingCriteriaMap::const_iterator> rows;
+    rows.reserve(criterias.size());
+    for (PendingCriteriaMap::const_iterator itr = criterias.begin(); itr != criterias.end(); ++itr)
+    {
+        if (itr->second.counter)
+        {
+            rows.push_back(itr);
+            continue;
+        }
+
+        stmt = CharacterDatabase.GetPreparedStatement(DeleteCriteriaStatements[type]);
+        stmt->setUInt32(0, itr->first.first);
+        stmt->setUInt16(1, uint16(itr->first.second));
+        trans->Append(stmt);
+    }
+
+    uint8 const rowSize = type == ACHIEVEMENT_OWNER_GUILD ? 5 : 4;
+    size_t i = 0;
+    for (; i + ACHIEVEMENT_SAVE_BATCH_SIZE <= rows.size(); i += ACHIEVEMENT_SAVE_BATCH_SIZE)
+    {
+        stmt = CharacterDatabase.GetPreparedStatement(ReplaceCriteriaBatchStatements[type]);
+        for (uint8 row = 0; row < ACHIEVEMENT_SAVE_BATCH_SIZE; ++row)
+            SetCriteriaRow(stmt, row * rowSize, type, rows[i + row]);
+        trans->Append(stmt);
+    }
+
+    for (; i < rows.size(); ++i)
+    {
+        stmt = CharacterDatabase.GetPreparedStatement(ReplaceCriteriaStatements[type]);
+        SetCriteriaRow(stmt, 0, type, rows[i]);
+        trans->Append(stmt);
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ACHIEVEMENTSAVEBUFFER_H
+#define _ACHIEVEMENTSAVEBUFFER_H
+
+#include "Define.h"
+#include "DatabaseEnv.h"
+#include <ace/Singleton.h>
+#include <ace/Thread_Mutex.h>
+
+#include <map>
+#include <string>
+
+// rows of the CHAR_REP_*_ACHIEVEMENT_*_BATCH statements
+#define ACHIEVEMENT_SAVE_BATCH_SIZE 8
+
+enum AchievementOwnerType
+{
+    ACHIEVEMENT_OWNER_PLAYER,
+    ACHIEVEMENT_OWNER_GUILD,
+    MAX_ACHIEVEMENT_OWNER_TYPES
+};
+
+struct PendingAchievement
+{
+    uint32 date;
+    std::string guids;                                     ///< Guild achievements only
+};
+
+struct PendingCriteria
+{
+    uint32 counter;                                        ///< 0 deletes the row
+    uint32 date;
+    uint32 completedGuid;                                  ///< Guild achievements only
+};
+
+// (owner guid or guild id, achievement or criteria id)
+typedef std::pair<uint32, uint32> AchievementSaveKey;
+typedef std::map<AchievementSaveKey, PendingAchievement> PendingAchievementMap;
+typedef std::map<AchievementSaveKey, PendingCriteria> PendingCriteriaMap;
+
+/**
+    Write-behind buffer of the completed achievements and criteria progress of players and guilds.
+    Owner saves only record their changed rows, the latest value of a row replacing the pending one,
+    and all of them are written in one transaction every Achievements.SaveInterval milliseconds, so
+    at most that much progress is lost on a crash. Rows are flushed before their owner is read back
+    from the database, dropped when it is deleted and everything is flushed on shutdown.
+*/
+class AchievementSaveBuffer
+{
+    friend class ACE_Singleton<AchievementSaveBuffer, ACE_Thread_Mutex>;
+
+    private:
+        AchievementSaveBuffer() { }
+        ~AchievementSaveBuffer() { }
+
+    public:
+        void AddAchievement(AchievementOwnerType type, uint32 ownerId, uint32 achievementId, PendingAchievement const& achievement);
+        void AddCriteria(AchievementOwnerType type, uint32 ownerId, uint32 criteriaId, PendingCriteria const& criteria);
+
+        /// Writes the pending rows of every owner
+        void Flush();
+        /// Writes the pending rows of one owner in trans, or in their own transaction if it is null
+        void Flush(AchievementOwnerType type, uint32 ownerId, SQLTransaction trans = SQLTransaction(NULL));
+        /// Drops the pending rows of one owner, its rows are being deleted
+        void Discard(AchievementOwnerType type, uint32 ownerId);
+
+    private:
+        void _Write(AchievementOwnerType type, PendingAchievementMap const& achievements, PendingCriteriaMap const& criterias, SQLTransaction& trans) const;
+
+        ACE_Thread_Mutex _lock;
+        PendingAchievementMap _achievements[MAX_ACHIEVEMENT_OWNER_TYPES];
+        PendingCriteriaMap _criterias[MAX_ACHIEVEMENT_OWNER_TYPES];
+};
+
+#define sAchievementSaveBuffer ACE_Singleton<AchievementSaveBuffer, ACE_Thread_Mutex>::instance()
+
+#endif
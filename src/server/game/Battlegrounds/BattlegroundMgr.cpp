@@ -114,8 +114,11 @@ void BattlegroundMgr::Update(uint32 diff)
     if (!m_QueueUpdateScheduler.empty())
     {
         std::vector<uint64> scheduled;
+        std::vector<uint32> scheduleTimes;
         std::swap(scheduled, m_QueueUpdateScheduler);
+        std::swap(scheduleTimes, m_QueueUpdateScheduleTimes);
 
+        uint32 now = getMSTime();
         for (uint8 i = 0; i < scheduled.size(); i++)
         {
             uint32 arenaMMRating = scheduled[i] >> 32;
@@ -123,7 +126,7 @@ void BattlegroundMgr::Update(uint32 diff)
             BattlegroundQueueTypeId bgQueueTypeId = BattlegroundQueueTypeId(scheduled[i] >> 16 & 255);
             BattlegroundTypeId bgTypeId = BattlegroundTypeId((scheduled[i] >> 8) & 255);
             BattlegroundBracketId bracket_id = BattlegroundBracketId(scheduled[i] & 255);
-            m_BattlegroundQueues[bgQueueTypeId].BattlegroundQueueUpdate(diff, bgTypeId, bracket_id, arenaType, arenaMMRating > 0, arenaMMRating);
+            UpdateQueue(diff, bgQueueTypeId, bgTypeId, bracket_id, arenaType, arenaMMRating > 0, arenaMMRating, getMSTimeDiff(scheduleTimes[i], now));
         }
     }
 
@@ -137,7 +140,7 @@ void BattlegroundMgr::Update(uint32 diff)
             sLog->outDebug(LOG_FILTER_BATTLEGROUND, "BattlegroundMgr: UPDATING ARENA QUEUES");
             for (int qtype = BATTLEGROUND_QUEUE_2v2; qtype <= BATTLEGROUND_QUEUE_5v5; ++qtype)
                 for (int bracket = BG_BRACKET_ID_FIRST; bracket < MAX_BATTLEGROUND_BRACKETS; ++bracket)
-                    m_BattlegroundQueues[qtype].BattlegroundQueueUpdate(diff, BATTLEGROUND_AA, BattlegroundBracketId(bracket), BattlegroundMgr::BGArenaType(BattlegroundQueueTypeId(qtype)), true, 0);
+                    UpdateQueue(diff, BattlegroundQueueTypeId(qtype), BATTLEGROUND_AA, BattlegroundBracketId(bracket), BattlegroundMgr::BGArenaType(BattlegroundQueueTypeId(qtype)), true, 0, 0);
 
             m_NextRatedArenaUpdate = sWorld->getIntConfig(CONFIG_ARENA_RATED_UPDATE_TIMER);
         }
@@ -1341,7 +1344,50 @@ void BattlegroundMgr::ScheduleQueueUpdate(uint32 arenaMatchmakerRating, uint8 ar
     //we will use only 1 number created of bgTypeId and bracket_id
     uint64 const scheduleId = ((uint64)arenaMatchmakerRating << 32) | (arenaType << 24) | (bgQueueTypeId << 16) | (bgTypeId << 8) | bracket_id;
     if (std::find(m_QueueUpdateScheduler.begin(), m_QueueUpdateScheduler.end(), scheduleId) == m_QueueUpdateScheduler.end())
+    {
         m_QueueUpdateScheduler.push_back(scheduleId);
+        m_QueueUpdateScheduleTimes.push_back(getMSTime());
+    }
+}
+
+// runs a queue update at the fixed point of BattlegroundMgr::Update, measuring it for .debug matchmaking
+void BattlegroundMgr::UpdateQueue(uint32 diff, BattlegroundQueueTypeId bgQueueTypeId, BattlegroundTypeId bgTypeId, BattlegroundBracketId bracket_id, uint8 arenaType, bool isRated, uint32 arenaRating, uint32 latency)
+{
+    BattlegroundQueue& queue = m_BattlegroundQueues[bgQueueTypeId];
+
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+    queue.BattlegroundQueueUpdate(diff, bgTypeId, bracket_id, arenaType, isRated, arenaRating);
+    ACE_Time_Value elapsed = ACE_OS::gettimeofday() - start;
+
+    if (bracket_id < MAX_BATTLEGROUND_BRACKETS)
+        queue.m_BracketStats[bracket_id].AddUpdate(latency, uint32(elapsed.sec() * IN_MILLISECONDS * IN_MILLISECONDS + elapsed.usec()));
+}
+
+std::string BattlegroundMgr::DumpQueueUpdateInfo()
+{
+    std::ostringstream o;
+    for (uint32 qtype = BATTLEGROUND_QUEUE_NONE; qtype < MAX_BATTLEGROUND_QUEUE_TYPES; ++qtype)
+    {
+        BattlegroundQueue& queue = m_BattlegroundQueues[qtype];
+        for (uint32 bracket = BG_BRACKET_ID_FIRST; bracket < MAX_BATTLEGROUND_BRACKETS; ++bracket)
+        {
+            BattlegroundQueueBracketStats const& stats = queue.m_BracketStats[bracket];
+            uint32 groups = queue.GetQueuedGroupCount(BattlegroundBracketId(bracket));
+            if (!groups && !stats.updates)
+                continue;
+
+            o << "Battleground queue " << qtype << " bracket " << bracket << ": " << groups << " groups ("
+              << queue.GetQueuedPlayerCount(BattlegroundBracketId(bracket)) << " players) queued, " << stats.updates << " updates, latency "
+              << stats.lastLatency << "/" << stats.maxLatency << " ms (last/max), update " << stats.lastUpdateTime << "/" << stats.maxUpdateTime << " us (last/max)\n";
+            o << "  waited <30s " << stats.waitTimes[0] << ", <1m " << stats.waitTimes[1] << ", <2m " << stats.waitTimes[2] << ", <5m " << stats.waitTimes[3]
+              << ", <10m " << stats.waitTimes[4] << ", <20m " << stats.waitTimes[5] << ", longer " << stats.waitTimes[6] << "\n";
+        }
+    }
+
+    if (o.str().empty())
+        o << "No battleground queue updated yet\n";
+
+    return o.str();
 }
 
 uint32 BattlegroundMgr::GetMaxRatingDifference() const
@@ -104,6 +104,7 @@ class BattlegroundMgr
         /* Battleground queues */
         BattlegroundQueue& GetBattlegroundQueue(BattlegroundQueueTypeId bgQueueTypeId) { return m_BattlegroundQueues[bgQueueTypeId]; }
         void ScheduleQueueUpdate(uint32 arenaMatchmakerRating, uint8 arenaType, BattlegroundQueueTypeId bgQueueTypeId, BattlegroundTypeId bgTypeId, BattlegroundBracketId bracket_id);
+        std::string DumpQueueUpdateInfo();
         uint32 GetPrematureFinishTime() const;
 
         void ToggleArenaTesting();
@@ -142,6 +143,7 @@ class BattlegroundMgr
         uint32 CreateClientVisibleInstanceId(BattlegroundTypeId bgTypeId, BattlegroundBracketId bracket_id);
         static bool IsArenaType(BattlegroundTypeId bgTypeId);
         BattlegroundTypeId GetRandomBG(BattlegroundTypeId id);
+        void UpdateQueue(uint32 diff, BattlegroundQueueTypeId bgQueueTypeId, BattlegroundTypeId bgTypeId, BattlegroundBracketId bracket_id, uint8 arenaType, bool isRated, uint32 arenaRating, uint32 latency);
 
         BattlegroundQueue m_BattlegroundQueues[MAX_BATTLEGROUND_QUEUE_TYPES];
 
@@ -149,6 +151,7 @@ class BattlegroundMgr
         BattlegroundSelectionWeightMap m_ArenaSelectionWeights;
         BattlegroundSelectionWeightMap m_BGSelectionWeights;
         std::vector<uint64> m_QueueUpdateScheduler;
+        std::vector<uint32> m_QueueUpdateScheduleTimes;     // getMSTime() when each scheduled update was requested
         uint32 m_NextRatedArenaUpdate;
         bool   m_ArenaTesting;
         bool   m_Testing;
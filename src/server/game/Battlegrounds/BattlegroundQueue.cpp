@@ -30,6 +30,30 @@
 /***            BATTLEGROUND QUEUE SYSTEM              ***/
 /*********************************************************/
 
+// matchmaker rating range of a slice of the rated arena index
+#define RATING_INDEX_SLICE_SIZE 50
+
+uint32 const BattlegroundQueueBracketStats::WaitTimeLimits[BG_QUEUE_WAIT_HISTOGRAM_SIZE - 1] =
+{
+    30 * IN_MILLISECONDS, MINUTE * IN_MILLISECONDS, 2 * MINUTE * IN_MILLISECONDS, 5 * MINUTE * IN_MILLISECONDS,
+    10 * MINUTE * IN_MILLISECONDS, 20 * MINUTE * IN_MILLISECONDS
+};
+
+// orders queued groups by time spent in queue, longest first
+class JoinedBefore
+{
+    public:
+        explicit JoinedBefore(uint32 now) : _now(now) { }
+
+        bool operator()(GroupQueueInfo const* left, GroupQueueInfo const* right) const
+        {
+            return getMSTimeDiff(left->JoinTime, _now) > getMSTimeDiff(right->JoinTime, _now);
+        }
+
+    private:
+        uint32 _now;
+};
+
 BattlegroundQueue::BattlegroundQueue()
 {
     for (uint32 i = 0; i < BG_TEAMS_COUNT; ++i)
@@ -255,6 +279,8 @@ GroupQueueInfo* BattlegroundQueue::AddGroup(Player* leader, Group* grp, Battlegr
     {
         //ACE_Guard<ACE_Recursive_Thread_Mutex> guard(m_Lock);
         m_QueuedGroups[bracketId][index].push_back(ginfo);
+        if (isRated && ArenaType)
+            AddToRatingIndex(ginfo, bracketId, index);
 
         //announce to world, this code needs mutex
         if (!isRated && !isPremade && sWorld->getBoolConfig(CONFIG_BATTLEGROUND_QUEUE_ANNOUNCER_ENABLE))
@@ -298,6 +324,8 @@ GroupQueueInfo* BattlegroundQueue::AddGroup(Player* leader, Group* grp, Battlegr
 void BattlegroundQueue::PlayerInvitedToBGUpdateAverageWaitTime(GroupQueueInfo* ginfo, BattlegroundBracketId bracket_id)
 {
     uint32 timeInQueue = getMSTimeDiff(ginfo->JoinTime, getMSTime());
+    m_BracketStats[bracket_id].AddWaitTime(timeInQueue);
+
     uint8 team_index = TEAM_ALLIANCE;                    //default set to TEAM_ALLIANCE - or non rated arenas!
     if (!ginfo->ArenaType)
     {
@@ -440,6 +468,8 @@ void BattlegroundQueue::RemovePlayer(uint64 guid, bool decreaseInvitedCount)
     if (group->Players.empty())
     {
         m_QueuedGroups[bracket_id][index].erase(group_itr);
+        if (group->IsRated && group->ArenaType && index < BG_TEAMS_COUNT)
+            RemoveFromRatingIndex(group, BattlegroundBracketId(bracket_id), index);
         delete group;
         return;
     }
@@ -490,6 +520,97 @@ uint32 BattlegroundQueue::GetPlayersInQueue(TeamId id)
     return m_SelectionPools[id].GetPlayerCount();
 }
 
+uint32 BattlegroundQueue::GetQueuedGroupCount(BattlegroundBracketId bracket_id) const
+{
+    uint32 count = 0;
+    for (uint32 i = 0; i < BG_QUEUE_GROUP_TYPES_COUNT; ++i)
+        count += m_QueuedGroups[bracket_id][i].size();
+    return count;
+}
+
+uint32 BattlegroundQueue::GetQueuedPlayerCount(BattlegroundBracketId bracket_id) const
+{
+    uint32 count = 0;
+    for (uint32 i = 0; i < BG_QUEUE_GROUP_TYPES_COUNT; ++i)
+        for (GroupsQueueType::const_iterator itr = m_QueuedGroups[bracket_id][i].begin(); itr != m_QueuedGroups[bracket_id][i].end(); ++itr)
+            count += (*itr)->Players.size();
+    return count;
+}
+
+void BattlegroundQueue::AddToRatingIndex(GroupQueueInfo* ginfo, BattlegroundBracketId bracket_id, uint32 side)
+{
+    GroupsQueueType& slice = m_RatingIndex[bracket_id][side][ginfo->ArenaMatchmakerRating / RATING_INDEX_SLICE_SIZE];
+    slice.insert(std::upper_bound(slice.begin(), slice.end(), ginfo, JoinedBefore(getMSTime())), ginfo);
+}
+
+void BattlegroundQueue::RemoveFromRatingIndex(GroupQueueInfo* ginfo, BattlegroundBracketId bracket_id, uint32 side)
+{
+    RatingIndexType& index = m_RatingIndex[bracket_id][side];
+    RatingIndexType::iterator slice = index.find(ginfo->ArenaMatchmakerRating / RATING_INDEX_SLICE_SIZE);
+    if (slice == index.end())
+        return;
+
+    GroupsQueueType::iterator itr = std::find(slice->second.begin(), slice->second.end(), ginfo);
+    if (itr != slice->second.end())
+        slice->second.erase(itr);
+
+    if (slice->second.empty())
+        index.erase(slice);
+}
+
+/**
+    Finds the rated arena team of a premade queue that waited the longest among the ones inside the
+    rating range or waiting for more than the rating discard timer. Only the slices overlapping the
+    range are looked at and in each of them only up to the first team inside the range.
+
+    @param opponent if set, teams of the same arena team are skipped
+*/
+GroupQueueInfo* BattlegroundQueue::FindRatedArenaTeam(BattlegroundBracketId bracket_id, uint32 side, uint32 minRating, uint32 maxRating, uint32 discardTime, GroupQueueInfo const* opponent) const
+{
+    uint32 now = getMSTime();
+    GroupQueueInfo* found = NULL;
+    uint32 foundWaitTime = 0;
+
+    // the queue is in join order, the longest waiting team not invited yet is the only one to check for the discard timer
+    GroupsQueueType const& queue = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + side];
+    for (GroupsQueueType::const_iterator itr = queue.begin(); itr != queue.end(); ++itr)
+    {
+        GroupQueueInfo* ginfo = *itr;
+        if (ginfo->IsInvitedToBGInstanceGUID || (opponent && ginfo->ArenaTeamId == opponent->ArenaTeamId))
+            continue;
+
+        if (ginfo->JoinTime < discardTime)
+        {
+            found = ginfo;
+            foundWaitTime = getMSTimeDiff(ginfo->JoinTime, now);
+        }
+        break;
+    }
+
+    RatingIndexType const& index = m_RatingIndex[bracket_id][side];
+    RatingIndexType::const_iterator end = index.upper_bound(maxRating / RATING_INDEX_SLICE_SIZE);
+    for (RatingIndexType::const_iterator slice = index.lower_bound(minRating / RATING_INDEX_SLICE_SIZE); slice != end; ++slice)
+    {
+        for (GroupsQueueType::const_iterator itr = slice->second.begin(); itr != slice->second.end(); ++itr)
+        {
+            GroupQueueInfo* ginfo = *itr;
+            if (ginfo->ArenaMatchmakerRating < minRating || ginfo->ArenaMatchmakerRating > maxRating
+                || (opponent && ginfo->ArenaTeamId == opponent->ArenaTeamId))
+                continue;
+
+            uint32 waitTime = getMSTimeDiff(ginfo->JoinTime, now);
+            if (!found || waitTime > foundWaitTime)
+            {
+                found = ginfo;
+                foundWaitTime = waitTime;
+            }
+            break;
+        }
+    }
+
+    return found;
+}
+
 bool BattlegroundQueue::InviteGroupToBG(GroupQueueInfo* ginfo, Battleground* bg, uint32 side)
 {
     // set side if needed
@@ -973,26 +1094,17 @@ void BattlegroundQueue::BattlegroundQueueUpdate(uint32 /*diff*/, BattlegroundTyp
             arenaMaxRating = mmrMaxDiff + arenaMaxRating;
         }
 
-        // we need to find 2 teams which will play next game
-        GroupsQueueType::iterator itr_teams[BG_TEAMS_COUNT];
+        // we need to find 2 teams which will play next game, the ones that joined first
+        GroupQueueInfo* teams[BG_TEAMS_COUNT];
         uint8 found = 0;
         uint8 team = 0;
 
-        for (uint8 i = BG_QUEUE_PREMADE_ALLIANCE; i < BG_QUEUE_NORMAL_ALLIANCE; i++)
+        for (uint8 i = TEAM_ALLIANCE; i < BG_TEAMS_COUNT; i++)
         {
-            // take the group that joined first
-            GroupsQueueType::iterator itr2 = m_QueuedGroups[bracket_id][i].begin();
-            for (; itr2 != m_QueuedGroups[bracket_id][i].end(); ++itr2)
+            if (GroupQueueInfo* ginfo = FindRatedArenaTeam(bracket_id, i, arenaMinRating, arenaMaxRating, discardTime, NULL))
             {
-                // if group match conditions, then add it to pool
-                if (!(*itr2)->IsInvitedToBGInstanceGUID
-                    && (((*itr2)->ArenaMatchmakerRating >= arenaMinRating && (*itr2)->ArenaMatchmakerRating <= arenaMaxRating)
-                        || (*itr2)->JoinTime < discardTime))
-                {
-                    itr_teams[found++] = itr2;
-                    team = i;
-                    break;
-                }
+                teams[found++] = ginfo;
+                team = i;
             }
         }
 
@@ -1000,25 +1112,14 @@ void BattlegroundQueue::BattlegroundQueueUpdate(uint32 /*diff*/, BattlegroundTyp
             return;
 
         if (found == 1)
-        {
-            for (GroupsQueueType::iterator itr3 = itr_teams[0]; itr3 != m_QueuedGroups[bracket_id][team].end(); ++itr3)
-            {
-                if (!(*itr3)->IsInvitedToBGInstanceGUID
-                    && (((*itr3)->ArenaMatchmakerRating >= arenaMinRating && (*itr3)->ArenaMatchmakerRating <= arenaMaxRating)
-                        || (*itr3)->JoinTime < discardTime)
-                    && (*itr_teams[0])->ArenaTeamId != (*itr3)->ArenaTeamId)
-                {
-                    itr_teams[found++] = itr3;
-                    break;
-                }
-            }
-        }
+            if (GroupQueueInfo* ginfo = FindRatedArenaTeam(bracket_id, team, arenaMinRating, arenaMaxRating, discardTime, teams[0]))
+                teams[found++] = ginfo;
 
         //if we have 2 teams, then start new arena and invite players!
         if (found == 2)
         {
-            GroupQueueInfo* aTeam = *itr_teams[TEAM_ALLIANCE];
-            GroupQueueInfo* hTeam = *itr_teams[TEAM_HORDE];
+            GroupQueueInfo* aTeam = teams[TEAM_ALLIANCE];
+            GroupQueueInfo* hTeam = teams[TEAM_HORDE];
             Battleground* arena = sBattlegroundMgr->CreateNewBattleground(bgTypeId, bracketEntry, arenaType, true);
             if (!arena)
             {
@@ -1033,16 +1134,22 @@ void BattlegroundQueue::BattlegroundQueueUpdate(uint32 /*diff*/, BattlegroundTyp
             sLog->outDebug(LOG_FILTER_BATTLEGROUND, "setting oposite teamrating for team %u to %u", aTeam->ArenaTeamId, aTeam->OpponentsTeamRating);
             sLog->outDebug(LOG_FILTER_BATTLEGROUND, "setting oposite teamrating for team %u to %u", hTeam->ArenaTeamId, hTeam->OpponentsTeamRating);
 
+            // invited teams can't be matched anymore
+            RemoveFromRatingIndex(aTeam, bracket_id, aTeam->Team == HORDE ? TEAM_HORDE : TEAM_ALLIANCE);
+            RemoveFromRatingIndex(hTeam, bracket_id, hTeam->Team == HORDE ? TEAM_HORDE : TEAM_ALLIANCE);
+
             // now we must move team if we changed its faction to another faction queue, because then we will spam log by errors in Queue::RemovePlayer
             if (aTeam->Team != ALLIANCE)
             {
+                GroupsQueueType& hordeQueue = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE];
+                hordeQueue.erase(std::find(hordeQueue.begin(), hordeQueue.end(), aTeam));
                 m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].push_front(aTeam);
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].erase(itr_teams[TEAM_ALLIANCE]);
             }
             if (hTeam->Team != HORDE)
             {
+                GroupsQueueType& allianceQueue = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE];
+                allianceQueue.erase(std::find(allianceQueue.begin(), allianceQueue.end(), hTeam));
                 m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].push_front(hTeam);
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].erase(itr_teams[TEAM_HORDE]);
             }
 
             arena->SetArenaMatchmakerRating(ALLIANCE, aTeam->ArenaMatchmakerRating);
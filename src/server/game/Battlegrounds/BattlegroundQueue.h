@@ -66,6 +66,43 @@ enum BattlegroundQueueGroupTypes
 };
 #define BG_QUEUE_GROUP_TYPES_COUNT 4
 
+#define BG_QUEUE_WAIT_HISTOGRAM_SIZE 7
+
+/// Cost and delay of the queue updates of a bracket and how long its groups waited, shown by .debug matchmaking
+struct BattlegroundQueueBracketStats
+{
+    BattlegroundQueueBracketStats(): updates(0), lastLatency(0), maxLatency(0), lastUpdateTime(0), maxUpdateTime(0)
+    {
+        memset(waitTimes, 0, sizeof(waitTimes));
+    }
+
+    void AddUpdate(uint32 latency, uint32 updateTime)
+    {
+        ++updates;
+        lastLatency = latency;
+        maxLatency = std::max(maxLatency, latency);
+        lastUpdateTime = updateTime;
+        maxUpdateTime = std::max(maxUpdateTime, updateTime);
+    }
+
+    void AddWaitTime(uint32 waitTime)
+    {
+        uint8 i = 0;
+        while (i < BG_QUEUE_WAIT_HISTOGRAM_SIZE - 1 && waitTime >= WaitTimeLimits[i])
+            ++i;
+        ++waitTimes[i];
+    }
+
+    static uint32 const WaitTimeLimits[BG_QUEUE_WAIT_HISTOGRAM_SIZE - 1]; // upper limit of each histogram slot but the last, in milliseconds
+
+    uint32 updates;
+    uint32 lastLatency;                                     // milliseconds from the update being scheduled to it running
+    uint32 maxLatency;
+    uint32 lastUpdateTime;                                  // microseconds spent in BattlegroundQueueUpdate
+    uint32 maxUpdateTime;
+    uint32 waitTimes[BG_QUEUE_WAIT_HISTOGRAM_SIZE];         // groups invited by time spent in queue
+};
+
 class Battleground;
 class BattlegroundQueue
 {
@@ -122,9 +159,20 @@ class BattlegroundQueue
         //one selection pool for horde, other one for alliance
         SelectionPool m_SelectionPools[BG_TEAMS_COUNT];
         uint32 GetPlayersInQueue(TeamId id);
+
+        uint32 GetQueuedGroupCount(BattlegroundBracketId bracket_id) const;
+        uint32 GetQueuedPlayerCount(BattlegroundBracketId bracket_id) const;
+        BattlegroundQueueBracketStats m_BracketStats[MAX_BATTLEGROUND_BRACKETS];
     private:
 
         bool InviteGroupToBG(GroupQueueInfo* ginfo, Battleground* bg, uint32 side);
+
+        // rated arena teams not invited yet, by matchmaker rating slice and in join order within a slice
+        typedef std::map<uint32, GroupsQueueType> RatingIndexType;
+        void AddToRatingIndex(GroupQueueInfo* ginfo, BattlegroundBracketId bracket_id, uint32 side);
+        void RemoveFromRatingIndex(GroupQueueInfo* ginfo, BattlegroundBracketId bracket_id, uint32 side);
+        GroupQueueInfo* FindRatedArenaTeam(BattlegroundBracketId bracket_id, uint32 side, uint32 minRating, uint32 maxRating, uint32 discardTime, GroupQueueInfo const* opponent) const;
+        RatingIndexType m_RatingIndex[MAX_BATTLEGROUND_BRACKETS][BG_TEAMS_COUNT];
         uint32 m_WaitTimes[BG_TEAMS_COUNT][MAX_BATTLEGROUND_BRACKETS][COUNT_OF_PLAYERS_TO_AVERAGE_WAIT_TIME];
         uint32 m_WaitTimeLastPlayer[BG_TEAMS_COUNT][MAX_BATTLEGROUND_BRACKETS];
         uint32 m_SumOfWaitTimes[BG_TEAMS_COUNT][MAX_BATTLEGROUND_BRACKETS];
@@ -39,55 +39,57 @@ void RatedBattlegroundQueue::Update()
     if (m_queueStore.size() < 2)
         return;
 
-    uint16 maxMMVDiff = 500;
+    uint32 now = getMSTime();
 
-    for (QueueStore::iterator itr1 = m_queueStore.begin(); itr1 != m_queueStore.end(); ++itr1)
-        for (QueueStore::iterator itr2 = m_queueStore.begin(); itr2 != m_queueStore.end(); ++itr2)
+    // a group matching one farther away matches its neighbour too, so only neighbours need to be checked
+    QueueStore::iterator itr2 = m_queueStore.begin();
+    for (QueueStore::iterator itr1 = itr2++; itr2 != m_queueStore.end(); itr1 = itr2++)
+    {
+        GroupQueueInfo* qInfo1 = itr1->second;
+        GroupQueueInfo* qInfo2 = itr2->second;
+
+        // the range grows by 100 every minute the group which joined first waits
+        uint32 waitTime = std::max(getMSTimeDiff(qInfo1->JoinTime, now), getMSTimeDiff(qInfo2->JoinTime, now));
+        uint32 maxMMVDiff = 500 + waitTime / MINUTE / IN_MILLISECONDS * 100;
+
+        if (uint32(qInfo2->RbgMMV - qInfo1->RbgMMV) < maxMMVDiff)
         {
-            GroupQueueInfo* qInfo1 = *itr1;
-            GroupQueueInfo* qInfo2 = *itr2;
+            Battleground* bg_template = sBattlegroundMgr->GetBattlegroundTemplate(BATTLEGROUND_RATED_10_VS_10);
+            if (!bg_template)
+            {
+                sLog->outError(LOG_FILTER_BATTLEGROUND, "RatedBattlegroundQueue Update: bg template not found for %u", BATTLEGROUND_RATED_10_VS_10);
+                continue;
+            }
 
-            if (qInfo1 == qInfo2)
+            PvPDifficultyEntry const* bracketEntry = GetBattlegroundBracketByLevel(bg_template->GetMapId(), 85);
+            if (!bracketEntry)
+            {
+                sLog->outError(LOG_FILTER_BATTLEGROUND, "RatedBattlegroundQueue Update: bg bracket entry not found for map %u bracket id %u", bg_template->GetMapId(), 85);
                 continue;
+            }
 
-            if (abs(int16(qInfo1->RbgMMV) - int16(qInfo2->RbgMMV)) < maxMMVDiff)
+            Battleground* rbg = sBattlegroundMgr->CreateNewBattleground(BATTLEGROUND_RATED_10_VS_10, bracketEntry, 0, false);
+            if (rbg)
             {
-                Battleground* bg_template = sBattlegroundMgr->GetBattlegroundTemplate(BATTLEGROUND_RATED_10_VS_10);
-                if (!bg_template)
-                {
-                    sLog->outError(LOG_FILTER_BATTLEGROUND, "RatedBattlegroundQueue Update: bg template not found for %u", BATTLEGROUND_RATED_10_VS_10);
-                    continue;
-                }
-
-                PvPDifficultyEntry const* bracketEntry = GetBattlegroundBracketByLevel(bg_template->GetMapId(), 85);
-                if (!bracketEntry)
-                {
-                    sLog->outError(LOG_FILTER_BATTLEGROUND, "RatedBattlegroundQueue Update: bg bracket entry not found for map %u bracket id %u", bg_template->GetMapId(), 85);
-                    continue;
-                }
-
-                Battleground* rbg = sBattlegroundMgr->CreateNewBattleground(BATTLEGROUND_RATED_10_VS_10, bracketEntry, 0, false);
-                if (rbg)
-                {
-                    m_queueStore.erase(itr1);
-                    m_queueStore.erase(itr2);
-
-                    qInfo1->OponentsRbgMMV = qInfo2->RbgMMV;
-                    qInfo2->OponentsRbgMMV = qInfo1->RbgMMV;
-
-                    rbg->SetArenaMatchmakerRating(ALLIANCE, qInfo1->RbgMMV);
-                    rbg->SetArenaMatchmakerRating(   HORDE, qInfo2->RbgMMV);
-
-                    InviteGroup(qInfo1, rbg, ALLIANCE);
-                    InviteGroup(qInfo2, rbg, HORDE);
-
-                    rbg->SetRBG(true);
-                    rbg->StartBattleground();
-
-                    return;
-                }
+                m_queueStore.erase(itr1);
+                m_queueStore.erase(itr2);
+
+                qInfo1->OponentsRbgMMV = qInfo2->RbgMMV;
+                qInfo2->OponentsRbgMMV = qInfo1->RbgMMV;
+
+                rbg->SetArenaMatchmakerRating(ALLIANCE, qInfo1->RbgMMV);
+                rbg->SetArenaMatchmakerRating(   HORDE, qInfo2->RbgMMV);
+
+                InviteGroup(qInfo1, rbg, ALLIANCE);
+                InviteGroup(qInfo2, rbg, HORDE);
+
+                rbg->SetRBG(true);
+                rbg->StartBattleground();
+
+                return;
             }
         }
+    }
 }
 
 GroupQueueInfo* RatedBattlegroundQueue::AddGroup(Player *leader)
@@ -126,11 +128,26 @@ GroupQueueInfo* RatedBattlegroundQueue::AddGroup(Player *leader)
 
     queueInfo->RbgMMV = mmv;
 
-    m_queueStore.insert(queueInfo);
+    m_queueStore.insert(QueueStore::value_type(queueInfo->RbgMMV, queueInfo));
 
     return queueInfo;
 }
 
+bool RatedBattlegroundQueue::RemoveFromQueue(GroupQueueInfo* ginfo)
+{
+    std::pair<QueueStore::iterator, QueueStore::iterator> range = m_queueStore.equal_range(ginfo->RbgMMV);
+    for (QueueStore::iterator itr = range.first; itr != range.second; ++itr)
+    {
+        if (itr->second == ginfo)
+        {
+            m_queueStore.erase(itr);
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void RatedBattlegroundQueue::RemovePlayer(uint64 playerGuid)
 {
     GroupQueueInfo* gInfo = GetQueueInfoByPlayer(playerGuid);
@@ -159,6 +176,7 @@ void RatedBattlegroundQueue::RemovePlayer(uint64 playerGuid)
 
             m_playersQueueStore.erase(player->GetGUID());
         }
+        RemoveFromQueue(gInfo);
         delete gInfo;
     }
     else
@@ -41,7 +41,10 @@ public:
 private:
     bool InviteGroup(GroupQueueInfo* ginfo, Battleground* bg, uint32 side);
 
-    typedef std::set<GroupQueueInfo*> QueueStore;
+    bool RemoveFromQueue(GroupQueueInfo* ginfo);
+
+    // queued groups sorted by matchmaking value, the closest opponents are always neighbours
+    typedef std::multimap<uint16, GroupQueueInfo*> QueueStore;
     typedef UNORDERED_MAP<uint64, GroupQueueInfo*> PlayersQueueStore;
 
     QueueStore m_queueStore;
@@ -150,6 +150,8 @@ void Channel::CleanOldChannelsInDB()
 
 void Channel::Join(uint64 p, const char *pass)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     WorldPacket data;
     if (IsOn(p))
     {
@@ -201,6 +203,11 @@ void Channel::Join(uint64 p, const char *pass)
     PlayerInfo pinfo;
     pinfo.player = p;
     pinfo.flags = MEMBER_FLAG_NONE;
+    if (player)
+    {
+        pinfo.session = player->GetSession();
+        pinfo.social = player->GetSocial();
+    }
     players[p] = pinfo;
 
     MakeYouJoined(&data);
@@ -226,6 +233,8 @@ void Channel::Join(uint64 p, const char *pass)
 
 void Channel::Leave(uint64 p, bool send)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     if (!IsOn(p))
     {
         if (send)
@@ -279,6 +288,8 @@ void Channel::Leave(uint64 p, bool send)
 
 void Channel::KickOrBan(uint64 good, const char *badname, bool ban)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     AccountTypes sec = SEC_PLAYER;
     Player* gplr = ObjectAccessor::FindPlayer(good);
     if (gplr)
@@ -347,6 +358,8 @@ void Channel::KickOrBan(uint64 good, const char *badname, bool ban)
 
 void Channel::UnBan(uint64 good, const char *badname)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     uint32 sec = 0;
     Player* gplr = ObjectAccessor::FindPlayer(good);
     if (gplr)
@@ -388,6 +401,8 @@ void Channel::UnBan(uint64 good, const char *badname)
 
 void Channel::Password(uint64 p, const char *pass)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     uint32 sec = 0;
     Player* player = ObjectAccessor::FindPlayer(p);
     if (player)
@@ -421,6 +436,8 @@ void Channel::Password(uint64 p, const char *pass)
 
 void Channel::SetMode(uint64 p, const char *p2n, bool mod, bool set)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     Player* player = ObjectAccessor::FindPlayer(p);
     if (!player)
         return;
@@ -489,6 +506,8 @@ void Channel::SetMode(uint64 p, const char *p2n, bool mod, bool set)
 
 void Channel::SetOwner(uint64 p, const char *newname)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     Player* player = ObjectAccessor::FindPlayer(p);
     if (!player)
         return;
@@ -534,6 +553,8 @@ void Channel::SetOwner(uint64 p, const char *newname)
 
 void Channel::SendWhoOwner(uint64 p)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     if (!IsOn(p))
     {
         WorldPacket data;
@@ -550,6 +571,8 @@ void Channel::SendWhoOwner(uint64 p)
 
 void Channel::List(Player* player)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     uint64 p = player->GetGUID();
 
     if (!IsOn(p))
@@ -594,6 +617,8 @@ void Channel::List(Player* player)
 
 void Channel::Announce(uint64 p)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     uint32 sec = 0;
     Player* player = ObjectAccessor::FindPlayer(p);
     if (player)
@@ -628,6 +653,8 @@ void Channel::Announce(uint64 p)
 
 void Channel::Say(uint64 p, const char *what, uint32 lang)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     if (!what)
         return;
     if (sWorld->getBoolConfig(CONFIG_ALLOW_TWO_SIDE_INTERACTION_CHANNEL))
@@ -668,6 +695,8 @@ void Channel::Say(uint64 p, const char *what, uint32 lang)
 
 void Channel::Invite(uint64 p, const char *newname)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     if (!IsOn(p))
     {
         WorldPacket data;
@@ -726,6 +755,8 @@ void Channel::Invite(uint64 p, const char *newname)
 
 void Channel::SetOwner(uint64 guid, bool exclaim)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     if (m_ownerGUID)
     {
         // [] will re-add player after it possible removed
@@ -755,39 +786,38 @@ void Channel::SetOwner(uint64 guid, bool exclaim)
     }
 }
 
+// the members keep their session, no player lookup per member and message
 void Channel::SendToAll(WorldPacket* data, uint64 p)
 {
+    uint32 ignoreGuid = GUID_LOPART(p);
     for (PlayerList::const_iterator i = players.begin(); i != players.end(); ++i)
     {
-        Player* player = ObjectAccessor::FindPlayer(i->first);
-        if (player)
-        {
-            if (!p || !player->GetSocial()->HasIgnore(GUID_LOPART(p)))
-                player->GetSession()->SendPacket(data);
-        }
+        if (!i->second.session)
+            continue;
+
+        if (!p || !i->second.social || !i->second.social->HasIgnore(ignoreGuid))
+            i->second.session->SendPacket(data);
     }
 }
 
 void Channel::SendToAllButOne(WorldPacket* data, uint64 who)
 {
-    if (players.empty())
-        return;
-
     for (PlayerList::const_iterator i = players.begin(); i != players.end(); ++i)
-    {
-        if (i->first != who)
-        {
-            Player* player = ObjectAccessor::FindPlayer(i->first);
-            if (player)
-                player->GetSession()->SendPacket(data);
-        }
-    }
+        if (i->first != who && i->second.session)
+            i->second.session->SendPacket(data);
 }
 
 void Channel::SendToOne(WorldPacket* data, uint64 who)
 {
-    Player* player = ObjectAccessor::FindPlayer(who);
-    if (player)
+    PlayerList::const_iterator i = players.find(who);
+    if (i != players.end() && i->second.session)
+    {
+        i->second.session->SendPacket(data);
+        return;
+    }
+
+    // not a member (yet)
+    if (Player* player = ObjectAccessor::FindPlayer(who))
         player->GetSession()->SendPacket(data);
 }
 
@@ -1049,6 +1079,8 @@ void Channel::MakeVoiceOff(WorldPacket* data, uint64 guid)
 
 void Channel::JoinNotify(uint64 guid)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     WorldPacket data(IsConstant() ? SMSG_USERLIST_ADD : SMSG_USERLIST_UPDATE, 8+1+1+4+GetName().size()+1);
 
     data << uint64(guid);
@@ -1065,6 +1097,8 @@ void Channel::JoinNotify(uint64 guid)
 
 void Channel::LeaveNotify(uint64 guid)
 {
+    TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+
     WorldPacket data(SMSG_USERLIST_REMOVE, 8+1+4+GetName().size()+1);
     data << uint64(guid);
     data << uint8(GetFlags());
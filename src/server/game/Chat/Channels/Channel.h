@@ -29,6 +29,10 @@
 #include "Player.h"
 #include "WorldPacket.h"
 
+#include <ace/Recursive_Thread_Mutex.h>
+
+class PlayerSocial;
+
 enum ChatNotify
 {
     CHAT_JOINED_NOTICE                = 0x00,           //+ "%s joined channel.";
@@ -121,8 +125,12 @@ class Channel
 {
     struct PlayerInfo
     {
+        PlayerInfo() : player(0), flags(MEMBER_FLAG_NONE), session(NULL), social(NULL) { }
+
         uint64 player;
         uint8 flags;
+        WorldSession* session;                              // members leave every channel before logging out
+        PlayerSocial* social;
 
         bool HasFlag(uint8 flag) const { return flags & flag; }
         void SetFlag(uint8 flag) { if (!HasFlag(flag)) flags |= flag; }
@@ -159,6 +167,8 @@ class Channel
     uint32      m_channelId;
     uint64      m_ownerGUID;
     bool        m_IsSaved;
+    // zone channels are joined and left from the map threads
+    mutable ACE_Recursive_Thread_Mutex m_lock;
 
     private:
         // initial packet data (notify type and channel name)
@@ -253,7 +263,11 @@ class Channel
         std::string GetPassword() const { return m_password; }
         void SetPassword(const std::string& npassword) { m_password = npassword; }
         void SetAnnounce(bool nannounce) { m_announce = nannounce; }
-        uint32 GetNumPlayers() const { return players.size(); }
+        uint32 GetNumPlayers() const
+        {
+            TRINITY_GUARD(ACE_Recursive_Thread_Mutex, m_lock);
+            return players.size();
+        }
         uint8 GetFlags() const { return m_flags; }
         bool HasFlag(uint8 flag) const { return m_flags & flag; }
 
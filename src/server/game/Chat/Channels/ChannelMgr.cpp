@@ -48,6 +48,8 @@ Channel* ChannelMgr::GetJoinChannel(std::string name, uint32 channel_id)
     Utf8toWStr(name, wname);
     wstrToLower(wname);
 
+    TRINITY_GUARD(ACE_Thread_Mutex, channelsLock);
+
     if (channels.find(wname) == channels.end())
     {
         Channel* nchan = new Channel(name, channel_id, team);
@@ -64,6 +66,8 @@ Channel* ChannelMgr::GetChannel(std::string name, Player* p, bool pkt)
     Utf8toWStr(name, wname);
     wstrToLower(wname);
 
+    TRINITY_GUARD(ACE_Thread_Mutex, channelsLock);
+
     ChannelMap::const_iterator i = channels.find(wname);
 
     if (i == channels.end())
@@ -87,6 +91,8 @@ void ChannelMgr::LeftChannel(std::string name)
     Utf8toWStr(name, wname);
     wstrToLower(wname);
 
+    TRINITY_GUARD(ACE_Thread_Mutex, channelsLock);
+
     ChannelMap::const_iterator i = channels.find(wname);
 
     if (i == channels.end())
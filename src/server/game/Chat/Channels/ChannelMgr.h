@@ -21,6 +21,7 @@
 #include "Common.h"
 #include "Channel.h"
 #include <ace/Singleton.h>
+#include <ace/Thread_Mutex.h>
 
 #include <map>
 #include <string>
@@ -40,6 +41,7 @@ class ChannelMgr
         void LeftChannel(std::string name);
     private:
         ChannelMap channels;
+        ACE_Thread_Mutex channelsLock;                      // zone channels are looked up from the map threads
         void MakeNotOnPacket(WorldPacket* data, std::string name);
 };
 
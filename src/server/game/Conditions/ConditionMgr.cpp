@@ -27,6 +27,7 @@
 #include "ScriptMgr.h"
 #include "ScriptedCreature.h"
 #include "Spell.h"
+#include "SmartScriptMgr.h"
 
 // Checks if object meets the condition
 // Can have CONDITION_SOURCE_TYPE_NONE && !mReferenceId if called from a special event (ie: SmartAI)
@@ -40,6 +41,32 @@ bool Condition::Meets(ConditionSourceInfo& sourceInfo)
         sLog->outDebug(LOG_FILTER_CONDITIONSYS, "Condition object not found for condition (Entry: %u Type: %u Group: %u)", SourceEntry, SourceType, SourceGroup);
         return false;
     }
+
+    bool condMeets;
+    if (GetCost() == CONDITION_COST_WORLD)
+    {
+        // result does not depend on the object, reuse it until world states or game events change
+        long generation = sConditionMgr->GetWorldGeneration();
+        long cached = _worldResult.value();
+        if (cached && (cached >> 1) == generation)
+            condMeets = (cached & 1) != 0;
+        else
+        {
+            condMeets = CheckCondition(sourceInfo, object);
+            _worldResult = (generation << 1) | (condMeets ? 1 : 0);
+        }
+    }
+    else
+        condMeets = CheckCondition(sourceInfo, object);
+
+    if (!condMeets)
+        sourceInfo.mLastFailedCondition = this;
+
+    return condMeets;
+}
+
+bool Condition::CheckCondition(ConditionSourceInfo& sourceInfo, WorldObject* object)
+{
     bool condMeets = false;
     switch (ConditionType)
     {
@@ -308,12 +335,48 @@ bool Condition::Meets(ConditionSourceInfo& sourceInfo)
     if (NegativeCondition)
         condMeets = !condMeets;
 
-    if (!condMeets)
-        sourceInfo.mLastFailedCondition = this;
-
     return condMeets;
 }
 
+ConditionCost Condition::GetCost() const
+{
+    if (ReferenceId)
+        return CONDITION_COST_LOOKUP;
+
+    switch (ConditionType)
+    {
+        case CONDITION_NONE:
+        case CONDITION_ACTIVE_EVENT:
+        case CONDITION_WORLD_STATE:
+            return CONDITION_COST_WORLD;
+        case CONDITION_TEAM:
+        case CONDITION_CLASS:
+        case CONDITION_RACE:
+        case CONDITION_GENDER:
+        case CONDITION_DRUNKENSTATE:
+        case CONDITION_MAPID:
+        case CONDITION_LEVEL:
+        case CONDITION_OBJECT_ENTRY:
+        case CONDITION_TYPE_MASK:
+        case CONDITION_ALIVE:
+        case CONDITION_HP_VAL:
+        case CONDITION_HP_PCT:
+        case CONDITION_PHASEMASK:
+        case CONDITION_SPAWNMASK:
+        case CONDITION_UNIT_STATE:
+        case CONDITION_DISTANCE_TO:
+            return CONDITION_COST_FIELD;
+        case CONDITION_ITEM:
+        case CONDITION_ITEM_EQUIPPED:
+            return CONDITION_COST_SCAN;
+        case CONDITION_NEAR_CREATURE:
+        case CONDITION_NEAR_GAMEOBJECT:
+            return CONDITION_COST_SEARCH;
+        default:
+            return CONDITION_COST_LOOKUP;
+    }
+}
+
 uint32 Condition::GetSearcherTypeMaskForCondition()
 {
     // build mask of types for which condition can return true
@@ -490,6 +553,7 @@ uint32 Condition::GetMaxAvailableConditionTargets()
 
 ConditionMgr::ConditionMgr()
 {
+    _worldGeneration = 1;
 }
 
 ConditionMgr::~ConditionMgr()
@@ -497,13 +561,25 @@ ConditionMgr::~ConditionMgr()
     Clean();
 }
 
-ConditionList ConditionMgr::GetConditionReferences(uint32 refId)
+ConditionList const& ConditionMgr::GetConditionReferences(uint32 refId)
 {
-    ConditionList conditions;
     ConditionReferenceContainer::const_iterator ref = ConditionReferenceStore.find(refId);
     if (ref != ConditionReferenceStore.end())
-        conditions = (*ref).second;
-    return conditions;
+        return (*ref).second;
+    return EmptyConditionList;
+}
+
+static bool ConditionEvaluatesBefore(Condition const* left, Condition const* right)
+{
+    if (left->ElseGroup != right->ElseGroup)
+        return left->ElseGroup < right->ElseGroup;
+    return left->GetCost() < right->GetCost();
+}
+
+void ConditionMgr::AddToConditionList(ConditionList& conditions, Condition* cond)
+{
+    // keep ElseGroups contiguous and cheap checks first, equal conditions keep their load order
+    conditions.insert(std::upper_bound(conditions.begin(), conditions.end(), cond, ConditionEvaluatesBefore), cond);
 }
 
 uint32 ConditionMgr::GetSearcherTypeMaskForConditionList(ConditionList const& conditions)
@@ -548,46 +624,49 @@ uint32 ConditionMgr::GetSearcherTypeMaskForConditionList(ConditionList const& co
 
 bool ConditionMgr::IsObjectMeetToConditionList(ConditionSourceInfo& sourceInfo, ConditionList const& conditions)
 {
-    //     groupId, groupCheckPassed
-    std::map<uint32, bool> ElseGroupStore;
-    for (ConditionList::const_iterator i = conditions.begin(); i != conditions.end(); ++i)
+    // the list is sorted by ElseGroup (see AddToConditionList), so every group is a contiguous run:
+    // a group passes when all of its conditions pass, the list passes when any group passes
+    ConditionList::const_iterator i = conditions.begin();
+    while (i != conditions.end())
     {
-        sLog->outDebug(LOG_FILTER_CONDITIONSYS, "ConditionMgr::IsPlayerMeetToConditionList condType: %u val1: %u", (*i)->ConditionType, (*i)->ConditionValue1);
-        if ((*i)->isLoaded())
-        {
-            //! Find ElseGroup in ElseGroupStore
-            std::map<uint32, bool>::const_iterator itr = ElseGroupStore.find((*i)->ElseGroup);
-            //! If not found, add an entry in the store and set to true (placeholder)
-            if (itr == ElseGroupStore.end())
-                ElseGroupStore[(*i)->ElseGroup] = true;
-            else if (!(*itr).second)
+        uint32 elseGroup = (*i)->ElseGroup;
+        bool groupChecked = false;
+        bool groupPassed = true;
+        for (; i != conditions.end() && (*i)->ElseGroup == elseGroup; ++i)
+        {
+            // rest of the group can't change the result anymore
+            if (!groupPassed)
+                continue;
+
+            sLog->outDebug(LOG_FILTER_CONDITIONSYS, "ConditionMgr::IsPlayerMeetToConditionList condType: %u val1: %u", (*i)->ConditionType, (*i)->ConditionValue1);
+            if (!(*i)->isLoaded())
                 continue;
 
+            groupChecked = true;
             if ((*i)->ReferenceId)//handle reference
             {
                 ConditionReferenceContainer::const_iterator ref = ConditionReferenceStore.find((*i)->ReferenceId);
                 if (ref != ConditionReferenceStore.end())
                 {
                     if (!IsObjectMeetToConditionList(sourceInfo, (*ref).second))
-                        ElseGroupStore[(*i)->ElseGroup] = false;
+                        groupPassed = false;
                 }
                 else
                 {
                     sLog->outDebug(LOG_FILTER_CONDITIONSYS, "IsPlayerMeetToConditionList: Reference template -%u not found",
                         (*i)->ReferenceId);//checked at loading, should never happen
                 }
-
             }
             else //handle normal condition
             {
                 if (!(*i)->Meets(sourceInfo))
-                    ElseGroupStore[(*i)->ElseGroup] = false;
+                    groupPassed = false;
             }
         }
-    }
-    for (std::map<uint32, bool>::const_iterator i = ElseGroupStore.begin(); i != ElseGroupStore.end(); ++i)
-        if (i->second)
+
+        if (groupChecked && groupPassed)
             return true;
+    }
 
     return false;
 }
@@ -642,9 +721,8 @@ bool ConditionMgr::CanHaveSourceIdSet(ConditionSourceType sourceType) const
     return (sourceType == CONDITION_SOURCE_TYPE_SMART_EVENT);
 }
 
-ConditionList ConditionMgr::GetConditionsForNotGroupedEntry(ConditionSourceType sourceType, uint32 entry)
+ConditionList const& ConditionMgr::GetConditionsForNotGroupedEntry(ConditionSourceType sourceType, uint32 entry)
 {
-    ConditionList spellCond;
     if (sourceType > CONDITION_SOURCE_TYPE_NONE && sourceType < CONDITION_SOURCE_TYPE_MAX)
     {
         ConditionContainer::const_iterator itr = ConditionStore.find(sourceType);
@@ -653,93 +731,88 @@ ConditionList ConditionMgr::GetConditionsForNotGroupedEntry(ConditionSourceType
             ConditionTypeContainer::const_iterator i = (*itr).second.find(entry);
             if (i != (*itr).second.end())
             {
-                spellCond = (*i).second;
                 sLog->outDebug(LOG_FILTER_CONDITIONSYS, "GetConditionsForNotGroupedEntry: found conditions for type %u and entry %u", uint32(sourceType), entry);
+                return (*i).second;
             }
         }
     }
-    return spellCond;
+    return EmptyConditionList;
 }
 
-ConditionList ConditionMgr::GetConditionsForSpellClickEvent(uint32 creatureId, uint32 spellId)
+ConditionList const& ConditionMgr::GetConditionsForSpellClickEvent(uint32 creatureId, uint32 spellId)
 {
-    ConditionList cond;
     CreatureSpellConditionContainer::const_iterator itr = SpellClickEventConditionStore.find(creatureId);
     if (itr != SpellClickEventConditionStore.end())
     {
         ConditionTypeContainer::const_iterator i = (*itr).second.find(spellId);
         if (i != (*itr).second.end())
         {
-            cond = (*i).second;
             sLog->outDebug(LOG_FILTER_CONDITIONSYS, "GetConditionsForSpellClickEvent: found conditions for Vehicle entry %u spell %u", creatureId, spellId);
+            return (*i).second;
         }
     }
-    return cond;
+    return EmptyConditionList;
 }
 
-ConditionList ConditionMgr::GetConditionsForVehicleSpell(uint32 creatureId, uint32 spellId)
+ConditionList const& ConditionMgr::GetConditionsForVehicleSpell(uint32 creatureId, uint32 spellId)
 {
-    ConditionList cond;
     CreatureSpellConditionContainer::const_iterator itr = VehicleSpellConditionStore.find(creatureId);
     if (itr != VehicleSpellConditionStore.end())
     {
             ConditionTypeContainer::const_iterator i = (*itr).second.find(spellId);
         if (i != (*itr).second.end())
         {
-            cond = (*i).second;
             sLog->outDebug(LOG_FILTER_CONDITIONSYS, "GetConditionsForVehicleSpell: found conditions for Vehicle entry %u spell %u", creatureId, spellId);
+            return (*i).second;
         }
     }
-    return cond;
+    return EmptyConditionList;
 }
 
-ConditionList ConditionMgr::GetConditionsForSmartEvent(int32 entryOrGuid, uint32 eventId, uint32 sourceType)
+ConditionList const* ConditionMgr::GetConditionsForSmartEvent(int32 entryOrGuid, uint32 eventId, uint32 sourceType)
 {
-    ConditionList cond;
     SmartEventConditionContainer::const_iterator itr = SmartEventConditionStore.find(std::make_pair(entryOrGuid, sourceType));
     if (itr != SmartEventConditionStore.end())
     {
         ConditionTypeContainer::const_iterator i = (*itr).second.find(eventId + 1);
         if (i != (*itr).second.end())
         {
-            cond = (*i).second;
             sLog->outDebug(LOG_FILTER_CONDITIONSYS, "GetConditionsForSmartEvent: found conditions for Smart Event entry or guid %d event_id %u", entryOrGuid, eventId);
+            return &(*i).second;
         }
     }
-    return cond;
+    return NULL;
 }
 
-ConditionList ConditionMgr::GetConditionsForPhaseDefinition(uint32 zone, uint32 entry)
+ConditionList const& ConditionMgr::GetConditionsForPhaseDefinition(uint32 zone, uint32 entry)
 {
-    ConditionList cond;
     PhaseDefinitionConditionContainer::const_iterator itr = PhaseDefinitionsConditionStore.find(zone);
     if (itr != PhaseDefinitionsConditionStore.end())
     {
         ConditionTypeContainer::const_iterator i = (*itr).second.find(entry);
         if (i != (*itr).second.end())
         {
-            cond = (*i).second;
             sLog->outDebug(LOG_FILTER_CONDITIONSYS, "GetConditionsForPhaseDefinition: found conditions for zone %u entry %u", zone, entry);
+            return (*i).second;
         }
     }
 
-    return cond;
+    return EmptyConditionList;
 }
 
-ConditionList ConditionMgr::GetConditionsForNpcVendorEvent(uint32 creatureId, uint32 itemId)
+ConditionList const& ConditionMgr::GetConditionsForNpcVendorEvent(uint32 creatureId, uint32 itemId)
 {
-    ConditionList cond;
     NpcVendorConditionContainer::const_iterator itr = NpcVendorConditionContainerStore.find(creatureId);
     if (itr != NpcVendorConditionContainerStore.end())
     {
         ConditionTypeContainer::const_iterator i = (*itr).second.find(itemId);
         if (i != (*itr).second.end())
         {
-            cond = (*i).second;
             sLog->outDebug(LOG_FILTER_CONDITIONSYS, "GetConditionsForNpcVendorEvent: found conditions for creature entry %u item %u", creatureId, itemId);
+            return (*i).second;
         }
     }
-    return cond;
+    return EmptyConditionList;
 }
 
 void ConditionMgr::LoadConditions(bool isReload)
@@ -780,6 +853,9 @@ void ConditionMgr::LoadConditions(bool isReload)
     {
         sLog->outError(LOG_FILTER_SERVER_LOADING, ">> Loaded 0 conditions. DB table `conditions` is empty!");
 
+        if (isReload)
+            sSmartScriptMgr->ResolveConditions();
+
         return;
     }
 
@@ -853,7 +929,7 @@ void ConditionMgr::LoadConditions(bool isReload)
                 ConditionList mCondList;
                 ConditionReferenceStore[uRefId] = mCondList;
             }
-            ConditionReferenceStore[uRefId].push_back(cond);//add to reference storage
+            AddToConditionList(ConditionReferenceStore[uRefId], cond);//add to reference storage
             count++;
             continue;
         }//end of reference templates
@@ -929,7 +1005,7 @@ void ConditionMgr::LoadConditions(bool isReload)
                     break;
                 case CONDITION_SOURCE_TYPE_SPELL_CLICK_EVENT:
                 {
-                    SpellClickEventConditionStore[cond->SourceGroup][cond->SourceEntry].push_back(cond);
+                    AddToConditionList(SpellClickEventConditionStore[cond->SourceGroup][cond->SourceEntry], cond);
                     valid = true;
                     ++count;
                     continue;   // do not add to m_AllocatedMemory to avoid double deleting
@@ -939,7 +1015,7 @@ void ConditionMgr::LoadConditions(bool isReload)
                     break;
                 case CONDITION_SOURCE_TYPE_VEHICLE_SPELL:
                 {
-                    VehicleSpellConditionStore[cond->SourceGroup][cond->SourceEntry].push_back(cond);
+                    AddToConditionList(VehicleSpellConditionStore[cond->SourceGroup][cond->SourceEntry], cond);
                     valid = true;
                     ++count;
                     continue;   // do not add to m_AllocatedMemory to avoid double deleting
@@ -948,21 +1024,21 @@ void ConditionMgr::LoadConditions(bool isReload)
                 {
                     //! TODO: PAIR_32 ?
                     std::pair<int32, uint32> key = std::make_pair(cond->SourceEntry, cond->SourceId);
-                    SmartEventConditionStore[key][cond->SourceGroup].push_back(cond);
+                    AddToConditionList(SmartEventConditionStore[key][cond->SourceGroup], cond);
                     valid = true;
                     ++count;
                     continue;
                 }
                 case CONDITION_SOURCE_TYPE_PHASE_DEFINITION:
                 {
-                    PhaseDefinitionsConditionStore[cond->SourceGroup][cond->SourceEntry].push_back(cond);
+                    AddToConditionList(PhaseDefinitionsConditionStore[cond->SourceGroup][cond->SourceEntry], cond);
                     valid = true;
                     ++count;
                     continue;
                 }
                 case CONDITION_SOURCE_TYPE_NPC_VENDOR:
                 {
-                    NpcVendorConditionContainerStore[cond->SourceGroup][cond->SourceEntry].push_back(cond);
+                    AddToConditionList(NpcVendorConditionContainerStore[cond->SourceGroup][cond->SourceEntry], cond);
                     valid = true;
                     ++count;
                     continue;
@@ -1000,11 +1076,15 @@ void ConditionMgr::LoadConditions(bool isReload)
         }
 
         //add new Condition to storage based on Type/Entry
-        ConditionStore[cond->SourceType][cond->SourceEntry].push_back(cond);
+        AddToConditionList(ConditionStore[cond->SourceType][cond->SourceEntry], cond);
         ++count;
     }
     while (result->NextRow());
 
+    // compiled SmartAI programs point into the condition lists rebuilt above
+    if (isReload)
+        sSmartScriptMgr->ResolveConditions();
+
     sLog->outInfo(LOG_FILTER_SERVER_LOADING, ">> Loaded %u conditions in %u ms", count, GetMSTimeDiffToNow(oldMSTime));
 
 }
@@ -1034,7 +1114,7 @@ bool ConditionMgr::addToGossipMenus(Condition* cond)
         {
             if ((*itr).second.entry == cond->SourceGroup && (*itr).second.text_id == uint32(cond->SourceEntry))
             {
-                (*itr).second.conditions.push_back(cond);
+                AddToConditionList((*itr).second.conditions, cond);
                 return true;
             }
         }
@@ -1053,7 +1133,7 @@ bool ConditionMgr::addToGossipMenuItems(Condition* cond)
         {
             if ((*itr).second.MenuId == cond->SourceGroup && (*itr).second.OptionIndex == uint32(cond->SourceEntry))
             {
-                (*itr).second.Conditions.push_back(cond);
+                AddToConditionList((*itr).second.Conditions, cond);
                 return true;
             }
         }
@@ -1128,7 +1208,7 @@ bool ConditionMgr::addToSpellImplicitTargetConditions(Condition* cond)
                     if ((1<<i) & commonMask)
                         spellInfo->Effects[i].ImplicitTargetConditions = sharedList;
             }
-            sharedList->push_back(cond);
+            AddToConditionList(*sharedList, cond);
             break;
         }
     }
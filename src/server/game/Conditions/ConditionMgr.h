@@ -20,6 +20,7 @@
 #define TRINITY_CONDITIONMGR_H
 
 #include <ace/Singleton.h>
+#include <ace/Atomic_Op.h>
 
 class Player;
 class Unit;
@@ -89,7 +90,7 @@ enum ConditionTypes
 
     Step 6: Determine how you are going to store your conditions. You need to add a new storage container
             for it in ConditionMgr class, along with a function like:
-            ConditionList GetConditionsForXXXYourNewSourceTypeXXX(parameters...)
+            ConditionList const& GetConditionsForXXXYourNewSourceTypeXXX(parameters...)
 
             The above function should be placed in upper level (practical) code that actually
             checks the conditions.
@@ -97,6 +98,9 @@ enum ConditionTypes
     Step 7: Implement loading for your source type in ConditionMgr::LoadConditions.
 
     Step 8: Implement memory cleaning for your source type in ConditionMgr::Clean.
+
+    Conditions are added to a list with ConditionMgr::AddToConditionList, which keeps the list in
+    evaluation order.
 */
 enum ConditionSourceType
 {
@@ -168,6 +172,16 @@ struct ConditionSourceInfo
     }
 };
 
+// rough cost of checking a condition, lists are evaluated cheapest first
+enum ConditionCost
+{
+    CONDITION_COST_WORLD            = 0,                    // same result for every object, cached until world states or game events change
+    CONDITION_COST_FIELD            = 1,                    // reads a field of the object
+    CONDITION_COST_LOOKUP           = 2,                    // looks up a container of the object (quests, spells, auras, ...)
+    CONDITION_COST_SCAN             = 3,                    // walks a container of the object (items)
+    CONDITION_COST_SEARCH           = 4                     // grid search around the object
+};
+
 struct Condition
 {
     ConditionSourceType     SourceType;        //SourceTypeOrReferenceId
@@ -200,15 +214,24 @@ struct Condition
         ErrorTextId        = 0;
         ScriptId           = 0;
         NegativeCondition  = false;
+        _worldResult       = 0;
     }
 
     bool Meets(ConditionSourceInfo& sourceInfo);
     uint32 GetSearcherTypeMaskForCondition();
     bool isLoaded() const { return ConditionType > CONDITION_NONE || ReferenceId; }
     uint32 GetMaxAvailableConditionTargets();
+    ConditionCost GetCost() const;
+
+    private:
+        bool CheckCondition(ConditionSourceInfo& sourceInfo, WorldObject* object);
+
+        // CONDITION_COST_WORLD result, (world generation << 1) | result, 0 while not cached
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> _worldResult;
 };
 
-typedef std::list<Condition*> ConditionList;
+// kept in evaluation order: grouped by ElseGroup, cheapest conditions first inside a group
+typedef std::vector<Condition*> ConditionList;
 typedef std::map<uint32, ConditionList> ConditionTypeContainer;
 typedef std::map<ConditionSourceType, ConditionTypeContainer> ConditionContainer;
 typedef std::map<uint32, ConditionTypeContainer> CreatureSpellConditionContainer;
@@ -229,7 +252,8 @@ class ConditionMgr
     public:
         void LoadConditions(bool isReload = false);
         bool isConditionTypeValid(Condition* cond);
-        ConditionList GetConditionReferences(uint32 refId);
+        ConditionList const& GetConditionReferences(uint32 refId);
+        static void AddToConditionList(ConditionList& conditions, Condition* cond);
 
         uint32 GetSearcherTypeMaskForConditionList(ConditionList const& conditions);
         bool IsObjectMeetToConditions(WorldObject* object, ConditionList const& conditions);
@@ -237,12 +261,17 @@ class ConditionMgr
         bool IsObjectMeetToConditions(ConditionSourceInfo& sourceInfo, ConditionList const& conditions);
         bool CanHaveSourceGroupSet(ConditionSourceType sourceType) const;
         bool CanHaveSourceIdSet(ConditionSourceType sourceType) const;
-        ConditionList GetConditionsForNotGroupedEntry(ConditionSourceType sourceType, uint32 entry);
-        ConditionList GetConditionsForSpellClickEvent(uint32 creatureId, uint32 spellId);
-        ConditionList GetConditionsForSmartEvent(int32 entryOrGuid, uint32 eventId, uint32 sourceType);
-        ConditionList GetConditionsForVehicleSpell(uint32 creatureId, uint32 spellId);
-        ConditionList GetConditionsForPhaseDefinition(uint32 zone, uint32 entry);
-        ConditionList GetConditionsForNpcVendorEvent(uint32 creatureId, uint32 itemId);
+        // the returned lists stay valid until conditions are reloaded
+        ConditionList const& GetConditionsForNotGroupedEntry(ConditionSourceType sourceType, uint32 entry);
+        ConditionList const& GetConditionsForSpellClickEvent(uint32 creatureId, uint32 spellId);
+        ConditionList const* GetConditionsForSmartEvent(int32 entryOrGuid, uint32 eventId, uint32 sourceType);
+        ConditionList const& GetConditionsForVehicleSpell(uint32 creatureId, uint32 spellId);
+        ConditionList const& GetConditionsForPhaseDefinition(uint32 zone, uint32 entry);
+        ConditionList const& GetConditionsForNpcVendorEvent(uint32 creatureId, uint32 itemId);
+
+        // world states and active game events changed, cached CONDITION_COST_WORLD results are stale
+        void InvalidateWorldConditions() { ++_worldGeneration; }
+        long GetWorldGeneration() const { return _worldGeneration.value(); }
 
     private:
         bool isSourceTypeValid(Condition* cond);
@@ -262,6 +291,9 @@ class ConditionMgr
         NpcVendorConditionContainer       NpcVendorConditionContainerStore;
         SmartEventConditionContainer      SmartEventConditionStore;
         PhaseDefinitionConditionContainer PhaseDefinitionsConditionStore;
+
+        ConditionList                     EmptyConditionList;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> _worldGeneration;
 };
 
 template <class T> bool CompareValues(ComparisionType type,  T val1, T val2)
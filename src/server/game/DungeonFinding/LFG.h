@@ -24,7 +24,8 @@ enum LFGEnum
 {
     LFG_TANKS_NEEDED                             = 1,
     LFG_HEALERS_NEEDED                           = 1,
-    LFG_DPS_NEEDED                               = 3
+    LFG_DPS_NEEDED                               = 3,
+    LFG_GROUP_SIZE                               = LFG_TANKS_NEEDED + LFG_HEALERS_NEEDED + LFG_DPS_NEEDED
 };
 
 enum LfgRoles
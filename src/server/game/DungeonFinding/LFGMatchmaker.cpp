@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LFGMatchmaker.h"
+#include "Log.h"
+
+LFGMatchmaker::LFGMatchmaker() : _condition(_lock), _stop(false), _lastSerial(0)
+{
+    ACE_Task_Base::activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, 1);
+}
+
+LFGMatchmaker::~LFGMatchmaker()
+{
+    {
+        ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+        _stop = true;
+        _condition.signal();
+    }
+
+    wait();
+}
+
+uint32 LFGMatchmaker::PostJoin(uint8 queueId, uint64 guid, LfgQueueData const& data)
+{
+    LfgMatchmakingRequest request(LFG_MATCHMAKING_JOIN, queueId, guid);
+    request.data = data;
+    return Post(request);
+}
+
+void LFGMatchmaker::PostRequeue(uint8 queueId, uint64 guid)
+{
+    LfgMatchmakingRequest request(LFG_MATCHMAKING_REQUEUE, queueId, guid);
+    Post(request);
+}
+
+void LFGMatchmaker::PostLeave(uint8 queueId, uint64 guid)
+{
+    LfgMatchmakingRequest request(LFG_MATCHMAKING_LEAVE, queueId, guid);
+    Post(request);
+}
+
+uint32 LFGMatchmaker::Post(LfgMatchmakingRequest& request)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    request.serial = ++_lastSerial;
+    _requests.push_back(request);
+    _condition.signal();
+    return request.serial;
+}
+
+void LFGMatchmaker::GetResults(LfgMatchmakingResultList& results)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    results.splice(results.end(), _results);
+}
+
+LFGQueue& LFGMatchmaker::GetQueue(uint8 queueId)
+{
+    LfgQueueContainer::iterator itr = _queues.find(queueId);
+    if (itr == _queues.end())
+        itr = _queues.insert(LfgQueueContainer::value_type(queueId, LFGQueue(queueId, &_proposals))).first;
+
+    return itr->second;
+}
+
+int LFGMatchmaker::svc()
+{
+    while (true)
+    {
+        std::deque<LfgMatchmakingRequest> requests;
+        {
+            ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+            while (_requests.empty() && !_stop)
+                _condition.wait();
+
+            if (_stop)
+                break;
+
+            requests.swap(_requests);
+        }
+
+        // Replay the changes in order, then look for groups once in every queue they touched
+        std::map<uint8, uint32> touched;                   // queue id, time of its oldest change
+        for (std::deque<LfgMatchmakingRequest>::const_iterator itr = requests.begin(); itr != requests.end(); ++itr)
+        {
+            LFGQueue& queue = GetQueue(itr->queueId);
+            switch (itr->type)
+            {
+                case LFG_MATCHMAKING_JOIN:
+                    queue.AddQueueData(itr->guid, itr->data);
+                    break;
+                case LFG_MATCHMAKING_REQUEUE:
+                    // cached results would match it again with the same people
+                    queue.ResetCompatibles(itr->guid);
+                    queue.AddToQueue(itr->guid);
+                    break;
+                case LFG_MATCHMAKING_LEAVE:
+                    queue.RemoveFromQueue(itr->guid);
+                    break;
+            }
+
+            touched.insert(std::make_pair(itr->queueId, itr->postTime));
+        }
+
+        for (std::map<uint8, uint32>::const_iterator itr = touched.begin(); itr != touched.end(); ++itr)
+        {
+            LfgMatchmakingResult result;
+            result.queueId = itr->first;
+            result.serial = requests.back().serial;
+            result.requestTime = itr->second;
+
+            LFGQueue& queue = GetQueue(itr->first);
+            ACE_Time_Value start = ACE_OS::gettimeofday();
+            if (uint8 newProposals = queue.FindGroups())
+                sLog->outDebug(LOG_FILTER_LFG, "LFGMatchmaker: Found %u new groups in queue %u", newProposals, itr->first);
+            ACE_Time_Value elapsed = ACE_OS::gettimeofday() - start;
+            result.matchTime = uint32(elapsed.sec() * IN_MILLISECONDS * IN_MILLISECONDS + elapsed.usec());
+
+            result.proposals.swap(_proposals);
+            queue.GetChangedNeeds(result.needs);
+
+            ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+            _results.push_back(result);
+        }
+    }
+
+    return 0;
+}
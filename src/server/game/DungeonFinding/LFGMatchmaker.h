@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LFGMATCHMAKER_H
+#define _LFGMATCHMAKER_H
+
+#include "LFGMgr.h"
+#include "Timer.h"
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <deque>
+
+enum LfgMatchmakingRequestType
+{
+    LFG_MATCHMAKING_JOIN,                                  // AddQueueData
+    LFG_MATCHMAKING_REQUEUE,                               // AddToQueue, after a proposal failed
+    LFG_MATCHMAKING_LEAVE                                  // RemoveFromQueue
+};
+
+/// Change of a world queue, replayed in the same order on the matchmaker copy of that queue
+struct LfgMatchmakingRequest
+{
+    LfgMatchmakingRequest(LfgMatchmakingRequestType _type, uint8 _queueId, uint64 _guid):
+        type(_type), queueId(_queueId), guid(_guid), serial(0), postTime(getMSTime()) { }
+
+    LfgMatchmakingRequestType type;
+    uint8 queueId;
+    uint64 guid;
+    LfgQueueData data;                                     ///< Joins only
+    uint32 serial;                                         ///< Position in the sequence of requests
+    uint32 postTime;
+};
+
+/// What a matching run found in a queue, applied by LFGMgr::Update
+struct LfgMatchmakingResult
+{
+    LfgMatchmakingResult(): queueId(0), serial(0), requestTime(0), matchTime(0) { }
+
+    uint8 queueId;
+    uint32 serial;                                         ///< Last request the run saw, entries joined later are not the ones it matched
+    uint32 requestTime;                                    ///< getMSTime() of the oldest change the run saw
+    uint32 matchTime;                                      ///< Microseconds spent in FindGroups
+    LfgProposalList proposals;                             ///< Not validated against the world state yet
+    LfgQueueNeedsList needs;
+};
+
+typedef std::list<LfgMatchmakingResult> LfgMatchmakingResultList;
+
+/**
+    Background thread finding dungeon finder groups. It keeps a detached copy of every queue, fed
+    with the changes of the real ones, so the world thread never waits for the compatibility checks.
+*/
+class LFGMatchmaker : protected ACE_Task_Base
+{
+    public:
+        LFGMatchmaker();
+        ~LFGMatchmaker();
+
+        /// Returns the serial of the request
+        uint32 PostJoin(uint8 queueId, uint64 guid, LfgQueueData const& data);
+        void PostRequeue(uint8 queueId, uint64 guid);
+        void PostLeave(uint8 queueId, uint64 guid);
+
+        /// Moves the results of the runs finished since last call to results
+        void GetResults(LfgMatchmakingResultList& results);
+
+    private:
+        virtual int svc();
+        uint32 Post(LfgMatchmakingRequest& request);
+        LFGQueue& GetQueue(uint8 queueId);
+
+        std::deque<LfgMatchmakingRequest> _requests;
+        LfgMatchmakingResultList _results;
+        ACE_Thread_Mutex _lock;
+        ACE_Condition_Thread_Mutex _condition;
+        bool _stop;
+        uint32 _lastSerial;
+
+        // matchmaker thread only
+        LfgQueueContainer _queues;
+        LfgProposalList _proposals;                        ///< Output of the detached queues
+};
+
+#endif
@@ -27,13 +27,15 @@
 #include "LFGGroupData.h"
 #include "LFGPlayerData.h"
 #include "LFGQueue.h"
+#include "LFGMatchmaker.h"
 #include "Group.h"
 #include "Player.h"
 #include "GroupMgr.h"
 #include "GameEventMgr.h"
 
 LFGMgr::LFGMgr(): m_queueId(1), m_QueueTimer(0), m_lfgProposalId(1),
-    m_options(sWorld->getIntConfig(CONFIG_LFG_OPTIONSMASK))
+    m_options(sWorld->getIntConfig(CONFIG_LFG_OPTIONSMASK)),
+    m_matchmaker(sWorld->getBoolConfig(CONFIG_LFG_MATCHMAKING_THREAD) ? new LFGMatchmaker() : NULL)
 {
     new LFGPlayerScript();
     new LFGGroupScript();
@@ -43,6 +45,8 @@ LFGMgr::~LFGMgr()
 {
     for (LfgRewardContainer::iterator itr = RewardMapStore.begin(); itr != RewardMapStore.end(); ++itr)
         delete itr->second;
+
+    StopMatchmaker();
 }
 
 void LFGMgr::_LoadFromDB(Field* fields, uint64 guid)
@@ -403,9 +407,10 @@ void LFGMgr::Update(uint32 diff)
 
     uint32 lastProposalId = m_lfgProposalId;
     // Check if a proposal can be formed with the new groups being added
-    for (LfgQueueContainer::iterator it = QueuesStore.begin(); it != QueuesStore.end(); ++it)
-        if (uint8 newProposals = it->second.FindGroups())
-            sLog->outDebug(LOG_FILTER_LFG, "LFGMgr::Update: Found %u new groups in queue %u", newProposals, it->first);
+    if (m_matchmaker)
+        ApplyMatchmakingResults();
+    else
+        FindGroups();
 
     if (lastProposalId != m_lfgProposalId)
     {
@@ -1965,7 +1970,115 @@ LFGQueue& LFGMgr::GetQueue(uint64 guid)
     }
     else
         queueId = GetTeam(guid);
-    return QueuesStore[queueId];
+    return GetQueueById(queueId);
+}
+
+LFGQueue& LFGMgr::GetQueueById(uint8 queueId)
+{
+    LfgQueueContainer::iterator itr = QueuesStore.find(queueId);
+    if (itr == QueuesStore.end())
+        itr = QueuesStore.insert(LfgQueueContainer::value_type(queueId, LFGQueue(queueId))).first;
+
+    return itr->second;
+}
+
+/**
+   Looks for groups in every queue with new entries, on the world thread
+*/
+void LFGMgr::FindGroups()
+{
+    for (LfgQueueContainer::iterator it = QueuesStore.begin(); it != QueuesStore.end(); ++it)
+    {
+        LFGQueue& queue = it->second;
+        if (!queue.HasNewEntries())
+            continue;
+
+        ACE_Time_Value start = ACE_OS::gettimeofday();
+        uint8 newProposals = queue.FindGroups();
+        ACE_Time_Value elapsed = ACE_OS::gettimeofday() - start;
+
+        LfgMatchmakingStats& stats = queue.GetMatchmakingStats();
+        stats.AddRun(0, uint32(elapsed.sec() * IN_MILLISECONDS * IN_MILLISECONDS + elapsed.usec()));
+        stats.proposals += newProposals;
+
+        if (newProposals)
+            sLog->outDebug(LOG_FILTER_LFG, "LFGMgr::FindGroups: Found %u new groups in queue %u", newProposals, it->first);
+    }
+}
+
+/**
+   Creates the proposals found by the matchmaker since last update, if still possible
+*/
+void LFGMgr::ApplyMatchmakingResults()
+{
+    LfgMatchmakingResultList results;
+    m_matchmaker->GetResults(results);
+
+    uint32 now = getMSTime();
+    for (LfgMatchmakingResultList::iterator itResult = results.begin(); itResult != results.end(); ++itResult)
+    {
+        LFGQueue& queue = GetQueueById(itResult->queueId);
+        LfgMatchmakingStats& stats = queue.GetMatchmakingStats();
+        stats.AddRun(getMSTimeDiff(itResult->requestTime, now), itResult->matchTime);
+
+        for (LfgQueueNeedsList::const_iterator it = itResult->needs.begin(); it != itResult->needs.end(); ++it)
+            queue.SetQueueNeeds(*it);
+
+        for (LfgProposalList::iterator itProposal = itResult->proposals.begin(); itProposal != itResult->proposals.end(); ++itProposal)
+        {
+            LfgProposal& proposal = *itProposal;
+
+            // Entries that left (and maybe joined again) meanwhile are not the ones matched
+            bool valid = true;
+            for (LfgGuidList::const_iterator it = proposal.queues.begin(); it != proposal.queues.end() && valid; ++it)
+                valid = GetState(*it) == LFG_STATE_QUEUED && queue.GetJoinSerial(*it) <= itResult->serial;
+
+            if (!valid)
+            {
+                sLog->outDebug(LOG_FILTER_LFG, "LFGMgr::ApplyMatchmakingResults: Proposal in queue %u is outdated, requeuing the entries still waiting", itResult->queueId);
+                for (LfgGuidList::const_iterator it = proposal.queues.begin(); it != proposal.queues.end(); ++it)
+                    if (GetState(*it) == LFG_STATE_QUEUED && queue.GetJoinSerial(*it) <= itResult->serial)
+                        m_matchmaker->PostRequeue(itResult->queueId, *it);
+
+                ++stats.rejected;
+                continue;
+            }
+
+            // What the matchmaker can't look up
+            proposal.isNew = !proposal.group || !GetDungeon(proposal.queues.front());
+            if (!proposal.isNew)
+                for (LfgProposalPlayerContainer::iterator it = proposal.players.begin(); it != proposal.players.end(); ++it)
+                    if (it->second.group && it->second.group == proposal.group) // Player from existing group, autoaccept
+                        it->second.accept = LFG_ANSWER_AGREE;
+
+            proposal.cancelTime = time(NULL) + LFG_TIME_PROPOSAL;
+            queue.RemoveMatched(proposal.queues);
+            AddProposal(proposal);
+            ++stats.proposals;
+        }
+    }
+}
+
+void LFGMgr::StopMatchmaker()
+{
+    delete m_matchmaker;
+    m_matchmaker = NULL;
+}
+
+std::string LFGMgr::DumpMatchmakingInfo()
+{
+    std::ostringstream o;
+    o << "Dungeon finder matching " << (m_matchmaker ? "in its own thread" : "on the world thread") << "\n";
+    for (LfgQueueContainer::iterator itr = QueuesStore.begin(); itr != QueuesStore.end(); ++itr)
+    {
+        LfgMatchmakingStats const& stats = itr->second.GetMatchmakingStats();
+        o << "Queue " << uint32(itr->first) << ": " << itr->second.GetQueueDepth() << " queued, "
+          << stats.runs << " runs, " << stats.proposals << " proposals (" << stats.rejected << " outdated), latency "
+          << stats.lastLatency << "/" << (stats.runs ? stats.totalLatency / stats.runs : 0) << "/" << stats.maxLatency << " ms (last/avg/max), matching "
+          << stats.lastMatchTime << "/" << stats.maxMatchTime << " us (last/max)\n";
+    }
+
+    return o.str();
 }
 
 bool LFGMgr::AllQueued(LfgGuidList const& check)
@@ -1983,6 +2096,13 @@ bool LFGMgr::AllQueued(LfgGuidList const& check)
 void LFGMgr::Clean()
 {
     QueuesStore.clear();
+
+    // its copies of the queues must be emptied too
+    if (m_matchmaker)
+    {
+        delete m_matchmaker;
+        m_matchmaker = new LFGMatchmaker();
+    }
 }
 
 bool LFGMgr::isOptionEnabled(uint32 option)
@@ -129,6 +129,7 @@ struct LfgRoleCheck;
 struct LfgProposal;
 struct LfgProposalPlayer;
 struct LfgPlayerBoot;
+class LFGMatchmaker;
 
 typedef std::map<uint8, LFGQueue> LfgQueueContainer;
 typedef std::multimap<uint32, LfgReward const*> LfgRewardContainer;
@@ -363,6 +364,11 @@ class LFGMgr
         bool AllQueued(LfgGuidList const& check);
         void Clean();
 
+        // Matchmaking
+        LFGMatchmaker* GetMatchmaker() { return m_matchmaker; }
+        void StopMatchmaker();
+        std::string DumpMatchmakingInfo();
+
         static bool HasIgnore(uint64 guid1, uint64 guid2);
         static void SendLfgQueueStatus(uint64 guid, LfgQueueStatusData const& data);
 
@@ -421,8 +427,13 @@ class LFGMgr
         void RemoveProposal(LfgProposalContainer::iterator itProposal, LfgUpdateType type);
         void MakeNewGroup(LfgProposal const& proposal);
 
+        // Matchmaking
+        void FindGroups();
+        void ApplyMatchmakingResults();
+
         // Generic
         LFGQueue &GetQueue(uint64 guid);
+        LFGQueue &GetQueueById(uint8 queueId);
         LfgDungeonSet const& GetDungeonsByRandom(uint32 randomdungeon);
         LfgType GetDungeonType(uint32 dungeon);
 
@@ -440,6 +451,7 @@ class LFGMgr
         uint32 m_options;                                  ///< Stores config options
 
         uint32 m_queueId;                                  ///< Queue Id
+        LFGMatchmaker* m_matchmaker;                       ///< Finds groups off the world thread, NULL if disabled
 
         LfgQueueContainer QueuesStore;                     ///< Queues
         LfgCachedDungeonContainer CachedDungeonMapStore;   ///< Stores all dungeons by groupType
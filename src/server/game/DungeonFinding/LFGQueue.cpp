@@ -23,31 +23,73 @@
 #include "Group.h"
 #include "LFGQueue.h"
 #include "LFGMgr.h"
+#include "LFGMatchmaker.h"
 #include "Log.h"
 #include "ObjectMgr.h"
+#include "ObjectAccessor.h"
+#include "Player.h"
+#include "SocialMgr.h"
 #include "World.h"
 #include "GroupMgr.h"
 
 /**
-   Given a list of guids returns the concatenation using | as delimiter
+   Given a list of guids builds the key of their compatibility
 
-   @param[in]     check list of guids
-   @returns Concatenated string
+   @param[in]     check list of guids, at most LFG_GROUP_SIZE
 */
-std::string ConcatenateGuids(LfgGuidList const& check)
+LfgCompatibilityKey::LfgCompatibilityKey(LfgGuidList const& check): size(0)
 {
-    if (check.empty())
-        return "";
+    memset(guids, 0, sizeof(guids));
 
     // need the guids in order to avoid duplicates
-    LfgGuidSet guids(check.begin(), check.end());
+    for (LfgGuidList::const_iterator it = check.begin(); it != check.end() && size < LFG_GROUP_SIZE; ++it)
+    {
+        uint64 guid = *it;
+        uint8 pos = 0;
+        while (pos < size && guids[pos] < guid)
+            ++pos;
 
-    std::ostringstream o;
+        if (pos < size && guids[pos] == guid)
+            continue;
+
+        for (uint8 i = size; i > pos; --i)
+            guids[i] = guids[i - 1];
+
+        guids[pos] = guid;
+        ++size;
+    }
+}
+
+bool LfgCompatibilityKey::Contains(uint64 guid) const
+{
+    for (uint8 i = 0; i < size; ++i)
+        if (guids[i] == guid)
+            return true;
+
+    return false;
+}
+
+size_t LfgCompatibilityKey::GetHash() const
+{
+    uint64 hash = UI64LIT(14695981039346656037);
+    for (uint8 i = 0; i < size; ++i)
+        hash = (hash ^ guids[i]) * UI64LIT(1099511628211);
+
+    return size_t(hash ^ (hash >> 32));
+}
 
-    LfgGuidSet::const_iterator it = guids.begin();
-    o << (*it);
-    for (++it; it != guids.end(); ++it)
-        o << '|' << (*it);
+/**
+   Concatenation of the guids using | as delimiter, for logs
+*/
+std::string LfgCompatibilityKey::ToString() const
+{
+    std::ostringstream o;
+    for (uint8 i = 0; i < size; ++i)
+    {
+        if (i)
+            o << '|';
+        o << guids[i];
+    }
 
     return o.str();
 }
@@ -91,33 +133,46 @@ void LFGQueue::AddToQueue(uint64 guid)
     }
 
     AddToNewQueue(guid);
+
+    if (LFGMatchmaker* matchmaker = GetMatchmaker())
+        matchmaker->PostRequeue(queueId, guid);
 }
 
 void LFGQueue::RemoveFromQueue(uint64 guid)
 {
+    if (LFGMatchmaker* matchmaker = GetMatchmaker())
+        matchmaker->PostLeave(queueId, guid);
+
     RemoveFromNewQueue(guid);
     RemoveFromCurrentQueue(guid);
-    RemoveFromCompatibles(guid);
+    ResetCompatibles(guid);
 
-    std::ostringstream o;
-    o << guid;
-    std::string sguid = o.str();
+    LfgQueueDataContainer::iterator itDelete = QueueDataStore.find(guid);
+    if (itDelete != QueueDataStore.end())
+        QueueDataStore.erase(itDelete);
+}
+
+/**
+   Forgets every cached compatibility of a guid, it will be checked again from scratch
+
+   @param[in]     guid Queued guid
+*/
+void LFGQueue::ResetCompatibles(uint64 guid)
+{
+    // only the groups checked together with this one can have it in their best compatible
+    LfgGuidSet partners;
+    RemoveFromCompatibles(guid, partners);
+    partners.insert(guid);
 
-    LfgQueueDataContainer::iterator itDelete = QueueDataStore.end();
-    for (LfgQueueDataContainer::iterator itr = QueueDataStore.begin(); itr != QueueDataStore.end(); ++itr)
-        if (itr->first != guid)
+    for (LfgGuidSet::const_iterator it = partners.begin(); it != partners.end(); ++it)
+    {
+        LfgQueueDataContainer::iterator itr = QueueDataStore.find(*it);
+        if (itr != QueueDataStore.end() && itr->second.bestCompatible.Contains(guid))
         {
-            if (std::string::npos != itr->second.bestCompatible.find(sguid))
-            {
-                itr->second.bestCompatible.clear();
-                FindBestCompatibleInQueue(itr);
-            }
+            itr->second.bestCompatible = LfgCompatibilityKey();
+            FindBestCompatibleInQueue(itr);
         }
-        else
-            itDelete = itr;
-
-    if (itDelete != QueueDataStore.end())
-        QueueDataStore.erase(itDelete);
+    }
 }
 
 void LFGQueue::AddToNewQueue(uint64 guid)
@@ -142,8 +197,43 @@ void LFGQueue::RemoveFromCurrentQueue(uint64 guid)
 
 void LFGQueue::AddQueueData(uint64 guid, time_t joinTime, LfgDungeonSet const& dungeons, LfgRolesMap const& rolesMap)
 {
-    QueueDataStore[guid] = LfgQueueData(joinTime, dungeons, rolesMap);
-    AddToQueue(guid);
+    LfgQueueData data(joinTime, dungeons, rolesMap);
+
+    // The matchmaker can't look players or groups up, give it what it needs now
+    if (GetMatchmaker())
+    {
+        data.lfgGroup = sLFGMgr->IsLfgGroup(guid);
+        for (LfgRolesMap::const_iterator it = rolesMap.begin(); it != rolesMap.end(); ++it)
+        {
+            Player* player = ObjectAccessor::FindPlayer(it->first);
+            if (!player)
+                continue;
+
+            std::set<uint32> ignored;
+            player->GetSocial()->GetIgnoredGuids(ignored);
+            for (std::set<uint32>::const_iterator itIgnored = ignored.begin(); itIgnored != ignored.end(); ++itIgnored)
+                data.ignores.insert(MAKE_NEW_GUID(*itIgnored, 0, HIGHGUID_PLAYER));
+        }
+    }
+
+    AddQueueData(guid, data);
+}
+
+void LFGQueue::AddQueueData(uint64 guid, LfgQueueData const& data)
+{
+    LfgQueueData& queueData = QueueDataStore[guid];
+    queueData = data;
+    queueData.roleCombinations = GetRoleCombinations(data.roles);
+    AddToNewQueue(guid);
+
+    if (LFGMatchmaker* matchmaker = GetMatchmaker())
+        queueData.joinSerial = matchmaker->PostJoin(queueId, guid, queueData);
+}
+
+uint32 LFGQueue::GetJoinSerial(uint64 guid) const
+{
+    LfgQueueDataContainer::const_iterator itQueue = QueueDataStore.find(guid);
+    return itQueue != QueueDataStore.end() ? itQueue->second.joinSerial : 0;
 }
 
 void LFGQueue::RemoveQueueData(uint64 guid)
@@ -153,6 +243,47 @@ void LFGQueue::RemoveQueueData(uint64 guid)
         QueueDataStore.erase(it);
 }
 
+/**
+   Takes out of the queue lists the entries of a proposal found by the matchmaker, as CheckCompatibility does
+
+   @param[in]     guids Queued guids of the proposal
+*/
+void LFGQueue::RemoveMatched(LfgGuidList const& guids)
+{
+    for (LfgGuidList::const_iterator it = guids.begin(); it != guids.end(); ++it)
+    {
+        RemoveFromNewQueue(*it);
+        RemoveFromCurrentQueue(*it);
+    }
+}
+
+void LFGQueue::SetQueueNeeds(LfgQueueNeeds const& needs)
+{
+    LfgQueueDataContainer::iterator itQueue = QueueDataStore.find(needs.guid);
+    if (itQueue == QueueDataStore.end())
+        return;
+
+    itQueue->second.tanks = needs.tanks;
+    itQueue->second.healers = needs.healers;
+    itQueue->second.dps = needs.dps;
+}
+
+/**
+   Needed roles of the entries of a detached queue whose best compatible group changed
+
+   @param[out]    needs Changed entries, still queued
+*/
+void LFGQueue::GetChangedNeeds(LfgQueueNeedsList& needs)
+{
+    for (LfgGuidSet::const_iterator it = changedNeeds.begin(); it != changedNeeds.end(); ++it)
+    {
+        LfgQueueDataContainer::const_iterator itQueue = QueueDataStore.find(*it);
+        if (itQueue != QueueDataStore.end())
+            needs.push_back(LfgQueueNeeds(*it, itQueue->second.tanks, itQueue->second.healers, itQueue->second.dps));
+    }
+    changedNeeds.clear();
+}
+
 void LFGQueue::UpdateWaitTimeAvg(int32 waitTime, uint32 dungeonId)
 {
     LfgWaitTime &wt = waitTimesAvgStore[dungeonId];
@@ -185,47 +316,88 @@ void LFGQueue::UpdateWaitTimeDps(int32 waitTime, uint32 dungeonId)
    Remove from cached compatible dungeons any entry that contains the given guid
 
    @param[in]     guid Guid to remove from compatible cache
+   @param[out]    partners Guids that were part of the removed entries
 */
-void LFGQueue::RemoveFromCompatibles(uint64 guid)
+void LFGQueue::RemoveFromCompatibles(uint64 guid, LfgGuidSet& partners)
 {
-    std::stringstream out;
-    out << guid;
-    std::string strGuid = out.str();
-
     sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::RemoveFromCompatibles: Removing [" UI64FMTD "]", guid);
-    for (LfgCompatibleContainer::iterator itNext = CompatibleMapStore.begin(); itNext != CompatibleMapStore.end();)
+    LfgCompatibleIndexContainer::iterator itIndex = CompatibleIndexStore.find(guid);
+    if (itIndex == CompatibleIndexStore.end())
+        return;
+
+    LfgCompatibilityKeyList const& keys = itIndex->second;
+    for (LfgCompatibilityKeyList::const_iterator it = keys.begin(); it != keys.end(); ++it)
     {
-        LfgCompatibleContainer::iterator it = itNext++;
-        if (std::string::npos != it->first.find(strGuid))
-            CompatibleMapStore.erase(it);
+        CompatibleMapStore.erase(*it);
+        for (uint8 i = 0; i < it->size; ++i)
+            if (it->guids[i] != guid)
+                partners.insert(it->guids[i]);
     }
+    CompatibleIndexStore.erase(itIndex);
+
+    // the partners no longer take part in the removed entries either
+    for (LfgGuidSet::const_iterator it = partners.begin(); it != partners.end(); ++it)
+    {
+        itIndex = CompatibleIndexStore.find(*it);
+        if (itIndex == CompatibleIndexStore.end())
+            continue;
+
+        LfgCompatibilityKeyList& partnerKeys = itIndex->second;
+        for (size_t i = 0; i < partnerKeys.size();)
+        {
+            if (partnerKeys[i].Contains(guid))
+            {
+                partnerKeys[i] = partnerKeys.back();
+                partnerKeys.pop_back();
+            }
+            else
+                ++i;
+        }
+
+        if (partnerKeys.empty())
+            CompatibleIndexStore.erase(itIndex);
+    }
+}
+
+/**
+   Returns the cached compatibility of a list of guids, adding an empty one if not cached yet
+
+   @param[in]     key Sorted guids
+*/
+LfgCompatibilityData& LFGQueue::AddCompatibilityData(LfgCompatibilityKey const& key)
+{
+    std::pair<LfgCompatibleContainer::iterator, bool> result = CompatibleMapStore.insert(LfgCompatibleContainer::value_type(key, LfgCompatibilityData()));
+    if (result.second)
+        for (uint8 i = 0; i < key.size; ++i)
+            CompatibleIndexStore[key.guids[i]].push_back(key);
+
+    return result.first->second;
 }
 
 /**
    Stores the compatibility of a list of guids
 
-   @param[in]     key String concatenation of guids (| used as separator)
+   @param[in]     key Sorted guids
    @param[in]     compatibles type of compatibility
 */
-void LFGQueue::SetCompatibles(std::string const& key, LfgCompatibility compatibles)
+void LFGQueue::SetCompatibles(LfgCompatibilityKey const& key, LfgCompatibility compatibles)
 {
-    LfgCompatibilityData& data = CompatibleMapStore[key];
-    data.compatibility = compatibles;
+    AddCompatibilityData(key).compatibility = compatibles;
 }
 
-void LFGQueue::SetCompatibilityData(std::string const& key, LfgCompatibilityData const& data)
+void LFGQueue::SetCompatibilityData(LfgCompatibilityKey const& key, LfgCompatibilityData const& data)
 {
-    CompatibleMapStore[key] = data;
+    AddCompatibilityData(key) = data;
 }
 
 
 /**
    Get the compatibility of a group of guids
 
-   @param[in]     key String concatenation of guids (| used as separator)
+   @param[in]     key Sorted guids
    @return LfgCompatibility type of compatibility
 */
-LfgCompatibility LFGQueue::GetCompatibles(std::string const& key)
+LfgCompatibility LFGQueue::GetCompatibles(LfgCompatibilityKey const& key)
 {
     LfgCompatibleContainer::iterator itr = CompatibleMapStore.find(key);
     if (itr != CompatibleMapStore.end())
@@ -234,7 +406,7 @@ LfgCompatibility LFGQueue::GetCompatibles(std::string const& key)
     return LFG_COMPATIBILITY_PENDING;
 }
 
-LfgCompatibilityData* LFGQueue::GetCompatibilityData(std::string const& key)
+LfgCompatibilityData* LFGQueue::GetCompatibilityData(LfgCompatibilityKey const& key)
 {
     LfgCompatibleContainer::iterator itr = CompatibleMapStore.find(key);
     if (itr != CompatibleMapStore.end())
@@ -256,7 +428,7 @@ uint8 LFGQueue::FindGroups()
         RemoveFromNewQueue(frontguid);
 
         LfgGuidList temporalList = currentQueueStore;
-        LfgCompatibility compatibles = FindNewGroups(firstNew, temporalList);
+        LfgCompatibility compatibles = FindNewGroups(firstNew, temporalList, GetRoleCombinations(frontguid));
 
         if (compatibles == LFG_COMPATIBLES_MATCH)
             ++proposals;
@@ -266,26 +438,129 @@ uint8 LFGQueue::FindGroups()
     return proposals;
 }
 
+/**
+   Returns the role combinations of a queued player or group
+
+   @param[in]     guid Queued guid
+   @return Role combinations, all of them if the guid is not queued (checked later)
+*/
+uint16 LFGQueue::GetRoleCombinations(uint64 guid) const
+{
+    LfgQueueDataContainer::const_iterator itQueue = QueueDataStore.find(guid);
+    if (itQueue == QueueDataStore.end())
+        return 0xFFFF;
+
+    return itQueue->second.roleCombinations;
+}
+
+LFGMatchmaker* LFGQueue::GetMatchmaker() const
+{
+    return detachedOutput ? NULL : sLFGMgr->GetMatchmaker();
+}
+
+bool LFGQueue::IsLfgGroup(uint64 guid)
+{
+    if (!detachedOutput)
+        return sLFGMgr->IsLfgGroup(guid);
+
+    LfgQueueDataContainer::const_iterator itQueue = QueueDataStore.find(guid);
+    return itQueue != QueueDataStore.end() && itQueue->second.lfgGroup;
+}
+
+/**
+   Checks if any of two players ignores the other one
+
+   @param[in]     guid1 First player
+   @param[in]     guid2 Second player
+   @param[in]     groups Group each player of the checked entries joined with, 0 if alone
+*/
+bool LFGQueue::HasIgnore(uint64 guid1, uint64 guid2, LfgGroupsMap const& groups)
+{
+    if (!detachedOutput)
+        return LFGMgr::HasIgnore(guid1, guid2);
+
+    // Ignores are stored per queued entry, the group for players that joined with one
+    LfgGroupsMap::const_iterator itGroup1 = groups.find(guid1);
+    LfgGroupsMap::const_iterator itGroup2 = groups.find(guid2);
+    LfgQueueDataContainer::const_iterator itQueue1 = QueueDataStore.find(itGroup1 != groups.end() && itGroup1->second ? itGroup1->second : guid1);
+    LfgQueueDataContainer::const_iterator itQueue2 = QueueDataStore.find(itGroup2 != groups.end() && itGroup2->second ? itGroup2->second : guid2);
+    return (itQueue1 != QueueDataStore.end() && itQueue1->second.ignores.count(guid2)) ||
+        (itQueue2 != QueueDataStore.end() && itQueue2->second.ignores.count(guid1));
+}
+
+uint16 LFGQueue::GetRoleCombinations(LfgRolesMap const& roles)
+{
+    // bit layout assumes LFG_TANKS_NEEDED = 1, LFG_HEALERS_NEEDED = 1, LFG_DPS_NEEDED = 3
+    uint16 combinations = 1;                               // nobody assigned yet
+    for (LfgRolesMap::const_iterator it = roles.begin(); it != roles.end() && combinations; ++it)
+    {
+        uint16 next = 0;
+        for (uint8 bit = 0; bit < 16; ++bit)
+        {
+            if (!(combinations & (1 << bit)))
+                continue;
+
+            if ((it->second & PLAYER_ROLE_TANK) && (bit >> 3) < LFG_TANKS_NEEDED)
+                next |= 1 << (bit + 8);
+            if ((it->second & PLAYER_ROLE_HEALER) && ((bit >> 2) & 1) < LFG_HEALERS_NEEDED)
+                next |= 1 << (bit + 4);
+            if ((it->second & PLAYER_ROLE_DAMAGE) && (bit & 3) < LFG_DPS_NEEDED)
+                next |= 1 << (bit + 1);
+        }
+        combinations = next;
+    }
+
+    return combinations;
+}
+
+uint16 LFGQueue::CombineRoleCombinations(uint16 left, uint16 right)
+{
+    uint16 combinations = 0;
+    for (uint8 i = 0; i < 16; ++i)
+    {
+        if (!(left & (1 << i)))
+            continue;
+
+        for (uint8 j = 0; j < 16; ++j)
+        {
+            if (!(right & (1 << j)))
+                continue;
+
+            uint8 tanks = (i >> 3) + (j >> 3);
+            uint8 healers = ((i >> 2) & 1) + ((j >> 2) & 1);
+            uint8 dps = (i & 3) + (j & 3);
+            if (tanks <= LFG_TANKS_NEEDED && healers <= LFG_HEALERS_NEEDED && dps <= LFG_DPS_NEEDED)
+                combinations |= 1 << (tanks * 8 + healers * 4 + dps);
+        }
+    }
+
+    return combinations;
+}
+
 /**
    Checks que main queue to try to form a Lfg group. Returns first match found (if any)
 
    @param[in]     check List of guids trying to match with other groups
    @param[in]     all List of all other guids in main queue to match against
+   @param[in]     roleCombinations Role combinations of the guids in check
    @return LfgCompatibility type of compatibility between groups
 */
-LfgCompatibility LFGQueue::FindNewGroups(LfgGuidList& check, LfgGuidList& all)
+LfgCompatibility LFGQueue::FindNewGroups(LfgGuidList& check, LfgGuidList& all, uint16 roleCombinations)
 {
-    std::string strGuids = ConcatenateGuids(check);
-    LfgCompatibility compatibles = GetCompatibles(strGuids);
+    if (check.size() > LFG_GROUP_SIZE)
+        return LFG_INCOMPATIBLES_WRONG_GROUP_SIZE;
 
-    sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::FindNewGroup: (%s): %s - all(%s)", strGuids.c_str(), GetCompatibleString(compatibles), ConcatenateGuids(all).c_str());
+    LfgCompatibilityKey key(check);
+    LfgCompatibility compatibles = GetCompatibles(key);
+
+    TC_LOG_DEBUG(LOG_FILTER_LFG, "LFGQueue::FindNewGroup: (%s): %s - all(%u)", key.ToString().c_str(), GetCompatibleString(compatibles), uint32(all.size()));
     if (compatibles == LFG_COMPATIBILITY_PENDING) // Not previously cached, calculate
         compatibles = CheckCompatibility(check);
 
     if (compatibles == LFG_COMPATIBLES_BAD_STATES && sLFGMgr->AllQueued(check))
     {
-        sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::FindNewGroup: (%s) compatibles (cached) changed from bad states to match", strGuids.c_str());
-        SetCompatibles(strGuids, LFG_COMPATIBLES_MATCH);
+        TC_LOG_DEBUG(LOG_FILTER_LFG, "LFGQueue::FindNewGroup: (%s) compatibles (cached) changed from bad states to match", key.ToString().c_str());
+        SetCompatibles(key, LFG_COMPATIBLES_MATCH);
         return LFG_COMPATIBLES_MATCH;
     }
 
@@ -295,9 +570,16 @@ LfgCompatibility LFGQueue::FindNewGroups(LfgGuidList& check, LfgGuidList& all)
     // Try to match with queued groups
     while (!all.empty())
     {
-        check.push_back(all.front());
+        uint64 guid = all.front();
         all.pop_front();
-        LfgCompatibility subcompatibility = FindNewGroups(check, all);
+
+        // roles that can't be filled together can't be filled by adding more players either
+        uint16 combinations = CombineRoleCombinations(roleCombinations, GetRoleCombinations(guid));
+        if (!combinations)
+            continue;
+
+        check.push_back(guid);
+        LfgCompatibility subcompatibility = FindNewGroups(check, all, combinations);
         if (subcompatibility == LFG_COMPATIBLES_MATCH)
             return LFG_COMPATIBLES_MATCH;
         check.pop_back();
@@ -313,7 +595,6 @@ LfgCompatibility LFGQueue::FindNewGroups(LfgGuidList& check, LfgGuidList& all)
 */
 LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
 {
-    std::string strGuids = ConcatenateGuids(check);
     LfgProposal proposal;
     LfgDungeonSet proposalDungeons;
     LfgGroupsMap proposalGroups;
@@ -322,10 +603,12 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
     // Check for correct size
     if (check.size() > MAXGROUPSIZE || check.empty())
     {
-        sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s): Size wrong - Not compatibles", strGuids.c_str());
+        sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%u guids): Size wrong - Not compatibles", uint32(check.size()));
         return LFG_INCOMPATIBLES_WRONG_GROUP_SIZE;
     }
 
+    LfgCompatibilityKey key(check);
+
     // Check all-but-new compatiblitity
     if (check.size() > 2)
     {
@@ -336,8 +619,8 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
         LfgCompatibility child_compatibles = CheckCompatibility(check);
         if (child_compatibles < LFG_COMPATIBLES_WITH_LESS_PLAYERS) // Group not compatible
         {
-            sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) child %s not compatibles", strGuids.c_str(), ConcatenateGuids(check).c_str());
-            SetCompatibles(strGuids, child_compatibles);
+            TC_LOG_DEBUG(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) child %s not compatibles", key.ToString().c_str(), LfgCompatibilityKey(check).ToString().c_str());
+            SetCompatibles(key, child_compatibles);
             return child_compatibles;
         }
         check.push_front(frontGuid);
@@ -363,7 +646,7 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
 
         numPlayers += itQueue->second.roles.size();
 
-        if (sLFGMgr->IsLfgGroup(guid))
+        if (IsLfgGroup(guid))
         {
             if (!numLfgGroups)
                 proposal.group = guid;
@@ -374,29 +657,29 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
     // Group with less that MAXGROUPSIZE members always compatible
     if (check.size() == 1 && numPlayers != MAXGROUPSIZE)
     {
-        sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) sigle group. Compatibles", strGuids.c_str());
+        TC_LOG_DEBUG(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) sigle group. Compatibles", key.ToString().c_str());
         LfgQueueDataContainer::iterator itQueue = QueueDataStore.find(check.front());
 
         LfgCompatibilityData data(LFG_COMPATIBLES_WITH_LESS_PLAYERS);
         data.roles = itQueue->second.roles;
         LFGMgr::CheckGroupRoles(data.roles);
 
-        UpdateBestCompatibleInQueue(itQueue, strGuids, data.roles);
-        SetCompatibilityData(strGuids, data);
+        UpdateBestCompatibleInQueue(itQueue, key, data.roles);
+        SetCompatibilityData(key, data);
         return LFG_COMPATIBLES_WITH_LESS_PLAYERS;
     }
 
     if (numLfgGroups > 1)
     {
-        sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) More than one Lfggroup (%u)", strGuids.c_str(), numLfgGroups);
-        SetCompatibles(strGuids, LFG_INCOMPATIBLES_MULTIPLE_LFG_GROUPS);
+        TC_LOG_DEBUG(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) More than one Lfggroup (%u)", key.ToString().c_str(), numLfgGroups);
+        SetCompatibles(key, LFG_INCOMPATIBLES_MULTIPLE_LFG_GROUPS);
         return LFG_INCOMPATIBLES_MULTIPLE_LFG_GROUPS;
     }
 
     if (numPlayers > MAXGROUPSIZE)
     {
-        sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) Too much players (%u)", strGuids.c_str(), numPlayers);
-        SetCompatibles(strGuids, LFG_INCOMPATIBLES_TOO_MUCH_PLAYERS);
+        TC_LOG_DEBUG(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) Too much players (%u)", key.ToString().c_str(), numPlayers);
+        SetCompatibles(key, LFG_INCOMPATIBLES_TOO_MUCH_PLAYERS);
         return LFG_INCOMPATIBLES_TOO_MUCH_PLAYERS;
     }
 
@@ -413,7 +696,7 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
                 {
                     if (itRoles->first == itPlayer->first)
                         sLog->outError(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: ERROR! Player multiple times in queue! [" UI64FMTD "]", itRoles->first);
-                    else if (sLFGMgr->HasIgnore(itRoles->first, itPlayer->first))
+                    else if (HasIgnore(itRoles->first, itPlayer->first, proposalGroups))
                         break;
                 }
                 if (itPlayer == proposalRoles.end())
@@ -423,40 +706,50 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
 
         if (uint8 playersize = numPlayers - proposalRoles.size())
         {
-            sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) not compatible, %u players are ignoring each other", strGuids.c_str(), playersize);
-            SetCompatibles(strGuids, LFG_INCOMPATIBLES_HAS_IGNORES);
+            TC_LOG_DEBUG(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) not compatible, %u players are ignoring each other", key.ToString().c_str(), playersize);
+            SetCompatibles(key, LFG_INCOMPATIBLES_HAS_IGNORES);
             return LFG_INCOMPATIBLES_HAS_IGNORES;
         }
 
-        LfgRolesMap debugRoles = proposalRoles;
+        // CheckGroupRoles assigns the roles, the requested ones are logged
+        bool logRoles = sLog->ShouldLog(LOG_FILTER_LFG, LOG_LEVEL_DEBUG);
+        LfgRolesMap debugRoles;
+        if (logRoles)
+            debugRoles = proposalRoles;
+
         if (!LFGMgr::CheckGroupRoles(proposalRoles))
         {
-            std::ostringstream o;
-            for (LfgRolesMap::const_iterator it = debugRoles.begin(); it != debugRoles.end(); ++it)
-                o << ", " << it->first << ": " << sLFGMgr->GetRolesString(it->second);
-
-            sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) Roles not compatible%s", strGuids.c_str(), o.str().c_str());
-            SetCompatibles(strGuids, LFG_INCOMPATIBLES_NO_ROLES);
+            if (logRoles)
+            {
+                std::ostringstream o;
+                for (LfgRolesMap::const_iterator it = debugRoles.begin(); it != debugRoles.end(); ++it)
+                    o << ", " << it->first << ": " << sLFGMgr->GetRolesString(it->second);
+                sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) Roles not compatible%s", key.ToString().c_str(), o.str().c_str());
+            }
+            SetCompatibles(key, LFG_INCOMPATIBLES_NO_ROLES);
             return LFG_INCOMPATIBLES_NO_ROLES;
         }
 
         LfgGuidList::iterator itguid = check.begin();
         proposalDungeons = QueueDataStore[*itguid].dungeons;
-        std::ostringstream o;
-        o << ", " << *itguid << ": (" << sLFGMgr->ConcatenateDungeons(proposalDungeons) << ")";
-        for (++itguid; itguid != check.end(); ++itguid)
+        for (++itguid; itguid != check.end() && !proposalDungeons.empty(); ++itguid)
         {
             LfgDungeonSet temporal;
             LfgDungeonSet &dungeons = QueueDataStore[*itguid].dungeons;
-            o << ", " << *itguid << ": (" << sLFGMgr->ConcatenateDungeons(dungeons) << ")";
             std::set_intersection(proposalDungeons.begin(), proposalDungeons.end(), dungeons.begin(), dungeons.end(), std::inserter(temporal, temporal.begin()));
-            proposalDungeons = temporal;
+            proposalDungeons.swap(temporal);
         }
 
         if (proposalDungeons.empty())
         {
-            sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) No compatible dungeons%s", strGuids.c_str(), o.str().c_str());
-            SetCompatibles(strGuids, LFG_INCOMPATIBLES_NO_DUNGEONS);
+            if (sLog->ShouldLog(LOG_FILTER_LFG, LOG_LEVEL_DEBUG))
+            {
+                std::ostringstream o;
+                for (itguid = check.begin(); itguid != check.end(); ++itguid)
+                    o << ", " << *itguid << ": (" << sLFGMgr->ConcatenateDungeons(QueueDataStore[*itguid].dungeons) << ")";
+                sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) No compatible dungeons%s", key.ToString().c_str(), o.str().c_str());
+            }
+            SetCompatibles(key, LFG_INCOMPATIBLES_NO_DUNGEONS);
             return LFG_INCOMPATIBLES_NO_DUNGEONS;
         }
     }
@@ -472,25 +765,26 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
     // Enough players?
     if (numPlayers != MAXGROUPSIZE)
     {
-        sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) Compatibles but not enough players(%u)", strGuids.c_str(), numPlayers);
+        TC_LOG_DEBUG(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) Compatibles but not enough players(%u)", key.ToString().c_str(), numPlayers);
         LfgCompatibilityData data(LFG_COMPATIBLES_WITH_LESS_PLAYERS);
         data.roles = proposalRoles;
 
         for (LfgGuidList::const_iterator itr = check.begin(); itr != check.end(); ++itr)
-            UpdateBestCompatibleInQueue(QueueDataStore.find(*itr), strGuids, data.roles);
+            UpdateBestCompatibleInQueue(QueueDataStore.find(*itr), key, data.roles);
 
-        SetCompatibilityData(strGuids, data);
+        SetCompatibilityData(key, data);
         return LFG_COMPATIBLES_WITH_LESS_PLAYERS;
     }
 
     uint64 gguid = *check.begin();
     proposal.queues = check;
-    proposal.isNew = numLfgGroups != 1 || !sLFGMgr->GetDungeon(gguid);
+    // A detached queue can't look the dungeon up, LFGMgr decides when the proposal is applied
+    proposal.isNew = numLfgGroups != 1 || (!detachedOutput && !sLFGMgr->GetDungeon(gguid));
 
-    if (!sLFGMgr->AllQueued(check))
+    if (!detachedOutput && !sLFGMgr->AllQueued(check))
     {
-        sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) Group MATCH but can't create proposal!", strGuids.c_str());
-        SetCompatibles(strGuids, LFG_COMPATIBLES_BAD_STATES);
+        TC_LOG_DEBUG(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) Group MATCH but can't create proposal!", key.ToString().c_str());
+        SetCompatibles(key, LFG_COMPATIBLES_BAD_STATES);
         return LFG_COMPATIBLES_BAD_STATES;
     }
 
@@ -529,10 +823,13 @@ LfgCompatibility LFGQueue::CheckCompatibility(LfgGuidList check)
         RemoveFromCurrentQueue(guid);
     }
 
-    sLFGMgr->AddProposal(proposal);
+    if (detachedOutput)
+        detachedOutput->push_back(proposal);
+    else
+        sLFGMgr->AddProposal(proposal);
 
-    sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) MATCH! Group formed", strGuids.c_str());
-    SetCompatibles(strGuids, LFG_COMPATIBLES_MATCH);
+    TC_LOG_DEBUG(LOG_FILTER_LFG, "LFGQueue::CheckCompatibility: (%s) MATCH! Group formed", key.ToString().c_str());
+    SetCompatibles(key, LFG_COMPATIBLES_MATCH);
     return LFG_COMPATIBLES_MATCH;
 }
 
@@ -576,7 +873,7 @@ void LFGQueue::UpdateQueueTimers(time_t currTime)
                 break;
         }
 
-        if (queueinfo.bestCompatible.empty())
+        if (!queueinfo.bestCompatible.size)
             FindBestCompatibleInQueue(itQueue);
 
         LfgQueueStatusData queueData(dungeonId, queueinfo.joinTime, waitTime, wtAvg, wtTank, wtHealer, wtDps, queuedTime, queueinfo.tanks, queueinfo.healers, queueinfo.dps);
@@ -624,7 +921,7 @@ std::string LFGQueue::DumpCompatibleInfo(bool full /* = false */) const
     o << "Compatible Map size: " << CompatibleMapStore.size() << "\n";
     if (full)
         for (LfgCompatibleContainer::const_iterator itr = CompatibleMapStore.begin(); itr != CompatibleMapStore.end(); ++itr)
-            o << "(" << itr->first << "): " << GetCompatibleString(itr->second.compatibility) << "\n";
+            o << "(" << itr->first.ToString() << "): " << GetCompatibleString(itr->second.compatibility) << "\n";
 
     return o.str();
 }
@@ -632,34 +929,30 @@ std::string LFGQueue::DumpCompatibleInfo(bool full /* = false */) const
 void LFGQueue::FindBestCompatibleInQueue(LfgQueueDataContainer::iterator itrQueue)
 {
     sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::FindBestCompatibleInQueue: " UI64FMTD, itrQueue->first);
-    std::ostringstream o;
-    o << itrQueue->first;
-    std::string sguid = o.str();
+    LfgCompatibleIndexContainer::const_iterator itIndex = CompatibleIndexStore.find(itrQueue->first);
+    if (itIndex == CompatibleIndexStore.end())
+        return;
 
-    for (LfgCompatibleContainer::const_iterator itr = CompatibleMapStore.begin(); itr != CompatibleMapStore.end(); ++itr)
-        if (itr->second.compatibility == LFG_COMPATIBLES_WITH_LESS_PLAYERS &&
-            std::string::npos != itr->first.find(sguid))
-        {
+    for (LfgCompatibilityKeyList::const_iterator it = itIndex->second.begin(); it != itIndex->second.end(); ++it)
+    {
+        LfgCompatibleContainer::const_iterator itr = CompatibleMapStore.find(*it);
+        if (itr != CompatibleMapStore.end() && itr->second.compatibility == LFG_COMPATIBLES_WITH_LESS_PLAYERS)
             UpdateBestCompatibleInQueue(itrQueue, itr->first, itr->second.roles);
-        }
+    }
 }
 
-void LFGQueue::UpdateBestCompatibleInQueue(LfgQueueDataContainer::iterator itrQueue, std::string const& key, LfgRolesMap const& roles)
+void LFGQueue::UpdateBestCompatibleInQueue(LfgQueueDataContainer::iterator itrQueue, LfgCompatibilityKey const& key, LfgRolesMap const& roles)
 {
     LfgQueueData& queueData = itrQueue->second;
-
-    uint8 storedSize = queueData.bestCompatible.empty() ? 0 :
-        std::count(queueData.bestCompatible.begin(), queueData.bestCompatible.end(), '|') + 1;
-
-    uint8 size = std::count(key.begin(), key.end(), '|') + 1;
-
-    if (size <= storedSize)
+    if (key.size <= queueData.bestCompatible.size)
         return;
 
-    sLog->outDebug(LOG_FILTER_LFG, "LFGQueue::UpdateBestCompatibleInQueue: Changed (%s) to (%s) as best compatible group for " UI64FMTD,
-        queueData.bestCompatible.c_str(), key.c_str(), itrQueue->first);
+    TC_LOG_DEBUG(LOG_FILTER_LFG, "LFGQueue::UpdateBestCompatibleInQueue: Changed (%s) to (%s) as best compatible group for " UI64FMTD,
+        queueData.bestCompatible.ToString().c_str(), key.ToString().c_str(), itrQueue->first);
 
     queueData.bestCompatible = key;
+    if (detachedOutput)
+        changedNeeds.insert(itrQueue->first);
     queueData.tanks = LFG_TANKS_NEEDED;
     queueData.healers = LFG_HEALERS_NEEDED;
     queueData.dps = LFG_DPS_NEEDED;
@@ -20,6 +20,10 @@
 
 #include "LFG.h"
 
+class LFGMatchmaker;
+struct LfgProposal;
+typedef std::list<LfgProposal> LfgProposalList;
+
 enum LfgCompatibility
 {
     LFG_COMPATIBILITY_PENDING,
@@ -34,6 +38,36 @@ enum LfgCompatibility
     LFG_COMPATIBLES_MATCH                                  // Must be the last one
 };
 
+/// Sorted guids of the queue entries checked together, key of the compatibility cache
+struct LfgCompatibilityKey
+{
+    LfgCompatibilityKey(): size(0) { memset(guids, 0, sizeof(guids)); }
+    explicit LfgCompatibilityKey(LfgGuidList const& check);
+
+    bool Contains(uint64 guid) const;
+    size_t GetHash() const;
+    std::string ToString() const;
+
+    bool operator==(LfgCompatibilityKey const& right) const
+    {
+        return size == right.size && !memcmp(guids, right.guids, sizeof(guids));
+    }
+
+    uint64 guids[LFG_GROUP_SIZE];
+    uint8 size;
+};
+
+HASH_NAMESPACE_START
+
+template<>
+class hash<LfgCompatibilityKey>
+{
+    public:
+        size_t operator()(LfgCompatibilityKey const& key) const { return key.GetHash(); }
+};
+
+HASH_NAMESPACE_END
+
 struct LfgCompatibilityData
 {
     LfgCompatibilityData(): compatibility(LFG_COMPATIBILITY_PENDING) { }
@@ -49,12 +83,12 @@ struct LfgCompatibilityData
 struct LfgQueueData
 {
     LfgQueueData(): joinTime(time_t(time(NULL))), tanks(LFG_TANKS_NEEDED),
-        healers(LFG_HEALERS_NEEDED), dps(LFG_DPS_NEEDED)
+        healers(LFG_HEALERS_NEEDED), dps(LFG_DPS_NEEDED), roleCombinations(0), lfgGroup(false), joinSerial(0)
         { }
 
     LfgQueueData(time_t _joinTime, LfgDungeonSet const& _dungeons, LfgRolesMap const& _roles):
         joinTime(_joinTime), tanks(LFG_TANKS_NEEDED), healers(LFG_HEALERS_NEEDED),
-        dps(LFG_DPS_NEEDED), dungeons(_dungeons), roles(_roles)
+        dps(LFG_DPS_NEEDED), dungeons(_dungeons), roles(_roles), roleCombinations(0), lfgGroup(false), joinSerial(0)
         { }
 
     time_t joinTime;                                       ///< Player queue join time (to calculate wait times)
@@ -63,7 +97,51 @@ struct LfgQueueData
     uint8 dps;                                             ///< Dps needed
     LfgDungeonSet dungeons;                                ///< Selected Player/Group Dungeon/s
     LfgRolesMap roles;                                     ///< Selected Player Role/s
-    std::string bestCompatible;                            ///< Best compatible combination of people queued
+    uint16 roleCombinations;                               ///< Role counts the players can fill, see LFGQueue::GetRoleCombinations
+    LfgCompatibilityKey bestCompatible;                    ///< Best compatible combination of people queued
+    bool lfgGroup;                                         ///< Existing dungeon group looking for replacements (detached queues only)
+    LfgGuidSet ignores;                                    ///< Players ignored by any member when joining (detached queues only)
+    uint32 joinSerial;                                     ///< Matchmaker request that added it, see LFGMatchmaker::PostJoin
+};
+
+/// Roles still needed by a queued player or group, as shown in its queue status
+struct LfgQueueNeeds
+{
+    LfgQueueNeeds(uint64 _guid, uint8 _tanks, uint8 _healers, uint8 _dps):
+        guid(_guid), tanks(_tanks), healers(_healers), dps(_dps) { }
+
+    uint64 guid;
+    uint8 tanks;
+    uint8 healers;
+    uint8 dps;
+};
+
+typedef std::vector<LfgQueueNeeds> LfgQueueNeedsList;
+
+/// Cost and delay of the matching of a queue, shown by .debug matchmaking
+struct LfgMatchmakingStats
+{
+    LfgMatchmakingStats(): runs(0), proposals(0), rejected(0), lastLatency(0), maxLatency(0),
+        totalLatency(0), lastMatchTime(0), maxMatchTime(0) { }
+
+    void AddRun(uint32 latency, uint32 matchTime)
+    {
+        ++runs;
+        lastLatency = latency;
+        maxLatency = std::max(maxLatency, latency);
+        totalLatency += latency;
+        lastMatchTime = matchTime;
+        maxMatchTime = std::max(maxMatchTime, matchTime);
+    }
+
+    uint32 runs;                                           ///< Matching runs applied
+    uint32 proposals;                                      ///< Proposals created
+    uint32 rejected;                                       ///< Matchmaker proposals dropped, an entry changed state meanwhile
+    uint32 lastLatency;                                    ///< Milliseconds from the oldest queue change a run saw to its results applied
+    uint32 maxLatency;
+    uint64 totalLatency;
+    uint32 lastMatchTime;                                  ///< Microseconds spent finding groups
+    uint32 maxMatchTime;
 };
 
 struct LfgWaitTime
@@ -74,7 +152,9 @@ struct LfgWaitTime
 };
 
 typedef std::map<uint32, LfgWaitTime> LfgWaitTimesContainer;
-typedef std::map<std::string, LfgCompatibilityData> LfgCompatibleContainer;
+typedef UNORDERED_MAP<LfgCompatibilityKey, LfgCompatibilityData> LfgCompatibleContainer;
+typedef std::vector<LfgCompatibilityKey> LfgCompatibilityKeyList;
+typedef UNORDERED_MAP<uint64, LfgCompatibilityKeyList> LfgCompatibleIndexContainer;
 typedef std::map<uint64, LfgQueueData> LfgQueueDataContainer;
 
 /**
@@ -83,12 +163,30 @@ typedef std::map<uint64, LfgQueueData> LfgQueueDataContainer;
 class LFGQueue
 {
     public:
+        /**
+            A detached queue (detachedOutput given) never touches players or LFGMgr state: group flags and
+            ignores come from the queue data and proposals are appended to detachedOutput instead of being added.
+            Otherwise, when LFGMgr has a matchmaker, every change is forwarded to it and FindGroups is not used.
+        */
+        explicit LFGQueue(uint8 _queueId = 0, LfgProposalList* _detachedOutput = NULL):
+            queueId(_queueId), detachedOutput(_detachedOutput) { }
 
         // Add/Remove from queue
         void AddToQueue(uint64 guid);
         void RemoveFromQueue(uint64 guid);
         void AddQueueData(uint64 guid, time_t joinTime, LfgDungeonSet const& dungeons, LfgRolesMap const& rolesMap);
+        void AddQueueData(uint64 guid, LfgQueueData const& data);
         void RemoveQueueData(uint64 guid);
+        void ResetCompatibles(uint64 guid);
+
+        // Matchmaker results
+        void RemoveMatched(LfgGuidList const& guids);
+        void SetQueueNeeds(LfgQueueNeeds const& needs);
+        void GetChangedNeeds(LfgQueueNeedsList& needs);
+        uint32 GetJoinSerial(uint64 guid) const;
+        bool HasNewEntries() const { return !newToQueueStore.empty(); }
+        uint32 GetQueueDepth() const { return uint32(newToQueueStore.size() + currentQueueStore.size()); }
+        LfgMatchmakingStats& GetMatchmakingStats() { return matchmakingStats; }
 
         // Update Timers (when proposal success)
         void UpdateWaitTimeAvg(int32 waitTime, uint32 dungeonId);
@@ -103,34 +201,45 @@ class LFGQueue
         // Find new group
         uint8 FindGroups();
 
+        /**
+            Bitmask of the (tanks, healers, dps) counts a set of players can fill at the same time,
+            bit tanks * 8 + healers * 4 + dps. Adding players never adds combinations, so an empty
+            mask means no group containing these players can be formed.
+        */
+        static uint16 GetRoleCombinations(LfgRolesMap const& roles);
+        static uint16 CombineRoleCombinations(uint16 left, uint16 right);
+
         // Just for debugging purposes
         std::string DumpQueueInfo() const;
         std::string DumpCompatibleInfo(bool full = false) const;
 
     private:
-        void SetQueueUpdateData(std::string const& strGuids, LfgRolesMap const& proposalRoles);
-        LfgRolesMap const& RemoveFromQueueUpdateData(uint64 guid);
-
         void AddToNewQueue(uint64 guid);
         void AddToCurrentQueue(uint64 guid);
         void RemoveFromNewQueue(uint64 guid);
         void RemoveFromCurrentQueue(uint64 guid);
 
-        void SetCompatibles(std::string const& key, LfgCompatibility compatibles);
-        LfgCompatibility GetCompatibles(std::string const& key);
-        void RemoveFromCompatibles(uint64 guid);
+        void SetCompatibles(LfgCompatibilityKey const& key, LfgCompatibility compatibles);
+        LfgCompatibility GetCompatibles(LfgCompatibilityKey const& key);
+        void RemoveFromCompatibles(uint64 guid, LfgGuidSet& partners);
 
-        void SetCompatibilityData(std::string const& key, LfgCompatibilityData const& compatibles);
-        LfgCompatibilityData* GetCompatibilityData(std::string const& key);
+        LfgCompatibilityData& AddCompatibilityData(LfgCompatibilityKey const& key);
+        void SetCompatibilityData(LfgCompatibilityKey const& key, LfgCompatibilityData const& compatibles);
+        LfgCompatibilityData* GetCompatibilityData(LfgCompatibilityKey const& key);
         void FindBestCompatibleInQueue(LfgQueueDataContainer::iterator itrQueue);
-        void UpdateBestCompatibleInQueue(LfgQueueDataContainer::iterator itrQueue, std::string const& key, LfgRolesMap const& roles);
+        void UpdateBestCompatibleInQueue(LfgQueueDataContainer::iterator itrQueue, LfgCompatibilityKey const& key, LfgRolesMap const& roles);
 
-        LfgCompatibility FindNewGroups(LfgGuidList& check, LfgGuidList& all);
+        uint16 GetRoleCombinations(uint64 guid) const;
+        LFGMatchmaker* GetMatchmaker() const;
+        bool IsLfgGroup(uint64 guid);
+        bool HasIgnore(uint64 guid1, uint64 guid2, LfgGroupsMap const& groups);
+        LfgCompatibility FindNewGroups(LfgGuidList& check, LfgGuidList& all, uint16 roleCombinations);
         LfgCompatibility CheckCompatibility(LfgGuidList check);
 
         // Queue
         LfgQueueDataContainer QueueDataStore;              ///< Queued groups
         LfgCompatibleContainer CompatibleMapStore;         ///< Compatible dungeons
+        LfgCompatibleIndexContainer CompatibleIndexStore;  ///< Keys of CompatibleMapStore each queued guid is part of
 
         LfgWaitTimesContainer waitTimesAvgStore;           ///< Average wait time to find a group queuing as multiple roles
         LfgWaitTimesContainer waitTimesTankStore;          ///< Average wait time to find a group queuing as tank
@@ -138,6 +247,11 @@ class LFGQueue
         LfgWaitTimesContainer waitTimesDpsStore;           ///< Average wait time to find a group queuing as dps
         LfgGuidList currentQueueStore;                     ///< Ordered list. Used to find groups
         LfgGuidList newToQueueStore;                       ///< New groups to add to queue
+
+        uint8 queueId;                                     ///< Key of this queue in LFGMgr
+        LfgProposalList* detachedOutput;                   ///< Proposals found by a detached queue, see LFGQueue()
+        LfgGuidSet changedNeeds;                           ///< Entries whose needed roles changed since GetChangedNeeds
+        LfgMatchmakingStats matchmakingStats;              ///< Matching cost and delay of this queue
 };
 
 #endif
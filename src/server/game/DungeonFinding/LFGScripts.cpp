@@ -29,7 +29,8 @@
 #include "ScriptMgr.h"
 #include "ObjectAccessor.h"
 
-LFGPlayerScript::LFGPlayerScript() : PlayerScript("LFGPlayerScript")
+LFGPlayerScript::LFGPlayerScript() : PlayerScript("LFGPlayerScript", SCRIPT_HOOK_MASK(PLAYERHOOK_ON_LEVEL_CHANGED) | SCRIPT_HOOK_MASK(PLAYERHOOK_ON_LOGOUT)
+    | SCRIPT_HOOK_MASK(PLAYERHOOK_ON_LOGIN) | SCRIPT_HOOK_MASK(PLAYERHOOK_ON_BIND_TO_INSTANCE))
 {
 }
 
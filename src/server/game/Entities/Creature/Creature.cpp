@@ -52,6 +52,7 @@
 #include "Group.h"
 #include "MoveSplineInit.h"
 #include "MoveSpline.h"
+#include "ScriptProfiler.h"
 // apply implementation of the singletons
 
 TrainerSpell const* TrainerSpellData::Find(uint32 spell_id) const
@@ -151,8 +152,8 @@ bool SetPhaseDelayEvent::Execute(uint64 /*e_time*/, uint32 /*p_time*/)
 
 Creature::Creature(bool isWorldObject): Unit(isWorldObject), MapCreature(),
 lootForPickPocketed(false), lootForBody(false), m_groupLootTimer(0), lootingGroupLowGUID(0),
-m_PlayerDamageReq(0), m_lootRecipient(0), m_lootRecipientGroup(0), m_corpseRemoveTime(0), m_respawnTime(0),
-m_respawnDelay(300), m_corpseDelay(60), m_respawnradius(0.0f), m_reactState(REACT_AGGRESSIVE),
+m_PlayerDamageReq(0), m_lootRecipient(0), m_lootRecipientGroup(0), m_corpseRemoveTime(0), m_respawnTime(0), m_respawnQueueTime(0),
+m_respawnDelay(300), m_corpseDelay(60), m_respawnradius(0.0f), m_dormantTimer(0), m_reactState(REACT_AGGRESSIVE),
 m_defaultMovementType(IDLE_MOTION_TYPE), m_DBTableGuid(0), m_equipmentId(0), m_AlreadyCallAssistance(false),
 m_AlreadySearchedAssistance(false), m_regenHealth(true), m_AI_locked(false), m_meleeDamageSchoolMask(SPELL_SCHOOL_MASK_NORMAL),
 m_creatureInfo(NULL), m_creatureData(NULL), m_path_id(0), m_formation(NULL), uiSeerGUID(0)
@@ -214,6 +215,7 @@ void Creature::RemoveFromWorld()
             sFormationMgr->RemoveCreatureFromGroup(m_formation, this);
         Unit::RemoveFromWorld();
         sObjectAccessor->RemoveObject(this);
+        WakeUp();
     }
 }
 
@@ -491,27 +493,21 @@ void Creature::Update(uint32 diff)
             break;
         case DEAD:
         {
+            // respawned by the map, see Map::ProcessCreatureRespawns
+            if (m_respawnQueueTime)
+                break;
+
             time_t now = time(NULL);
-            if (m_respawnTime <= now)
+            m_respawnQueueTime = std::max(m_respawnTime, now);
+            if (m_respawnTime > now && !GetZoneScript() && !GetFormation() && GetMap()->CanUnloadDeadCreature(m_DBTableGuid))
             {
-                bool allowed = IsAIEnabled ? AI()->CanRespawn() : true;     // First check if there are any scripts that object to us respawning
-                if (!allowed)                                               // Will be rechecked on next Update call
-                    break;
-
-                uint64 dbtableHighGuid = MAKE_NEW_GUID(m_DBTableGuid, GetEntry(), HIGHGUID_UNIT);
-                time_t linkedRespawntime = GetMap()->GetLinkedRespawnTime(dbtableHighGuid);
-                if (!linkedRespawntime)             // Can respawn
-                    Respawn();
-                else                                // the master is dead
-                {
-                    uint64 targetGuid = sObjectMgr->GetLinkedRespawnGuid(dbtableHighGuid);
-                    if (targetGuid == dbtableHighGuid) // if linking self, never respawn (check delayed to next day)
-                        SetRespawnTime(DAY);
-                    else
-                        m_respawnTime = (now > linkedRespawntime ? now : linkedRespawntime)+urand(5, MINUTE); // else copy time from master and add a little
-                    SaveRespawnTime(); // also save to DB immediately
-                }
+                // nothing left to see until the respawn, the map creates it again then
+                SaveRespawnTime();
+                GetMap()->ScheduleCreatureRespawn(0, m_DBTableGuid, m_respawnQueueTime);
+                AddObjectToRemoveList();
             }
+            else
+                GetMap()->ScheduleCreatureRespawn(GetGUID(), m_DBTableGuid, m_respawnQueueTime);
             break;
         }
         case CORPSE:
@@ -561,7 +557,10 @@ void Creature::Update(uint32 diff)
             {
                 // do not allow the AI to be changed during update
                 m_AI_locked = true;
-                i_AI->UpdateAI(diff);
+                {
+                    ScriptProfileScope profile(SCRIPT_PROFILE_CREATURE_AI, GetMapId(), GetEntry());
+                    i_AI->UpdateAI(diff);
+                }
                 m_AI_locked = false;
             }
 
@@ -606,6 +605,119 @@ void Creature::Update(uint32 diff)
     }
 
     sScriptMgr->OnCreatureUpdate(this, diff);
+
+    UpdateDormancy();
+}
+
+void Creature::ProcessRespawn()
+{
+    m_respawnQueueTime = 0;
+
+    time_t now = time(NULL);
+    if (getDeathState() != DEAD || m_respawnTime > now)
+        return;
+
+    bool allowed = IsAIEnabled ? AI()->CanRespawn() : true;     // First check if there are any scripts that object to us respawning
+    if (!allowed)                                               // Will be rechecked by the map a second later
+        return;
+
+    uint64 dbtableHighGuid = MAKE_NEW_GUID(m_DBTableGuid, GetEntry(), HIGHGUID_UNIT);
+    time_t linkedRespawntime = GetMap()->GetLinkedRespawnTime(dbtableHighGuid);
+    if (!linkedRespawntime)             // Can respawn
+        Respawn();
+    else                                // the master is dead
+    {
+        uint64 targetGuid = sObjectMgr->GetLinkedRespawnGuid(dbtableHighGuid);
+        if (targetGuid == dbtableHighGuid) // if linking self, never respawn (check delayed to next day)
+            SetRespawnTime(DAY);
+        else
+            m_respawnTime = (now > linkedRespawntime ? now : linkedRespawntime)+urand(5, MINUTE); // else copy time from master and add a little
+        SaveRespawnTime(); // also save to DB with the next batch
+    }
+}
+
+bool Creature::SkipUpdate(uint32 diff)
+{
+    if (!m_dormantTimer)
+        return false;
+
+    // scripts may add events or launch splines without anything waking us
+    if (m_dormantTimer <= diff || m_Events.HasEvents() || !movespline->Finalized())
+    {
+        m_dormantTimer = 0;
+        return false;
+    }
+
+    m_dormantTimer -= diff;
+    return true;
+}
+
+void Creature::UpdateDormancy()
+{
+    m_dormantTimer = 0;
+
+    uint32 sleepTime = sWorld->getIntConfig(CONFIG_CREATURE_DORMANT_SLEEP_TIME);
+    if (!sleepTime || !IsInWorld() || isSummon() || IsVehicle() || GetCharmerOrOwnerGUID() || m_Events.HasEvents())
+        return;
+
+    // core scripts may do anything in their OnUpdate and AI
+    if (GetScriptId())
+        return;
+
+    switch (m_deathState)
+    {
+        case DEAD:
+            // respawned by the map, anything changing the respawn time wakes it up to queue again
+            if (m_respawnQueueTime)
+                m_dormantTimer = HOUR * IN_MILLISECONDS;
+            break;
+        case ALIVE:
+            // AI timers are not known, so recheck idle creatures every sleepTime
+            if (CanSleepWhileIdle())
+                m_dormantTimer = sleepTime;
+            break;
+        default:
+            break;
+    }
+}
+
+bool Creature::CanSleepWhileIdle()
+{
+    // the default AIs do nothing out of combat, SmartAI runs its own timers
+    if (!m_creatureInfo->AIName.empty() || NeedChangeAI || TriggerJustRespawned)
+        return false;
+
+    if (isInCombat() || IsInEvadeMode() || IsNonMeleeSpellCasted(false, false, false, false, false))
+        return false;
+
+    if (GetMotionMaster()->GetCurrentMovementGeneratorType() != IDLE_MOTION_TYPE || !movespline->Finalized())
+        return false;
+
+    // nothing to regenerate
+    if (m_regenHealth && GetHealth() < GetMaxHealth())
+        return false;
+
+    Powers power = getPowerType();
+    if ((power == POWER_MANA || power == POWER_ENERGY) && GetPower(power) < GetMaxPower(power))
+        return false;
+
+    if (!m_gameObj.empty())
+        return false;
+
+    // no aura to expire or tick
+    for (AuraMap::const_iterator itr = m_ownedAuras.begin(); itr != m_ownedAuras.end(); ++itr)
+    {
+        Aura const* aura = itr->second;
+        if (!aura->IsPermanent())
+            return false;
+
+        for (uint8 i = 0; i < MAX_SPELL_EFFECTS; ++i)
+            if (AuraEffect const* effect = aura->GetEffect(i))
+                if (effect->IsPeriodic())
+                    return false;
+    }
+
+    return true;
 }
 
 void Creature::RegenerateMana()
@@ -1604,6 +1716,8 @@ float Creature::GetAttackDistance(Unit const* player) const
 
 void Creature::setDeathState(DeathState s)
 {
+    WakeUp();
+
     if (s != ALIVE && s != JUST_RESPAWNED)
         SetUInt32Value(UNIT_NPC_EMOTESTATE, 0);
 
@@ -1616,7 +1730,7 @@ void Creature::setDeathState(DeathState s)
 
         // always save boss respawn time at death to prevent crash cheating
         if (sWorld->getBoolConfig(CONFIG_SAVE_RESPAWN_TIME_IMMEDIATELY) || isWorldBoss())
-            SaveRespawnTime();
+            SaveRespawnTime(true);
 
         SetTarget(0);                // remove target selection in any cases (can be set at aura remove in Unit::setDeathState)
         SetUInt32Value(UNIT_NPC_FLAGS, UNIT_NPC_FLAG_NONE);
@@ -1706,6 +1820,7 @@ void Creature::Respawn(bool force)
 
         sLog->outDebug(LOG_FILTER_UNITS, "Respawning creature %s (GuidLow: %u, Full GUID: " UI64FMTD " Entry: %u)", GetName(), GetGUIDLow(), GetGUID(), GetEntry());
         m_respawnTime = 0;
+        m_respawnQueueTime = 0;
         lootForPickPocketed = false;
         lootForBody         = false;
 
@@ -2145,12 +2260,12 @@ bool Creature::_IsTargetAcceptable(const Unit* target) const
     return false;
 }
 
-void Creature::SaveRespawnTime()
+void Creature::SaveRespawnTime(bool immediate)
 {
     if (isSummon() || !m_DBTableGuid || (m_creatureData && !m_creatureData->dbData))
         return;
 
-    GetMap()->SaveCreatureRespawnTime(m_DBTableGuid, m_respawnTime);
+    GetMap()->SaveCreatureRespawnTime(m_DBTableGuid, m_respawnTime, immediate);
 }
 
 // this should not be called by petAI or
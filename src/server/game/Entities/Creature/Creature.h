@@ -533,6 +533,11 @@ class Creature : public Unit, public GridObject<Creature>, public MapCreature
         uint32 GetDBTableGUIDLow() const { return m_DBTableGuid; }
 
         void Update(uint32 time);                         // overwrited Unit::Update
+
+        // dead and idle creatures skip map updates until their next wake-up time or until something wakes them
+        bool SkipUpdate(uint32 diff);
+        void WakeUp() { m_dormantTimer = 0; }
+        bool IsDormant() const { return m_dormantTimer != 0; }
         void GetRespawnPosition(float &x, float &y, float &z, float* ori = NULL, float* dist =NULL) const;
         uint32 GetEquipmentId() const { return GetCreatureTemplate()->equipmentId; }
 
@@ -734,9 +739,15 @@ class Creature : public Unit, public GridObject<Creature>, public MapCreature
 
         time_t const& GetRespawnTime() const { return m_respawnTime; }
         time_t GetRespawnTimeEx() const;
-        void SetRespawnTime(uint32 respawn) { m_respawnTime = respawn ? time(NULL) + respawn : 0; }
+        void SetRespawnTime(uint32 respawn) { m_respawnTime = respawn ? time(NULL) + respawn : 0; m_respawnQueueTime = 0; WakeUp(); }
         void Respawn(bool force = false);
-        void SaveRespawnTime();
+        void SaveRespawnTime() { SaveRespawnTime(false); }
+        void SaveRespawnTime(bool immediate);               // immediate skips the map's batch of respawn time writes
+
+        // dead creatures are queued in their map, which calls ProcessRespawn once the queue time passed
+        time_t GetRespawnQueueTime() const { return m_respawnQueueTime; }
+        void SetRespawnQueueTime(time_t queueTime) { m_respawnQueueTime = queueTime; }
+        void ProcessRespawn();
 
         uint32 GetRespawnDelay() const { return m_respawnDelay; }
         void SetRespawnDelay(uint32 delay) { m_respawnDelay = delay; }
@@ -836,9 +847,14 @@ class Creature : public Unit, public GridObject<Creature>, public MapCreature
         /// Timers
         time_t m_corpseRemoveTime;                          // (msecs)timer for death or corpse disappearance
         time_t m_respawnTime;                               // (secs) time of next respawn
+        time_t m_respawnQueueTime;                          // (secs) time of the map respawn queue entry, 0 if not queued
         uint32 m_respawnDelay;                              // (secs) delay between corpse disappearance and respawning
         uint32 m_corpseDelay;                               // (secs) delay between death and corpse disappearance
         float m_respawnradius;
+        uint32 m_dormantTimer;                              // (msecs) map updates left to skip, 0 while awake
+
+        void UpdateDormancy();
+        bool CanSleepWhileIdle();
 
         ReactStates m_reactState;                           // for AI, not charmInfo
         void RegenerateMana();
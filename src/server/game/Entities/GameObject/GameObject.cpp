@@ -360,7 +360,7 @@ void GameObject::Update(uint32 diff)
                             SetRespawnTime(DAY);
                         else
                             m_respawnTime = (now > linkedRespawntime ? now : linkedRespawntime)+urand(5, MINUTE); // else copy time from master and add a little
-                        SaveRespawnTime(); // also save to DB immediately
+                        SaveRespawnTime(); // also save to DB with the next batch
                         return;
                     }
 
@@ -601,7 +601,7 @@ void GameObject::Update(uint32 diff)
 
             // if option not set then object will be saved at grid unload
             if (sWorld->getBoolConfig(CONFIG_SAVE_RESPAWN_TIME_IMMEDIATELY))
-                SaveRespawnTime();
+                SaveRespawnTime(true);
 
             UpdateObjectVisibility();
 
@@ -884,10 +884,10 @@ Unit* GameObject::GetOwner() const
     return ObjectAccessor::GetUnit(*this, GetOwnerGUID());
 }
 
-void GameObject::SaveRespawnTime()
+void GameObject::SaveRespawnTime(bool immediate)
 {
     if (m_goData && m_goData->dbData && m_respawnTime > time(NULL) && m_spawnedByDefault)
-        GetMap()->SaveGORespawnTime(m_DBTableGuid, m_respawnTime);
+        GetMap()->SaveGORespawnTime(m_DBTableGuid, m_respawnTime, immediate);
 }
 
 bool GameObject::IsAlwaysVisibleFor(WorldObject const* seer) const
@@ -778,7 +778,8 @@ class GameObject : public WorldObject, public GridObject<GameObject>
         uint32 GetUseCount() const { return m_usetimes; }
         uint32 GetUniqueUseCount() const { return m_unique_users.size(); }
 
-        void SaveRespawnTime();
+        void SaveRespawnTime() { SaveRespawnTime(false); }
+        void SaveRespawnTime(bool immediate);               // immediate skips the map's batch of respawn time writes
 
         Loot        loot;
 
@@ -277,7 +277,7 @@ void Object::SendUpdateToPlayer(Player* player)
     player->GetSession()->SendPacket(&packet);
 }
 
-void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const
+void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target, UpdateMask const* extraChanges) const
 {
     ByteBuffer buf(500);
 
@@ -291,7 +291,7 @@ void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) c
 
     updateMask.SetCount(valCount);
 
-    _SetUpdateBits(&updateMask, target);
+    _SetUpdateBits(&updateMask, target, extraChanges);
     _BuildValuesUpdate(UPDATETYPE_VALUES, &buf, &updateMask, target);
 
     data->AddUpdateBlock(buf);
@@ -993,7 +993,7 @@ void Object::ClearUpdateMask(bool remove)
     }
 }
 
-void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map) const
+void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map, UpdateMask const* extraChanges) const
 {
     UpdateDataMapType::iterator iter = data_map.find(player);
 
@@ -1004,7 +1004,7 @@ void Object::BuildFieldsUpdate(Player* player, UpdateDataMapType& data_map) cons
         iter = p.first;
     }
 
-    BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
+    BuildValuesUpdateBlockForPlayer(&iter->second, iter->first, extraChanges);
 }
 
 void Object::_LoadIntoDataField(char const* data, uint32 startOffset, uint32 count)
@@ -1077,7 +1077,7 @@ uint32 Object::GetUpdateFieldData(Player const* target, uint32*& flags) const
     return visibleFlag;
 }
 
-void Object::_SetUpdateBits(UpdateMask* updateMask, Player* target) const
+void Object::_SetUpdateBits(UpdateMask* updateMask, Player* target, UpdateMask const* extraChanges) const
 {
     uint32* flags = NULL;
     uint32 visibleFlag = GetUpdateFieldData(target, flags);
@@ -1087,7 +1087,8 @@ void Object::_SetUpdateBits(UpdateMask* updateMask, Player* target) const
         valCount = PLAYER_END_NOT_SELF;
 
     for (uint16 index = 0; index < valCount; ++index)
-        if (_fieldNotifyFlags & flags[index] || ((flags[index] & visibleFlag) & UF_FLAG_SPECIAL_INFO) || (_changesMask.GetBit(index) && (flags[index] & visibleFlag)))
+        if (_fieldNotifyFlags & flags[index] || ((flags[index] & visibleFlag) & UF_FLAG_SPECIAL_INFO) ||
+            ((_changesMask.GetBit(index) || (extraChanges && extraChanges->GetBit(index))) && (flags[index] & visibleFlag)))
             updateMask->SetBit(index);
 }
 
@@ -2858,6 +2859,28 @@ void WorldObject::SendMessageToSet(WorldPacket* data, Player const* skipped_rcvr
     VisitNearbyWorldObject(GetVisibilityRange(), notifier);
 }
 
+void WorldObject::SendMovementMessageToSet(WorldPacket* data, Player const* skipped_rcvr, bool heartbeat, bool lowPriority)
+{
+    uint8 flags = 0;
+    if (lowPriority)
+        flags |= Trinity::MESSAGE_DELIVER_LOW_PRIORITY;
+    if (sWorld->getBoolConfig(CONFIG_MOVEMENT_BATCHING))
+        flags |= heartbeat ? (Trinity::MESSAGE_DELIVER_BATCHED | Trinity::MESSAGE_DELIVER_REPLACEABLE) : Trinity::MESSAGE_DELIVER_BATCHED;
+
+    if (!flags)
+    {
+        SendMessageToSet(data, skipped_rcvr);
+        return;
+    }
+
+    if (Player* player = ToPlayer())
+        if (player != skipped_rcvr)
+            player->GetSession()->SendPacket(data);
+
+    Trinity::MessageDistDeliverer notifier(this, data, GetVisibilityRange(), false, skipped_rcvr, flags);
+    VisitNearbyWorldObject(GetVisibilityRange(), notifier);
+}
+
 void WorldObject::SendObjectDeSpawnAnim(uint64 guid)
 {
     WorldPacket data(SMSG_GAMEOBJECT_DESPAWN_ANIM, 8);
@@ -3583,7 +3606,11 @@ struct WorldObjectChangeAccumulator
         // Only send update once to a player
         if (plr_list.find(player->GetGUID()) == plr_list.end() && player->HaveAtClient(&i_object))
         {
-            i_object.BuildFieldsUpdate(player, i_updateDatas);
+            // far objects in crowded areas are merged and sent later
+            if (player->IsVisibilityThrottledFor(&i_object))
+                i_object.DeferFieldsUpdate(player);
+            else
+                i_object.BuildFieldsUpdateFor(player, i_updateDatas);
             plr_list.insert(player->GetGUID());
         }
     }
@@ -3593,16 +3620,90 @@ struct WorldObjectChangeAccumulator
 
 void WorldObject::BuildUpdate(UpdateDataMapType& data_map)
 {
-    CellCoord p = Trinity::ComputeCellCoord(GetPositionX(), GetPositionY());
-    Cell cell(p);
-    cell.SetNoCreate();
-    WorldObjectChangeAccumulator notifier(*this, data_map);
-    TypeContainerVisitor<WorldObjectChangeAccumulator, WorldTypeMapContainer > player_notifier(notifier);
-    Map& map = *GetMap();
-    //we must build packets for all visible players
-    cell.Visit(p, player_notifier, map, *this, GetVisibilityRange());
+    // we may be queued only to flush held back updates, nothing new to send then
+    if (_deferredValuesObservers.empty() || !_changesMask.IsEmpty())
+    {
+        CellCoord p = Trinity::ComputeCellCoord(GetPositionX(), GetPositionY());
+        Cell cell(p);
+        cell.SetNoCreate();
+        WorldObjectChangeAccumulator notifier(*this, data_map);
+        TypeContainerVisitor<WorldObjectChangeAccumulator, WorldTypeMapContainer > player_notifier(notifier);
+        Map& map = *GetMap();
+        //we must build packets for all visible players
+        cell.Visit(p, player_notifier, map, *this, GetVisibilityRange());
+
+        if (!_deferredValuesObservers.empty())
+            _deferredChangesMask |= _changesMask;
+    }
+
+    if (!_deferredValuesObservers.empty())
+        FlushDeferredFieldsUpdates(data_map);
 
     ClearUpdateMask(false);
+
+    // stay in the update queue until every held back update is sent
+    if (!_deferredValuesObservers.empty())
+    {
+        m_objectUpdated = true;
+        sObjectAccessor->AddUpdateObject(this);
+    }
+}
+
+void WorldObject::DeferFieldsUpdate(Player* player)
+{
+    if (_deferredValuesObservers.empty())
+    {
+        if (_deferredChangesMask.GetCount() != m_valuesCount)
+            _deferredChangesMask.SetCount(m_valuesCount);
+        else
+            _deferredChangesMask.Clear();
+    }
+
+    // keep the time of the first held back update, later changes are merged into it
+    if (_deferredValuesObservers.insert(DeferredValuesObservers::value_type(player->GetGUID(), getMSTime())).second)
+        ++GetMap()->GetVisibilityStats().ValuesDeferred;
+}
+
+void WorldObject::BuildFieldsUpdateFor(Player* player, UpdateDataMapType& data_map)
+{
+    if (!_deferredValuesObservers.empty())
+    {
+        DeferredValuesObservers::iterator itr = _deferredValuesObservers.find(player->GetGUID());
+        if (itr != _deferredValuesObservers.end())
+        {
+            // came close again, send everything held back along with the new changes
+            _deferredValuesObservers.erase(itr);
+            BuildFieldsUpdate(player, data_map, &_deferredChangesMask);
+            return;
+        }
+    }
+
+    BuildFieldsUpdate(player, data_map);
+}
+
+void WorldObject::FlushDeferredFieldsUpdates(UpdateDataMapType& data_map)
+{
+    uint32 now = getMSTime();
+    for (DeferredValuesObservers::iterator itr = _deferredValuesObservers.begin(); itr != _deferredValuesObservers.end();)
+    {
+        Player* player = ObjectAccessor::FindPlayer(itr->first);
+        // observer left, it gets a full create block if it ever sees us again
+        if (!player || player->GetMap() != GetMap() || !player->HaveAtClient(this))
+        {
+            _deferredValuesObservers.erase(itr++);
+            continue;
+        }
+
+        if (getMSTimeDiff(itr->second, now) < World::Visibility_DensityValuesInterval)
+        {
+            ++itr;
+            continue;
+        }
+
+        BuildFieldsUpdate(player, data_map, &_deferredChangesMask);
+        ++GetMap()->GetVisibilityStats().ValuesFlushed;
+        _deferredValuesObservers.erase(itr++);
+    }
 }
 
 uint64 WorldObject::GetTransGUID() const
@@ -206,7 +206,7 @@ class Object
         void SendForcedObjectUpdate();
         void SendUpdateToPlayer(Player* player);
 
-        void BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const;
+        void BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target, UpdateMask const* extraChanges = NULL) const;
         void BuildOutOfRangeUpdateBlock(UpdateData* data) const;
 
         virtual void DestroyForPlayer(Player* target, bool onDeath = false) const;
@@ -385,7 +385,7 @@ class Object
         virtual bool hasQuest(uint32 /* quest_id */) const { return false; }
         virtual bool hasInvolvedQuest(uint32 /* quest_id */) const { return false; }
         virtual void BuildUpdate(UpdateDataMapType&) {}
-        void BuildFieldsUpdate(Player*, UpdateDataMapType &) const;
+        void BuildFieldsUpdate(Player*, UpdateDataMapType &, UpdateMask const* extraChanges = NULL) const;
 
         void SetFieldNotifyFlag(uint16 flag) { _fieldNotifyFlags |= flag; }
         void RemoveFieldNotifyFlag(uint16 flag) { _fieldNotifyFlags &= ~flag; }
@@ -421,7 +421,7 @@ class Object
 
         uint32 GetUpdateFieldData(Player const* target, uint32*& flags) const;
 
-        void _SetUpdateBits(UpdateMask* updateMask, Player* target) const;
+        void _SetUpdateBits(UpdateMask* updateMask, Player* target, UpdateMask const* extraChanges = NULL) const;
         void _SetCreateBits(UpdateMask* updateMask, Player* target) const;
         void _BuildMovementUpdate(ByteBuffer * data, uint16 flags) const;
         void _BuildValuesUpdate(uint8 updatetype, ByteBuffer *data, UpdateMask* updateMask, Player* target) const;
@@ -772,6 +772,7 @@ class WorldObject : public Object, public WorldLocation
                 return;
 
             DestroyForNearbyPlayers();
+            _deferredValuesObservers.clear();
 
             Object::RemoveFromWorld();
         }
@@ -923,6 +924,8 @@ class WorldObject : public Object, public WorldLocation
         virtual void SendMessageToSet(WorldPacket* data, bool self);
         virtual void SendMessageToSetInRange(WorldPacket* data, float dist, bool self);
         virtual void SendMessageToSet(WorldPacket* data, Player const* skipped_rcvr);
+        // relays client movement; heartbeats may be merged in the observers' batches or skipped by far crowded observers
+        void SendMovementMessageToSet(WorldPacket* data, Player const* skipped_rcvr, bool heartbeat, bool lowPriority);
 
         virtual uint8 getLevelForTarget(WorldObject const* /*target*/) const { return 1; }
 
@@ -1008,6 +1011,10 @@ class WorldObject : public Object, public WorldLocation
         virtual void UpdateObjectVisibility(bool forced = true);
         void BuildUpdate(UpdateDataMapType&);
 
+        // values updates held back for observers in crowded areas, see Player::IsVisibilityThrottledFor
+        void DeferFieldsUpdate(Player* player);
+        void BuildFieldsUpdateFor(Player* player, UpdateDataMapType& data_map);
+
         bool isActiveObject() const { return m_isActive; }
         void setActive(bool isActiveObject);
         void SetWorldObject(bool apply);
@@ -1074,6 +1081,13 @@ class WorldObject : public Object, public WorldLocation
         bool CanDetect(WorldObject const* obj, bool ignoreStealth) const;
         bool CanDetectInvisibilityOf(WorldObject const* obj) const;
         bool CanDetectStealthOf(WorldObject const* obj) const;
+
+        void FlushDeferredFieldsUpdates(UpdateDataMapType& data_map);
+
+        // observer guid -> time of the first held back update
+        typedef UNORDERED_MAP<uint64, uint32> DeferredValuesObservers;
+        DeferredValuesObservers _deferredValuesObservers;
+        UpdateMask _deferredChangesMask;                    // changes since the oldest held back update
 };
 
 namespace Trinity
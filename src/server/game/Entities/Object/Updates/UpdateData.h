@@ -59,6 +59,7 @@ class UpdateData
         void AddUpdateBlock(const ByteBuffer &block);
         bool BuildPacket(WorldPacket* packet);
         bool HasData() const { return m_blockCount > 0 || !m_outOfRangeGUIDs.empty(); }
+        uint32 GetBlockCount() const { return m_blockCount; }
         void Clear();
 
         std::set<uint64> const& GetOutOfRangeGUIDs() const { return m_outOfRangeGUIDs; }
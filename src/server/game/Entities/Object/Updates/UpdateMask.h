@@ -81,6 +81,15 @@ class UpdateMask
                 memset(_bits, 0, sizeof(uint8) * _blockCount * CLIENT_UPDATE_MASK_BITS);
         }
 
+        bool IsEmpty() const
+        {
+            for (uint32 i = 0; i < _fieldCount; ++i)
+                if (_bits[i])
+                    return false;
+
+            return true;
+        }
+
         UpdateMask& operator=(UpdateMask const& right)
         {
             if (this == &right)
@@ -66,6 +66,7 @@
 #include "SocialMgr.h"
 #include "GameEventMgr.h"
 #include "AchievementMgr.h"
+#include "AchievementSaveBuffer.h"
 #include "SpellAuras.h"
 #include "SpellAuraEffects.h"
 #include "ConditionMgr.h"
@@ -869,6 +870,12 @@ Player::Player(WorldSession* session): Unit(true), m_achievementMgr(this), m_rep
     m_movedPlayer = this;
     m_seer = this;
 
+    m_visibilityCenterRange = 0.0f;
+    m_visibilityCenterValid = false;
+    m_visibilityIncrementalPasses = 0;
+    m_visibleUnitsCount = 0;
+    m_denseVisibility = false;
+
     m_contestedPvPTimer = 0;
 
     m_declinedname = NULL;
@@ -5031,6 +5038,7 @@ void Player::DeleteFromDB(uint64 playerguid, uint32 accountId, bool updateRealmC
             trans->PAppend("DELETE FROM mail_items WHERE receiver = '%u'",guid);
             trans->PAppend("DELETE FROM character_pet WHERE owner = '%u'",guid);
             trans->PAppend("DELETE FROM character_pet_declinedname WHERE owner = '%u'",guid);
+            sAchievementSaveBuffer->Flush(ACHIEVEMENT_OWNER_PLAYER, guid, trans);   // the realm first achievements are kept
             trans->PAppend("DELETE FROM character_achievement WHERE guid = '%u' "   // NOTE: These achievements have flags & 256 in DBC.
                                         "AND achievement NOT BETWEEN '456' AND '467' "          // Realm First Level 80
                                         "AND achievement NOT BETWEEN '1400' AND '1427' "        // Realm First Raid Achievements
@@ -15443,7 +15451,7 @@ bool Player::SatisfyQuestStatus(Quest const* qInfo, bool msg)
 
 bool Player::SatisfyQuestConditions(Quest const* qInfo, bool msg)
 {
-    ConditionList conditions = sConditionMgr->GetConditionsForNotGroupedEntry(CONDITION_SOURCE_TYPE_QUEST_ACCEPT, qInfo->GetQuestId());
+    ConditionList const& conditions = sConditionMgr->GetConditionsForNotGroupedEntry(CONDITION_SOURCE_TYPE_QUEST_ACCEPT, qInfo->GetQuestId());
     if (!sConditionMgr->IsObjectMeetToConditions(this, conditions))
     {
         if (msg)
@@ -17917,49 +17925,39 @@ Item* Player::_LoadItem(SQLTransaction& trans, uint32 zoneId, uint32 timeDiff, F
     return item;
 }
 
-// load mailed item which should receive current player
-void Player::_LoadMailedItems(Mail* mail)
+// load mailed item which should receive current player, fields are the item columns of the mailbox query
+void Player::_LoadMailedItem(Mail* mail, Field* fields)
 {
     // data needs to be at first place for Item::LoadFromDB
-    QueryResult result = CharacterDatabase.PQuery("SELECT creatorGuid, giftCreatorGuid, count, duration, charges, flags, enchantments, randomPropertyId, durability, playedTime, text, item_guid, itemEntry, owner_guid FROM mail_items mi JOIN item_instance ii ON mi.item_guid = ii.guid WHERE mail_id = '%u'", mail->messageID);
-    if (!result)
-        return;
-
-    do
-    {
-        Field* fields = result->Fetch();
-
-        uint32 itemGuid = fields[11].GetUInt32();
-        uint32 itemTemplate = fields[12].GetUInt32();
+    uint32 itemGuid = fields[11].GetUInt32();
+    uint32 itemTemplate = fields[12].GetUInt32();
 
-        mail->AddItem(itemGuid, itemTemplate);
+    mail->AddItem(itemGuid, itemTemplate);
 
-        ItemTemplate const* proto = sObjectMgr->GetItemTemplate(itemTemplate);
-
-        if (!proto)
-        {
-            sLog->outError(LOG_FILTER_PLAYER, "Player %u has unknown item_template (ProtoType) in mailed items(GUID: %u template: %u) in mail (%u), deleted.", GetGUIDLow(), itemGuid, itemTemplate, mail->messageID);
-            CharacterDatabase.PExecute("DELETE FROM mail_items WHERE item_guid = '%u'", itemGuid);
-            CharacterDatabase.PExecute("DELETE FROM item_instance WHERE guid = '%u'", itemGuid);
-            continue;
-        }
+    ItemTemplate const* proto = sObjectMgr->GetItemTemplate(itemTemplate);
 
-        Item* item = NewItemOrBag(proto);
+    if (!proto)
+    {
+        sLog->outError(LOG_FILTER_PLAYER, "Player %u has unknown item_template (ProtoType) in mailed items(GUID: %u template: %u) in mail (%u), deleted.", GetGUIDLow(), itemGuid, itemTemplate, mail->messageID);
+        CharacterDatabase.PExecute("DELETE FROM mail_items WHERE item_guid = '%u'", itemGuid);
+        CharacterDatabase.PExecute("DELETE FROM item_instance WHERE guid = '%u'", itemGuid);
+        return;
+    }
 
-        if (!item->LoadFromDB(itemGuid, MAKE_NEW_GUID(fields[13].GetUInt32(), 0, HIGHGUID_PLAYER), fields, itemTemplate))
-        {
-            sLog->outError(LOG_FILTER_PLAYER, "Player::_LoadMailedItems - Item in mail (%u) doesn't exist !!!! - item guid: %u, deleted from mail", mail->messageID, itemGuid);
-            CharacterDatabase.PExecute("DELETE FROM mail_items WHERE item_guid = '%u'", itemGuid);
-            item->FSetState(ITEM_REMOVED);
+    Item* item = NewItemOrBag(proto);
 
-            SQLTransaction temp = SQLTransaction(NULL);
-            item->SaveToDB(temp);                               // it also deletes item object !
-            continue;
-        }
+    if (!item->LoadFromDB(itemGuid, MAKE_NEW_GUID(fields[13].GetUInt32(), 0, HIGHGUID_PLAYER), fields, itemTemplate))
+    {
+        sLog->outError(LOG_FILTER_PLAYER, "Player::_LoadMailedItem - Item in mail (%u) doesn't exist !!!! - item guid: %u, deleted from mail", mail->messageID, itemGuid);
+        CharacterDatabase.PExecute("DELETE FROM mail_items WHERE item_guid = '%u'", itemGuid);
+        item->FSetState(ITEM_REMOVED);
 
-        AddMItem(item);
+        SQLTransaction temp = SQLTransaction(NULL);
+        item->SaveToDB(temp);                               // it also deletes item object !
+        return;
     }
-    while (result->NextRow());
+
+    AddMItem(item);
 }
 
 void Player::_LoadMailInit(PreparedQueryResult resultUnread, PreparedQueryResult resultDelivery)
@@ -17975,45 +17973,51 @@ void Player::_LoadMailInit(PreparedQueryResult resultUnread, PreparedQueryResult
         m_nextMailDelivereTime = time_t((*resultDelivery)[0].GetUInt32());
 }
 
-void Player::_LoadMail()
+void Player::_LoadMail(PreparedQueryResult result)
 {
     m_mail.clear();
-    //mails are in right order                             0  1           2      3        4       5          6         7           8            9     10  11      12         13	  	
-    QueryResult result = CharacterDatabase.PQuery("SELECT id, messageType, sender, receiver, subject, body, has_items, expire_time, deliver_time, money, cod, checked, stationery, mailTemplateId FROM mail WHERE receiver = '%u' ORDER BY id DESC", GetGUIDLow());
+    // mails are in right order, one row per mailed item (CHAR_SEL_MAILBOX)
+    // 0 id, 1 messageType, 2 sender, 3 receiver, 4 subject, 5 body, 6 has_items, 7 expire_time, 8 deliver_time, 9 money, 10 cod, 11 checked, 12 stationery, 13 mailTemplateId,
+    // 14 - 24 item_instance data for Item::LoadFromDB, 25 item_guid, 26 itemEntry, 27 owner_guid, all NULL for mails without items
     if (result)
     {
+        Mail* m = NULL;
         do
         {
             Field* fields = result->Fetch();
-            Mail* m = new Mail;
 
-            m->messageID      = fields[0].GetUInt32();
-            m->messageType    = fields[1].GetUInt8();
-            m->sender         = fields[2].GetUInt32();
-            m->receiver       = fields[3].GetUInt32();
-            m->subject        = fields[4].GetString();
-            m->body           = fields[5].GetString();
-            bool has_items    = fields[6].GetBool();
-            m->expire_time    = time_t(fields[7].GetUInt32());
-            m->deliver_time   = time_t(fields[8].GetUInt32());
-            m->money          = fields[9].GetUInt64();
-            m->COD            = fields[10].GetUInt64();
-            m->checked        = fields[11].GetUInt8();
-            m->stationery     = fields[12].GetUInt8();
-            m->mailTemplateId = fields[13].GetInt16();
-
-            if (m->mailTemplateId && !sMailTemplateStore.LookupEntry(m->mailTemplateId))
-            {
-                sLog->outError(LOG_FILTER_PLAYER, "Player::_LoadMail - Mail (%u) have not existed MailTemplateId (%u), remove at load", m->messageID, m->mailTemplateId);
-                m->mailTemplateId = 0;
-            }
+            uint32 messageID = fields[0].GetUInt32();
+            if (!m || m->messageID != messageID)
+            {
+                m = new Mail;
+
+                m->messageID      = messageID;
+                m->messageType    = fields[1].GetUInt8();
+                m->sender         = fields[2].GetUInt32();
+                m->receiver       = fields[3].GetUInt32();
+                m->subject        = fields[4].GetString();
+                m->body           = fields[5].GetString();
+                m->expire_time    = time_t(fields[7].GetUInt32());
+                m->deliver_time   = time_t(fields[8].GetUInt32());
+                m->money          = fields[9].GetUInt64();
+                m->COD            = fields[10].GetUInt64();
+                m->checked        = fields[11].GetUInt8();
+                m->stationery     = fields[12].GetUInt8();
+                m->mailTemplateId = fields[13].GetInt16();
+
+                if (m->mailTemplateId && !sMailTemplateStore.LookupEntry(m->mailTemplateId))
+                {
+                    sLog->outError(LOG_FILTER_PLAYER, "Player::_LoadMail - Mail (%u) have not existed MailTemplateId (%u), remove at load", m->messageID, m->mailTemplateId);
+                    m->mailTemplateId = 0;
+                }
 
-            m->state = MAIL_STATE_UNCHANGED;
+                m->state = MAIL_STATE_UNCHANGED;
 
-            if (has_items)
-                _LoadMailedItems(m);
+                m_mail.push_back(m);
+            }
 
-            m_mail.push_back(m);
+            if (fields[6].GetBool() && !fields[25].IsNull())
+                _LoadMailedItem(m, fields + 14);
         }
         while (result->NextRow());
     }
@@ -19448,6 +19452,7 @@ void Player::_SaveMail(SQLTransaction& trans)
             ++itr;
     }
 
+    sWorld->UpdateCharacterNameDataMailCount(GetGUIDLow(), m_mail.size());
     m_mailsUpdated = false;
 }
 
@@ -20302,7 +20307,7 @@ void Player::VehicleSpellInitialize()
             continue;
         }
 
-        ConditionList conditions = sConditionMgr->GetConditionsForVehicleSpell(vehicle->GetEntry(), spellId);
+        ConditionList const& conditions = sConditionMgr->GetConditionsForVehicleSpell(vehicle->GetEntry(), spellId);
         if (!sConditionMgr->IsObjectMeetToConditions(this, vehicle, conditions))
         {
             data << uint16(0) << uint8(0) << uint8(i+8);
@@ -22157,13 +22162,13 @@ bool Player::IsVisibleGloballyFor(Player* u) const
 }
 
 template<class T>
-inline void UpdateVisibilityOf_helper(std::set<uint64>& s64, T* target, std::set<Unit*>& /*v*/)
+inline void UpdateVisibilityOf_helper(Player::ClientGUIDs& s64, T* target, std::set<Unit*>& /*v*/)
 {
     s64.insert(target->GetGUID());
 }
 
 template<>
-inline void UpdateVisibilityOf_helper(std::set<uint64>& s64, GameObject* target, std::set<Unit*>& /*v*/)
+inline void UpdateVisibilityOf_helper(Player::ClientGUIDs& s64, GameObject* target, std::set<Unit*>& /*v*/)
 {
     // Don't update only GAMEOBJECT_TYPE_TRANSPORT (or all transports and destructible buildings?)
     if (!target->IsTransport() && !target->IsDestructibleBuilding())
@@ -22171,14 +22176,14 @@ inline void UpdateVisibilityOf_helper(std::set<uint64>& s64, GameObject* target,
 }
 
 template<>
-inline void UpdateVisibilityOf_helper(std::set<uint64>& s64, Creature* target, std::set<Unit*>& v)
+inline void UpdateVisibilityOf_helper(Player::ClientGUIDs& s64, Creature* target, std::set<Unit*>& v)
 {
     s64.insert(target->GetGUID());
     v.insert(target);
 }
 
 template<>
-inline void UpdateVisibilityOf_helper(std::set<uint64>& s64, Player* target, std::set<Unit*>& v)
+inline void UpdateVisibilityOf_helper(Player::ClientGUIDs& s64, Player* target, std::set<Unit*>& v)
 {
     s64.insert(target->GetGUID());
     v.insert(target);
@@ -22289,12 +22294,105 @@ template void Player::UpdateVisibilityOf(Corpse*        target, UpdateData& data
 template void Player::UpdateVisibilityOf(GameObject*    target, UpdateData& data, std::set<Unit*>& visibleNow);
 template void Player::UpdateVisibilityOf(DynamicObject* target, UpdateData& data, std::set<Unit*>& visibleNow);
 
-void Player::UpdateVisibilityForPlayer()
+bool Player::CanUpdateVisibilityIncrementally(float sightRange) const
+{
+    if (!World::Visibility_IncrementalFullPassInterval)
+        return false;
+
+    if (!m_visibilityCenterValid || m_visibilityIncrementalPasses >= World::Visibility_IncrementalFullPassInterval)
+        return false;
+
+    // farsight, ghost corpse visibility and transport passengers are not bound to our own cells
+    if (m_seer != this || isDead() || GetTransport())
+        return false;
+
+    if (m_visibilityCenterRange != sightRange)
+        return false;
+
+    // views do not overlap, nothing to gain
+    return GetExactDist2d(&m_visibilityCenter) < sightRange;
+}
+
+void Player::UpdateVisibilityForPlayer(bool relocated /*= false*/)
+{
+    float sightRange = GetSightRange();
+
+    // phase, stealth detection and gm visibility changes affect objects anywhere in the view
+    if (relocated && CanUpdateVisibilityIncrementally(sightRange))
+    {
+        // recheck only cells near us and on the edges of the old and new view,
+        // objects deep inside both views can't change visibility by our own move
+        Trinity::VisibleNotifier notifier(*this, true);
+        GetMap()->VisitVisibilityDelta(m_visibilityCenter.GetPositionX(), m_visibilityCenter.GetPositionY(), GetPositionX(), GetPositionY(),
+            sightRange, MAX_PLAYER_STEALTH_DETECT_RANGE, notifier);
+        notifier.SendToSelf();
+        ++m_visibilityIncrementalPasses;
+    }
+    else
+    {
+        // updates visibility of all objects around point of view for current player
+        Trinity::VisibleNotifier notifier(*this);
+        m_seer->VisitNearbyObject(sightRange, notifier, true);
+        notifier.SendToSelf();   // send gathered data
+        m_visibilityIncrementalPasses = 0;
+    }
+
+    m_visibilityCenter.Relocate(m_seer);
+    m_visibilityCenterRange = sightRange;
+    m_visibilityCenterValid = true;
+
+    UpdateVisibilityDensity();
+}
+
+void Player::UpdateVisibilityDensity()
+{
+    uint32 threshold = GetMap()->GetVisibilityDensityThreshold();
+    if (!threshold)
+    {
+        m_visibleUnitsCount = 0;
+        m_denseVisibility = false;
+        return;
+    }
+
+    uint32 count = 0;
+    for (ClientGUIDs::const_iterator itr = m_clientGUIDs.begin(); itr != m_clientGUIDs.end(); ++itr)
+        if (IS_UNIT_GUID(*itr))
+            ++count;
+
+    m_visibleUnitsCount = count;
+    m_denseVisibility = count > threshold;
+}
+
+bool Player::IsVisibilityThrottledFor(WorldObject const* target) const
 {
-    // updates visibility of all objects around point of view for current player
-    Trinity::VisibleNotifier notifier(*this);
-    m_seer->VisitNearbyObject(GetSightRange(), notifier, true);
-    notifier.SendToSelf();   // send gathered data
+    if (!m_denseVisibility || target == this)
+        return false;
+
+    // what happens close to us is always sent at full rate
+    float nearDist = World::Visibility_DensityNearDistance;
+    if (GetExactDist2dSq(target) < nearDist * nearDist)
+        return false;
+
+    if (target->GetGUID() == GetSelection())
+        return false;
+
+    if (Unit const* unit = target->ToUnit())
+    {
+        // group members, their pets and our own pets, and anything fighting us
+        if (Player* player = unit->GetCharmerOrOwnerPlayerOrPlayerItself())
+            if (IsInSameRaidWith(player))
+                return false;
+
+        if (unit->getVictim() == this)
+            return false;
+    }
+    else if (GameObject const* go = target->ToGameObject())
+    {
+        if (go->GetOwnerGUID() == GetGUID())
+            return false;
+    }
+
+    return true;
 }
 
 void Player::InitPrimaryProfessions()
@@ -23076,7 +23174,7 @@ void Player::UpdateForQuestWorldObjects()
             {
                 //! This code doesn't look right, but it was logically converted to condition system to do the exact
                 //! same thing it did before. It definitely needs to be overlooked for intended functionality.
-                ConditionList conds = sConditionMgr->GetConditionsForSpellClickEvent(obj->GetEntry(), _itr->second.spellId);
+                ConditionList const& conds = sConditionMgr->GetConditionsForSpellClickEvent(obj->GetEntry(), _itr->second.spellId);
                 bool buildUpdateBlock = false;
                 for (ConditionList::const_iterator jtr = conds.begin(); jtr != conds.end() && !buildUpdateBlock; ++jtr)
                     if ((*jtr)->ConditionType == CONDITION_QUESTREWARDED || (*jtr)->ConditionType == CONDITION_QUESTTAKEN)
@@ -23965,6 +24063,7 @@ void Player::SetViewpoint(WorldObject* target, bool apply)
 
         //must immediately set seer back otherwise may crash
         m_seer = this;
+        ResetVisibilityCenter();
 
         WorldPacket data(SMSG_CLEAR_FAR_SIGHT_IMMEDIATE, 0);
         GetSession()->SendPacket(&data);
@@ -25127,7 +25226,7 @@ bool Player::canSeeSpellClickOn(Creature const* c) const
         if (!itr->second.IsFitToRequirements(this, c))
             return false;
 
-        ConditionList conds = sConditionMgr->GetConditionsForSpellClickEvent(c->GetEntry(), itr->second.spellId);
+        ConditionList const& conds = sConditionMgr->GetConditionsForSpellClickEvent(c->GetEntry(), itr->second.spellId);
         ConditionSourceInfo info = ConditionSourceInfo(const_cast<Player*>(this), const_cast<Creature*>(c));
         if (sConditionMgr->IsObjectMeetToConditions(info, conds))
             return true;
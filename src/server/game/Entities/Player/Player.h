@@ -2673,7 +2673,7 @@ class Player : public Unit, public GridObject<Player>
 
         bool SetHover(bool enable);
 
-        void SetSeer(WorldObject* target) { m_seer = target; }
+        void SetSeer(WorldObject* target) { m_seer = target; ResetVisibilityCenter(); }
         void SetViewpoint(WorldObject* target, bool apply);
         WorldObject* GetViewpoint() const;
         void StopCastingCharm();
@@ -2745,7 +2745,7 @@ class Player : public Unit, public GridObject<Player>
         void SendPetTameResult(PetTameResult result);
 
         // currently visible objects at player client
-        typedef std::set<uint64> ClientGUIDs;
+        typedef UNORDERED_SET<uint64> ClientGUIDs;
         ClientGUIDs m_clientGUIDs;
 
         bool HaveAtClient(WorldObject const* u) const { return u == this || m_clientGUIDs.find(u->GetGUID()) != m_clientGUIDs.end(); }
@@ -2755,7 +2755,13 @@ class Player : public Unit, public GridObject<Player>
         bool IsVisibleGloballyFor(Player* player) const;
 
         void SendInitialVisiblePackets(Unit* target);
-        void UpdateVisibilityForPlayer();
+        /// relocated: called for our own move, which may only recheck the cells our view gained or lost
+        void UpdateVisibilityForPlayer(bool relocated = false);
+        void ResetVisibilityCenter() { m_visibilityCenterValid = false; }
+        // crowded areas: far objects get merged values updates and fewer movement heartbeats
+        uint32 GetVisibleUnitsCount() const { return m_visibleUnitsCount; }
+        bool IsInDenseVisibilityArea() const { return m_denseVisibility; }
+        bool IsVisibilityThrottledFor(WorldObject const* target) const;
         void UpdateVisibilityOf(WorldObject* target);
         void UpdateTriggerVisibility();
 
@@ -3146,8 +3152,8 @@ class Player : public Unit, public GridObject<Player>
         void _LoadInventory(PreparedQueryResult result, uint32 timeDiff);
         void _LoadVoidStorage(PreparedQueryResult result);
         void _LoadMailInit(PreparedQueryResult resultUnread, PreparedQueryResult resultDelivery);
-        void _LoadMail();
-        void _LoadMailedItems(Mail* mail);
+        void _LoadMail(PreparedQueryResult result);
+        void _LoadMailedItem(Mail* mail, Field* fields);
         void _LoadQuestStatus(PreparedQueryResult result);
         void _LoadQuestStatusRewarded(PreparedQueryResult result);
         void _LoadDailyQuestStatus(PreparedQueryResult result);
@@ -3399,6 +3405,16 @@ class Player : public Unit, public GridObject<Player>
 
         MapReference m_mapRef;
 
+        // point of view and sight range used by the last visibility update, base for incremental updates
+        bool CanUpdateVisibilityIncrementally(float sightRange) const;
+        Position m_visibilityCenter;
+        float m_visibilityCenterRange;
+        bool m_visibilityCenterValid;
+        uint32 m_visibilityIncrementalPasses;
+        void UpdateVisibilityDensity();
+        uint32 m_visibleUnitsCount;
+        bool m_denseVisibility;
+
         void UpdateCharmedAI();
 
         uint32 m_lastFallTime;
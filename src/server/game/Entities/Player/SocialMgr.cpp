@@ -31,6 +31,7 @@
 PlayerSocial::PlayerSocial()
 {
     m_playerGUID = 0;
+    m_ignoreMask = 0;
 }
 
 PlayerSocial::~PlayerSocial()
@@ -80,6 +81,9 @@ bool PlayerSocial::AddToSocialList(uint32 friendGuid, bool ignore)
         fi.Flags |= flag;
         m_playerSocialMap[friendGuid] = fi;
     }
+
+    if (ignore)
+        m_ignoreMask |= UI64LIT(1) << (friendGuid % 64);
     return true;
 }
 
@@ -101,6 +105,9 @@ void PlayerSocial::RemoveFromSocialList(uint32 friendGuid, bool ignore)
     }
     else
         CharacterDatabase.PExecute("UPDATE character_social SET flags = (flags & ~%u) WHERE guid = '%u' AND friend = '%u'", flag, GetPlayerGUID(), friendGuid);
+
+    if (ignore)
+        UpdateIgnoreMask();
 }
 
 void PlayerSocial::SetFriendNote(uint32 friendGuid, std::string note)
@@ -160,12 +167,31 @@ bool PlayerSocial::HasFriend(uint32 friend_guid)
 
 bool PlayerSocial::HasIgnore(uint32 ignore_guid)
 {
+    // channel messages ask every member, most ignore nobody
+    if (!(m_ignoreMask & (UI64LIT(1) << (ignore_guid % 64))))
+        return false;
+
     PlayerSocialMap::const_iterator itr = m_playerSocialMap.find(ignore_guid);
     if (itr != m_playerSocialMap.end())
         return itr->second.Flags & SOCIAL_FLAG_IGNORED;
     return false;
 }
 
+void PlayerSocial::UpdateIgnoreMask()
+{
+    m_ignoreMask = 0;
+    for (PlayerSocialMap::const_iterator itr = m_playerSocialMap.begin(); itr != m_playerSocialMap.end(); ++itr)
+        if (itr->second.Flags & SOCIAL_FLAG_IGNORED)
+            m_ignoreMask |= UI64LIT(1) << (itr->first % 64);
+}
+
+void PlayerSocial::GetIgnoredGuids(std::set<uint32>& ignored) const
+{
+    for (PlayerSocialMap::const_iterator itr = m_playerSocialMap.begin(); itr != m_playerSocialMap.end(); ++itr)
+        if (itr->second.Flags & SOCIAL_FLAG_IGNORED)
+            ignored.insert(itr->first);
+}
+
 SocialMgr::SocialMgr()
 {
 }
@@ -317,6 +343,7 @@ PlayerSocial* SocialMgr::LoadFromDB(PreparedQueryResult result, uint32 guid)
     }
     while (result->NextRow());
 
+    social->UpdateIgnoreMask();
     return social;
 }
 
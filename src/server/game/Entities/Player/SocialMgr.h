@@ -116,12 +116,16 @@ class PlayerSocial
         // Misc
         bool HasFriend(uint32 friend_guid);
         bool HasIgnore(uint32 ignore_guid);
+        void GetIgnoredGuids(std::set<uint32>& ignored) const;
         uint32 GetPlayerGUID() const { return m_playerGUID; }
         void SetPlayerGUID(uint32 guid) { m_playerGUID = guid; }
         uint32 GetNumberOfSocialsWithFlag(SocialFlag flag);
     private:
+        void UpdateIgnoreMask();
+
         PlayerSocialMap m_playerSocialMap;
         uint32 m_playerGUID;
+        uint64 m_ignoreMask;                                // bit guid % 64 of every ignored guid, checked before the map
 };
 
 class SocialMgr
@@ -2891,6 +2891,9 @@ void Unit::SetCurrentCastedSpell(Spell* pSpell)
 {
     ASSERT(pSpell);                                         // NULL may be never passed here, use InterruptSpell or InterruptNonMeleeSpells
 
+    if (Creature* creature = ToCreature())
+        creature->WakeUp();
+
     CurrentSpellTypes CSpellType = pSpell->GetCurrentContainer();
 
     if (pSpell == m_currentSpells[CSpellType])             // avoid breaking self
@@ -3235,6 +3238,9 @@ void Unit::_AddAura(UnitAura* aura, Unit* caster)
 {
     ASSERT(!m_cleanupDone);
 
+    if (Creature* creature = ToCreature())
+        creature->WakeUp();
+
     // temporary hack: dynamic auras should be updated from dynobject::update
     if (!aura->GetSpellInfo()->HasPersistenAura())
         m_ownedAuras.insert(AuraMap::value_type(aura->GetId(), aura));
@@ -14613,6 +14619,9 @@ void Unit::SetInCombatState(bool PvP, Unit* enemy, bool isControlled)
     if (PvP)
         m_CombatTimer = 5000;
 
+    if (Creature* creature = ToCreature())
+        creature->WakeUp();
+
     if (isInCombat() || HasUnitState(UNIT_STATE_EVADE))
         return;
 
@@ -16528,6 +16537,10 @@ void Unit::SetLevel(uint8 lvl)
 
 void Unit::SetHealth(uint32 val)
 {
+    // health to regenerate
+    if (Creature* creature = ToCreature())
+        creature->WakeUp();
+
     if (getDeathState() == JUST_DIED)
         val = 0;
     else if (GetTypeId() == TYPEID_PLAYER && getDeathState() == DEAD)
@@ -16614,6 +16627,10 @@ void Unit::SetPower(Powers power, int32 val)
     if (maxPower < val)
         val = maxPower;
 
+    // power to regenerate
+    if (Creature* creature = ToCreature())
+        creature->WakeUp();
+
     SetInt32Value(UNIT_FIELD_POWER1 + powerIndex, val);
 
     if (IsInWorld())
@@ -17324,7 +17341,7 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* target, uint32 procFlag, u
         }
 
         // do checks using conditions table
-        ConditionList conditions = sConditionMgr->GetConditionsForNotGroupedEntry(CONDITION_SOURCE_TYPE_SPELL_PROC, spellProto->Id);
+        ConditionList const& conditions = sConditionMgr->GetConditionsForNotGroupedEntry(CONDITION_SOURCE_TYPE_SPELL_PROC, spellProto->Id);
         ConditionSourceInfo condInfo = ConditionSourceInfo(eventInfo.GetActor(), eventInfo.GetActionTarget());
         if (!sConditionMgr->IsObjectMeetToConditions(condInfo, conditions))
             continue;
@@ -19988,16 +20005,17 @@ public:
 class Unit::VisibilityUpdateTask : public BasicEvent
 {
     Unit& m_owner;
+    bool m_relocated;
 public:
-    explicit VisibilityUpdateTask(Unit * me) : m_owner(*me) {}
+    VisibilityUpdateTask(Unit * me, bool relocated) : m_owner(*me), m_relocated(relocated) {}
 
     virtual bool Execute(uint64 , uint32) 
     {
-        UpdateVisibility(&m_owner);
+        UpdateVisibility(&m_owner, m_relocated);
         return true;
     }
 
-    static void UpdateVisibility(Unit* me)
+    static void UpdateVisibility(Unit* me, bool relocated)
     {
         if (!me->m_sharedVision.empty())
             for (SharedVisionList::const_iterator it = me->m_sharedVision.begin();it!= me->m_sharedVision.end();)
@@ -20007,7 +20025,7 @@ public:
                 tmp->UpdateVisibilityForPlayer();
             }
         if (me->isType(TYPEMASK_PLAYER))
-            ((Player*)me)->UpdateVisibilityForPlayer();
+            ((Player*)me)->UpdateVisibilityForPlayer(relocated);
         me->WorldObject::UpdateObjectVisibility(true);
     }
 };
@@ -20016,7 +20034,7 @@ void Unit::OnRelocated()
 {
     if (!m_lastVisibilityUpdPos.IsInDist(this, World::Visibility_RelocationLowerLimit)) {
         m_lastVisibilityUpdPos = *this;
-        m_Events.AddEvent(new VisibilityUpdateTask(this), m_Events.CalculateTime(1));
+        m_Events.AddEvent(new VisibilityUpdateTask(this, true), m_Events.CalculateTime(1));
     }
     AINotifyTask::ScheduleAINotify(this);
 }
@@ -20024,9 +20042,9 @@ void Unit::OnRelocated()
 void Unit::UpdateObjectVisibility(bool forced)
 {
     if (forced)
-        VisibilityUpdateTask::UpdateVisibility(this);
+        VisibilityUpdateTask::UpdateVisibility(this, false);
     else
-        m_Events.AddEvent(new VisibilityUpdateTask(this), m_Events.CalculateTime(1));
+        m_Events.AddEvent(new VisibilityUpdateTask(this, false), m_Events.CalculateTime(1));
     AINotifyTask::ScheduleAINotify(this);
 }
 
@@ -20634,7 +20652,7 @@ bool Unit::HandleSpellClick(Unit* clicker, int8 seatId)
             continue;
 
         //! Check database conditions
-        ConditionList conds = sConditionMgr->GetConditionsForSpellClickEvent(spellClickEntry, itr->second.spellId);
+        ConditionList const& conds = sConditionMgr->GetConditionsForSpellClickEvent(spellClickEntry, itr->second.spellId);
         ConditionSourceInfo info = ConditionSourceInfo(clicker, this);
         if (!sConditionMgr->IsObjectMeetToConditions(info, conds))
             continue;
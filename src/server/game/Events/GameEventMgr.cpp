@@ -30,6 +30,7 @@
 #include "BattlegroundMgr.h"
 #include "UnitAI.h"
 #include "GameObjectAI.h"
+#include "ConditionMgr.h"
 
 bool GameEventMgr::CheckOneGameEvent(uint16 entry) const
 {
@@ -108,6 +109,18 @@ uint32 GameEventMgr::NextCheck(uint16 entry) const
         return delay;
 }
 
+void GameEventMgr::AddActiveEvent(uint16 event_id)
+{
+    m_ActiveEvents.insert(event_id);
+    sConditionMgr->InvalidateWorldConditions();
+}
+
+void GameEventMgr::RemoveActiveEvent(uint16 event_id)
+{
+    m_ActiveEvents.erase(event_id);
+    sConditionMgr->InvalidateWorldConditions();
+}
+
 void GameEventMgr::StartInternalEvent(uint16 event_id)
 {
     if (event_id < 1 || event_id >= mGameEvent.size())
@@ -396,6 +409,7 @@ void GameEventMgr::LoadFromDB()
 
                 GuidList& crelist = mGameEventCreatureGuids[internal_event_id];
                 crelist.push_back(guid);
+                _eventCreatureGuids.insert(guid);
 
                 ++count;
             }
@@ -980,6 +994,7 @@ void GameEventMgr::Initialize()
 uint32 GameEventMgr::StartSystem()                           // return the next event delay in ms
 {
     m_ActiveEvents.clear();
+    sConditionMgr->InvalidateWorldConditions();
     uint32 delay = Update();
     isSystemInit = true;
     return delay;
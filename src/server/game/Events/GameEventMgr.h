@@ -121,10 +121,11 @@ class GameEventMgr
         uint32 GetNPCFlag(Creature* cr);
         uint32 GetNpcTextId(uint32 guid);
         uint16 GetEventIdForQuest(Quest const* quest) const;
+        bool IsCreatureInEvent(uint32 guid) const { return _eventCreatureGuids.find(guid) != _eventCreatureGuids.end(); }
     private:
         void SendWorldStateUpdate(Player* player, uint16 event_id);
-        void AddActiveEvent(uint16 event_id) { m_ActiveEvents.insert(event_id); }
-        void RemoveActiveEvent(uint16 event_id) { m_ActiveEvents.erase(event_id); }
+        void AddActiveEvent(uint16 event_id);
+        void RemoveActiveEvent(uint16 event_id);
         void ApplyNewEvent(uint16 event_id);
         void UnApplyEvent(uint16 event_id);
         void GameEventSpawn(int16 event_id);
@@ -173,6 +174,7 @@ class GameEventMgr
         GameEventNPCFlagMap mGameEventNPCFlags;
         ActiveEvents m_ActiveEvents;
         UNORDERED_MAP<uint32, uint16> _questToEventLinks;
+        std::set<uint32> _eventCreatureGuids;                          // spawns of every game_event_creature row
         bool isSystemInit;
     public:
         GameEventGuidMap  mGameEventCreatureGuids;
@@ -367,11 +367,13 @@ void ObjectAccessor::Update(uint32 /*diff*/)
 {
     UpdateDataMapType update_players;
 
-    while (!i_objects.empty())
+    // objects holding back updates for crowded observers queue themselves again for the next tick
+    std::set<Object*> objects;
+    objects.swap(i_objects);
+    for (std::set<Object*>::const_iterator itr = objects.begin(); itr != objects.end(); ++itr)
     {
-        Object* obj = *i_objects.begin();
+        Object* obj = *itr;
         ASSERT(obj && obj->IsInWorld());
-        i_objects.erase(i_objects.begin());
         obj->BuildUpdate(update_players);
     }
 
@@ -5369,7 +5369,7 @@ void ObjectMgr::ReturnOrDeleteOldMails(bool serverUp)
         if (serverUp)
             player = ObjectAccessor::FindPlayer((uint64)m->receiver);
 
-        if (player && player->m_mailsLoaded)
+        if (player && (player->m_mailsLoaded || player->GetSession()->IsLoadingMailbox()))
         {                                                   // this code will run very improbably (the time is between 4 and 5 am, in game is online a player, who has old mail
             // his in mailbox and he has already listed his mails)
             delete m;
@@ -5417,6 +5417,8 @@ void ObjectMgr::ReturnOrDeleteOldMails(bool serverUp)
                     stmt->setUInt32(1, itr2->item_guid);
                     CharacterDatabase.Execute(stmt);
                 }
+                sWorld->ModifyCharacterNameDataMailCount(m->receiver, -1);
+                sWorld->ModifyCharacterNameDataMailCount(m->sender, 1);
                 delete m;
                 ++returnedCount;
                 continue;
@@ -5426,6 +5428,7 @@ void ObjectMgr::ReturnOrDeleteOldMails(bool serverUp)
         stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_MAIL_BY_ID);
         stmt->setUInt32(0, m->messageID);
         CharacterDatabase.Execute(stmt);
+        sWorld->ModifyCharacterNameDataMailCount(m->receiver, -1);
         delete m;
         ++deletedCount;
     }
@@ -111,6 +111,9 @@ struct Cell
     template<class T, class CONTAINER> void Visit(CellCoord const&, TypeContainerVisitor<T, CONTAINER>& visitor, Map &, float, float, float) const;
 
     static CellArea CalculateCellArea(float x, float y, float radius);
+    // squared 2d distances from point to the nearest and the farthest point of cell
+    static float GetNearestDistSq(CellCoord const& cellCoord, float x, float y);
+    static float GetFarthestDistSq(CellCoord const& cellCoord, float x, float y);
 
 private:
     template<class T, class CONTAINER> void VisitCircle(TypeContainerVisitor<T, CONTAINER> &, Map &, CellCoord const&, CellCoord const&) const;
@@ -60,6 +60,26 @@ inline CellArea Cell::CalculateCellArea(float x, float y, float radius)
     return CellArea(centerX, centerY);
 }
 
+inline float Cell::GetNearestDistSq(CellCoord const& cellCoord, float x, float y)
+{
+    float minX = (int32(cellCoord.x_coord) - CENTER_GRID_CELL_ID) * SIZE_OF_GRID_CELL;
+    float minY = (int32(cellCoord.y_coord) - CENTER_GRID_CELL_ID) * SIZE_OF_GRID_CELL;
+
+    float dx = x < minX ? minX - x : (x > minX + SIZE_OF_GRID_CELL ? x - minX - SIZE_OF_GRID_CELL : 0.0f);
+    float dy = y < minY ? minY - y : (y > minY + SIZE_OF_GRID_CELL ? y - minY - SIZE_OF_GRID_CELL : 0.0f);
+    return dx * dx + dy * dy;
+}
+
+inline float Cell::GetFarthestDistSq(CellCoord const& cellCoord, float x, float y)
+{
+    float minX = (int32(cellCoord.x_coord) - CENTER_GRID_CELL_ID) * SIZE_OF_GRID_CELL;
+    float minY = (int32(cellCoord.y_coord) - CENTER_GRID_CELL_ID) * SIZE_OF_GRID_CELL;
+
+    float dx = std::max(std::fabs(x - minX), std::fabs(x - minX - SIZE_OF_GRID_CELL));
+    float dy = std::max(std::fabs(y - minY), std::fabs(y - minY - SIZE_OF_GRID_CELL));
+    return dx * dx + dy * dy;
+}
+
 template<class T, class CONTAINER>
 inline void Cell::Visit(CellCoord const& standing_cell, TypeContainerVisitor<T, CONTAINER>& visitor, Map& map, float radius, float x_off, float y_off) const
 {
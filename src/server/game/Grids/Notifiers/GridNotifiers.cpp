@@ -33,6 +33,10 @@ using namespace Trinity;
 
 void VisibleNotifier::SendToSelf()
 {
+    Map::VisibilityStats& stats = i_player.GetMap()->GetVisibilityStats();
+    ++(i_incremental ? stats.IncrementalPasses : stats.FullPasses);
+    stats.ObjectsChecked += i_checked;
+
     // at this moment i_clientGUIDs have guids that not iterate at grid level checks
     // but exist one case when this possible and object not out of range: transports
     if (Transport* transport = i_player.GetTransport())
@@ -61,6 +65,9 @@ void VisibleNotifier::SendToSelf()
         }
     }
 
+    stats.ObjectsCreated += i_data.GetBlockCount();
+    stats.ObjectsDestroyed += i_data.GetOutOfRangeGUIDs().size();
+
     if (!i_data.HasData())
         return;
 
@@ -43,8 +43,15 @@ namespace Trinity
         UpdateData i_data;
         std::set<Unit*> i_visibleNow;
         Player::ClientGUIDs vis_guids;
+        bool i_incremental;
+        uint32 i_checked;
 
-        VisibleNotifier(Player &player) : i_player(player), i_data(player.GetMapId()), vis_guids(player.m_clientGUIDs) {}
+        // incremental notifier doesn't see the whole view, so it can't treat unvisited guids as out of range
+        VisibleNotifier(Player &player, bool incremental = false) : i_player(player), i_data(player.GetMapId()), i_incremental(incremental), i_checked(0)
+        {
+            if (!incremental)
+                vis_guids = player.m_clientGUIDs;
+        }
         template<class T> void Visit(GridRefManager<T> &m);
         void SendToSelf(void);
     };
@@ -88,6 +95,13 @@ namespace Trinity
         void Visit(CorpseMapType &m) { updateObjects<Corpse>(m); }
     };
 
+    enum MessageDeliverFlags
+    {
+        MESSAGE_DELIVER_LOW_PRIORITY    = 0x01,             // may be dropped for crowded observers
+        MESSAGE_DELIVER_BATCHED         = 0x02,             // queued to the observer's movement batch
+        MESSAGE_DELIVER_REPLACEABLE     = 0x04              // batched and outdated by the mover's next one
+    };
+
     struct MessageDistDeliverer
     {
         WorldObject* i_source;
@@ -96,10 +110,11 @@ namespace Trinity
         float i_distSq;
         uint32 team;
         Player const* skipped_receiver;
-        MessageDistDeliverer(WorldObject* src, WorldPacket* msg, float dist, bool own_team_only = false, Player const* skipped = NULL)
+        uint8 deliver_flags;                                // MessageDeliverFlags
+        MessageDistDeliverer(WorldObject* src, WorldPacket* msg, float dist, bool own_team_only = false, Player const* skipped = NULL, uint8 flags = 0)
             : i_source(src), i_message(msg), i_phaseMask(src->GetPhaseMask()), i_distSq(dist * dist)
             , team((own_team_only && src->GetTypeId() == TYPEID_PLAYER) ? ((Player*)src)->GetTeam() : 0)
-            , skipped_receiver(skipped)
+            , skipped_receiver(skipped), deliver_flags(flags)
         {
         }
         void Visit(PlayerMapType &m);
@@ -117,8 +132,23 @@ namespace Trinity
             if (!player->HaveAtClient(i_source))
                 return;
 
+            if ((deliver_flags & MESSAGE_DELIVER_LOW_PRIORITY) && player->IsVisibilityThrottledFor(i_source))
+            {
+                ++i_source->GetMap()->GetVisibilityStats().MessagesSkipped;
+                return;
+            }
+
             if (WorldSession* session = player->GetSession())
-                session->SendPacket(i_message);
+            {
+                if (deliver_flags & MESSAGE_DELIVER_BATCHED)
+                    session->QueueMovementPacket(i_source->GetGUID(), i_message, deliver_flags & MESSAGE_DELIVER_REPLACEABLE);
+                else
+                {
+                    // teleports, speed changes, knockbacks and casts must not overtake the source's batched movement
+                    session->FlushMovementBatch(i_source->GetGUID());
+                    session->SendPacket(i_message);
+                }
+            }
         }
     };
 
@@ -163,7 +193,9 @@ namespace Trinity
     struct ObjectUpdater
     {
         uint32 i_timeDiff;
-        explicit ObjectUpdater(const uint32 diff) : i_timeDiff(diff) {}
+        uint32 i_awakeCreatures;
+        uint32 i_dormantCreatures;
+        explicit ObjectUpdater(const uint32 diff) : i_timeDiff(diff), i_awakeCreatures(0), i_dormantCreatures(0) {}
         template<class T> void Visit(GridRefManager<T> &m);
         void Visit(PlayerMapType &) {}
         void Visit(CorpseMapType &) {}
@@ -32,16 +32,30 @@ inline void Trinity::VisibleNotifier::Visit(GridRefManager<T> &m)
 {
     for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
     {
-        vis_guids.erase(iter->getSource()->GetGUID());
+        if (!i_incremental)
+            vis_guids.erase(iter->getSource()->GetGUID());
         i_player.UpdateVisibilityOf(iter->getSource(), i_data, i_visibleNow);
+        ++i_checked;
     }
 }
 
 inline void Trinity::ObjectUpdater::Visit(CreatureMapType &m)
 {
     for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-        if (iter->getSource()->IsInWorld())
-            iter->getSource()->Update(i_timeDiff);
+    {
+        Creature* creature = iter->getSource();
+        if (!creature->IsInWorld())
+            continue;
+
+        if (creature->SkipUpdate(i_timeDiff))
+        {
+            ++i_dormantCreatures;
+            continue;
+        }
+
+        ++i_awakeCreatures;
+        creature->Update(i_timeDiff);
+    }
 }
 
 // SEARCHERS & LIST SEARCHERS & WORKERS
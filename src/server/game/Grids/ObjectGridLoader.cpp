@@ -88,13 +88,20 @@ void AddObjectHelper(CellCoord &cell, GridRefManager<T> &m, uint32 &count, Map*
     ++count;
 }
 
+// dead creatures the map respawns unloaded are only created at their respawn
+template <class T> bool IsSpawnDeferred(Map* /*map*/, uint32 /*guid*/) { return false; }
+template <> bool IsSpawnDeferred<Creature>(Map* map, uint32 guid) { return map->DeferCreatureSpawn(guid); }
+
 template <class T>
 void LoadHelper(CellGuidSet const& guid_set, CellCoord &cell, GridRefManager<T> &m, uint32 &count, Map* map)
 {
     for (CellGuidSet::const_iterator i_guid = guid_set.begin(); i_guid != guid_set.end(); ++i_guid)
     {
-        T* obj = new T;
         uint32 guid = *i_guid;
+        if (IsSpawnDeferred<T>(map, guid))
+            continue;
+
+        T* obj = new T;
         //sLog->outInfo(LOG_FILTER_GENERAL, "DEBUG: LoadHelper from table: %s for (guid: %u) Loading", table, guid);
         if (!obj->LoadFromDB(guid, map))
         {
@@ -163,30 +170,33 @@ void ObjectWorldLoader::Visit(CorpseMapType &m)
 void ObjectGridLoader::LoadN(void)
 {
     i_gameObjects = 0; i_creatures = 0; i_corpses = 0;
-    i_cell.data.Part.cell_y = 0;
-    for (unsigned int x=0; x < MAX_NUMBER_OF_CELLS; ++x)
+    LoadCells(0, MAX_NUMBER_OF_CELLS * MAX_NUMBER_OF_CELLS);
+    sLog->outDebug(LOG_FILTER_MAPS, "%u GameObjects, %u Creatures, and %u Corpses/Bones loaded for grid %u on map %u", i_gameObjects, i_creatures, i_corpses, i_grid.GetGridId(), i_map->GetId());
+}
+
+void ObjectGridLoader::LoadCells(uint32 first, uint32 last)
+{
+    for (uint32 i = first; i < last; ++i)
     {
+        uint32 x = i / MAX_NUMBER_OF_CELLS;
+        uint32 y = i % MAX_NUMBER_OF_CELLS;
         i_cell.data.Part.cell_x = x;
-        for (unsigned int y=0; y < MAX_NUMBER_OF_CELLS; ++y)
+        i_cell.data.Part.cell_y = y;
+
+        //Load creatures and game objects
         {
-            i_cell.data.Part.cell_y = y;
-
-            //Load creatures and game objects
-            {
-                TypeContainerVisitor<ObjectGridLoader, GridTypeMapContainer> visitor(*this);
-                i_grid.VisitGrid(x, y, visitor);
-            }
-
-            //Load corpses (not bones)
-            {
-                ObjectWorldLoader worker(*this);
-                TypeContainerVisitor<ObjectWorldLoader, WorldTypeMapContainer> visitor(worker);
-                i_grid.VisitGrid(x, y, visitor);
-                i_corpses += worker.i_corpses;
-            }
+            TypeContainerVisitor<ObjectGridLoader, GridTypeMapContainer> visitor(*this);
+            i_grid.VisitGrid(x, y, visitor);
+        }
+
+        //Load corpses (not bones)
+        {
+            ObjectWorldLoader worker(*this);
+            TypeContainerVisitor<ObjectWorldLoader, WorldTypeMapContainer> visitor(worker);
+            i_grid.VisitGrid(x, y, visitor);
+            i_corpses += worker.i_corpses;
         }
     }
-    sLog->outDebug(LOG_FILTER_MAPS, "%u GameObjects, %u Creatures, and %u Corpses/Bones loaded for grid %u on map %u", i_gameObjects, i_creatures, i_corpses, i_grid.GetGridId(), i_map->GetId());
 }
 
 template<class T>
@@ -42,6 +42,8 @@ class ObjectGridLoader
         void Visit(DynamicObjectMapType&) const {}
 
         void LoadN(void);
+        // loads the cells of index first to last excluded, index is cell x * MAX_NUMBER_OF_CELLS + cell y
+        void LoadCells(uint32 first, uint32 last);
 
         template<class T> static void SetObjectCell(T* obj, CellCoord const& cellCoord);
 
@@ -403,6 +403,7 @@ bool Guild::BankTab::LoadItemFromDB(Field* fields)
 
     pItem->AddToWorld();
     m_items[slotId] = pItem;
+    m_listDataValid = false;
     return true;
 }
 
@@ -459,6 +460,7 @@ bool Guild::BankTab::SetItem(SQLTransaction& trans, uint8 slotId, Item* item)
         return false;
 
     m_items[slotId] = item;
+    m_listDataValid = false;
 
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_GUILD_BANK_ITEM);
     stmt->setUInt32(0, m_guildId);
@@ -483,6 +485,60 @@ bool Guild::BankTab::SetItem(SQLTransaction& trans, uint8 slotId, Item* item)
     return true;
 }
 
+std::vector<uint8> const& Guild::BankTab::GetListEnchantCounts() const
+{
+    if (!m_listDataValid)
+        _UpdateListData();
+
+    return m_listEnchantCounts;
+}
+
+ByteBuffer const& Guild::BankTab::GetListData() const
+{
+    if (!m_listDataValid)
+        _UpdateListData();
+
+    return m_listData;
+}
+
+void Guild::BankTab::_UpdateListData() const
+{
+    m_listEnchantCounts.clear();
+    m_listData.clear();
+
+    for (uint8 slotId = 0; slotId < GUILD_BANK_MAX_SLOTS; ++slotId)
+    {
+        Item* tabItem = m_items[slotId];
+        if (!tabItem)
+            continue;
+
+        uint8 enchants = 0;
+        for (uint32 i = 0; i < MAX_GEM_SOCKETS; ++i)
+        {
+            if (uint32 enchantId = tabItem->GetEnchantmentId(EnchantmentSlot(SOCK_ENCHANTMENT_SLOT + i)))
+            {
+                m_listData << uint32(enchantId) << uint32(i);
+                ++enchants;
+            }
+        }
+
+        m_listEnchantCounts.push_back(enchants);
+
+        m_listData << uint32(0);
+        m_listData << uint32(0);
+        m_listData << uint32(0);
+        m_listData << uint32(tabItem->GetCount());                 // ITEM_FIELD_STACK_COUNT
+        m_listData << uint32(slotId);
+        m_listData << uint32(0);
+        m_listData << uint32(tabItem->GetEntry());
+        m_listData << uint32(tabItem->GetItemRandomPropertyId());
+        m_listData << uint32(abs(tabItem->GetSpellCharges()));     // Spell charges
+        m_listData << uint32(tabItem->GetItemSuffixFactor());      // SuffixFactor
+    }
+
+    m_listDataValid = true;
+}
+
 void Guild::BankTab::SendText(Guild const* guild, WorldSession* session) const
 {
     uint32 size = uint32(m_text.size());
@@ -509,6 +565,7 @@ void Guild::Member::SetStats(Player* player)
     m_accountId = player->GetSession()->GetAccountId();
 
     m_achievementPoints = player->GetAchievementMgr().GetAchievementPoints();
+    m_rosterDirty = true;
 
     uint8 maxProf = 2;
     uint32 prev_skill = 0;
@@ -571,6 +628,7 @@ void Guild::Member::SetStats(const std::string& name, uint8 level, uint8 _class,
     m_class     = _class;
     m_zoneId    = zoneId;
     m_accountId = accountId;
+    m_rosterDirty = true;
 
     for (uint8 i = 0; i < 2; ++i)
         SetProfession(i, 0, 0, 0);
@@ -582,6 +640,7 @@ void Guild::Member::SetPublicNote(const std::string& publicNote)
         return;
 
     m_publicNote = publicNote;
+    m_rosterDirty = true;
 
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_UPD_GUILD_MEMBER_PNOTE);
     stmt->setString(0, publicNote);
@@ -595,6 +654,7 @@ void Guild::Member::SetOfficerNote(const std::string& officerNote)
         return;
 
     m_officerNote = officerNote;
+    m_rosterDirty = true;
 
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_UPD_GUILD_MEMBER_OFFNOTE);
     stmt->setString(0, officerNote);
@@ -605,6 +665,7 @@ void Guild::Member::SetOfficerNote(const std::string& officerNote)
 void Guild::Member::ChangeRank(uint8 newRank)
 {
     m_rankId = newRank;
+    m_rosterDirty = true;
 
     // Update rank information in player's field, if he is online.
     if (Player* player = FindPlayer())
@@ -667,6 +728,82 @@ bool Guild::Member::LoadFromDB(Field* fields, uint32 lowGuid)
     return true;
 }
 
+ByteBuffer const& Guild::Member::GetRosterData(uint32 weeklyRepCap, time_t now)
+{
+    Player* player = FindPlayer();
+
+    RosterState state;
+    state.weeklyRepCap = weeklyRepCap;
+    if (player)
+    {
+        state.reputation = player->GetReputation(1168);
+        state.zoneId = player->GetZoneId();
+        state.level = player->getLevel();
+        state.gender = player->getGender();
+        state.flags = GUILDMEMBER_STATUS_ONLINE;
+        if (player->isAFK())
+            state.flags |= GUILDMEMBER_STATUS_AFK;
+        if (player->isDND())
+            state.flags |= GUILDMEMBER_STATUS_DND;
+    }
+    else
+    {
+        state.zoneId = GetZone();
+        state.level = GetLevel();
+    }
+
+    if (m_rosterDirty || state != m_rosterState)
+    {
+        ObjectGuid guid = m_guid;
+        m_rosterData.clear();
+
+        m_rosterData << uint8(m_class);
+        m_rosterData << int32(state.reputation);
+        m_rosterData.WriteByteSeq(guid[0]);
+        m_rosterData << uint64(m_xpContribWeek);
+        m_rosterData << uint32(m_rankId);
+        m_rosterData << uint32(m_achievementPoints);
+
+        for (uint8 i = 0; i < 2; ++i)
+        {
+            m_rosterData << uint32(_professions[i].rank);
+            m_rosterData << uint32(_professions[i].value);
+            m_rosterData << uint32(_professions[i].skillId);
+        }
+
+        m_rosterData.WriteByteSeq(guid[2]);
+        m_rosterData << uint8(state.flags);
+        m_rosterData << uint32(state.zoneId);
+        m_rosterData << uint64(m_xpContrib);
+        m_rosterData.WriteByteSeq(guid[7]);
+        m_rosterData << uint32(weeklyRepCap - m_week_rep);          // Remaining guild week Rep
+
+        m_rosterData << WriteBuffer(m_publicNote.c_str(), m_publicNote.length());
+
+        m_rosterData.WriteByteSeq(guid[3]);
+        m_rosterData << uint8(state.level);
+        m_rosterData << int32(0);                                   // unk
+        m_rosterData.WriteByteSeq(guid[5]);
+        m_rosterData.WriteByteSeq(guid[4]);
+        m_rosterData << uint8(state.gender);
+        m_rosterData.WriteByteSeq(guid[1]);
+        m_rosterLogoutPos = m_rosterData.wpos();
+        m_rosterData << float(0.0f);                                // Days offline
+
+        m_rosterData << WriteBuffer(m_officerNote.c_str(), m_officerNote.length());
+        m_rosterData.WriteByteSeq(guid[6]);
+        m_rosterData << WriteBuffer(m_name.c_str(), m_name.length());
+
+        m_rosterState = state;
+        m_rosterDirty = false;
+    }
+
+    if (!player)
+        m_rosterData.put<float>(m_rosterLogoutPos, float(float(now - m_logoutTime) / DAY));
+
+    return m_rosterData;
+}
+
 // Validate player fields. Returns false if corrupted fields are found.
 bool Guild::Member::CheckStats() const
 {
@@ -736,6 +873,7 @@ uint32 Guild::Member::GetBankRemainingValue(uint8 tabId, const Guild* guild) con
 void Guild::Member::SetAchievementPoints(uint32 val, uint32 lowGuid, bool saveData)
 {
     m_achievementPoints = val;
+    m_rosterDirty = true;
     if (saveData)
     {
         PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_UPD_GUILD_MEMBER_ACHIEVEMENTS);
@@ -1195,6 +1333,9 @@ void Guild::Disband()
         DeleteMember(itr->second->GetGUID(), true);
     }
 
+    // Unsaved event log records, the logs are deleted below
+    m_eventLogTrans = SQLTransaction(NULL);
+
     PreparedStatement* stmt = NULL;
     SQLTransaction trans = CharacterDatabase.BeginTransaction();
     stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_GUILD);
@@ -1248,6 +1389,12 @@ void Guild::SaveToDB()
 
     m_achievementMgr.SaveToDB(trans);
 
+    if (!m_eventLogTrans.null())
+    {
+        CharacterDatabase.CommitTransaction(m_eventLogTrans);
+        m_eventLogTrans = SQLTransaction(NULL);
+    }
+
     CharacterDatabase.CommitTransaction(trans);
 }
 
@@ -1288,7 +1435,6 @@ void Guild::HandleRoster(WorldSession* session /*= NULL*/)
     for (Members::const_iterator itr = m_members.begin(); itr != m_members.end(); ++itr)
     {
         Member* member = itr->second;
-        Player* player = member->FindPlayer();
 
         uint32 nameSize = uint32(member->GetName().length());
         uint32 pubNoteLength = uint32(member->GetPublicNote().length());
@@ -1309,51 +1455,7 @@ void Guild::HandleRoster(WorldSession* session /*= NULL*/)
         data.WriteByteMask(guid[5]);
         data.WriteByteMask(guid[7]);
 
-        uint8 flags = GUILDMEMBER_STATUS_NONE;
-        if (player)
-        {
-            flags |= GUILDMEMBER_STATUS_ONLINE;
-            if (player->isAFK())
-                flags |= GUILDMEMBER_STATUS_AFK;
-            if (player->isDND())
-                flags |= GUILDMEMBER_STATUS_DND;
-        }
-
-        memberData << uint8(member->GetClass());
-        memberData << int32(player ? player->GetReputation(1168) : 0);
-        memberData.WriteByteSeq(guid[0]);
-        memberData << uint64(member->GetXPContribWeek());
-        memberData << uint32(member->GetRankId());
-        memberData << uint32(member->GetAchievementPoints());                                    // player->GetAchievementMgr().GetCompletedAchievementsAmount()
-
-        for (uint8 i = 0; i < 2; ++i)
-        {
-            memberData << uint32(member->GetProfession(i).rank);
-            memberData << uint32(member->GetProfession(i).value);
-            memberData << uint32(member->GetProfession(i).skillId);
-        }
-
-        memberData.WriteByteSeq(guid[2]);
-        memberData << uint8(flags);
-        memberData << uint32(player ? player->GetZoneId() : member->GetZone());
-        memberData << uint64(member->GetXPContrib());
-        memberData.WriteByteSeq(guid[7]);
-        memberData << uint32(weeklyRepCap - member->GetWeeklyReputation()); // Remaining guild week Rep
-
-        memberData << WriteBuffer(member->GetPublicNote().c_str(), pubNoteLength);
-
-        memberData.WriteByteSeq(guid[3]);
-        memberData << uint8(player ? player->getLevel() : member->GetLevel());
-        memberData << int32(0);                                     // unk
-        memberData.WriteByteSeq(guid[5]);
-        memberData.WriteByteSeq(guid[4]);
-        memberData << uint8(player ? player->getGender() : 0);
-        memberData.WriteByteSeq(guid[1]);
-        memberData << float(player ? 0.0f : float(float(now - member->GetLogoutTime()) / DAY));
-
-        memberData << WriteBuffer(member->GetOfficerNote().c_str(), offNoteLength);
-        memberData.WriteByteSeq(guid[6]);
-        memberData << WriteBuffer(member->GetName().c_str(), nameSize);
+        memberData.append(member->GetRosterData(weeklyRepCap, now));
     }
 
     data.WriteBits(infoLength, 12);
@@ -2005,6 +2107,12 @@ bool Guild::HandleMemberWithdrawMoney(WorldSession* session, uint32 amount, bool
     return true;
 }
 
+void Guild::HandleMemberLogin(Player* player)
+{
+    if (Member* member = GetMember(player->GetGUID()))
+        member->SetOnline(true);
+}
+
 void Guild::HandleMemberLogout(WorldSession* session)
 {
     Player* player = session->GetPlayer();
@@ -2012,6 +2120,7 @@ void Guild::HandleMemberLogout(WorldSession* session)
     {
         member->SetStats(player);
         member->UpdateLogoutTime();
+        member->SetOnline(false);
     }
     _BroadcastEvent(GE_SIGNED_OFF, player->GetGUID(), player->GetName());
 
@@ -2072,52 +2181,21 @@ void Guild::SendBankLog(WorldSession* session, uint8 tabId) const
 
 void Guild::SendBankList(WorldSession* session, uint8 tabId, bool withContent, bool withTabInfo) const
 {
-    ByteBuffer tabData;
-    WorldPacket data(SMSG_GUILD_BANK_LIST, 500);
-    data.WriteBit(false);
-    uint32 itemCount = 0;
+    BankTab const* tab = NULL;
     if (withContent && _MemberHasTabRights(session->GetPlayer()->GetGUID(), tabId, GUILD_BANK_RIGHT_VIEW_TAB))
-        if (BankTab const* tab = GetBankTab(tabId))
-            for (uint8 slotId = 0; slotId < GUILD_BANK_MAX_SLOTS; ++slotId)
-                if (tab->GetItem(slotId))
-                    ++itemCount;
+        tab = GetBankTab(tabId);
 
-    data.WriteBits(itemCount, 20);
+    WorldPacket data(SMSG_GUILD_BANK_LIST, 500);
+    data.WriteBit(false);
+    data.WriteBits(tab ? tab->GetListEnchantCounts().size() : 0, 20);
     data.WriteBits(withTabInfo ? _GetPurchasedTabsSize() : 0, 22);
-    if (withContent && _MemberHasTabRights(session->GetPlayer()->GetGUID(), tabId, GUILD_BANK_RIGHT_VIEW_TAB))
+    if (tab)
     {
-        if (BankTab const* tab = GetBankTab(tabId))
+        std::vector<uint8> const& enchantCounts = tab->GetListEnchantCounts();
+        for (std::vector<uint8>::const_iterator itr = enchantCounts.begin(); itr != enchantCounts.end(); ++itr)
         {
-            for (uint8 slotId = 0; slotId < GUILD_BANK_MAX_SLOTS; ++slotId)
-            {
-                if (Item* tabItem = tab->GetItem(slotId))
-                {
-                    data.WriteBit(false);
-
-                    uint32 enchants = 0;
-                    for (uint32 i = 0; i < MAX_GEM_SOCKETS; ++i)
-                    {
-                        if (uint32 enchantId = tabItem->GetEnchantmentId(EnchantmentSlot(SOCK_ENCHANTMENT_SLOT + i)))
-                        {
-                            tabData << uint32(enchantId) << uint32(i);
-                            ++enchants;
-                        }
-                    }
-
-                    data.WriteBits(enchants, 23);
-
-                    tabData << uint32(0);
-                    tabData << uint32(0);
-                    tabData << uint32(0);
-                    tabData << uint32(tabItem->GetCount());                 // ITEM_FIELD_STACK_COUNT
-                    tabData << uint32(slotId);
-                    tabData << uint32(0);
-                    tabData << uint32(tabItem->GetEntry());
-                    tabData << uint32(tabItem->GetItemRandomPropertyId());
-                    tabData << uint32(abs(tabItem->GetSpellCharges()));     // Spell charges
-                    tabData << uint32(tabItem->GetItemSuffixFactor());      // SuffixFactor
-                }
-            }
+            data.WriteBit(false);
+            data.WriteBits(*itr, 23);
         }
     }
 
@@ -2139,8 +2217,8 @@ void Guild::SendBankList(WorldSession* session, uint8 tabId, bool withContent, b
     }
 
     data << uint64(m_bankMoney);
-    if (!tabData.empty())
-        data.append(tabData);
+    if (tab)
+        data.append(tab->GetListData());
 
     data << uint32(tabId);
     data << uint32(_GetMemberRemainingSlots(session->GetPlayer()->GetGUID(), 0));
@@ -2567,6 +2645,7 @@ bool Guild::AddMember(uint64 guid, uint8 rankId)
     // If player not in game data in will be loaded from guild tables, so no need to update it!
     if (player)
     {
+        member->SetOnline(true);
         player->SetInGuild(m_id);
         player->SetRank(rankId);
         player->SetGuildLevel(GetLevel());
@@ -2945,11 +3024,12 @@ inline bool Guild::_MemberHasTabRights(uint64 guid, uint8 tabId, uint32 rights)
 }
 
 // Add new event log record
+// Records are written with the next guild save, members logging out save the guild too
 inline void Guild::_LogEvent(GuildEventLogTypes eventType, uint32 playerGuid1, uint32 playerGuid2, uint8 newRank)
 {
-    SQLTransaction trans = CharacterDatabase.BeginTransaction();
-    m_eventLog->AddEvent(trans, new EventLogEntry(m_id, m_eventLog->GetNextGUID(), eventType, playerGuid1, playerGuid2, newRank));
-    CharacterDatabase.CommitTransaction(trans);
+    if (m_eventLogTrans.null())
+        m_eventLogTrans = CharacterDatabase.BeginTransaction();
+    m_eventLog->AddEvent(m_eventLogTrans, new EventLogEntry(m_id, m_eventLog->GetNextGUID(), eventType, playerGuid1, playerGuid2, newRank));
 }
 
 // Add new bank event log record
@@ -3126,6 +3206,9 @@ void Guild::_SendBankContentUpdate(uint8 tabId, SlotIds slots) const
 {
     if (BankTab const* tab = GetBankTab(tabId))
     {
+        // stacks are also split and merged in place, not only through SetItem
+        tab->InvalidateListData();
+
         ByteBuffer tabData;
         WorldPacket data(SMSG_GUILD_BANK_LIST, 1200);
         data.WriteBit(false);
@@ -346,8 +346,28 @@ private:
             uint32 skillId;
         };
 
+        // Roster values read from the online player
+        struct RosterState
+        {
+            RosterState() : weeklyRepCap(0), reputation(0), zoneId(0), flags(0), level(0), gender(0) { }
+
+            bool operator!=(RosterState const& right) const
+            {
+                return weeklyRepCap != right.weeklyRepCap || reputation != right.reputation || zoneId != right.zoneId ||
+                    flags != right.flags || level != right.level || gender != right.gender;
+            }
+
+            uint32 weeklyRepCap;
+            int32 reputation;
+            uint32 zoneId;
+            uint8 flags;
+            uint8 level;
+            uint8 gender;
+        };
+
     public:
-        Member(uint32 guildId, uint64 guid, uint32 rankId) : m_guildId(guildId), m_guid(guid), m_logoutTime(::time(NULL)), m_rankId(rankId) { }
+        Member(uint32 guildId, uint64 guid, uint32 rankId) : m_guildId(guildId), m_guid(guid), m_logoutTime(::time(NULL)), m_rankId(rankId),
+            m_online(false), m_rosterDirty(true), m_rosterLogoutPos(0) { }
 
         void SetStats(Player* player);
         void SetStats(const std::string& name, uint8 level, uint8 _class, uint32 zoneId, uint32 accountId);
@@ -373,14 +393,14 @@ private:
         const uint64& GetXPContrib() const { return m_xpContrib; }
         const uint64& GetXPContribWeek() const { return m_xpContribWeek; }
 
-        void AddXPContrib(uint64 value) { m_xpContrib += value; }
-        void AddXPContribWeek(uint64 value) { m_xpContribWeek += value; }
+        void AddXPContrib(uint64 value) { m_xpContrib += value; m_rosterDirty = true; }
+        void AddXPContribWeek(uint64 value) { m_xpContribWeek += value; m_rosterDirty = true; }
 
-        void ResetXPContribWeek() { m_xpContribWeek = 0LL; }
+        void ResetXPContribWeek() { m_xpContribWeek = 0LL; m_rosterDirty = true; }
 
         void ChangeRank(uint8 newRank);
 
-        inline void UpdateLogoutTime() { m_logoutTime = ::time(NULL); }
+        inline void UpdateLogoutTime() { m_logoutTime = ::time(NULL); m_rosterDirty = true; }
         inline bool IsRank(uint8 rankId) const { return m_rankId == rankId; }
         inline bool IsRankNotLower(uint8 rankId) const { return m_rankId <= rankId; }
         inline bool IsSamePlayer(uint64 guid) const { return m_guid == guid; }
@@ -391,10 +411,15 @@ private:
         void ResetTabTimes();
         void ResetMoneyTime();
 
-        inline Player* FindPlayer() const { return ObjectAccessor::FindPlayer(m_guid); }
+        // Set on login and logout, the offline members are not looked up
+        void SetOnline(bool online) { m_online = online; }
+        inline Player* FindPlayer() const { return m_online ? ObjectAccessor::FindPlayer(m_guid) : NULL; }
+
+        // The member part of SMSG_GUILD_ROSTER, rebuilt only when the member or its player changed
+        ByteBuffer const& GetRosterData(uint32 weeklyRepCap, time_t now);
 
         uint32 GetWeeklyReputation() const { return m_week_rep; }
-        void SetWeeklyReputation(uint32 val) { m_week_rep = val; }
+        void SetWeeklyReputation(uint32 val) { m_week_rep = val; m_rosterDirty = true; }
         
         void SetGuildReputation(uint32 rep)
         {
@@ -409,14 +434,15 @@ private:
             return 0;
         }
 
-        void SetZoneID(uint32 id) { m_zoneId = id; }
-        void SetLevel(uint8 var) { m_level = var; }
+        void SetZoneID(uint32 id) { m_zoneId = id; m_rosterDirty = true; }
+        void SetLevel(uint8 var) { m_level = var; m_rosterDirty = true; }
         void SetAchievementPoints(uint32 val, uint32 lowGuid, bool saveData = false);
         uint32 GetAchievementPoints() { return m_achievementPoints; }
 
         void SetProfession(uint8 index, uint16 value, uint32 skill, uint8 rank)
         {
             _professions[index] = Profession(skill, value, rank);
+            m_rosterDirty = true;
         }
 
         const Profession& GetProfession(uint8 index) const { return _professions[index]; }
@@ -444,6 +470,12 @@ private:
         Profession _professions[2];
 
         RemainingValue m_bankRemaining[GUILD_BANK_MAX_TABS + 1];
+
+        bool m_online;
+        bool m_rosterDirty;
+        RosterState m_rosterState;
+        ByteBuffer m_rosterData;
+        size_t m_rosterLogoutPos;                           // days offline, written on every roster
     };
 
     // News Log class
@@ -623,7 +655,7 @@ private:
     class BankTab
     {
     public:
-        BankTab(uint32 guildId, uint8 tabId) : m_guildId(guildId), m_tabId(tabId)
+        BankTab(uint32 guildId, uint8 tabId) : m_guildId(guildId), m_tabId(tabId), m_listDataValid(false)
         {
             memset(m_items, 0, GUILD_BANK_MAX_SLOTS * sizeof(Item*));
         }
@@ -643,7 +675,14 @@ private:
         inline Item* GetItem(uint8 slotId) const { return slotId < GUILD_BANK_MAX_SLOTS ?  m_items[slotId] : NULL; }
         bool SetItem(SQLTransaction& trans, uint8 slotId, Item* item);
 
+        // Item part of SMSG_GUILD_BANK_LIST, kept until a slot of the tab changes
+        std::vector<uint8> const& GetListEnchantCounts() const;  // One per item
+        ByteBuffer const& GetListData() const;
+        void InvalidateListData() const { m_listDataValid = false; }
+
     private:
+        void _UpdateListData() const;
+
         uint32 m_guildId;
         uint8 m_tabId;
 
@@ -651,6 +690,10 @@ private:
         std::string m_name;
         std::string m_icon;
         std::string m_text;
+
+        mutable bool m_listDataValid;
+        mutable std::vector<uint8> m_listEnchantCounts;
+        mutable ByteBuffer m_listData;
     };
 
     // Movement data
@@ -786,6 +829,7 @@ public:
     void HandleRemoveRank(WorldSession* session, uint32 rankId);
     void HandleMemberDepositMoney(WorldSession* session, uint32 amount, bool cashFlow = false);
     bool HandleMemberWithdrawMoney(WorldSession* session, uint32 amount, bool repair = false);
+    void HandleMemberLogin(Player* player);
     void HandleMemberLogout(WorldSession* session);
     void HandleDisband(WorldSession* session);
     void HandleGuildPartyRequest(WorldSession* session);
@@ -887,6 +931,7 @@ protected:
     // These are actually ordered lists. The first element is the oldest entry.
     LogHolder* m_eventLog;
     LogHolder* m_bankEventLog[GUILD_BANK_MAX_TABS + 1];
+    SQLTransaction m_eventLogTrans;                         // Event log records waiting for the next guild save
 
     AchievementMgr<Guild> m_achievementMgr;
     GuildNewsLog _newsLog;
@@ -22,6 +22,7 @@
 #include "ObjectMgr.h"
 #include "ArenaTeamMgr.h"
 #include "GuildMgr.h"
+#include "AchievementSaveBuffer.h"
 #include "SystemConfig.h"
 #include "World.h"
 #include "WorldPacket.h"
@@ -697,6 +698,7 @@ void WorldSession::HandleCharCreateCallback(PreparedQueryResult result, Characte
             // Player created, save it now
             newChar.SaveToDB(true);
             createInfo->CharCount += 1;
+            sWorld->SetRealmCharCount(GetAccountId(), createInfo->CharCount);
 
             WorldPacket data(SMSG_CHAR_CREATE, 1);
             data << uint8(CHAR_CREATE_SUCCESS);
@@ -811,6 +813,9 @@ void WorldSession::HandlePlayerLoginOpcode(WorldPacket& recvData)
         return;
     }
 
+    // queued before the login queries, which read the progress saved at the last logout
+    sAchievementSaveBuffer->Flush(ACHIEVEMENT_OWNER_PLAYER, GUID_LOPART(playerGuid));
+
     LoginQueryHolder *holder = new LoginQueryHolder(GetAccountId(), playerGuid);
     if (!holder->Initialize())
     {
@@ -997,7 +1002,10 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder* holder)
     if (pCurrChar->GetGuildId() != 0)
     {
         if (Guild* guild = sGuildMgr->GetGuildById(pCurrChar->GetGuildId()))
+        {
+            guild->HandleMemberLogin(pCurrChar);
             guild->SendLoginInfo(this);
+        }
         else
         {
             // remove wrong guild data
@@ -2017,7 +2025,8 @@ void WorldSession::HandleCharFactionOrRaceChange(WorldPacket& recvData)
             }
             trans->Append(stmt);
 
-            // Achievement conversion
+            // Achievement conversion, of the buffered achievements too
+            sAchievementSaveBuffer->Flush(ACHIEVEMENT_OWNER_PLAYER, lowGuid, trans);
             for (std::map<uint32, uint32>::const_iterator it = sObjectMgr->FactionChange_Achievements.begin(); it != sObjectMgr->FactionChange_Achievements.end(); ++it)
             {
                 uint32 achiev_alliance = it->first;
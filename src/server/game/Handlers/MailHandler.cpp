@@ -31,6 +31,7 @@
 #include "DBCStores.h"
 #include "Item.h"
 #include "AccountMgr.h"
+#include "Map.h"
 
 void WorldSession::HandleSendMail(WorldPacket& recvData)
 {
@@ -184,30 +185,26 @@ void WorldSession::HandleSendMail(WorldPacket& recvData)
     Player* receive = ObjectAccessor::FindPlayer(rc);
 
     uint32 rc_team = 0;
-    uint8 mails_count = 0;                                  //do not allow to send to one player more than 100 mails
+    uint32 mails_count = 0;                                 //do not allow to send to one player more than 100 mails
     uint8 receiveLevel = 0;
 
     if (receive)
     {
         rc_team = receive->GetTeam();
-        mails_count = receive->GetMailSize();
         receiveLevel = receive->getLevel();
+        if (receive->IsMailsLoaded())
+            mails_count = receive->GetMailSize();
     }
     else
-    {
         rc_team = sObjectMgr->GetPlayerTeamByGUID(rc);
 
-        if (QueryResult result = CharacterDatabase.PQuery("SELECT COUNT(*) FROM mail WHERE receiver = '%u'", GUID_LOPART(rc)))
-        {
-            Field* fields = result->Fetch();
-            mails_count = fields[0].GetUInt64();
-        }
-
-        if (QueryResult result = CharacterDatabase.PQuery("SELECT level FROM characters WHERE guid = '%u'", GUID_LOPART(rc)))	
-        {
-            Field* fields = result->Fetch();
-            receiveLevel = fields[0].GetUInt8();
-        }
+    // offline receivers and mailboxes not loaded yet are served from the character name data
+    if (CharacterNameData const* nameData = sWorld->GetCharacterNameData(GUID_LOPART(rc)))
+    {
+        if (!receive)
+            receiveLevel = nameData->m_level;
+        if (!receive || !receive->IsMailsLoaded())
+            mails_count = uint32(nameData->m_mailCount.value());
     }
     //do not allow to have more than 100 mails in mailbox.. mails count is in opcode uint8!!! - so max can be 255..
     if (mails_count > 100)
@@ -630,11 +627,20 @@ void WorldSession::HandleGetMailList(WorldPacket& recvData)
     if (!GetPlayer()->GetGameObjectIfCanInteractWith(mailbox, GAMEOBJECT_TYPE_MAILBOX) && !GetPlayer()->GetNPCIfCanInteractWith(mailbox,UNIT_NPC_FLAG_MAILBOX))
         return;
 
-    Player* player = _player;
+    //load players mails, and mailed items, the list is sent once they are loaded
+    if (!_player->m_mailsLoaded)
+    {
+        _mailListRequest = mailbox;
+        LoadMailbox();
+        return;
+    }
 
-    //load players mails, and mailed items
-    if (!player->m_mailsLoaded)
-        player->_LoadMail();
+    SendMailList();
+}
+
+void WorldSession::SendMailList()
+{
+    Player* player = _player;
 
     // client can't work with packets > max int16 value
     const uint32 maxPacketSize = 32767;
@@ -808,10 +814,20 @@ void WorldSession::HandleMailCreateTextItem(WorldPacket& recvData)
 //TODO Fix me! ... this void has probably bad condition, but good data are sent
 void WorldSession::HandleQueryNextMailTime(WorldPacket & /*recvData*/)
 {
-    WorldPacket data(MSG_QUERY_NEXT_MAIL_TIME, 8);
-
+    // answered once the mails are loaded
     if (!_player->m_mailsLoaded)
-        _player->_LoadMail();
+    {
+        _nextMailTimeRequest = true;
+        LoadMailbox();
+        return;
+    }
+
+    SendNextMailTime();
+}
+
+void WorldSession::SendNextMailTime()
+{
+    WorldPacket data(MSG_QUERY_NEXT_MAIL_TIME, 8);
 
     if (_player->unReadMails > 0)
     {
@@ -858,3 +874,78 @@ void WorldSession::HandleQueryNextMailTime(WorldPacket & /*recvData*/)
 
     SendPacket(&data);
 }
+
+void WorldSession::LoadMailbox()
+{
+    if (_mailboxLoading)
+        return;
+
+    // retried at next update while the map has too many mailbox loads in flight
+    Map* map = _player->GetMap();
+    if (!map->StartMailboxLoad())
+        return;
+
+    _mailboxLoading = true;
+    _mailboxLoadStale = false;
+    _mailboxLoadMap = map;
+    QueryMailbox();
+}
+
+void WorldSession::QueryMailbox()
+{
+    // mails and their items in one query
+    PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_MAILBOX);
+    stmt->setUInt32(0, _player->GetGUIDLow());
+
+    _mailboxLoadCallback.SetParam(_player->GetGUID());
+    _mailboxLoadCallback.SetFutureResult(CharacterDatabase.AsyncQuery(stmt));
+}
+
+void WorldSession::HandleMailboxLoadCallback(PreparedQueryResult result, uint64 guid)
+{
+    Player* player = GetPlayer();
+    if (!player || player->GetGUID() != guid)
+    {
+        // logged out meanwhile, the slot was released when leaving the map
+        _mailboxLoading = false;
+        _mailListRequest = 0;
+        _nextMailTimeRequest = false;
+        return;
+    }
+
+    // a mail was sent to or returned from the player while querying, the result may miss it
+    if (_mailboxLoadStale.value())
+    {
+        _mailboxLoadStale = false;
+        QueryMailbox();
+        return;
+    }
+
+    ReleaseMailboxLoadSlot();
+    _mailboxLoading = false;
+
+    if (!player->m_mailsLoaded)
+        player->_LoadMail(result);
+
+    if (uint64 mailbox = _mailListRequest)
+    {
+        _mailListRequest = 0;
+        if (player->GetGameObjectIfCanInteractWith(mailbox, GAMEOBJECT_TYPE_MAILBOX) || player->GetNPCIfCanInteractWith(mailbox, UNIT_NPC_FLAG_MAILBOX))
+            SendMailList();
+    }
+
+    if (_nextMailTimeRequest)
+    {
+        _nextMailTimeRequest = false;
+        SendNextMailTime();
+    }
+}
+
+void WorldSession::ReleaseMailboxLoadSlot()
+{
+    if (!_mailboxLoadMap)
+        return;
+
+    _mailboxLoadMap->FinishMailboxLoad();
+    _mailboxLoadMap = NULL;
+}
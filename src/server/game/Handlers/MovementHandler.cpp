@@ -297,7 +297,10 @@ void WorldSession::HandleMovementOpcodes(WorldPacket& recvPacket)
 
     WorldPacket data(SMSG_PLAYER_MOVE, recvPacket.size());
     _player->WriteMovementInfo(data);
-    mover->SendMessageToSet(&data, _player);
+    // plain heartbeats only refresh a position the client already extrapolates, crowded observers get every Nth
+    bool heartbeat = recvPacket.GetOpcode() == MSG_MOVE_HEARTBEAT;
+    bool lowPriority = heartbeat && ++m_movementHeartbeatCount % World::Visibility_DensityHeartbeatRatio;
+    mover->SendMovementMessageToSet(&data, _player, heartbeat, lowPriority);
 
     if (fall)
         plrMover->SetFallInformation(mover->m_movementInfo.fallTime, mover->m_movementInfo.pos.GetPositionZ());
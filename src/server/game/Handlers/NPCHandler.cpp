@@ -318,6 +318,8 @@ void WorldSession::HandleGossipHelloOpcode(WorldPacket & recvData)
     if (!unit)
         return;
 
+    unit->WakeUp();
+
     // set faction visible if needed
     if (FactionTemplateEntry const* factionTemplateEntry = sFactionTemplateStore.LookupEntry(unit->getFaction()))
         _player->GetReputationMgr().SetVisible(factionTemplateEntry);
@@ -1553,7 +1553,7 @@ bool LootTemplate::addConditionItem(Condition* cond)
         {
             if (i->itemid == uint32(cond->SourceEntry))
             {
-                i->conditions.push_back(cond);
+                ConditionMgr::AddToConditionList(i->conditions, cond);
                 return true;
             }
         }
@@ -1569,7 +1569,7 @@ bool LootTemplate::addConditionItem(Condition* cond)
                 {
                     if ((*i).itemid == uint32(cond->SourceEntry))
                     {
-                        (*i).conditions.push_back(cond);
+                        ConditionMgr::AddToConditionList((*i).conditions, cond);
                         return true;
                     }
                 }
@@ -1581,7 +1581,7 @@ bool LootTemplate::addConditionItem(Condition* cond)
                 {
                     if ((*i).itemid == uint32(cond->SourceEntry))
                     {
-                        (*i).conditions.push_back(cond);
+                        ConditionMgr::AddToConditionList((*i).conditions, cond);
                         return true;
                     }
                 }
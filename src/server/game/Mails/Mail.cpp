@@ -219,11 +219,17 @@ void MailDraft::SendMailTo(SQLTransaction& trans, MailReceiver const& receiver,
         trans->PAppend("INSERT INTO mail_items(mail_id, item_guid, receiver) VALUES ('%u', '%u', '%u')", mailId, pItem->GetGUIDLow(), receiver.GetPlayerGUIDLow());
     }
 
+    sWorld->ModifyCharacterNameDataMailCount(receiver.GetPlayerGUIDLow(), 1);
+
     // For online receiver update in game mail status and data
     if (pReceiver)
     {
         pReceiver->AddNewMailDeliverTime(deliver_time);
 
+        // a mailbox query in flight may run before this transaction
+        if (!pReceiver->IsMailsLoaded())
+            pReceiver->GetSession()->InvalidateMailboxLoad();
+
         if (pReceiver->IsMailsLoaded())
         {
             Mail* m = new Mail;
@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GridMapCache.h"
+#include "Map.h"
+#include "World.h"
+#include "Log.h"
+
+GridMapPrefetcher::GridMapPrefetcher() : _condition(_lock), _stop(false)
+{
+    ACE_Task_Base::activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, 1);
+}
+
+GridMapPrefetcher::~GridMapPrefetcher()
+{
+    {
+        ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+        _stop = true;
+        _condition.signal();
+    }
+
+    wait();
+}
+
+void GridMapPrefetcher::Enqueue(uint32 key)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    _keys.push_back(key);
+    _condition.signal();
+}
+
+int GridMapPrefetcher::svc()
+{
+    while (true)
+    {
+        uint32 key;
+        {
+            ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+            while (_keys.empty() && !_stop)
+                _condition.wait();
+
+            if (_stop)
+                break;
+
+            key = _keys.front();
+            _keys.pop_front();
+        }
+
+        sGridMapCache->LoadUnused(key);
+    }
+
+    return 0;
+}
+
+GridMapCache::GridMapCache() : _prefetcher(NULL), _hits(0), _misses(0), _prefetched(0)
+{
+}
+
+GridMapCache::~GridMapCache()
+{
+    Unload();
+}
+
+GridMap* GridMapCache::LoadTile(uint32 key)
+{
+    uint32 mapId = key >> 12;
+    uint32 gx = (key >> 6) & 63;
+    uint32 gy = key & 63;
+
+    // map file name
+    int len = sWorld->GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
+    char* fileName = new char[len];
+    snprintf(fileName, len, (sWorld->GetDataPath() + "maps/%03u%02u%02u.map").c_str(), mapId, gx, gy);
+    sLog->outInfo(LOG_FILTER_MAPS, "Loading map %s", fileName);
+
+    GridMap* tile = new GridMap();
+    if (!tile->loadData(fileName))
+        sLog->outError(LOG_FILTER_MAPS, "Error loading map file: \n %s\n", fileName);
+
+    delete [] fileName;
+    return tile;
+}
+
+GridMap* GridMapCache::Acquire(uint32 mapId, uint32 gx, uint32 gy)
+{
+    uint32 key = MakeKey(mapId, gx, gy);
+    {
+        ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+        EntryMap::iterator itr = _entries.find(key);
+        if (itr != _entries.end())
+        {
+            if (!itr->second.Refs)
+                _unused.erase(itr->second.UnusedPos);
+            ++itr->second.Refs;
+            ++_hits;
+            return itr->second.Tile;
+        }
+
+        ++_misses;
+    }
+
+    // read outside of the lock, other maps keep using their tiles meanwhile
+    GridMap* tile = LoadTile(key);
+
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    EntryMap::iterator itr = _entries.find(key);
+    if (itr != _entries.end())
+    {
+        // loaded by the prefetcher or another map in the meantime
+        delete tile;
+        if (!itr->second.Refs)
+            _unused.erase(itr->second.UnusedPos);
+        ++itr->second.Refs;
+        return itr->second.Tile;
+    }
+
+    Entry& entry = _entries[key];
+    entry.Tile = tile;
+    entry.Refs = 1;
+    return tile;
+}
+
+void GridMapCache::Release(uint32 mapId, uint32 gx, uint32 gy)
+{
+    std::list<GridMap*> expired;
+    {
+        ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+        EntryMap::iterator itr = _entries.find(MakeKey(mapId, gx, gy));
+        if (itr == _entries.end() || !itr->second.Refs)
+        {
+            sLog->outError(LOG_FILTER_MAPS, "GridMapCache::Release: map %u tile [%u, %u] is not in use", mapId, gx, gy);
+            return;
+        }
+
+        if (!--itr->second.Refs)
+            AddUnused(itr, expired);
+    }
+
+    // unmap outside of the lock
+    for (std::list<GridMap*>::iterator itr = expired.begin(); itr != expired.end(); ++itr)
+        delete *itr;
+}
+
+void GridMapCache::Evict(uint32 mapId, uint32 gx, uint32 gy)
+{
+    GridMap* tile = NULL;
+    {
+        ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+        EntryMap::iterator itr = _entries.find(MakeKey(mapId, gx, gy));
+        if (itr == _entries.end() || itr->second.Refs)
+            return;
+
+        tile = itr->second.Tile;
+        _unused.erase(itr->second.UnusedPos);
+        _entries.erase(itr);
+    }
+
+    delete tile;
+}
+
+void GridMapCache::AddUnused(EntryMap::iterator itr, std::list<GridMap*>& expired)
+{
+    _unused.push_front(itr->first);
+    itr->second.UnusedPos = _unused.begin();
+
+    uint32 limit = sWorld->getIntConfig(CONFIG_GRID_MAP_CACHE_SIZE);
+    while (_unused.size() > limit)
+    {
+        EntryMap::iterator last = _entries.find(_unused.back());
+        expired.push_back(last->second.Tile);
+        _entries.erase(last);
+        _unused.pop_back();
+    }
+}
+
+void GridMapCache::Prefetch(uint32 mapId, uint32 gx, uint32 gy)
+{
+    uint32 key = MakeKey(mapId, gx, gy);
+
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    if (_entries.find(key) != _entries.end() || !_pending.insert(key).second)
+        return;
+
+    if (!_prefetcher)
+        _prefetcher = new GridMapPrefetcher();
+
+    _prefetcher->Enqueue(key);
+}
+
+void GridMapCache::LoadUnused(uint32 key)
+{
+    {
+        ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+        if (_entries.find(key) != _entries.end())
+        {
+            _pending.erase(key);
+            return;
+        }
+    }
+
+    GridMap* tile = LoadTile(key);
+    tile->prefault();
+
+    std::list<GridMap*> expired;
+    {
+        ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+        _pending.erase(key);
+
+        if (_entries.find(key) != _entries.end())
+            expired.push_back(tile);
+        else
+        {
+            Entry& entry = _entries[key];
+            entry.Tile = tile;
+            entry.Refs = 0;
+            ++_prefetched;
+            AddUnused(_entries.find(key), expired);
+        }
+    }
+
+    for (std::list<GridMap*>::iterator itr = expired.begin(); itr != expired.end(); ++itr)
+        delete *itr;
+}
+
+void GridMapCache::Unload()
+{
+    // joins the prefetch thread
+    delete _prefetcher;
+    _prefetcher = NULL;
+
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    for (std::list<uint32>::iterator itr = _unused.begin(); itr != _unused.end(); ++itr)
+    {
+        EntryMap::iterator entry = _entries.find(*itr);
+        delete entry->second.Tile;
+        _entries.erase(entry);
+    }
+
+    _unused.clear();
+    _pending.clear();
+}
+
+uint32 GridMapCache::GetTilesCount()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    return _entries.size();
+}
+
+uint32 GridMapCache::GetUnusedTilesCount()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+    return _unused.size();
+}
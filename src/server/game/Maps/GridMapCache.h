@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_GRIDMAPCACHE_H
+#define TRINITY_GRIDMAPCACHE_H
+
+#include "Common.h"
+#include <ace/Singleton.h>
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <deque>
+#include <list>
+#include <set>
+
+class GridMap;
+
+/// Background thread loading tiles players are about to walk into
+class GridMapPrefetcher : protected ACE_Task_Base
+{
+    public:
+        GridMapPrefetcher();
+        ~GridMapPrefetcher();
+
+        void Enqueue(uint32 key);
+
+    private:
+        virtual int svc();
+
+        std::deque<uint32> _keys;
+        ACE_Thread_Mutex _lock;
+        ACE_Condition_Thread_Mutex _condition;
+        bool _stop;
+};
+
+/// Process wide cache of memory mapped .map tiles.
+/// Tiles are refcounted by the maps using them; unused tiles stay mapped in LRU order
+/// so grids reloaded shortly after unloading don't touch the disk again.
+class GridMapCache
+{
+    friend class ACE_Singleton<GridMapCache, ACE_Thread_Mutex>;
+    friend class GridMapPrefetcher;
+
+    GridMapCache();
+    ~GridMapCache();
+
+    public:
+        GridMap* Acquire(uint32 mapId, uint32 gx, uint32 gy);
+        void Release(uint32 mapId, uint32 gx, uint32 gy);
+        // drop an unused cached copy so the next Acquire reads the file again
+        void Evict(uint32 mapId, uint32 gx, uint32 gy);
+        // load a tile in background if it isn't cached yet
+        void Prefetch(uint32 mapId, uint32 gx, uint32 gy);
+        // stop prefetching and drop all unused tiles
+        void Unload();
+
+        uint32 GetTilesCount();
+        uint32 GetUnusedTilesCount();
+        uint32 GetHits() const { return _hits; }
+        uint32 GetMisses() const { return _misses; }
+        uint32 GetPrefetched() const { return _prefetched; }
+
+    private:
+        struct Entry
+        {
+            GridMap* Tile;
+            uint32 Refs;
+            std::list<uint32>::iterator UnusedPos;          // valid only while Refs == 0
+        };
+
+        typedef UNORDERED_MAP<uint32, Entry> EntryMap;
+
+        static uint32 MakeKey(uint32 mapId, uint32 gx, uint32 gy) { return (mapId << 12) | (gx << 6) | gy; }
+        static GridMap* LoadTile(uint32 key);
+
+        void LoadUnused(uint32 key);                        // prefetcher callback
+        void AddUnused(EntryMap::iterator itr, std::list<GridMap*>& expired);
+
+        EntryMap _entries;
+        std::list<uint32> _unused;                          // most recently used first
+        std::set<uint32> _pending;                          // queued for prefetch
+        ACE_Thread_Mutex _lock;
+        GridMapPrefetcher* _prefetcher;
+
+        uint32 _hits;
+        uint32 _misses;
+        uint32 _prefetched;
+};
+
+#define sGridMapCache ACE_Singleton<GridMapCache, ACE_Thread_Mutex>::instance()
+
+#endif
@@ -34,6 +34,15 @@
 #include "LFGMgr.h"
 #include "DynamicTree.h"
 #include "Vehicle.h"
+#include "GridMapCache.h"
+#include "ScriptProfiler.h"
+#include "PoolMgr.h"
+#include "CreatureGroups.h"
+#include "GameEventMgr.h"
+#include "BattlefieldMgr.h"
+#include "OutdoorPvPMgr.h"
+
+#include <ace/Mem_Map.h>
 
 union u_map_magic
 {
@@ -56,6 +65,7 @@ GridState* si_GridStates[MAX_GRID_STATE];
 Map::~Map()
 {
     UnloadAll();
+    SaveRespawnTimes();
 
     while (!i_worldObjects.empty())
     {
@@ -158,23 +168,56 @@ void Map::LoadMap(int gx, int gy, bool reload)
     {
         sLog->outInfo(LOG_FILTER_MAPS, "Unloading previously loaded map %u before reloading.", GetId());
 
-        delete (GridMaps[gx][gy]);
+        sGridMapCache->Release(GetId(), gx, gy);
+        sGridMapCache->Evict(GetId(), gx, gy);
         GridMaps[gx][gy]=NULL;
     }
 
-    // map file name
-    char *tmp=NULL;
-    int len = sWorld->GetDataPath().length()+strlen("maps/%03u%02u%02u.map")+1;
-    tmp = new char[len];
-    snprintf(tmp, len, (char *)(sWorld->GetDataPath()+"maps/%03u%02u%02u.map").c_str(), GetId(), gx, gy);
-    sLog->outInfo(LOG_FILTER_MAPS, "Loading map %s", tmp);
-    // loading data
-    GridMaps[gx][gy] = new GridMap();
-    if (!GridMaps[gx][gy]->loadData(tmp))
-    {
-        sLog->outError(LOG_FILTER_MAPS, "Error loading map file: \n %s\n", tmp);
-    }
-    delete [] tmp;
+    // shared with every other user of the tile, usually already mapped by the prefetcher
+    GridMaps[gx][gy] = sGridMapCache->Acquire(GetId(), gx, gy);
+}
+
+void Map::PrefetchGridMapsAround(float x, float y)
+{
+    float distance = float(sWorld->getIntConfig(CONFIG_GRID_MAP_PREFETCH_DISTANCE));
+    if (distance <= 0.0f)
+        return;
+
+    float fx = 32 - x / SIZE_OF_GRIDS;
+    float fy = 32 - y / SIZE_OF_GRIDS;
+    int gx = int(fx);
+    int gy = int(fy);
+
+    // grid indexes grow while world coordinates shrink
+    int dx = 0;
+    if ((fx - gx) * SIZE_OF_GRIDS < distance)
+        dx = -1;
+    else if ((gx + 1 - fx) * SIZE_OF_GRIDS < distance)
+        dx = 1;
+
+    int dy = 0;
+    if ((fy - gy) * SIZE_OF_GRIDS < distance)
+        dy = -1;
+    else if ((gy + 1 - fy) * SIZE_OF_GRIDS < distance)
+        dy = 1;
+
+    if (dx)
+        PrefetchGridMap(gx + dx, gy);
+    if (dy)
+        PrefetchGridMap(gx, gy + dy);
+    if (dx && dy)
+        PrefetchGridMap(gx + dx, gy + dy);
+}
+
+void Map::PrefetchGridMap(int gx, int gy)
+{
+    if (gx < 0 || gy < 0 || gx >= MAX_NUMBER_OF_GRIDS || gy >= MAX_NUMBER_OF_GRIDS)
+        return;
+
+    if (GridMaps[gx][gy] || (m_parentMap != this && m_parentMap->GridMaps[gx][gy]))
+        return;
+
+    sGridMapCache->Prefetch(GetId(), gx, gy);
 }
 
 void Map::LoadMapAndVMap(int gx, int gy)
@@ -203,9 +246,10 @@ void Map::DeleteStateMachine()
 Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode, Map* _parent):
 _creatureToMoveLock(false), i_mapEntry (sMapStore.LookupEntry(id)), i_spawnMode(SpawnMode), i_InstanceId(InstanceId),
 m_unloadTimer(0), m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE),
-m_VisibilityNotifyPeriod(DEFAULT_VISIBILITY_NOTIFY_PERIOD),
-m_activeNonPlayersIter(m_activeNonPlayers.end()), i_gridExpiry(expiry),
-i_scriptLock(false)
+m_VisibilityNotifyPeriod(DEFAULT_VISIBILITY_NOTIFY_PERIOD), m_VisibilityDensityThreshold(0),
+i_gridExpiry(expiry),
+i_scriptLock(false), _navPathCache(sWorld->getIntConfig(CONFIG_NAVIGATION_PATH_CACHE_SIZE)), _updateTick(0),
+_awakeCreatures(0), _dormantCreatures(0), _respawnTimesSaveTimer(0), _mailboxLoads(0)
 {
     m_parentMap = (_parent ? _parent : this);
     for (unsigned int idx=0; idx < MAX_NUMBER_OF_GRIDS; ++idx)
@@ -227,6 +271,7 @@ void Map::InitVisibilityDistance()
     //init visibility for continents
     m_VisibleDistance = World::GetMaxVisibleDistanceOnContinents();
     m_VisibilityNotifyPeriod = World::GetVisibilityNotifyPeriodOnContinents();
+    m_VisibilityDensityThreshold = World::GetVisibilityDensityThresholdOnContinents();
 }
 
 // Template specialization of utility methods
@@ -360,7 +405,11 @@ bool Map::EnsureGridLoaded(const Cell &cell)
         setGridObjectDataLoaded(true, cell.GridX(), cell.GridY());
 
         ObjectGridLoader loader(*grid, this, cell);
-        loader.LoadN();
+        // the grid may be partly loaded ahead already
+        if (uint32 firstCell = TakePendingGridLoad(cell.GridX(), cell.GridY()))
+            loader.LoadCells(firstCell, MAX_NUMBER_OF_CELLS * MAX_NUMBER_OF_CELLS);
+        else
+            loader.LoadN();
 
         // Add resurrectable corpses to world object list in grid
         sObjectAccessor->AddCorpsesToGrid(GridCoord(cell.GridX(), cell.GridY()), grid->GetGridType(cell.CellX(), cell.CellY()), this);
@@ -376,6 +425,83 @@ void Map::LoadGrid(float x, float y)
     EnsureGridLoaded(Cell(x, y));
 }
 
+void Map::PredictGridLoad(Player* player)
+{
+    float distance = float(sWorld->getIntConfig(CONFIG_GRID_LOAD_AHEAD_DISTANCE));
+    if (distance <= 0.0f || !player->isMoving())
+        return;
+
+    float x = player->GetPositionX() + distance * std::cos(player->GetOrientation());
+    float y = player->GetPositionY() + distance * std::sin(player->GetOrientation());
+    if (!Trinity::IsValidMapCoord(x, y))
+        return;
+
+    GridCoord p = Trinity::ComputeGridCoord(x, y);
+    if (NGridType* grid = getNGrid(p.x_coord, p.y_coord))
+        if (grid->isGridObjectDataLoaded())
+            return;
+
+    for (std::list<PendingGridLoad>::const_iterator itr = _pendingGridLoads.begin(); itr != _pendingGridLoads.end(); ++itr)
+        if (itr->x == p.x_coord && itr->y == p.y_coord)
+            return;
+
+    // terrain is read by the prefetcher while the grids queued before are loaded
+    PrefetchGridMap((MAX_NUMBER_OF_GRIDS - 1) - p.x_coord, (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord);
+    _pendingGridLoads.push_back(PendingGridLoad(p.x_coord, p.y_coord));
+}
+
+void Map::ProcessPendingGridLoads()
+{
+    uint32 budget = sWorld->getIntConfig(CONFIG_GRID_LOAD_TIME_BUDGET);
+    uint32 startTime = getMSTime();
+    while (!_pendingGridLoads.empty())
+    {
+        PendingGridLoad& load = _pendingGridLoads.front();
+        GridCoord gridCoord(load.x, load.y);
+        EnsureGridCreated(gridCoord);
+        NGridType* grid = getNGrid(load.x, load.y);
+
+        if (grid->isGridObjectDataLoaded())
+            _pendingGridLoads.pop_front();
+        else
+        {
+            // advanced first, objects added by the cell may load the rest of the grid and take this pending load
+            uint32 cellIndex = load.nextCell++;
+            Cell cell(CellCoord(load.x * MAX_NUMBER_OF_CELLS, load.y * MAX_NUMBER_OF_CELLS));
+            ObjectGridLoader loader(*grid, this, cell);
+            loader.LoadCells(cellIndex, cellIndex + 1);
+
+            if (!grid->isGridObjectDataLoaded() && load.nextCell == MAX_NUMBER_OF_CELLS * MAX_NUMBER_OF_CELLS)
+            {
+                sLog->outDebug(LOG_FILTER_MAPS, "Loaded grid[%u, %u] ahead for map %u instance %u", load.x, load.y, GetId(), i_InstanceId);
+
+                grid->setGridObjectDataLoaded(true);
+                sObjectAccessor->AddCorpsesToGrid(gridCoord, grid->GetGridType(cell.CellX(), cell.CellY()), this);
+                Balance();
+                _pendingGridLoads.pop_front();
+            }
+        }
+
+        if (GetMSTimeDiffToNow(startTime) >= budget)
+            return;
+    }
+}
+
+uint32 Map::TakePendingGridLoad(uint32 x, uint32 y)
+{
+    for (std::list<PendingGridLoad>::iterator itr = _pendingGridLoads.begin(); itr != _pendingGridLoads.end(); ++itr)
+    {
+        if (itr->x == x && itr->y == y)
+        {
+            uint32 nextCell = itr->nextCell;
+            _pendingGridLoads.erase(itr);
+            return nextCell;
+        }
+    }
+
+    return 0;
+}
+
 bool Map::AddPlayerToMap(Player* player)
 {
     CellCoord cellCoord = Trinity::ComputeCellCoord(player->GetPositionX(), player->GetPositionY());
@@ -398,8 +524,11 @@ bool Map::AddPlayerToMap(Player* player)
     SendInitTransports(player);
 
     player->m_clientGUIDs.clear();
+    player->ResetVisibilityCenter();
     player->UpdateObjectVisibility(false);
 
+    AddActiveCellSource(player);
+
     return true;
 }
 
@@ -464,37 +593,113 @@ bool Map::IsGridLoaded(const GridCoord &p) const
     return (getNGrid(p.x_coord, p.y_coord) && isGridObjectDataLoaded(p.x_coord, p.y_coord));
 }
 
-void Map::VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer> &worldVisitor)
+void Map::AddActiveCellSource(WorldObject* obj)
 {
-    // Check for valid position
+    ActiveCellSource& source = _activeCellSources[obj];
+    if (source.valid)
+        return;
+
+    // Check for valid position, the source will be picked up on next update otherwise
     if (!obj->IsPositionValid())
         return;
 
-    // Update mobs/objects in ALL visible cells around object!
-    CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), obj->GetGridActivationRange());
+    source.area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), obj->GetGridActivationRange());
+    source.valid = true;
+    RefActiveCells(source.area);
+}
+
+void Map::RemoveActiveCellSource(WorldObject* obj)
+{
+    ActiveCellSources::iterator itr = _activeCellSources.find(obj);
+    if (itr == _activeCellSources.end())
+        return;
+
+    if (itr->second.valid)
+        UnrefActiveCells(itr->second.area);
+
+    _activeCellSources.erase(itr);
+}
+
+void Map::UpdateActiveCellSources()
+{
+    for (ActiveCellSources::iterator itr = _activeCellSources.begin(); itr != _activeCellSources.end(); ++itr)
+    {
+        WorldObject* obj = itr->first;
+        if (!obj->IsPositionValid())
+            continue;
+
+        CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), obj->GetGridActivationRange());
+
+        ActiveCellSource& source = itr->second;
+        if (source.valid && source.area.low_bound == area.low_bound && source.area.high_bound == area.high_bound)
+            continue;
+
+        // ref new area before unref old one so overlapping cells never drop to zero
+        RefActiveCells(area);
+        if (source.valid)
+            UnrefActiveCells(source.area);
+
+        source.area = area;
+        source.valid = true;
+    }
+}
+
+void Map::RefActiveCells(CellArea const& area)
+{
+    for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+        for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+            ++_activeCellRefs[(y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x];
+}
 
+void Map::UnrefActiveCells(CellArea const& area)
+{
     for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
     {
         for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
         {
-            // marked cells are those that have been visited
-            // don't visit the same cell twice
-            uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-            if (isCellMarked(cell_id))
+            ActiveCellRefs::iterator itr = _activeCellRefs.find((y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x);
+            if (itr == _activeCellRefs.end())
                 continue;
 
-            markCell(cell_id);
-            CellCoord pair(x, y);
-            Cell cell(pair);
-            cell.SetNoCreate();
-            Visit(cell, gridVisitor);
-            Visit(cell, worldVisitor);
+            if (--itr->second == 0)
+                _activeCellRefs.erase(itr);
         }
     }
 }
 
+void Map::VisitActiveCells(TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer> &worldVisitor)
+{
+    UpdateActiveCellSources();
+
+    // objects updated below may add or remove active sources, so iterate a snapshot of live cells
+    _activeCellsToVisit.clear();
+    _activeCellsToVisit.reserve(_activeCellRefs.size());
+    for (ActiveCellRefs::const_iterator itr = _activeCellRefs.begin(); itr != _activeCellRefs.end(); ++itr)
+        _activeCellsToVisit.push_back(itr->first);
+
+    for (std::vector<uint32>::const_iterator itr = _activeCellsToVisit.begin(); itr != _activeCellsToVisit.end(); ++itr)
+    {
+        CellCoord pair(*itr % TOTAL_NUMBER_OF_CELLS_PER_MAP, *itr / TOTAL_NUMBER_OF_CELLS_PER_MAP);
+        Cell cell(pair);
+        cell.SetNoCreate();
+        Visit(cell, gridVisitor);
+        Visit(cell, worldVisitor);
+    }
+}
+
 void Map::Update(const uint32 t_diff)
 {
+    _lastTickVisibilityStats = _visibilityStats;
+    _visibilityStats.Reset();
+
+    ++_updateTick;
+    _splineStats.Elapsed += t_diff;
+    if (_splineStats.Elapsed >= IN_MILLISECONDS)
+    {
+        _lastSecondSplineStats = _splineStats;
+        _splineStats.Reset();
+    }
+
     _dynamicTree.update(t_diff);
     /// update worldsessions for existing players
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
@@ -508,8 +713,11 @@ void Map::Update(const uint32 t_diff)
             session->Update(t_diff, updater);
         }
     }
-    /// update active cells around players and active objects
-    resetMarkedCells();
+
+    /// send movement relayed while handling the packets above, one batch per observer
+    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+        if (Player* player = m_mapRefIter->getSource())
+            player->GetSession()->SendMovementBatch();
 
     Trinity::ObjectUpdater updater(t_diff);
     // for creature
@@ -528,20 +736,21 @@ void Map::Update(const uint32 t_diff)
 
         // update players at tick
         player->Update(t_diff);
-
-        VisitNearbyCellsOf(player, grid_object_update, world_object_update);
     }
 
-    // non-player active objects, increasing iterator in the loop in case of object removal
-    for (m_activeNonPlayersIter = m_activeNonPlayers.begin(); m_activeNonPlayersIter != m_activeNonPlayers.end();)
-    {
-        WorldObject* obj = *m_activeNonPlayersIter;
-        ++m_activeNonPlayersIter;
+    /// update active cells around players and active objects
+    VisitActiveCells(grid_object_update, world_object_update);
+    _awakeCreatures = updater.i_awakeCreatures;
+    _dormantCreatures = updater.i_dormantCreatures;
 
-        if (!obj || !obj->IsInWorld())
-            continue;
+    ProcessCreatureRespawns();
+    ProcessPendingGridLoads();
 
-        VisitNearbyCellsOf(obj, grid_object_update, world_object_update);
+    _respawnTimesSaveTimer += t_diff;
+    if (_respawnTimesSaveTimer >= sWorld->getIntConfig(CONFIG_RESPAWN_TIME_SAVE_INTERVAL))
+    {
+        _respawnTimesSaveTimer = 0;
+        SaveRespawnTimes();
     }
 
     ///- Process necessary scripts
@@ -557,6 +766,8 @@ void Map::Update(const uint32 t_diff)
 
 void Map::RemovePlayerFromMap(Player* player, bool remove)
 {
+    player->GetSession()->ReleaseMailboxLoadSlot();
+    RemoveActiveCellSource(player);
     player->RemoveFromWorld();
     SendRemoveTransports(player);
 
@@ -618,6 +829,10 @@ void Map::PlayerRelocation(Player* player, float x, float y, float z, float orie
             EnsureGridLoadedForActiveObject(new_cell, player);
 
         AddToGrid(player, new_cell);
+
+        // terrain of the next grid is read in background before the player gets there
+        PrefetchGridMapsAround(x, y);
+        PredictGridLoad(player);
     }
 
     player->OnRelocated();
@@ -887,6 +1102,7 @@ bool Map::UnloadGrid(NGridType& ngrid, bool unloadAll)
 
         delete &ngrid;
         setNGrid(NULL, x, y);
+        TakePendingGridLoad(x, y);
     }
     int gx = (MAX_NUMBER_OF_GRIDS - 1) - x;
     int gy = (MAX_NUMBER_OF_GRIDS - 1) - y;
@@ -896,11 +1112,9 @@ bool Map::UnloadGrid(NGridType& ngrid, bool unloadAll)
     {
         if (i_InstanceId == 0)
         {
+            // stays mapped in the tile cache for a while
             if (GridMaps[gx][gy])
-            {
-                GridMaps[gx][gy]->unloadData();
-                delete GridMaps[gx][gy];
-            }
+                sGridMapCache->Release(GetId(), gx, gy);
             // x and y are swapped
             VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(GetId(), gx, gy);
         }
@@ -967,6 +1181,7 @@ GridMap::GridMap()
     _liquidEntry = NULL;
     _liquidFlags = NULL;
     _liquidMap  = NULL;
+    _file = NULL;
 }
 
 GridMap::~GridMap()
@@ -974,62 +1189,66 @@ GridMap::~GridMap()
     unloadData();
 }
 
-bool GridMap::loadData(char *filename)
+bool GridMap::loadData(char const* filename)
 {
     // Unload old data if exist
     unloadData();
 
-    map_fileheader header;
     // Not return error if file not found
-    FILE* in = fopen(filename, "rb");
-    if (!in)
+    _file = new ACE_Mem_Map();
+    if (_file->map(filename, static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ, ACE_MAP_PRIVATE) == -1)
+    {
+        delete _file;
+        _file = NULL;
         return true;
+    }
 
-    if (fread(&header, sizeof(header), 1, in) != 1)
+    map_fileheader const* header = reinterpret_cast<map_fileheader const*>(getFileData(0, sizeof(map_fileheader)));
+    if (!header)
     {
-        fclose(in);
+        unloadData();
         return false;
     }
 
-    if (header.mapMagic == MapMagic.asUInt && header.versionMagic == MapVersionMagic.asUInt)
+    if (header->mapMagic == MapMagic.asUInt && header->versionMagic == MapVersionMagic.asUInt)
     {
         // loadup area data
-        if (header.areaMapOffset && !loadAreaData(in, header.areaMapOffset, header.areaMapSize))
+        if (header->areaMapOffset && !loadAreaData(header->areaMapOffset, header->areaMapSize))
         {
             sLog->outError(LOG_FILTER_MAPS, "Error loading map area data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
         // loadup height data
-        if (header.heightMapOffset && !loadHeihgtData(in, header.heightMapOffset, header.heightMapSize))
+        if (header->heightMapOffset && !loadHeihgtData(header->heightMapOffset, header->heightMapSize))
         {
             sLog->outError(LOG_FILTER_MAPS, "Error loading map height data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
         // loadup liquid data
-        if (header.liquidMapOffset && !loadLiquidData(in, header.liquidMapOffset, header.liquidMapSize))
+        if (header->liquidMapOffset && !loadLiquidData(header->liquidMapOffset, header->liquidMapSize))
         {
             sLog->outError(LOG_FILTER_MAPS, "Error loading map liquids data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
-        fclose(in);
         return true;
     }
     sLog->outError(LOG_FILTER_MAPS, "Map file '%s' is from an incompatible clientversion. Please recreate using the mapextractor.", filename);
-    fclose(in);
+    unloadData();
     return false;
 }
 
 void GridMap::unloadData()
 {
-    delete[] _areaMap;
-    delete[] m_V9;
-    delete[] m_V8;
-    delete[] _liquidEntry;
-    delete[] _liquidFlags;
-    delete[] _liquidMap;
+    if (_file)
+    {
+        _file->close();
+        delete _file;
+        _file = NULL;
+    }
+
     _areaMap = NULL;
     m_V9 = NULL;
     m_V8 = NULL;
@@ -1039,61 +1258,75 @@ void GridMap::unloadData()
     _gridGetHeight = &GridMap::getHeightFromFlat;
 }
 
-bool GridMap::loadAreaData(FILE* in, uint32 offset, uint32 /*size*/)
+void GridMap::prefault() const
 {
-    map_areaHeader header;
-    fseek(in, offset, SEEK_SET);
+    if (!_file)
+        return;
 
-    if (fread(&header, sizeof(header), 1, in) != 1 || header.fourcc != MapAreaMagic.asUInt)
+    uint8 const* data = static_cast<uint8 const*>(_file->addr());
+    size_t size = _file->size();
+    volatile uint8 sum = 0;
+    for (size_t i = 0; i < size; i += 4096)
+        sum += data[i];
+}
+
+uint8 const* GridMap::getFileData(uint32 offset, uint32 size) const
+{
+    if (!_file || size_t(offset) + size > _file->size())
+        return NULL;
+
+    return static_cast<uint8 const*>(_file->addr()) + offset;
+}
+
+bool GridMap::loadAreaData(uint32 offset, uint32 /*size*/)
+{
+    map_areaHeader const* header = reinterpret_cast<map_areaHeader const*>(getFileData(offset, sizeof(map_areaHeader)));
+    if (!header || header->fourcc != MapAreaMagic.asUInt)
         return false;
 
-    _gridArea = header.gridArea;
-    if (!(header.flags & MAP_AREA_NO_AREA))
+    _gridArea = header->gridArea;
+    if (!(header->flags & MAP_AREA_NO_AREA))
     {
-        _areaMap = new uint16 [16*16];
-        if (fread(_areaMap, sizeof(uint16), 16*16, in) != 16*16)
+        _areaMap = reinterpret_cast<uint16 const*>(getFileData(offset + sizeof(map_areaHeader), sizeof(uint16) * 16*16));
+        if (!_areaMap)
             return false;
     }
     return true;
 }
 
-bool GridMap::loadHeihgtData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadHeihgtData(uint32 offset, uint32 /*size*/)
 {
-    map_heightHeader header;
-    fseek(in, offset, SEEK_SET);
-
-    if (fread(&header, sizeof(header), 1, in) != 1 || header.fourcc != MapHeightMagic.asUInt)
+    map_heightHeader const* header = reinterpret_cast<map_heightHeader const*>(getFileData(offset, sizeof(map_heightHeader)));
+    if (!header || header->fourcc != MapHeightMagic.asUInt)
         return false;
 
-    _gridHeight = header.gridHeight;
-    if (!(header.flags & MAP_HEIGHT_NO_HEIGHT))
+    _gridHeight = header->gridHeight;
+    offset += sizeof(map_heightHeader);
+    if (!(header->flags & MAP_HEIGHT_NO_HEIGHT))
     {
-        if ((header.flags & MAP_HEIGHT_AS_INT16))
+        if ((header->flags & MAP_HEIGHT_AS_INT16))
         {
-            m_uint16_V9 = new uint16 [129*129];
-            m_uint16_V8 = new uint16 [128*128];
-            if (fread(m_uint16_V9, sizeof(uint16), 129*129, in) != 129*129 ||
-                fread(m_uint16_V8, sizeof(uint16), 128*128, in) != 128*128)
+            m_uint16_V9 = reinterpret_cast<uint16 const*>(getFileData(offset, sizeof(uint16) * 129*129));
+            m_uint16_V8 = reinterpret_cast<uint16 const*>(getFileData(offset + sizeof(uint16) * 129*129, sizeof(uint16) * 128*128));
+            if (!m_uint16_V9 || !m_uint16_V8)
                 return false;
-            _gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 65535;
+            _gridIntHeightMultiplier = (header->gridMaxHeight - header->gridHeight) / 65535;
             _gridGetHeight = &GridMap::getHeightFromUint16;
         }
-        else if ((header.flags & MAP_HEIGHT_AS_INT8))
+        else if ((header->flags & MAP_HEIGHT_AS_INT8))
         {
-            m_uint8_V9 = new uint8 [129*129];
-            m_uint8_V8 = new uint8 [128*128];
-            if (fread(m_uint8_V9, sizeof(uint8), 129*129, in) != 129*129 ||
-                fread(m_uint8_V8, sizeof(uint8), 128*128, in) != 128*128)
+            m_uint8_V9 = getFileData(offset, sizeof(uint8) * 129*129);
+            m_uint8_V8 = getFileData(offset + sizeof(uint8) * 129*129, sizeof(uint8) * 128*128);
+            if (!m_uint8_V9 || !m_uint8_V8)
                 return false;
-            _gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 255;
+            _gridIntHeightMultiplier = (header->gridMaxHeight - header->gridHeight) / 255;
             _gridGetHeight = &GridMap::getHeightFromUint8;
         }
         else
         {
-            m_V9 = new float [129*129];
-            m_V8 = new float [128*128];
-            if (fread(m_V9, sizeof(float), 129*129, in) != 129*129 ||
-                fread(m_V8, sizeof(float), 128*128, in) != 128*128)
+            m_V9 = reinterpret_cast<float const*>(getFileData(offset, sizeof(float) * 129*129));
+            m_V8 = reinterpret_cast<float const*>(getFileData(offset + sizeof(float) * 129*129, sizeof(float) * 128*128));
+            if (!m_V9 || !m_V8)
                 return false;
             _gridGetHeight = &GridMap::getHeightFromFloat;
         }
@@ -1103,35 +1336,32 @@ bool GridMap::loadHeihgtData(FILE* in, uint32 offset, uint32 /*size*/)
     return true;
 }
 
-bool GridMap::loadLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadLiquidData(uint32 offset, uint32 /*size*/)
 {
-    map_liquidHeader header;
-    fseek(in, offset, SEEK_SET);
-
-    if (fread(&header, sizeof(header), 1, in) != 1 || header.fourcc != MapLiquidMagic.asUInt)
+    map_liquidHeader const* header = reinterpret_cast<map_liquidHeader const*>(getFileData(offset, sizeof(map_liquidHeader)));
+    if (!header || header->fourcc != MapLiquidMagic.asUInt)
         return false;
 
-    _liquidType   = header.liquidType;
-    _liquidOffX  = header.offsetX;
-    _liquidOffY  = header.offsetY;
-    _liquidWidth = header.width;
-    _liquidHeight = header.height;
-    _liquidLevel  = header.liquidLevel;
+    _liquidType   = header->liquidType;
+    _liquidOffX  = header->offsetX;
+    _liquidOffY  = header->offsetY;
+    _liquidWidth = header->width;
+    _liquidHeight = header->height;
+    _liquidLevel  = header->liquidLevel;
 
-    if (!(header.flags & MAP_LIQUID_NO_TYPE))
+    offset += sizeof(map_liquidHeader);
+    if (!(header->flags & MAP_LIQUID_NO_TYPE))
     {
-        _liquidEntry = new uint16[16*16];
-        if (fread(_liquidEntry, sizeof(uint16), 16*16, in) != 16*16)
-            return false;
-
-        _liquidFlags = new uint8[16*16];
-        if (fread(_liquidFlags, sizeof(uint8), 16*16, in) != 16*16)
+        _liquidEntry = reinterpret_cast<uint16 const*>(getFileData(offset, sizeof(uint16) * 16*16));
+        _liquidFlags = getFileData(offset + sizeof(uint16) * 16*16, sizeof(uint8) * 16*16);
+        if (!_liquidEntry || !_liquidFlags)
             return false;
+        offset += (sizeof(uint16) + sizeof(uint8)) * 16*16;
     }
-    if (!(header.flags & MAP_LIQUID_NO_HEIGHT))
+    if (!(header->flags & MAP_LIQUID_NO_HEIGHT))
     {
-        _liquidMap = new float[uint32(_liquidWidth) * uint32(_liquidHeight)];
-        if (fread(_liquidMap, sizeof(float), _liquidWidth*_liquidHeight, in) != (uint32(_liquidWidth) * uint32(_liquidHeight)))
+        _liquidMap = reinterpret_cast<float const*>(getFileData(offset, sizeof(float) * uint32(_liquidWidth) * uint32(_liquidHeight)));
+        if (!_liquidMap)
             return false;
     }
     return true;
@@ -1252,7 +1482,7 @@ float GridMap::getHeightFromUint8(float x, float y) const
     y_int&=(MAP_RESOLUTION - 1);
 
     int32 a, b, c;
-    uint8 *V9_h1_ptr = &m_uint8_V9[x_int*128 + x_int + y_int];
+    uint8 const* V9_h1_ptr = &m_uint8_V9[x_int*128 + x_int + y_int];
     if (x+y < 1)
     {
         if (x > y)
@@ -1319,7 +1549,7 @@ float GridMap::getHeightFromUint16(float x, float y) const
     y_int&=(MAP_RESOLUTION - 1);
 
     int32 a, b, c;
-    uint16 *V9_h1_ptr = &m_uint16_V9[x_int*128 + x_int + y_int];
+    uint16 const* V9_h1_ptr = &m_uint16_V9[x_int*128 + x_int + y_int];
     if (x+y < 1)
     {
         if (x > y)
@@ -2221,6 +2451,7 @@ void InstanceMap::InitVisibilityDistance()
     //init visibility distance for instances
     m_VisibleDistance = World::GetMaxVisibleDistanceInInstances();
     m_VisibilityNotifyPeriod = World::GetVisibilityNotifyPeriodInInstances();
+    m_VisibilityDensityThreshold = World::GetVisibilityDensityThresholdInInstances();
 }
 
 /*
@@ -2492,7 +2723,10 @@ void InstanceMap::Update(const uint32 t_diff)
     Map::Update(t_diff);
 
     if (i_data)
+    {
+        ScriptProfileScope profile(SCRIPT_PROFILE_INSTANCE, GetId(), GetScriptId());
         i_data->Update(t_diff);
+    }
 }
 
 void InstanceMap::RemovePlayerFromMap(Player* player, bool remove)
@@ -2718,6 +2952,7 @@ void BattlegroundMap::InitVisibilityDistance()
     //init visibility distance for BG/Arenas
     m_VisibleDistance = World::GetMaxVisibleDistanceInBGArenas();
     m_VisibilityNotifyPeriod = World::GetVisibilityNotifyPeriodInBGArenas();
+    m_VisibilityDensityThreshold = World::GetVisibilityDensityThresholdInBGArenas();
 }
 
 bool BattlegroundMap::CanEnter(Player* player)
@@ -2791,7 +3026,7 @@ void Map::UpdateIteratorBack(Player* player)
         m_mapRefIter = m_mapRefIter->nocheck_prev();
 }
 
-void Map::SaveCreatureRespawnTime(uint32 dbGuid, time_t respawnTime)
+void Map::SaveCreatureRespawnTime(uint32 dbGuid, time_t respawnTime, bool immediate)
 {
     if (!respawnTime)
     {
@@ -2801,27 +3036,24 @@ void Map::SaveCreatureRespawnTime(uint32 dbGuid, time_t respawnTime)
     }
 
     _creatureRespawnTimes[dbGuid] = respawnTime;
+    if (!immediate)
+    {
+        _creatureRespawnTimesToSave.insert(dbGuid);
+        return;
+    }
 
-    PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_REP_CREATURE_RESPAWN);
-    stmt->setUInt32(0, dbGuid);
-    stmt->setUInt32(1, uint32(respawnTime));
-    stmt->setUInt16(2, GetId());
-    stmt->setUInt32(3, GetInstanceId());
-    CharacterDatabase.Execute(stmt);
+    _creatureRespawnTimesToSave.erase(dbGuid);
+    CharacterDatabase.Execute(BuildRespawnTimeStatement(true, dbGuid));
 }
 
 void Map::RemoveCreatureRespawnTime(uint32 dbGuid)
 {
-    _creatureRespawnTimes.erase(dbGuid);
-
-    PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_CREATURE_RESPAWN);
-    stmt->setUInt32(0, dbGuid);
-    stmt->setUInt16(1, GetId());
-    stmt->setUInt32(2, GetInstanceId());
-    CharacterDatabase.Execute(stmt);
+    // the database has no row the map does not know
+    if (_creatureRespawnTimes.erase(dbGuid))
+        _creatureRespawnTimesToSave.insert(dbGuid);
 }
 
-void Map::SaveGORespawnTime(uint32 dbGuid, time_t respawnTime)
+void Map::SaveGORespawnTime(uint32 dbGuid, time_t respawnTime, bool immediate)
 {
     if (!respawnTime)
     {
@@ -2831,24 +3063,228 @@ void Map::SaveGORespawnTime(uint32 dbGuid, time_t respawnTime)
     }
 
     _goRespawnTimes[dbGuid] = respawnTime;
+    if (!immediate)
+    {
+        _goRespawnTimesToSave.insert(dbGuid);
+        return;
+    }
 
-    PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_REP_GO_RESPAWN);
-    stmt->setUInt32(0, dbGuid);
-    stmt->setUInt32(1, uint32(respawnTime));
-    stmt->setUInt16(2, GetId());
-    stmt->setUInt32(3, GetInstanceId());
-    CharacterDatabase.Execute(stmt);
+    _goRespawnTimesToSave.erase(dbGuid);
+    CharacterDatabase.Execute(BuildRespawnTimeStatement(false, dbGuid));
 }
 
 void Map::RemoveGORespawnTime(uint32 dbGuid)
 {
-    _goRespawnTimes.erase(dbGuid);
+    if (_goRespawnTimes.erase(dbGuid))
+        _goRespawnTimesToSave.insert(dbGuid);
+}
 
-    PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_DEL_GO_RESPAWN);
-    stmt->setUInt32(0, dbGuid);
-    stmt->setUInt16(1, GetId());
-    stmt->setUInt32(2, GetInstanceId());
-    CharacterDatabase.Execute(stmt);
+PreparedStatement* Map::BuildRespawnTimeStatement(bool creature, uint32 dbGuid) const
+{
+    PreparedStatement* stmt;
+    if (time_t respawnTime = creature ? GetCreatureRespawnTime(dbGuid) : GetGORespawnTime(dbGuid))
+    {
+        stmt = CharacterDatabase.GetPreparedStatement(creature ? CHAR_REP_CREATURE_RESPAWN : CHAR_REP_GO_RESPAWN);
+        stmt->setUInt32(0, dbGuid);
+        stmt->setUInt32(1, uint32(respawnTime));
+        stmt->setUInt16(2, GetId());
+        stmt->setUInt32(3, GetInstanceId());
+    }
+    else
+    {
+        stmt = CharacterDatabase.GetPreparedStatement(creature ? CHAR_DEL_CREATURE_RESPAWN : CHAR_DEL_GO_RESPAWN);
+        stmt->setUInt32(0, dbGuid);
+        stmt->setUInt16(1, GetId());
+        stmt->setUInt32(2, GetInstanceId());
+    }
+
+    return stmt;
+}
+
+void Map::SaveRespawnTimes()
+{
+    if (_creatureRespawnTimesToSave.empty() && _goRespawnTimesToSave.empty())
+        return;
+
+    std::vector<PreparedStatement*> statements;
+    statements.reserve(_creatureRespawnTimesToSave.size() + _goRespawnTimesToSave.size());
+    for (std::set<uint32>::const_iterator itr = _creatureRespawnTimesToSave.begin(); itr != _creatureRespawnTimesToSave.end(); ++itr)
+        statements.push_back(BuildRespawnTimeStatement(true, *itr));
+    for (std::set<uint32>::const_iterator itr = _goRespawnTimesToSave.begin(); itr != _goRespawnTimesToSave.end(); ++itr)
+        statements.push_back(BuildRespawnTimeStatement(false, *itr));
+
+    _creatureRespawnTimesToSave.clear();
+    _goRespawnTimesToSave.clear();
+
+    // the asynchronous queue is not drained when the database closes at shutdown
+    if (World::IsStopped())
+    {
+        for (std::vector<PreparedStatement*>::const_iterator itr = statements.begin(); itr != statements.end(); ++itr)
+            CharacterDatabase.DirectExecute(*itr);
+        return;
+    }
+
+    SQLTransaction trans = CharacterDatabase.BeginTransaction();
+    for (std::vector<PreparedStatement*>::const_iterator itr = statements.begin(); itr != statements.end(); ++itr)
+        trans->Append(*itr);
+    CharacterDatabase.CommitTransaction(trans);
+}
+
+void Map::ScheduleCreatureRespawn(uint64 guid, uint32 dbGuid, time_t respawnTime)
+{
+    _creatureRespawnQueue.push(CreatureRespawnInfo(respawnTime, guid, dbGuid));
+    if (!guid)
+        _unloadedDeadCreatures.insert(dbGuid);
+}
+
+void Map::ProcessCreatureRespawns()
+{
+    time_t now = time(NULL);
+    while (!_creatureRespawnQueue.empty() && _creatureRespawnQueue.top().respawnTime <= now)
+    {
+        CreatureRespawnInfo info = _creatureRespawnQueue.top();
+        _creatureRespawnQueue.pop();
+
+        if (!info.guid)
+        {
+            time_t respawnTime = GetCreatureRespawnTime(info.dbGuid);
+            if (respawnTime == info.respawnTime)
+            {
+                _unloadedDeadCreatures.erase(info.dbGuid);
+                RespawnUnloadedCreature(info.dbGuid);
+            }
+            else if (!respawnTime)                          // respawned meanwhile
+                _unloadedDeadCreatures.erase(info.dbGuid);
+            else if (respawnTime < info.respawnTime)        // respawn time changed without being queued
+                ScheduleCreatureRespawn(0, info.dbGuid, respawnTime);
+            continue;
+        }
+
+        Creature* creature = GetCreature(info.guid);
+        if (!creature || creature->GetRespawnQueueTime() != info.respawnTime)
+            continue;
+
+        creature->ProcessRespawn();
+
+        // not allowed yet or waiting for its linked master
+        if (creature->getDeathState() == DEAD)
+        {
+            time_t respawnTime = std::max(creature->GetRespawnTime(), now + 1);
+            creature->SetRespawnQueueTime(respawnTime);
+            ScheduleCreatureRespawn(info.guid, info.dbGuid, respawnTime);
+        }
+    }
+}
+
+bool Map::CanUnloadDeadCreature(uint32 dbGuid) const
+{
+    // instance scripts keep track of their creatures
+    if (!dbGuid || Instanceable())
+        return false;
+
+    CreatureData const* data = sObjectMgr->GetCreatureData(dbGuid);
+    if (!data || !data->dbData)
+        return false;
+
+    // CanRespawn of the AI can not be asked without the creature
+    CreatureTemplate const* creatureTemplate = sObjectMgr->GetCreatureTemplate(data->id);
+    if (!creatureTemplate || creatureTemplate->ScriptID)
+        return false;
+
+    if (sPoolMgr->IsPartOfAPool<Creature>(dbGuid))
+        return false;
+
+    // formation leaders, game events and zone scripts look for their creatures on the grid
+    if (sFormationMgr->CreatureGroupMap.find(dbGuid) != sFormationMgr->CreatureGroupMap.end())
+        return false;
+
+    if (sGameEventMgr->IsCreatureInEvent(dbGuid))
+        return false;
+
+    uint32 zoneId = GetZoneId(data->posX, data->posY, data->posZ);
+    return !sBattlefieldMgr->GetBattlefieldToZoneId(zoneId) && !sOutdoorPvPMgr->GetZoneScript(zoneId);
+}
+
+bool Map::DeferCreatureSpawn(uint32 dbGuid)
+{
+    time_t respawnTime = GetCreatureRespawnTime(dbGuid);
+    if (respawnTime <= time(NULL) || !CanUnloadDeadCreature(dbGuid))
+        return false;
+
+    ScheduleCreatureRespawn(0, dbGuid, respawnTime);
+    return true;
+}
+
+void Map::RespawnUnloadedCreature(uint32 dbGuid)
+{
+    CreatureData const* data = sObjectMgr->GetCreatureData(dbGuid);
+    if (!data)
+    {
+        RemoveCreatureRespawnTime(dbGuid);
+        return;
+    }
+
+    uint64 dbtableHighGuid = MAKE_NEW_GUID(dbGuid, data->id, HIGHGUID_UNIT);
+    if (time_t linkedRespawnTime = GetLinkedRespawnTime(dbtableHighGuid))
+    {
+        // same delays as Creature::ProcessRespawn
+        time_t now = time(NULL);
+        time_t respawnTime;
+        if (sObjectMgr->GetLinkedRespawnGuid(dbtableHighGuid) == dbtableHighGuid)
+            respawnTime = now + DAY;
+        else
+            respawnTime = std::max(now, linkedRespawnTime) + urand(5, MINUTE);
+
+        SaveCreatureRespawnTime(dbGuid, respawnTime);
+        ScheduleCreatureRespawn(0, dbGuid, respawnTime);
+        return;
+    }
+
+    RemoveCreatureRespawnTime(dbGuid);
+    SpawnUnloadedCreature(dbGuid, data);
+}
+
+uint32 Map::RespawnUnloadedCreatures(WorldObject const* center, float range)
+{
+    uint32 count = 0;
+    for (std::set<uint32>::iterator itr = _unloadedDeadCreatures.begin(); itr != _unloadedDeadCreatures.end();)
+    {
+        uint32 dbGuid = *itr;
+        CreatureData const* data = sObjectMgr->GetCreatureData(dbGuid);
+        if (data && center->GetExactDist2dSq(data->posX, data->posY) > range * range)
+        {
+            ++itr;
+            continue;
+        }
+
+        // the queue entry is skipped once the respawn time is gone
+        _unloadedDeadCreatures.erase(itr++);
+        RemoveCreatureRespawnTime(dbGuid);
+        if (data)
+        {
+            SpawnUnloadedCreature(dbGuid, data);
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+void Map::SpawnUnloadedCreature(uint32 dbGuid, CreatureData const* data)
+{
+    // spawned alive when its grid gets loaded
+    if (!IsGridLoaded(data->posX, data->posY))
+        return;
+
+    // game events may have removed the spawn meanwhile
+    CellCoord cellCoord = Trinity::ComputeCellCoord(data->posX, data->posY);
+    CellObjectGuids const& cellGuids = sObjectMgr->GetCellObjectGuids(GetId(), GetSpawnMode(), cellCoord.GetId());
+    if (cellGuids.creatures.find(dbGuid) == cellGuids.creatures.end())
+        return;
+
+    Creature* creature = new Creature();
+    if (!creature->LoadCreatureFromDB(dbGuid, this))
+        delete creature;
 }
 
 void Map::LoadRespawnTimes()
@@ -2888,6 +3324,8 @@ void Map::DeleteRespawnTimes()
 {
     _creatureRespawnTimes.clear();
     _goRespawnTimes.clear();
+    _creatureRespawnTimesToSave.clear();
+    _goRespawnTimesToSave.clear();
 
     DeleteRespawnTimesInDB(GetId(), GetInstanceId());
 }
@@ -2905,6 +3343,16 @@ void Map::DeleteRespawnTimesInDB(uint16 mapId, uint32 instanceId)
     CharacterDatabase.Execute(stmt);
 }
 
+bool Map::StartMailboxLoad()
+{
+    uint32 maxLoads = sWorld->getIntConfig(CONFIG_MAILBOX_LOADS_PER_MAP);
+    if (++_mailboxLoads <= maxLoads || !maxLoads)
+        return true;
+
+    --_mailboxLoads;
+    return false;
+}
+
 time_t Map::GetLinkedRespawnTime(uint64 guid) const
 {
     uint64 linkedGuid = sObjectMgr->GetLinkedRespawnGuid(guid);
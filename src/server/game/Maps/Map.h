@@ -20,6 +20,7 @@
 #define TRINITY_MAP_H
 
 #include "Define.h"
+#include <ace/Atomic_Op.h>
 #include <ace/RW_Thread_Mutex.h>
 #include <ace/Thread_Mutex.h>
 
@@ -32,10 +33,14 @@
 #include "MapRefManager.h"
 #include "DynamicTree.h"
 #include "GameObjectModel.h"
+#include "NavPathCache.h"
 
 #include <bitset>
 #include <list>
+#include <queue>
+#include <set>
 
+class ACE_Mem_Map;
 class Unit;
 class WorldPacket;
 class InstanceScript;
@@ -49,6 +54,8 @@ class CreatureGroup;
 struct ScriptInfo;
 struct ScriptAction;
 struct Position;
+struct CreatureData;
+class PreparedStatement;
 class Battleground;
 class MapInstanced;
 class InstanceMap;
@@ -142,31 +149,32 @@ struct LiquidData
     float  depth_level;
 };
 
+// read-only view of a memory mapped .map tile, shared through GridMapCache
 class GridMap
 {
     uint32  _flags;
     union{
-        float* m_V9;
-        uint16* m_uint16_V9;
-        uint8* m_uint8_V9;
+        float const* m_V9;
+        uint16 const* m_uint16_V9;
+        uint8 const* m_uint8_V9;
     };
     union{
-        float* m_V8;
-        uint16* m_uint16_V8;
-        uint8* m_uint8_V8;
+        float const* m_V8;
+        uint16 const* m_uint16_V8;
+        uint8 const* m_uint8_V8;
     };
     // Height level data
     float _gridHeight;
     float _gridIntHeightMultiplier;
 
     // Area data
-    uint16* _areaMap;
+    uint16 const* _areaMap;
 
     // Liquid data
     float _liquidLevel;
-    uint16* _liquidEntry;
-    uint8* _liquidFlags;
-    float* _liquidMap;
+    uint16 const* _liquidEntry;
+    uint8 const* _liquidFlags;
+    float const* _liquidMap;
     uint16 _gridArea;
     uint16 _liquidType;
     uint8 _liquidOffX;
@@ -174,10 +182,13 @@ class GridMap
     uint8 _liquidWidth;
     uint8 _liquidHeight;
 
+    ACE_Mem_Map* _file;
 
-    bool loadAreaData(FILE* in, uint32 offset, uint32 size);
-    bool loadHeihgtData(FILE* in, uint32 offset, uint32 size);
-    bool loadLiquidData(FILE* in, uint32 offset, uint32 size);
+    // returns a pointer to size bytes at offset of the mapped file, NULL if the file is too short
+    uint8 const* getFileData(uint32 offset, uint32 size) const;
+    bool loadAreaData(uint32 offset, uint32 size);
+    bool loadHeihgtData(uint32 offset, uint32 size);
+    bool loadLiquidData(uint32 offset, uint32 size);
 
     // Get height functions and pointers
     typedef float (GridMap::*GetHeightPtr) (float x, float y) const;
@@ -190,8 +201,9 @@ class GridMap
 public:
     GridMap();
     ~GridMap();
-    bool loadData(char* filaname);
+    bool loadData(char const* filename);
     void unloadData();
+    void prefault() const;                                  // touch every page so first lookups don't hit the disk
 
     uint16 getArea(float x, float y) const;
     inline float getHeight(float x, float y) const {return (this->*_gridGetHeight)(x, y);}
@@ -260,10 +272,12 @@ class Map : public GridRefManager<NGridType>
         template<class T> bool AddToMap(T *);
         template<class T> void RemoveFromMap(T *, bool);
 
-        void VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer> &worldVisitor);
+        void VisitActiveCells(TypeContainerVisitor<Trinity::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<Trinity::ObjectUpdater, WorldTypeMapContainer> &worldVisitor);
         virtual void Update(const uint32);
 
         float GetVisibilityRange() const { return m_VisibleDistance; }
+        // visible units count above which players get throttled updates of far objects, 0 = off
+        uint32 GetVisibilityDensityThreshold() const { return m_VisibilityDensityThreshold; }
         //function for setting up visibility distance for maps on per-type/per-Id basis
         virtual void InitVisibilityDistance();
 
@@ -384,9 +398,59 @@ class Map : public GridRefManager<NGridType>
         void UpdateObjectVisibility(WorldObject* obj, Cell cell, CellCoord cellpair);
         void UpdateObjectsVisibilityFor(Player* player, Cell cell, CellCoord cellpair);
 
-        void resetMarkedCells() { marked_cells.reset(); }
-        bool isCellMarked(uint32 pCellId) { return marked_cells.test(pCellId); }
-        void markCell(uint32 pCellId) { marked_cells.set(pCellId); }
+        // visits only cells where visibility may change when point of view moves from old to new position:
+        // cells within nearRadius of either point and cells not fully inside both views
+        template<class NOTIFIER> void VisitVisibilityDelta(float oldX, float oldY, float newX, float newY, float radius, float nearRadius, NOTIFIER &notifier);
+
+        // visibility work done by player visibility updates, accumulated per map tick
+        struct VisibilityStats
+        {
+            VisibilityStats() { Reset(); }
+            void Reset() { memset(this, 0, sizeof(VisibilityStats)); }
+
+            uint32 FullPasses;
+            uint32 IncrementalPasses;
+            uint32 CellsVisited;                            // by incremental passes
+            uint32 CellsSkipped;                            // by incremental passes
+            uint32 ObjectsChecked;
+            uint32 ObjectsCreated;
+            uint32 ObjectsDestroyed;
+            uint32 ValuesDeferred;                          // values updates held back for crowded observers
+            uint32 ValuesFlushed;
+            uint32 MessagesSkipped;                         // low priority messages dropped for crowded observers
+        };
+
+        VisibilityStats& GetVisibilityStats() { return _visibilityStats; }
+        VisibilityStats const& GetLastTickVisibilityStats() const { return _lastTickVisibilityStats; }
+
+        // paths found by PathGenerator for units of this map
+        NavPathCache& GetNavPathCache() { return _navPathCache; }
+
+        // spline movement started on this map, accumulated over one second windows
+        struct SplineStats
+        {
+            SplineStats() { Reset(); }
+            void Reset() { memset(this, 0, sizeof(SplineStats)); }
+
+            uint32 Elapsed;                                 // length of the window, in ms
+            uint32 SplinesLaunched;                         // all units, any movement
+            uint32 ChaseLaunches;                           // chase and follow generators
+            uint32 ChaseReplansSkipped;                     // target still inside the tolerance cone
+            uint32 ChaseLaunchesCoalesced;                  // postponed, already launched this tick
+        };
+
+        SplineStats& GetSplineStats() { return _splineStats; }
+        SplineStats const& GetLastSecondSplineStats() const { return _lastSecondSplineStats; }
+        uint32 GetUpdateTick() const { return _updateTick; }
+
+        // creatures of the active cells updated and left dormant by the last map update
+        uint32 GetAwakeCreatureCount() const { return _awakeCreatures; }
+        uint32 GetDormantCreatureCount() const { return _dormantCreatures; }
+
+        // cells kept updated by players and active objects, refcounted per cell
+        void AddActiveCellSource(WorldObject* obj);
+        void RemoveActiveCellSource(WorldObject* obj);
+        uint32 GetActiveCellsCount() const { return _activeCellRefs.size(); }
 
         bool HavePlayers() const { return !m_mapRefManager.isEmpty(); }
         uint32 GetPlayersCountExceptGMs() const;
@@ -468,19 +532,44 @@ class Map : public GridRefManager<NGridType>
             return time_t(0);
         }
 
-        void SaveCreatureRespawnTime(uint32 dbGuid, time_t respawnTime);
+        // kept in memory, written to the database by SaveRespawnTimes unless immediate
+        void SaveCreatureRespawnTime(uint32 dbGuid, time_t respawnTime, bool immediate = false);
         void RemoveCreatureRespawnTime(uint32 dbGuid);
-        void SaveGORespawnTime(uint32 dbGuid, time_t respawnTime);
+        void SaveGORespawnTime(uint32 dbGuid, time_t respawnTime, bool immediate = false);
         void RemoveGORespawnTime(uint32 dbGuid);
         void LoadRespawnTimes();
         void DeleteRespawnTimes();
+        void SaveRespawnTimes();
+
+        // dead creatures are respawned by the map at their respawn time, guid is 0 for unloaded ones
+        void ScheduleCreatureRespawn(uint64 guid, uint32 dbGuid, time_t respawnTime);
+        // dead spawns of continents without scripts, pools, formations, game events or zone scripts are unloaded until they respawn
+        bool CanUnloadDeadCreature(uint32 dbGuid) const;
+        // at grid load, true if the spawn is dead and left unloaded
+        bool DeferCreatureSpawn(uint32 dbGuid);
+        // respawns now the unloaded dead spawns within range of center, returns their count
+        uint32 RespawnUnloadedCreatures(WorldObject const* center, float range);
+        uint32 GetRespawnQueueSize() const { return _creatureRespawnQueue.size(); }
+        uint32 GetRespawnTimesToSaveCount() const { return _creatureRespawnTimesToSave.size() + _goRespawnTimesToSave.size(); }
 
         static void DeleteRespawnTimesInDB(uint16 mapId, uint32 instanceId);
 
+        // mailbox loads in flight for the players of the map, at most CONFIG_MAILBOX_LOADS_PER_MAP
+        bool StartMailboxLoad();
+        void FinishMailboxLoad() { --_mailboxLoads; }
+        uint32 GetMailboxLoadCount() const { return _mailboxLoads.value(); }
+
     private:
+        PreparedStatement* BuildRespawnTimeStatement(bool creature, uint32 dbGuid) const;
+        void ProcessCreatureRespawns();
+        void RespawnUnloadedCreature(uint32 dbGuid);
+        void SpawnUnloadedCreature(uint32 dbGuid, CreatureData const* data);
+
         void LoadMapAndVMap(int gx, int gy);
         void LoadVMap(int gx, int gy);
         void LoadMap(int gx, int gy, bool reload = false);
+        void PrefetchGridMapsAround(float x, float y);
+        void PrefetchGridMap(int gx, int gy);
         GridMap* GetGrid(float x, float y);
 
         void SetTimer(uint32 t) { i_gridExpiry = t < MIN_GRID_DELAY ? MIN_GRID_DELAY : t; }
@@ -504,6 +593,22 @@ class Map : public GridRefManager<NGridType>
         bool EnsureGridLoaded(Cell const&);
         void EnsureGridLoadedForActiveObject(Cell const&, WorldObject* object);
 
+        // grid a moving player heads to, its objects are created a few cells per update
+        struct PendingGridLoad
+        {
+            PendingGridLoad(uint32 _x, uint32 _y) : x(_x), y(_y), nextCell(0) { }
+
+            uint32 x;
+            uint32 y;
+            uint32 nextCell;                                // the cells before are loaded
+        };
+
+        void PredictGridLoad(Player* player);
+        void ProcessPendingGridLoads();
+        uint32 TakePendingGridLoad(uint32 x, uint32 y);     // returns the first cell left to load
+
+        std::list<PendingGridLoad> _pendingGridLoads;
+
         void buildNGridLinkage(NGridType* pNGridType) { pNGridType->link(this); }
 
         template<class T> void AddType(T *obj);
@@ -544,10 +649,10 @@ class Map : public GridRefManager<NGridType>
         MapRefManager::iterator m_mapRefIter;
 
         int32 m_VisibilityNotifyPeriod;
+        uint32 m_VisibilityDensityThreshold;
 
         typedef std::set<WorldObject*> ActiveNonPlayers;
         ActiveNonPlayers m_activeNonPlayers;
-        ActiveNonPlayers::iterator m_activeNonPlayersIter;
 
     private:
         Player* _GetScriptPlayerSourceOrTarget(Object* source, Object* target, const ScriptInfo* scriptInfo) const;
@@ -567,9 +672,36 @@ class Map : public GridRefManager<NGridType>
 
         NGridType* i_grids[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
         GridMap* GridMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
-        std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP*TOTAL_NUMBER_OF_CELLS_PER_MAP> marked_cells;
+
+        struct ActiveCellSource
+        {
+            ActiveCellSource() : valid(false) {}
+
+            CellArea area;
+            bool valid;
+        };
+
+        typedef UNORDERED_MAP<WorldObject*, ActiveCellSource> ActiveCellSources;
+        typedef UNORDERED_MAP<uint32 /*cellId*/, uint32 /*refCount*/> ActiveCellRefs;
+        VisibilityStats _visibilityStats;
+        VisibilityStats _lastTickVisibilityStats;
+
+        ActiveCellSources _activeCellSources;
+        ActiveCellRefs _activeCellRefs;
+        std::vector<uint32> _activeCellsToVisit;
+
+        void UpdateActiveCellSources();
+        void RefActiveCells(CellArea const& area);
+        void UnrefActiveCells(CellArea const& area);
 
         bool i_scriptLock;
+        NavPathCache _navPathCache;
+        SplineStats _splineStats;
+        SplineStats _lastSecondSplineStats;
+        uint32 _updateTick;
+        uint32 _awakeCreatures;
+        uint32 _dormantCreatures;
+
         std::set<WorldObject*> i_objectsToRemove;
         std::map<WorldObject*, bool> i_objectsToSwitch;
         std::set<WorldObject*> i_worldObjects;
@@ -587,28 +719,39 @@ class Map : public GridRefManager<NGridType>
         template<class T>
         void AddToActiveHelper(T* obj)
         {
-            m_activeNonPlayers.insert(obj);
+            if (m_activeNonPlayers.insert(obj).second)
+                AddActiveCellSource(obj);
         }
 
         template<class T>
         void RemoveFromActiveHelper(T* obj)
         {
-            // Map::Update for active object in proccess
-            if (m_activeNonPlayersIter != m_activeNonPlayers.end())
-            {
-                ActiveNonPlayers::iterator itr = m_activeNonPlayers.find(obj);
-                if (itr == m_activeNonPlayers.end())
-                    return;
-                if (itr == m_activeNonPlayersIter)
-                    ++m_activeNonPlayersIter;
-                m_activeNonPlayers.erase(itr);
-            }
-            else
-                m_activeNonPlayers.erase(obj);
+            if (m_activeNonPlayers.erase(obj))
+                RemoveActiveCellSource(obj);
         }
 
         UNORDERED_MAP<uint32 /*dbGUID*/, time_t> _creatureRespawnTimes;
         UNORDERED_MAP<uint32 /*dbGUID*/, time_t> _goRespawnTimes;
+        std::set<uint32 /*dbGUID*/> _creatureRespawnTimesToSave;
+        std::set<uint32 /*dbGUID*/> _goRespawnTimesToSave;
+        uint32 _respawnTimesSaveTimer;
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint32> _mailboxLoads;
+
+        struct CreatureRespawnInfo
+        {
+            CreatureRespawnInfo(time_t _respawnTime, uint64 _guid, uint32 _dbGuid) : respawnTime(_respawnTime), guid(_guid), dbGuid(_dbGuid) { }
+
+            // soonest on top of the priority queue
+            bool operator<(CreatureRespawnInfo const& right) const { return respawnTime > right.respawnTime; }
+
+            time_t respawnTime;
+            uint64 guid;
+            uint32 dbGuid;
+        };
+
+        // entries are not removed when the creature respawns or changes its respawn time, they are skipped when popped
+        std::priority_queue<CreatureRespawnInfo> _creatureRespawnQueue;
+        std::set<uint32 /*dbGUID*/> _unloadedDeadCreatures;
 };
 
 enum InstanceResetMethod
@@ -687,6 +830,52 @@ inline void Map::Visit(Cell const& cell, TypeContainerVisitor<T, CONTAINER>& vis
     }
 }
 
+template<class NOTIFIER>
+inline void Map::VisitVisibilityDelta(float oldX, float oldY, float newX, float newY, float radius, float nearRadius, NOTIFIER& notifier)
+{
+    CellArea oldArea = Cell::CalculateCellArea(oldX, oldY, radius);
+    CellArea newArea = Cell::CalculateCellArea(newX, newY, radius);
+
+    uint32 lowX = std::min(oldArea.low_bound.x_coord, newArea.low_bound.x_coord);
+    uint32 lowY = std::min(oldArea.low_bound.y_coord, newArea.low_bound.y_coord);
+    uint32 highX = std::max(oldArea.high_bound.x_coord, newArea.high_bound.x_coord);
+    uint32 highY = std::max(oldArea.high_bound.y_coord, newArea.high_bound.y_coord);
+
+    float radiusSq = radius * radius;
+    float nearRadiusSq = nearRadius * nearRadius;
+
+    TypeContainerVisitor<NOTIFIER, WorldTypeMapContainer> world_object_notifier(notifier);
+    TypeContainerVisitor<NOTIFIER, GridTypeMapContainer >  grid_object_notifier(notifier);
+
+    for (uint32 x = lowX; x <= highX; ++x)
+    {
+        for (uint32 y = lowY; y <= highY; ++y)
+        {
+            CellCoord cellCoord(x, y);
+            float nearOldSq = Cell::GetNearestDistSq(cellCoord, oldX, oldY);
+            float nearNewSq = Cell::GetNearestDistSq(cellCoord, newX, newY);
+
+            // out of both views
+            if (nearOldSq > radiusSq && nearNewSq > radiusSq)
+                continue;
+
+            // fully inside both views and out of detection range, nothing can change here
+            if (nearOldSq > nearRadiusSq && nearNewSq > nearRadiusSq &&
+                Cell::GetFarthestDistSq(cellCoord, oldX, oldY) <= radiusSq &&
+                Cell::GetFarthestDistSq(cellCoord, newX, newY) <= radiusSq)
+            {
+                ++_visibilityStats.CellsSkipped;
+                continue;
+            }
+
+            ++_visibilityStats.CellsVisited;
+            Cell cell(cellCoord);
+            Visit(cell, world_object_notifier);
+            Visit(cell, grid_object_notifier);
+        }
+    }
+}
+
 template<class NOTIFIER>
 inline void Map::VisitAll(float const& x, float const& y, float radius, NOTIFIER& notifier, bool loadGrids)
 {
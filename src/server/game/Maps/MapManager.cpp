@@ -25,6 +25,8 @@
 #include "Transport.h"
 #include "GridDefines.h"
 #include "MapInstanced.h"
+#include "GridMapCache.h"
+#include "NavMeshMgr.h"
 #include "InstanceScript.h"
 #include "Config.h"
 #include "World.h"
@@ -344,6 +346,9 @@ void MapManager::UnloadAll()
     if (m_updater.activated())
         m_updater.deactivate();
 
+    sGridMapCache->Unload();
+    sNavMeshMgr->Unload();
+
     Map::DeleteStateMachine();
 }
 
@@ -116,7 +116,7 @@ bool PhaseMgr::NeedsPhaseUpdateWithData(PhaseUpdateData const& updateData) const
     {
         for (PhaseDefinitionContainer::const_iterator phase = itr->second.begin(); phase != itr->second.end(); ++phase)
         {
-            ConditionList conditionList = sConditionMgr->GetConditionsForPhaseDefinition(phase->zoneId, phase->entry);
+            ConditionList const& conditionList = sConditionMgr->GetConditionsForPhaseDefinition(phase->zoneId, phase->entry);
             for (ConditionList::const_iterator condition = conditionList.begin(); condition != conditionList.end(); ++condition)
                 if (updateData.IsConditionRelated(*condition))
                     return true;
@@ -25,8 +25,20 @@
 #include "MoveSplineInit.h"
 #include "MoveSpline.h"
 #include "Player.h"
+#include "PathGenerator.h"
 
 //----- Point Movement Generator
+template<class T>
+void PointMovementGenerator<T>::_setPath(T &unit, Movement::MoveSplineInit& init)
+{
+    // scripts expect the exact point to be reached, walk around obstacles only when that is possible
+    PathGenerator path(&unit);
+    if (path.CalculatePath(i_x, i_y, i_z) == PATHFIND_NORMAL)
+        init.MovebyPath(path.GetPath());
+    else
+        init.MoveTo(i_x, i_y, i_z);
+}
+
 template<class T>
 void PointMovementGenerator<T>::Initialize(T &unit)
 {
@@ -36,7 +48,7 @@ void PointMovementGenerator<T>::Initialize(T &unit)
     unit.AddUnitState(UNIT_STATE_ROAMING|UNIT_STATE_ROAMING_MOVE);
     i_recalculateSpeed = false;
     Movement::MoveSplineInit init(unit);
-    init.MoveTo(i_x, i_y, i_z);
+    _setPath(unit, init);
     if (speed > 0.0f)
         init.SetVelocity(speed);
     init.Launch();
@@ -60,7 +72,7 @@ bool PointMovementGenerator<T>::Update(T &unit, const uint32 & /*diff*/)
     {
         i_recalculateSpeed = false;
         Movement::MoveSplineInit init(unit);
-        init.MoveTo(i_x, i_y, i_z);
+        _setPath(unit, init);
         if (speed > 0.0f) // Default value for point motion type is 0.0, if 0.0 spline will use GetSpeed on unit
             init.SetVelocity(speed);
         init.Launch();
@@ -22,6 +22,11 @@
 #include "MovementGenerator.h"
 #include "FollowerReference.h"
 
+namespace Movement
+{
+    class MoveSplineInit;
+}
+
 template<class T>
 class PointMovementGenerator : public MovementGeneratorMedium< T, PointMovementGenerator<T> >
 {
@@ -42,6 +47,8 @@ class PointMovementGenerator : public MovementGeneratorMedium< T, PointMovementG
 
         bool GetDestination(float& x, float& y, float& z) const { x=i_x; y=i_y; z=i_z; return true; }
     private:
+        void _setPath(T &, Movement::MoveSplineInit& init);
+
         uint32 id;
         float i_x, i_y, i_z;
         float speed;
@@ -26,6 +26,7 @@
 #include "CreatureGroups.h"
 #include "MoveSplineInit.h"
 #include "MoveSpline.h"
+#include "PathGenerator.h"
 
 #define RUNNING_CHANCE_RANDOMMV 20                                  //will be "1 / RUNNING_CHANCE_RANDOMMV"
 
@@ -102,10 +103,14 @@ void RandomMovementGenerator<Creature>::_setRandomLocation(Creature& creature)
     else
         i_nextMoveTime.Reset(urand(500, 10000));
 
+    PathGenerator path(&creature);
+    if (path.CalculatePath(destX, destY, destZ) == PATHFIND_NOPATH)
+        return;
+
     creature.AddUnitState(UNIT_STATE_ROAMING_MOVE);
 
     Movement::MoveSplineInit init(creature);
-    init.MoveTo(destX, destY, destZ);
+    init.MovebyPath(path.GetPath());
     init.SetWalk(true);
     init.Launch();
 
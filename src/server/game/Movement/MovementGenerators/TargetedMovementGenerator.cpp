@@ -26,6 +26,8 @@
 #include "MoveSplineInit.h"
 #include "MoveSpline.h"
 #include "Player.h"
+#include "Map.h"
+#include "PathGenerator.h"
 
 #include <cmath>
 
@@ -35,6 +37,119 @@ bool PetFollowMovementGenerator<Creature>::EnableWalking() const
     return i_target.isValid() && i_target->IsWalking();
 }
 
+template<class T, typename D>
+bool TargetedMovementGeneratorMedium<T,D>::_isPathUsable(T &owner, PathGenerator const& path) const
+{
+    // target out of reach, stay where we are
+    if (path.GetPathType() == PATHFIND_NOPATH)
+        return false;
+
+    // already walking to the closest reachable point, don't relaunch the same spline
+    if (path.GetPathType() == PATHFIND_INCOMPLETE && !owner.movespline->Finalized() &&
+        (owner.movespline->FinalDestination() - path.GetPath().back()).squaredLength() < 1.0f)
+        return false;
+
+    return true;
+}
+
+template<class T, typename D>
+bool TargetedMovementGeneratorMedium<T,D>::_needsReplan(T &owner)
+{
+    //More distance let have better performance, less distance let have more sensitive reaction at target move.
+    float allowed_dist = i_target->GetObjectSize() + owner.GetObjectSize() + MELEE_RANGE - 0.5f;
+    G3D::Vector3 dest = owner.movespline->FinalDestination();
+    float dist = (dest - G3D::Vector3(i_target->GetPositionX(),i_target->GetPositionY(),i_target->GetPositionZ())).squaredLength();
+    if (dist < allowed_dist * allowed_dist)
+        return false;
+
+    if (owner.movespline->Finalized())
+        return true;
+
+    // keep the current spline while the target, where it is going to be, stays inside
+    // a cone around the spline end; far targets may drift more before a new spline is sent
+    float x, y, z;
+    _predictTargetPosition(owner, x, y, z);
+    float cone = std::sin(sWorld->getIntConfig(CONFIG_CHASE_TOLERANCE_ANGLE) * float(M_PI) / 180.0f);
+    float tolerance = std::max(allowed_dist, owner.GetExactDist(x, y, z) * cone);
+    if ((dest - G3D::Vector3(x, y, z)).squaredLength() > tolerance * tolerance)
+        return true;
+
+    if (Map* map = owner.FindMap())
+        ++map->GetSplineStats().ChaseReplansSkipped;
+    return false;
+}
+
+template<class T, typename D>
+void TargetedMovementGeneratorMedium<T,D>::_predictTargetPosition(T &owner, float &x, float &y, float &z) const
+{
+    Unit* target = i_target.getTarget();
+    target->GetPosition(x, y, z);
+
+    uint32 predictionTime = sWorld->getIntConfig(CONFIG_CHASE_PREDICTION_TIME);
+    if (!predictionTime || target->GetTransGUID())
+        return;
+
+    // no use looking further ahead than the time we need to get there
+    float time = std::min(owner.GetExactDist(x, y, z) / std::max(owner.GetSpeed(MOVE_RUN), 1.0f), predictionTime / float(IN_MILLISECONDS));
+    float dist;
+    float angle;
+
+    if (!target->movespline->Finalized())
+    {
+        // server controlled target, heading for the end of its spline
+        G3D::Vector3 end = target->movespline->FinalDestination();
+        float length = target->GetExactDist(end.x, end.y, end.z);
+        dist = std::min(target->GetSpeed(target->IsWalking() ? MOVE_WALK : MOVE_RUN) * time, length);
+        if (length < 0.1f)
+            return;
+
+        x += (end.x - x) * dist / length;
+        y += (end.y - y) * dist / length;
+        z += (end.z - z) * dist / length;
+        return;
+    }
+
+    // client controlled target, direction from its movement flags
+    int32 forward = (target->m_movementInfo.HasMovementFlag(MOVEMENTFLAG_FORWARD) ? 1 : 0) - (target->m_movementInfo.HasMovementFlag(MOVEMENTFLAG_BACKWARD) ? 1 : 0);
+    int32 strafe = (target->m_movementInfo.HasMovementFlag(MOVEMENTFLAG_STRAFE_LEFT) ? 1 : 0) - (target->m_movementInfo.HasMovementFlag(MOVEMENTFLAG_STRAFE_RIGHT) ? 1 : 0);
+    if (!forward && !strafe)
+        return;
+
+    UnitMoveType moveType;
+    if (target->m_movementInfo.HasMovementFlag(MOVEMENTFLAG_SWIMMING))
+        moveType = forward < 0 ? MOVE_SWIM_BACK : MOVE_SWIM;
+    else
+        moveType = forward < 0 ? MOVE_RUN_BACK : (target->IsWalking() ? MOVE_WALK : MOVE_RUN);
+
+    dist = target->GetSpeed(moveType) * time;
+    angle = target->GetOrientation() + std::atan2(float(strafe), float(forward));
+    x += dist * std::cos(angle);
+    y += dist * std::sin(angle);
+}
+
+// one spline per generator and map tick, later requests are picked up by the next update
+template<class T, typename D>
+bool TargetedMovementGeneratorMedium<T,D>::_canLaunch(T &owner)
+{
+    Map* map = owner.FindMap();
+    if (!map || i_lastLaunchTick != map->GetUpdateTick())
+        return true;
+
+    i_recalculateTravel = true;
+    ++map->GetSplineStats().ChaseLaunchesCoalesced;
+    return false;
+}
+
+template<class T, typename D>
+void TargetedMovementGeneratorMedium<T,D>::_onLaunch(T &owner)
+{
+    if (Map* map = owner.FindMap())
+    {
+        i_lastLaunchTick = map->GetUpdateTick();
+        ++map->GetSplineStats().ChaseLaunches;
+    }
+}
+
 template<class T, typename D>
 void TargetedMovementGeneratorMedium<T,D>::_setTargetLocation(T &owner)
 {
@@ -44,6 +159,9 @@ void TargetedMovementGeneratorMedium<T,D>::_setTargetLocation(T &owner)
     if (owner.HasUnitState(UNIT_STATE_NOT_MOVE))
         return;
 
+    if (!_canLaunch(owner))
+        return;
+
     // Hack for Beth'tilac
     switch((&owner)->GetEntry())
     {
@@ -135,14 +253,19 @@ void TargetedMovementGeneratorMedium<T,D>::_setTargetLocation(T &owner)
     */
 
 
+    owner.UpdateAllowedPositionZ(x, y, z);
+
+    PathGenerator path(&owner);
+    path.CalculatePath(x, y, z);
+    if (!_isPathUsable(owner, path))
+        return;
+
     D::_addUnitStateMove(owner);
     i_targetReached = false;
     i_recalculateTravel = false;
 
-    owner.UpdateAllowedPositionZ(x, y, z);
-
     Movement::MoveSplineInit init(owner);
-    init.MoveTo(x,y,z);
+    init.MovebyPath(path.GetPath());
     init.SetWalk(((D*)this)->EnableWalking());
     // Using the same condition for facing target as the one that is used for SetInFront on movement end
     // - applies to ChaseMovementGenerator mostly
@@ -150,6 +273,7 @@ void TargetedMovementGeneratorMedium<T,D>::_setTargetLocation(T &owner)
         init.SetFacing(i_target.getTarget());
 
     init.Launch();
+    _onLaunch(owner);
 }
 
 template <>
@@ -161,6 +285,9 @@ void TargetedMovementGeneratorMedium<Creature, PetFollowMovementGenerator<Creatu
     if (owner.HasUnitState(UNIT_STATE_NOT_MOVE))
         return;
 
+    if (!_canLaunch(owner))
+        return;
+
     float x, y, z;
     if (!i_offset)
     {
@@ -218,14 +345,19 @@ void TargetedMovementGeneratorMedium<Creature, PetFollowMovementGenerator<Creatu
     */
 
 
+    owner.UpdateAllowedPositionZ(x, y, z);
+
+    PathGenerator path(&owner);
+    path.CalculatePath(x, y, z);
+    if (!_isPathUsable(owner, path))
+        return;
+
     PetFollowMovementGenerator<Creature>::_addUnitStateMove(owner);
     i_targetReached = false;
     i_recalculateTravel = false;
 
-    owner.UpdateAllowedPositionZ(x, y, z);
-
     Movement::MoveSplineInit init(owner);
-    init.MoveTo(x,y,z);
+    init.MovebyPath(path.GetPath());
     init.SetWalk(((PetFollowMovementGenerator<Creature>*)this)->EnableWalking());
     // Using the same condition for facing target as the one that is used for SetInFront on movement end
     // - applies to ChaseMovementGenerator mostly
@@ -233,6 +365,7 @@ void TargetedMovementGeneratorMedium<Creature, PetFollowMovementGenerator<Creatu
         init.SetFacing(i_target.getTarget());
 
     init.Launch();
+    _onLaunch(owner);
 }
 
 template<>
@@ -295,10 +428,7 @@ bool TargetedMovementGeneratorMedium<T,D>::Update(T &owner, const uint32 & time_
     if (i_recheckDistance.Passed())
     {
         i_recheckDistance.Reset(50);
-        //More distance let have better performance, less distance let have more sensitive reaction at target move.
-        float allowed_dist = i_target->GetObjectSize() + owner.GetObjectSize() + MELEE_RANGE - 0.5f;
-        float dist = (owner.movespline->FinalDestination() - G3D::Vector3(i_target->GetPositionX(),i_target->GetPositionY(),i_target->GetPositionZ())).squaredLength();
-        if (dist >= allowed_dist * allowed_dist)
+        if (_needsReplan(owner))
             _setTargetLocation(owner);
     }
 
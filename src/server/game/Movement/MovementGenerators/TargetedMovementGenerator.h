@@ -24,6 +24,8 @@
 #include "Timer.h"
 #include "Unit.h"
 
+class PathGenerator;
+
 class TargetedMovementGeneratorBase
 {
     public:
@@ -39,7 +41,7 @@ class TargetedMovementGeneratorMedium : public MovementGeneratorMedium< T, D >,
     protected:
         TargetedMovementGeneratorMedium(Unit &target, float offset, float angle) :
             TargetedMovementGeneratorBase(target), i_recheckDistance(0),
-            i_offset(offset), i_angle(angle),
+            i_offset(offset), i_angle(angle), i_lastLaunchTick(uint32(-1)),
             i_recalculateTravel(false), i_targetReached(false)
         {
         }
@@ -54,10 +56,16 @@ class TargetedMovementGeneratorMedium : public MovementGeneratorMedium< T, D >,
 
     protected:
         void _setTargetLocation(T &);
+        bool _isPathUsable(T &, PathGenerator const& path) const;
+        bool _needsReplan(T &);
+        void _predictTargetPosition(T &, float &x, float &y, float &z) const;
+        bool _canLaunch(T &);
+        void _onLaunch(T &);
 
         TimeTrackerSmall i_recheckDistance;
         float i_offset;
         float i_angle;
+        uint32 i_lastLaunchTick;                            // map update tick of the last spline launch, -1 before the first
         bool i_recalculateTravel : 1;
         bool i_targetReached : 1;
 };
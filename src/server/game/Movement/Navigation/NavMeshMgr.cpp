@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NavMeshMgr.h"
+#include "World.h"
+#include "Log.h"
+
+static char const* NAV_MAGIC         = "NAVT";
+static char const* NAV_VERSION_MAGIC = "n1.0";
+
+static inline uint32 MakeTileKey(uint32 mapId, uint32 gx, uint32 gy)
+{
+    return (mapId << 12) | (gx << 6) | gy;
+}
+
+NavMeshMgr::NavMeshMgr() : _enabled(false)
+{
+}
+
+NavMeshMgr::~NavMeshMgr()
+{
+    Unload();
+}
+
+void NavMeshMgr::Initialize()
+{
+    _enabled = sWorld->getBoolConfig(CONFIG_NAVIGATION_ENABLE);
+    sLog->outInfo(LOG_FILTER_SERVER_LOADING, "Navigation support: %s. Data directory is: %snavmesh",
+        _enabled ? "enabled" : "disabled", sWorld->GetDataPath().c_str());
+}
+
+void NavMeshMgr::Unload()
+{
+    ACE_Write_Guard<ACE_RW_Thread_Mutex> guard(_lock);
+    for (TileMap::iterator itr = _tiles.begin(); itr != _tiles.end(); ++itr)
+        delete itr->second;
+    _tiles.clear();
+}
+
+NavTile* NavMeshMgr::LoadTile(uint32 mapId, uint32 gx, uint32 gy)
+{
+    int len = sWorld->GetDataPath().length() + strlen("navmesh/%03u%02u%02u.nav") + 1;
+    char* fileName = new char[len];
+    snprintf(fileName, len, (sWorld->GetDataPath() + "navmesh/%03u%02u%02u.nav").c_str(), mapId, gx, gy);
+
+    FILE* file = fopen(fileName, "rb");
+    if (!file)
+    {
+        delete [] fileName;
+        return NULL;
+    }
+
+    NavTile* tile = NULL;
+    nav_fileheader header;
+    if (fread(&header, sizeof(header), 1, file) == 1 &&
+        header.navMagic == *((uint32 const*)(NAV_MAGIC)) &&
+        header.versionMagic == *((uint32 const*)(NAV_VERSION_MAGIC)) &&
+        header.mapId == mapId && header.tileX == gx && header.tileY == gy &&
+        header.cellsPerSide == NAV_TILE_CELLS)
+    {
+        tile = new NavTile();
+        if (fread(tile->cells, sizeof(tile->cells), 1, file) != 1)
+        {
+            delete tile;
+            tile = NULL;
+        }
+    }
+
+    if (!tile)
+        sLog->outError(LOG_FILTER_MAPS, "Navigation file '%s' is non-compatible or corrupt, please re-create it with navmesh_generator", fileName);
+    else
+        sLog->outDebug(LOG_FILTER_MAPS, "Loaded navigation tile %s", fileName);
+
+    fclose(file);
+    delete [] fileName;
+    return tile;
+}
+
+NavTile const* NavMeshMgr::GetTile(uint32 mapId, uint32 gx, uint32 gy)
+{
+    uint32 key = MakeTileKey(mapId, gx, gy);
+    {
+        ACE_Read_Guard<ACE_RW_Thread_Mutex> guard(_lock);
+        TileMap::const_iterator itr = _tiles.find(key);
+        if (itr != _tiles.end())
+            return itr->second;
+    }
+
+    // read outside of the lock, tiles are small and never change once loaded
+    NavTile* tile = LoadTile(mapId, gx, gy);
+
+    ACE_Write_Guard<ACE_RW_Thread_Mutex> guard(_lock);
+    std::pair<TileMap::iterator, bool> result = _tiles.insert(TileMap::value_type(key, tile));
+    if (!result.second)
+        delete tile;                                        // loaded by another map thread meanwhile
+
+    return result.first->second;
+}
+
+uint32 NavMeshMgr::GetLoadedTilesCount()
+{
+    ACE_Read_Guard<ACE_RW_Thread_Mutex> guard(_lock);
+    uint32 count = 0;
+    for (TileMap::const_iterator itr = _tiles.begin(); itr != _tiles.end(); ++itr)
+        if (itr->second)
+            ++count;
+    return count;
+}
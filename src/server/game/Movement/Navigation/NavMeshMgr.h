@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_NAVMESHMGR_H
+#define TRINITY_NAVMESHMGR_H
+
+#include "Common.h"
+#include "GridDefines.h"
+#include <ace/Singleton.h>
+#include <ace/RW_Thread_Mutex.h>
+
+// ******************************************
+// Navigation tile file format, written by navmesh_generator
+// ******************************************
+#define NAV_TILE_CELLS      MAP_RESOLUTION                  // cells per tile side, same layout as .map V8 heights
+#define NAV_MAP_CELLS       (NAV_TILE_CELLS * MAX_NUMBER_OF_GRIDS)
+#define NAV_CELL_SIZE       (SIZE_OF_GRIDS / NAV_TILE_CELLS)
+
+enum NavCellFlags
+{
+    NAV_CELL_WALKABLE   = 0x01,
+    NAV_CELL_LINK_XP    = 0x02,                             // can step to cell x + 1
+    NAV_CELL_LINK_XN    = 0x04,                             // can step to cell x - 1
+    NAV_CELL_LINK_YP    = 0x08,                             // can step to cell y + 1
+    NAV_CELL_LINK_YN    = 0x10,                             // can step to cell y - 1
+    NAV_CELL_WATER      = 0x20                              // deep water, only for swimmers
+};
+
+struct nav_fileheader
+{
+    uint32 navMagic;
+    uint32 versionMagic;
+    uint32 mapId;
+    uint32 tileX;
+    uint32 tileY;
+    uint32 cellsPerSide;
+};
+
+struct NavTile
+{
+    uint8 cells[NAV_TILE_CELLS * NAV_TILE_CELLS];
+};
+
+/// Read-only walkability grid built offline from terrain and vmap data.
+/// Tiles are loaded on first use and shared by all instances of a map.
+class NavMeshMgr
+{
+    friend class ACE_Singleton<NavMeshMgr, ACE_Thread_Mutex>;
+
+    NavMeshMgr();
+    ~NavMeshMgr();
+
+    public:
+        void Initialize();
+        void Unload();
+
+        bool IsEnabled() const { return _enabled; }
+
+        // NULL if the map has no navigation data at this tile
+        NavTile const* GetTile(uint32 mapId, uint32 gx, uint32 gy);
+
+        uint32 GetLoadedTilesCount();
+
+        // world position to global cell coordinates, 0 .. NAV_MAP_CELLS - 1
+        static uint32 ComputeCell(float c)
+        {
+            int32 cell = int32(NAV_TILE_CELLS * (CENTER_GRID_ID - c / SIZE_OF_GRIDS));
+            return cell < 0 ? 0 : (cell >= NAV_MAP_CELLS ? NAV_MAP_CELLS - 1 : uint32(cell));
+        }
+        static float ComputeCellCenter(uint32 cell) { return (CENTER_GRID_ID - (cell + 0.5f) / NAV_TILE_CELLS) * SIZE_OF_GRIDS; }
+
+    private:
+        NavTile* LoadTile(uint32 mapId, uint32 gx, uint32 gy);
+
+        typedef UNORDERED_MAP<uint32, NavTile*> TileMap;    // NULL entries remember missing files
+        TileMap _tiles;
+        ACE_RW_Thread_Mutex _lock;
+
+        bool _enabled;
+};
+
+#define sNavMeshMgr ACE_Singleton<NavMeshMgr, ACE_Thread_Mutex>::instance()
+
+#endif
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NavPathCache.h"
+
+NavPathCache::NavPathCache(uint32 maxSize) : _maxSize(maxSize), _hits(0), _misses(0)
+{
+}
+
+NavCachedPath const* NavPathCache::Find(uint32 startCell, uint32 endCell, bool swim)
+{
+    IndexMap::iterator itr = _index.find(MakeKey(startCell, endCell, swim));
+    if (itr == _index.end())
+    {
+        ++_misses;
+        return NULL;
+    }
+
+    ++_hits;
+    _lru.splice(_lru.begin(), _lru, itr->second);
+    return &itr->second->second;
+}
+
+void NavPathCache::Insert(uint32 startCell, uint32 endCell, bool swim, NavCellPath const& cells, uint8 type)
+{
+    if (!_maxSize)
+        return;
+
+    uint64 key = MakeKey(startCell, endCell, swim);
+    IndexMap::iterator itr = _index.find(key);
+    if (itr != _index.end())
+    {
+        _lru.splice(_lru.begin(), _lru, itr->second);
+        itr->second->second.Cells = cells;
+        itr->second->second.Type = type;
+        return;
+    }
+
+    if (_index.size() >= _maxSize)
+    {
+        _index.erase(_lru.back().first);
+        _lru.pop_back();
+    }
+
+    _lru.push_front(LruList::value_type(key, NavCachedPath()));
+    _lru.front().second.Cells = cells;
+    _lru.front().second.Type = type;
+    _index[key] = _lru.begin();
+}
+
+void NavPathCache::Clear()
+{
+    _lru.clear();
+    _index.clear();
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_NAVPATHCACHE_H
+#define TRINITY_NAVPATHCACHE_H
+
+#include "Common.h"
+#include <list>
+#include <vector>
+
+typedef std::vector<uint32> NavCellPath;                    // corner cells of a smoothed path
+
+struct NavCachedPath
+{
+    NavCellPath Cells;
+    uint8 Type;                                             // PathType of the search
+};
+
+/// LRU cache of cell paths, owned by a map and only used from its update thread.
+/// Chasing many creatures to the same target cell runs the search once.
+class NavPathCache
+{
+    public:
+        explicit NavPathCache(uint32 maxSize);
+
+        NavCachedPath const* Find(uint32 startCell, uint32 endCell, bool swim);
+        void Insert(uint32 startCell, uint32 endCell, bool swim, NavCellPath const& cells, uint8 type);
+        void Clear();
+
+        uint32 GetSize() const { return _index.size(); }
+        uint32 GetMaxSize() const { return _maxSize; }
+        uint32 GetHits() const { return _hits; }
+        uint32 GetMisses() const { return _misses; }
+
+    private:
+        static uint64 MakeKey(uint32 startCell, uint32 endCell, bool swim)
+        {
+            return (uint64(startCell) << 32) | (uint64(endCell) << 1) | uint64(swim);
+        }
+
+        typedef std::list<std::pair<uint64, NavCachedPath> > LruList;
+        typedef UNORDERED_MAP<uint64, LruList::iterator> IndexMap;
+
+        LruList _lru;                                       // most recently used first
+        IndexMap _index;
+        uint32 _maxSize;
+        uint32 _hits;
+        uint32 _misses;
+};
+
+#endif
@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PathGenerator.h"
+#include "Creature.h"
+#include "Map.h"
+#include "World.h"
+
+#include <algorithm>
+#include <queue>
+
+// how far from the terrain surface a position may be and still be treated as standing on it;
+// units on bridges, in buildings or caves move in a straight line as before
+#define NAV_TERRAIN_TOLERANCE   4.0f
+
+#define NAV_DIAGONAL_COST       1.41421356f
+
+struct NavNode
+{
+    float Cost;
+    uint32 Parent;
+    bool Closed;
+};
+
+static inline uint32 MakeCellKey(uint32 cellX, uint32 cellY)
+{
+    return cellX * NAV_MAP_CELLS + cellY;
+}
+
+static inline float OctileDistance(uint32 from, uint32 to)
+{
+    int32 dx = std::abs(int32(from / NAV_MAP_CELLS) - int32(to / NAV_MAP_CELLS));
+    int32 dy = std::abs(int32(from % NAV_MAP_CELLS) - int32(to % NAV_MAP_CELLS));
+    return float(dx + dy) + (NAV_DIAGONAL_COST - 2.0f) * float(std::min(dx, dy));
+}
+
+PathGenerator::PathGenerator(Unit const* owner) : _owner(owner), _mapId(owner->GetMapId()), _canSwim(true),
+    _type(PATHFIND_BLANK), _cacheHit(false), _searchedNodes(0), _lastTileKey(0xFFFFFFFF), _lastTile(NULL)
+{
+    if (Creature const* creature = owner->ToCreature())
+        _canSwim = creature->canSwim();
+}
+
+PathType PathGenerator::CalculatePath(float destX, float destY, float destZ)
+{
+    _points.clear();
+    _cacheHit = false;
+    _searchedNodes = 0;
+
+    if (!CanUseNavigation(destX, destY, destZ))
+    {
+        BuildShortcut(destX, destY, destZ);
+        return _type;
+    }
+
+    uint32 startCell = MakeCellKey(NavMeshMgr::ComputeCell(_owner->GetPositionX()), NavMeshMgr::ComputeCell(_owner->GetPositionY()));
+    uint32 endCell = MakeCellKey(NavMeshMgr::ComputeCell(destX), NavMeshMgr::ComputeCell(destY));
+
+    // same cell, or one of the ends outside of the navigation data
+    if (startCell == endCell ||
+        !(GetCellFlags(startCell / NAV_MAP_CELLS, startCell % NAV_MAP_CELLS) & NAV_CELL_WALKABLE) ||
+        !(GetCellFlags(endCell / NAV_MAP_CELLS, endCell % NAV_MAP_CELLS) & NAV_CELL_WALKABLE))
+    {
+        BuildShortcut(destX, destY, destZ);
+        return _type;
+    }
+
+    NavPathCache& cache = _owner->GetMap()->GetNavPathCache();
+    NavCellPath cells;
+    if (NavCachedPath const* cached = cache.Find(startCell, endCell, _canSwim))
+    {
+        cells = cached->Cells;
+        _type = PathType(cached->Type);
+        _cacheHit = true;
+    }
+    else
+    {
+        _type = FindCellPath(startCell, endCell, cells);
+        SmoothCellPath(cells);
+        cache.Insert(startCell, endCell, _canSwim, cells, _type);
+    }
+
+    if (_type == PATHFIND_NOPATH)
+    {
+        _points.push_back(G3D::Vector3(_owner->GetPositionX(), _owner->GetPositionY(), _owner->GetPositionZ()));
+        return _type;
+    }
+
+    BuildPointPath(cells, destX, destY, destZ);
+    return _type;
+}
+
+bool PathGenerator::CanUseNavigation(float destX, float destY, float destZ) const
+{
+    if (!sNavMeshMgr->IsEnabled())
+        return false;
+
+    if (_owner->GetTransGUID() || _owner->IsFlying())
+        return false;
+
+    if (Creature const* creature = _owner->ToCreature())
+        if (creature->CanFly())
+            return false;
+
+    return IsOnTerrain(_owner->GetPositionX(), _owner->GetPositionY(), _owner->GetPositionZ()) &&
+        IsOnTerrain(destX, destY, destZ);
+}
+
+bool PathGenerator::IsOnTerrain(float x, float y, float z) const
+{
+    float ground = _owner->GetMap()->GetHeight(x, y, MAX_HEIGHT, false);
+    return ground > INVALID_HEIGHT && fabs(z - ground) < NAV_TERRAIN_TOLERANCE;
+}
+
+uint8 PathGenerator::GetCellFlags(uint32 cellX, uint32 cellY)
+{
+    uint32 tileKey = ((cellX / NAV_TILE_CELLS) << 6) | (cellY / NAV_TILE_CELLS);
+    if (tileKey != _lastTileKey)
+    {
+        _lastTileKey = tileKey;
+        _lastTile = sNavMeshMgr->GetTile(_mapId, cellX / NAV_TILE_CELLS, cellY / NAV_TILE_CELLS);
+    }
+
+    if (!_lastTile)
+        return 0;
+
+    uint8 flags = _lastTile->cells[(cellX % NAV_TILE_CELLS) * NAV_TILE_CELLS + cellY % NAV_TILE_CELLS];
+    if (!_canSwim && (flags & NAV_CELL_WATER))
+        return 0;
+
+    return flags;
+}
+
+bool PathGenerator::IsLinked(uint32 cellX, uint32 cellY, int32 dx, int32 dy)
+{
+    uint8 link;
+    if (dx > 0)
+        link = NAV_CELL_LINK_XP;
+    else if (dx < 0)
+        link = NAV_CELL_LINK_XN;
+    else if (dy > 0)
+        link = NAV_CELL_LINK_YP;
+    else
+        link = NAV_CELL_LINK_YN;
+
+    if (!(GetCellFlags(cellX, cellY) & link))
+        return false;
+
+    // the generator never links past the map border, but the destination may still be water
+    return GetCellFlags(cellX + dx, cellY + dy) & NAV_CELL_WALKABLE;
+}
+
+// walks the cells crossed by the line between both cell centers, one axis step at a time
+bool PathGenerator::HasStraightPath(uint32 from, uint32 to)
+{
+    int32 x = from / NAV_MAP_CELLS;
+    int32 y = from % NAV_MAP_CELLS;
+    int32 nx = std::abs(int32(to / NAV_MAP_CELLS) - x);
+    int32 ny = std::abs(int32(to % NAV_MAP_CELLS) - y);
+    int32 sx = int32(to / NAV_MAP_CELLS) > x ? 1 : -1;
+    int32 sy = int32(to % NAV_MAP_CELLS) > y ? 1 : -1;
+
+    for (int32 ix = 0, iy = 0; ix < nx || iy < ny;)
+    {
+        if ((1 + 2 * ix) * ny < (1 + 2 * iy) * nx)
+        {
+            if (!IsLinked(x, y, sx, 0))
+                return false;
+            x += sx;
+            ++ix;
+        }
+        else
+        {
+            if (!IsLinked(x, y, 0, sy))
+                return false;
+            y += sy;
+            ++iy;
+        }
+    }
+
+    return true;
+}
+
+PathType PathGenerator::FindCellPath(uint32 startCell, uint32 endCell, NavCellPath& cells)
+{
+    typedef UNORDERED_MAP<uint32, NavNode> NodeMap;
+    typedef std::pair<float, uint32> OpenEntry;
+
+    static int32 const directions[8][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+
+    uint32 maxNodes = sWorld->getIntConfig(CONFIG_NAVIGATION_MAX_SEARCH_NODES);
+
+    NodeMap nodes;
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry> > open;
+
+    NavNode startNode = { 0.0f, startCell, false };
+    nodes[startCell] = startNode;
+    open.push(OpenEntry(OctileDistance(startCell, endCell), startCell));
+
+    uint32 best = startCell;
+    float bestDistance = OctileDistance(startCell, endCell);
+    bool found = false;
+
+    while (!open.empty())
+    {
+        uint32 current = open.top().second;
+        open.pop();
+
+        NavNode& node = nodes[current];
+        if (node.Closed)
+            continue;
+
+        node.Closed = true;
+        float cost = node.Cost;
+
+        if (current == endCell)
+        {
+            found = true;
+            break;
+        }
+
+        float distance = OctileDistance(current, endCell);
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            best = current;
+        }
+
+        if (++_searchedNodes >= maxNodes)
+            break;
+
+        uint32 cellX = current / NAV_MAP_CELLS;
+        uint32 cellY = current % NAV_MAP_CELLS;
+        for (uint8 i = 0; i < 8; ++i)
+        {
+            int32 dx = directions[i][0];
+            int32 dy = directions[i][1];
+
+            if (dx && dy)
+            {
+                // no corner cutting, both orthogonal ways around must be open
+                if (!IsLinked(cellX, cellY, dx, 0) || !IsLinked(cellX + dx, cellY, 0, dy) ||
+                    !IsLinked(cellX, cellY, 0, dy) || !IsLinked(cellX, cellY + dy, dx, 0))
+                    continue;
+            }
+            else if (!IsLinked(cellX, cellY, dx, dy))
+                continue;
+
+            uint32 next = MakeCellKey(cellX + dx, cellY + dy);
+            float nextCost = cost + (dx && dy ? NAV_DIAGONAL_COST : 1.0f);
+
+            NodeMap::iterator itr = nodes.find(next);
+            if (itr == nodes.end())
+            {
+                NavNode nextNode = { nextCost, current, false };
+                nodes[next] = nextNode;
+            }
+            else if (itr->second.Closed || itr->second.Cost <= nextCost)
+                continue;
+            else
+            {
+                itr->second.Cost = nextCost;
+                itr->second.Parent = current;
+            }
+
+            open.push(OpenEntry(nextCost + OctileDistance(next, endCell), next));
+        }
+    }
+
+    uint32 last = found ? endCell : best;
+    if (last == startCell)
+        return PATHFIND_NOPATH;
+
+    for (uint32 cell = last; cell != startCell; cell = nodes[cell].Parent)
+        cells.push_back(cell);
+    cells.push_back(startCell);
+    std::reverse(cells.begin(), cells.end());
+
+    return found ? PATHFIND_NORMAL : PATHFIND_INCOMPLETE;
+}
+
+// keeps only the cells where the path has to turn
+void PathGenerator::SmoothCellPath(NavCellPath& cells)
+{
+    if (cells.size() <= 2)
+        return;
+
+    NavCellPath corners;
+    corners.push_back(cells.front());
+
+    uint32 anchor = 0;
+    for (uint32 i = 2; i < cells.size(); ++i)
+    {
+        if (!HasStraightPath(cells[anchor], cells[i]))
+        {
+            anchor = i - 1;
+            corners.push_back(cells[anchor]);
+        }
+    }
+
+    corners.push_back(cells.back());
+    cells.swap(corners);
+}
+
+void PathGenerator::BuildPointPath(NavCellPath const& cells, float destX, float destY, float destZ)
+{
+    Map* map = _owner->GetMap();
+    G3D::Vector3 start(_owner->GetPositionX(), _owner->GetPositionY(), _owner->GetPositionZ());
+
+    _points.reserve(cells.size());
+    _points.push_back(start);                               // replaced by the real position at launch
+
+    // corners at the cell centers; an incomplete path ends at the center of its last cell
+    uint32 corners = _type == PATHFIND_NORMAL ? cells.size() - 1 : cells.size();
+    for (uint32 i = 1; i < corners; ++i)
+    {
+        float x = NavMeshMgr::ComputeCellCenter(cells[i] / NAV_MAP_CELLS);
+        float y = NavMeshMgr::ComputeCellCenter(cells[i] % NAV_MAP_CELLS);
+        float z = map->GetHeight(x, y, MAX_HEIGHT, false);
+        if (z <= INVALID_HEIGHT)
+            z = start.z + (destZ - start.z) * i / cells.size();
+
+        _points.push_back(G3D::Vector3(x, y, z));
+    }
+
+    if (_type == PATHFIND_NORMAL)
+        _points.push_back(G3D::Vector3(destX, destY, destZ));
+}
+
+void PathGenerator::BuildShortcut(float destX, float destY, float destZ)
+{
+    _points.push_back(G3D::Vector3(_owner->GetPositionX(), _owner->GetPositionY(), _owner->GetPositionZ()));
+    _points.push_back(G3D::Vector3(destX, destY, destZ));
+    _type = PATHFIND_SHORTCUT;
+}
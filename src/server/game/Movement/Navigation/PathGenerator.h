@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_PATHGENERATOR_H
+#define TRINITY_PATHGENERATOR_H
+
+#include "NavMeshMgr.h"
+#include "NavPathCache.h"
+#include "MoveSplineInitArgs.h"
+
+class Unit;
+
+enum PathType
+{
+    PATHFIND_BLANK      = 0x00,
+    PATHFIND_NORMAL     = 0x01,                             // path found on the navigation grid
+    PATHFIND_SHORTCUT   = 0x02,                             // straight line, no navigation data applies here
+    PATHFIND_INCOMPLETE = 0x04,                             // destination unreachable, path ends at the closest reachable point
+    PATHFIND_NOPATH     = 0x08                              // no progress towards the destination is possible
+};
+
+/// Finds a walkable way from the owner position to a destination.
+/// The resulting points are meant for Movement::MoveSplineInit::MovebyPath.
+class PathGenerator
+{
+    public:
+        explicit PathGenerator(Unit const* owner);
+
+        PathType CalculatePath(float destX, float destY, float destZ);
+
+        Movement::PointsArray const& GetPath() const { return _points; }
+        PathType GetPathType() const { return _type; }
+        bool IsCacheHit() const { return _cacheHit; }
+        uint32 GetSearchedNodes() const { return _searchedNodes; }
+
+    private:
+        bool CanUseNavigation(float destX, float destY, float destZ) const;
+        bool IsOnTerrain(float x, float y, float z) const;
+
+        uint8 GetCellFlags(uint32 cellX, uint32 cellY);
+        bool IsLinked(uint32 cellX, uint32 cellY, int32 dx, int32 dy);
+        bool HasStraightPath(uint32 from, uint32 to);
+
+        PathType FindCellPath(uint32 startCell, uint32 endCell, NavCellPath& cells);
+        void SmoothCellPath(NavCellPath& cells);
+        void BuildPointPath(NavCellPath const& cells, float destX, float destY, float destZ);
+        void BuildShortcut(float destX, float destY, float destZ);
+
+        Unit const* _owner;
+        uint32 _mapId;
+        bool _canSwim;
+
+        Movement::PointsArray _points;
+        PathType _type;
+        bool _cacheHit;
+        uint32 _searchedNodes;
+
+        // last tile looked up, cells are mostly visited in runs on the same tile
+        uint32 _lastTileKey;
+        NavTile const* _lastTile;
+};
+
+#endif
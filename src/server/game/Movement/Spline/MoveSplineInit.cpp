@@ -21,6 +21,7 @@
 #include "MoveSpline.h"
 #include "MovementPacketBuilder.h"
 #include "Unit.h"
+#include "Map.h"
 #include "Transport.h"
 #include "Vehicle.h"
 
@@ -119,6 +120,9 @@ namespace Movement
 
         PacketBuilder::WriteMonsterMove(move_spline, data);
         unit.SendMessageToSet(&data, true);
+
+        if (unit.IsInWorld())
+            ++unit.GetMap()->GetSplineStats().SplinesLaunched;
     }
 
     void MoveSplineInit::Stop()
@@ -157,6 +157,104 @@ if (!V) \
 if (!V) \
     return R;
 
+// Calls and time spent in the scripts of a hook. Player hooks are also called from map threads.
+struct ScriptHookStats
+{
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> Calls;
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> Time;             // microseconds
+};
+
+// Scripts of a type subscribed to each of its hooks, in registry order. Built once all scripts are added.
+template<class TScript>
+class ScriptHookRegistry
+{
+public:
+
+    typedef std::vector<TScript*> ScriptList;
+
+    static ScriptList Subscribers[MAX_SCRIPT_HOOKS];
+    static ScriptHookStats Stats[MAX_SCRIPT_HOOKS];
+
+    static void Build()
+    {
+        Clear();
+
+        for (typename ScriptRegistry<TScript>::ScriptMapIterator itr = ScriptRegistry<TScript>::ScriptPointerList.begin();
+            itr != ScriptRegistry<TScript>::ScriptPointerList.end(); ++itr)
+            for (uint32 hook = 0; hook < MAX_SCRIPT_HOOKS; ++hook)
+                if (itr->second->GetHooks() & SCRIPT_HOOK_MASK(hook))
+                    Subscribers[hook].push_back(itr->second);
+    }
+
+    static void Clear()
+    {
+        for (uint32 hook = 0; hook < MAX_SCRIPT_HOOKS; ++hook)
+            Subscribers[hook].clear();
+    }
+};
+
+class ScriptHookTimer
+{
+public:
+
+    explicit ScriptHookTimer(ScriptHookStats& stats) : _stats(stats), _start(ACE_OS::gettimeofday()) { }
+
+    ~ScriptHookTimer()
+    {
+        ACE_Time_Value elapsed = ACE_OS::gettimeofday() - _start;
+        ++_stats.Calls;
+        _stats.Time += long(elapsed.sec() * IN_MILLISECONDS * IN_MILLISECONDS + elapsed.usec());
+    }
+
+private:
+
+    ScriptHookStats& _stats;
+    ACE_Time_Value _start;
+};
+
+// Utility macro for looping over the scripts subscribed to a hook, a hook without any costs a single check.
+#define FOREACH_SCRIPT_HOOK(T, H) \
+if (ScriptHookRegistry<T>::Subscribers[H].empty()) \
+    return; \
+ScriptHookTimer hookTimer(ScriptHookRegistry<T>::Stats[H]); \
+for (ScriptHookRegistry<T>::ScriptList::const_iterator itr = ScriptHookRegistry<T>::Subscribers[H].begin(); \
+    itr != ScriptHookRegistry<T>::Subscribers[H].end(); ++itr) \
+    (*itr)
+
+static char const* const WorldScriptHookNames[WORLDHOOK_END] =
+{
+    "OnOpenStateChange", "OnConfigLoad", "OnMotdChange", "OnShutdownInitiate", "OnShutdownCancel", "OnUpdate"
+};
+
+static char const* const PlayerScriptHookNames[PLAYERHOOK_END] =
+{
+    "OnPVPKill", "OnCreatureKill", "OnPlayerKilledByCreature", "OnLevelChanged", "OnDuelRequest", "OnDuelStart",
+    "OnDuelEnd", "OnChat", "OnChat(whisper)", "OnChat(group)", "OnChat(guild)", "OnChat(channel)", "OnEmote",
+    "OnTextEmote", "OnSpellCast", "OnLogin", "OnLogout", "OnBindToInstance", "OnPlayerEnterCombat",
+    "OnPlayerLeaveCombat", "OnStartWatching", "OnEndWatching"
+};
+
+static char const* const GroupScriptHookNames[GROUPHOOK_END] =
+{
+    "OnAddMember", "OnInviteMember", "OnRemoveMember", "OnChangeLeader", "OnDisband"
+};
+
+template<class TScript>
+static void DumpScriptHookStats(std::ostringstream& o, char const* type, char const* const* names, uint32 hookCount)
+{
+    for (uint32 hook = 0; hook < hookCount; ++hook)
+    {
+        size_t scripts = ScriptHookRegistry<TScript>::Subscribers[hook].size();
+        if (!scripts)
+            continue;
+
+        long calls = ScriptHookRegistry<TScript>::Stats[hook].Calls.value();
+        long time = ScriptHookRegistry<TScript>::Stats[hook].Time.value();
+        o << type << "::" << names[hook] << ": " << uint32(scripts) << " scripts, " << calls << " calls, "
+          << time / IN_MILLISECONDS << " ms total, " << (calls ? time / calls : 0) << " us per call\n";
+    }
+}
+
 void DoScriptText(int32 iTextEntry, WorldObject* pSource, Unit* target)
 {
     if (!pSource)
@@ -253,6 +351,10 @@ void ScriptMgr::Initialize()
     FillSpellSummary();
     AddScripts();
 
+    ScriptHookRegistry<WorldScript>::Build();
+    ScriptHookRegistry<PlayerScript>::Build();
+    ScriptHookRegistry<GroupScript>::Build();
+
     sLog->outInfo(LOG_FILTER_SERVER_LOADING, ">> Loaded %u C++ scripts in %u ms", GetScriptCount(), GetMSTimeDiffToNow(oldMSTime));
 }
 
@@ -263,6 +365,10 @@ void ScriptMgr::Unload()
     delete itr->second; \
     SCR_REG_LST(T).clear();
 
+    ScriptHookRegistry<WorldScript>::Clear();
+    ScriptHookRegistry<PlayerScript>::Clear();
+    ScriptHookRegistry<GroupScript>::Clear();
+
     // Clear scripts for every script type.
     SCR_CLEAR(SpellScriptLoader);
     SCR_CLEAR(ServerScript);
@@ -446,32 +552,32 @@ void ScriptMgr::CreateSpellScriptLoaders(uint32 spellId, std::vector<std::pair<S
 
 void ScriptMgr::OnOpenStateChange(bool open)
 {
-    FOREACH_SCRIPT(WorldScript)->OnOpenStateChange(open);
+    FOREACH_SCRIPT_HOOK(WorldScript, WORLDHOOK_ON_OPEN_STATE_CHANGE)->OnOpenStateChange(open);
 }
 
 void ScriptMgr::OnConfigLoad(bool reload)
 {
-    FOREACH_SCRIPT(WorldScript)->OnConfigLoad(reload);
+    FOREACH_SCRIPT_HOOK(WorldScript, WORLDHOOK_ON_CONFIG_LOAD)->OnConfigLoad(reload);
 }
 
 void ScriptMgr::OnMotdChange(std::string& newMotd)
 {
-    FOREACH_SCRIPT(WorldScript)->OnMotdChange(newMotd);
+    FOREACH_SCRIPT_HOOK(WorldScript, WORLDHOOK_ON_MOTD_CHANGE)->OnMotdChange(newMotd);
 }
 
 void ScriptMgr::OnShutdownInitiate(ShutdownExitCode code, ShutdownMask mask)
 {
-    FOREACH_SCRIPT(WorldScript)->OnShutdownInitiate(code, mask);
+    FOREACH_SCRIPT_HOOK(WorldScript, WORLDHOOK_ON_SHUTDOWN_INITIATE)->OnShutdownInitiate(code, mask);
 }
 
 void ScriptMgr::OnShutdownCancel()
 {
-    FOREACH_SCRIPT(WorldScript)->OnShutdownCancel();
+    FOREACH_SCRIPT_HOOK(WorldScript, WORLDHOOK_ON_SHUTDOWN_CANCEL)->OnShutdownCancel();
 }
 
 void ScriptMgr::OnWorldUpdate(uint32 diff)
 {
-    FOREACH_SCRIPT(WorldScript)->OnUpdate(diff);
+    FOREACH_SCRIPT_HOOK(WorldScript, WORLDHOOK_ON_UPDATE)->OnUpdate(diff);
 }
 
 InstanceScript* ScriptMgr::CreateInstanceData(InstanceMap* map)
@@ -864,145 +970,145 @@ bool ScriptMgr::OnCriteriaCheck(uint32 scriptId, Player* source, Unit* target)
 
 void ScriptMgr::OnPlayerEnterCombat(Player* player, Unit* enemy)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnPlayerEnterCombat(player, enemy);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_ENTER_COMBAT)->OnPlayerEnterCombat(player, enemy);
 }
 
 void ScriptMgr::OnPlayerLeaveCombat(Player* player)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnPlayerLeaveCombat(player);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_LEAVE_COMBAT)->OnPlayerLeaveCombat(player);
 }
 
 void ScriptMgr::OnPlayerStartWatchingMovie(Player* player)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnStartWatching(player);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_START_WATCHING)->OnStartWatching(player);
 }
 
 void ScriptMgr::OnPlayerEndWatchingMovie(Player* player)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnEndWatching(player);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_END_WATCHING)->OnEndWatching(player);
 }
 
 // Player
 
 void ScriptMgr::OnPVPKill(Player* killer, Player* killed)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnPVPKill(killer, killed);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_PVP_KILL)->OnPVPKill(killer, killed);
 }
 
 void ScriptMgr::OnCreatureKill(Player* killer, Creature* killed)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnCreatureKill(killer, killed);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_CREATURE_KILL)->OnCreatureKill(killer, killed);
 }
 
 void ScriptMgr::OnPlayerKilledByCreature(Creature* killer, Player* killed)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnPlayerKilledByCreature(killer, killed);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_PLAYER_KILLED_BY_CREATURE)->OnPlayerKilledByCreature(killer, killed);
 }
 
 void ScriptMgr::OnPlayerLevelChanged(Player* player, uint8 oldLevel)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnLevelChanged(player, oldLevel);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_LEVEL_CHANGED)->OnLevelChanged(player, oldLevel);
 }
 
 void ScriptMgr::OnPlayerDuelRequest(Player* target, Player* challenger)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnDuelRequest(target, challenger);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_DUEL_REQUEST)->OnDuelRequest(target, challenger);
 }
 
 void ScriptMgr::OnPlayerDuelStart(Player* player1, Player* player2)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnDuelStart(player1, player2);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_DUEL_START)->OnDuelStart(player1, player2);
 }
 
 void ScriptMgr::OnPlayerDuelEnd(Player* winner, Player* loser, DuelCompleteType type)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnDuelEnd(winner, loser, type);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_DUEL_END)->OnDuelEnd(winner, loser, type);
 }
 
 void ScriptMgr::OnPlayerChat(Player* player, uint32 type, uint32 lang, std::string& msg)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnChat(player, type, lang, msg);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_CHAT)->OnChat(player, type, lang, msg);
 }
 
 void ScriptMgr::OnPlayerChat(Player* player, uint32 type, uint32 lang, std::string& msg, Player* receiver)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnChat(player, type, lang, msg, receiver);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_CHAT_WHISPER)->OnChat(player, type, lang, msg, receiver);
 }
 
 void ScriptMgr::OnPlayerChat(Player* player, uint32 type, uint32 lang, std::string& msg, Group* group)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnChat(player, type, lang, msg, group);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_CHAT_GROUP)->OnChat(player, type, lang, msg, group);
 }
 
 void ScriptMgr::OnPlayerChat(Player* player, uint32 type, uint32 lang, std::string& msg, Guild* guild)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnChat(player, type, lang, msg, guild);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_CHAT_GUILD)->OnChat(player, type, lang, msg, guild);
 }
 
 void ScriptMgr::OnPlayerChat(Player* player, uint32 type, uint32 lang, std::string& msg, Channel* channel)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnChat(player, type, lang, msg, channel);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_CHAT_CHANNEL)->OnChat(player, type, lang, msg, channel);
 }
 
 void ScriptMgr::OnPlayerEmote(Player* player, uint32 emote)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnEmote(player, emote);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_EMOTE)->OnEmote(player, emote);
 }
 
 void ScriptMgr::OnPlayerTextEmote(Player* player, uint32 textEmote, uint32 emoteNum, uint64 guid)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnTextEmote(player, textEmote, emoteNum, guid);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_TEXT_EMOTE)->OnTextEmote(player, textEmote, emoteNum, guid);
 }
 
 void ScriptMgr::OnPlayerSpellCast(Player* player, Spell* spell, bool skipCheck)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnSpellCast(player, spell, skipCheck);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_SPELL_CAST)->OnSpellCast(player, spell, skipCheck);
 }
 
 void ScriptMgr::OnPlayerLogin(Player* player)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnLogin(player);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_LOGIN)->OnLogin(player);
 }
 
 void ScriptMgr::OnPlayerLogout(Player* player)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnLogout(player);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_LOGOUT)->OnLogout(player);
 }
 
 void ScriptMgr::OnPlayerBindToInstance(Player* player, Difficulty difficulty, uint32 mapid, bool permanent)
 {
-    FOREACH_SCRIPT(PlayerScript)->OnBindToInstance(player, difficulty, mapid, permanent);
+    FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_BIND_TO_INSTANCE)->OnBindToInstance(player, difficulty, mapid, permanent);
 }
 
 // Group
 void ScriptMgr::OnGroupAddMember(Group* group, uint64 guid)
 {
     ASSERT(group);
-    FOREACH_SCRIPT(GroupScript)->OnAddMember(group, guid);
+    FOREACH_SCRIPT_HOOK(GroupScript, GROUPHOOK_ON_ADD_MEMBER)->OnAddMember(group, guid);
 }
 
 void ScriptMgr::OnGroupInviteMember(Group* group, uint64 guid)
 {
     ASSERT(group);
-    FOREACH_SCRIPT(GroupScript)->OnInviteMember(group, guid);
+    FOREACH_SCRIPT_HOOK(GroupScript, GROUPHOOK_ON_INVITE_MEMBER)->OnInviteMember(group, guid);
 }
 
 void ScriptMgr::OnGroupRemoveMember(Group* group, uint64 guid, RemoveMethod method, uint64 kicker, const char* reason)
 {
     ASSERT(group);
-    FOREACH_SCRIPT(GroupScript)->OnRemoveMember(group, guid, method, kicker, reason);
+    FOREACH_SCRIPT_HOOK(GroupScript, GROUPHOOK_ON_REMOVE_MEMBER)->OnRemoveMember(group, guid, method, kicker, reason);
 }
 
 void ScriptMgr::OnGroupChangeLeader(Group* group, uint64 newLeaderGuid, uint64 oldLeaderGuid)
 {
     ASSERT(group);
-    FOREACH_SCRIPT(GroupScript)->OnChangeLeader(group, newLeaderGuid, oldLeaderGuid);
+    FOREACH_SCRIPT_HOOK(GroupScript, GROUPHOOK_ON_CHANGE_LEADER)->OnChangeLeader(group, newLeaderGuid, oldLeaderGuid);
 }
 
 void ScriptMgr::OnGroupDisband(Group* group)
 {
     ASSERT(group);
-    FOREACH_SCRIPT(GroupScript)->OnDisband(group);
+    FOREACH_SCRIPT_HOOK(GroupScript, GROUPHOOK_ON_DISBAND)->OnDisband(group);
 }
 
 SpellScriptLoader::SpellScriptLoader(const char* name)
@@ -1011,8 +1117,8 @@ SpellScriptLoader::SpellScriptLoader(const char* name)
     ScriptRegistry<SpellScriptLoader>::AddScript(this);
 }
 
-WorldScript::WorldScript(const char* name)
-: ScriptObject(name)
+WorldScript::WorldScript(const char* name, uint32 hooks)
+: ScriptObject(name), _hooks(hooks)
 {
     ScriptRegistry<WorldScript>::AddScript(this);
 }
@@ -1128,18 +1234,31 @@ AchievementCriteriaScript::AchievementCriteriaScript(const char* name)
     ScriptRegistry<AchievementCriteriaScript>::AddScript(this);
 }
 
-PlayerScript::PlayerScript(const char* name)
-: ScriptObject(name)
+PlayerScript::PlayerScript(const char* name, uint32 hooks)
+: ScriptObject(name), _hooks(hooks)
 {
     ScriptRegistry<PlayerScript>::AddScript(this);
 }
 
-GroupScript::GroupScript(const char* name)
-: ScriptObject(name)
+GroupScript::GroupScript(const char* name, uint32 hooks)
+: ScriptObject(name), _hooks(hooks)
 {
     ScriptRegistry<GroupScript>::AddScript(this);
 }
 
+std::string ScriptMgr::DumpHookStats() const
+{
+    std::ostringstream o;
+    DumpScriptHookStats<WorldScript>(o, "WorldScript", WorldScriptHookNames, WORLDHOOK_END);
+    DumpScriptHookStats<PlayerScript>(o, "PlayerScript", PlayerScriptHookNames, PLAYERHOOK_END);
+    DumpScriptHookStats<GroupScript>(o, "GroupScript", GroupScriptHookNames, GROUPHOOK_END);
+
+    if (o.str().empty())
+        o << "No script is subscribed to any hook\n";
+
+    return o.str();
+}
+
 // Instantiate static members of ScriptRegistry.
 template<class TScript> std::map<uint32, TScript*> ScriptRegistry<TScript>::ScriptPointerList;
 template<class TScript> uint32 ScriptRegistry<TScript>::_scriptIdCounter = 0;
@@ -1163,9 +1282,18 @@ template class ScriptRegistry<AchievementCriteriaScript>;
 template class ScriptRegistry<PlayerScript>;
 template class ScriptRegistry<GroupScript>;
 
+// Instantiate static members of ScriptHookRegistry.
+template<class TScript> std::vector<TScript*> ScriptHookRegistry<TScript>::Subscribers[MAX_SCRIPT_HOOKS];
+template<class TScript> ScriptHookStats ScriptHookRegistry<TScript>::Stats[MAX_SCRIPT_HOOKS];
+
+template class ScriptHookRegistry<WorldScript>;
+template class ScriptHookRegistry<PlayerScript>;
+template class ScriptHookRegistry<GroupScript>;
+
 // Undefine utility macros.
 #undef GET_SCRIPT_RET
 #undef GET_SCRIPT
+#undef FOREACH_SCRIPT_HOOK
 #undef FOREACH_SCRIPT
 #undef FOR_SCRIPTS_RET
 #undef FOR_SCRIPTS
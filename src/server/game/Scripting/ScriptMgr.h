@@ -147,8 +147,68 @@ void DoScriptText(int32 textEntry, WorldObject* pSource, Unit* target = NULL);
 
     Now you simply call these two functions from anywhere in the core to trigger the
     event on all registered scripts of that type.
+
+    Script types with many hooks called for every script (WorldScript, PlayerScript and
+    GroupScript) take the mask of the hooks a script overrides in their constructor, like so:
+
+    MyPlayerScript() : PlayerScript("MyPlayerScript", SCRIPT_HOOK_MASK(PLAYERHOOK_ON_LOGIN)) { }
+
+    and dispatch with FOREACH_SCRIPT_HOOK(PlayerScript, PLAYERHOOK_ON_LOGIN), which only
+    calls the scripts subscribed to that hook. Scripts not giving a mask get every hook.
 */
 
+#define MAX_SCRIPT_HOOKS        32
+#define SCRIPT_HOOK_MASK(hook)  (uint32(1) << (hook))
+#define SCRIPT_HOOK_MASK_ALL    0xFFFFFFFF
+
+enum WorldScriptHook
+{
+    WORLDHOOK_ON_OPEN_STATE_CHANGE,
+    WORLDHOOK_ON_CONFIG_LOAD,
+    WORLDHOOK_ON_MOTD_CHANGE,
+    WORLDHOOK_ON_SHUTDOWN_INITIATE,
+    WORLDHOOK_ON_SHUTDOWN_CANCEL,
+    WORLDHOOK_ON_UPDATE,
+    WORLDHOOK_END
+};
+
+enum PlayerScriptHook
+{
+    PLAYERHOOK_ON_PVP_KILL,
+    PLAYERHOOK_ON_CREATURE_KILL,
+    PLAYERHOOK_ON_PLAYER_KILLED_BY_CREATURE,
+    PLAYERHOOK_ON_LEVEL_CHANGED,
+    PLAYERHOOK_ON_DUEL_REQUEST,
+    PLAYERHOOK_ON_DUEL_START,
+    PLAYERHOOK_ON_DUEL_END,
+    PLAYERHOOK_ON_CHAT,
+    PLAYERHOOK_ON_CHAT_WHISPER,
+    PLAYERHOOK_ON_CHAT_GROUP,
+    PLAYERHOOK_ON_CHAT_GUILD,
+    PLAYERHOOK_ON_CHAT_CHANNEL,
+    PLAYERHOOK_ON_EMOTE,
+    PLAYERHOOK_ON_TEXT_EMOTE,
+    PLAYERHOOK_ON_SPELL_CAST,
+    PLAYERHOOK_ON_LOGIN,
+    PLAYERHOOK_ON_LOGOUT,
+    PLAYERHOOK_ON_BIND_TO_INSTANCE,
+    PLAYERHOOK_ON_ENTER_COMBAT,
+    PLAYERHOOK_ON_LEAVE_COMBAT,
+    PLAYERHOOK_ON_START_WATCHING,
+    PLAYERHOOK_ON_END_WATCHING,
+    PLAYERHOOK_END
+};
+
+enum GroupScriptHook
+{
+    GROUPHOOK_ON_ADD_MEMBER,
+    GROUPHOOK_ON_INVITE_MEMBER,
+    GROUPHOOK_ON_REMOVE_MEMBER,
+    GROUPHOOK_ON_CHANGE_LEADER,
+    GROUPHOOK_ON_DISBAND,
+    GROUPHOOK_END
+};
+
 class ScriptObject
 {
     friend class ScriptMgr;
@@ -245,10 +305,13 @@ class WorldScript : public ScriptObject
 {
     protected:
 
-        WorldScript(const char* name);
+        WorldScript(const char* name, uint32 hooks = SCRIPT_HOOK_MASK_ALL);
 
     public:
 
+        // Mask of the WorldScriptHook this script is called for.
+        uint32 GetHooks() const { return _hooks; }
+
         // Called when the open/closed state of the world changes.
         virtual void OnOpenStateChange(bool /*open*/) { }
 
@@ -272,6 +335,10 @@ class WorldScript : public ScriptObject
 
         // Called when the world is actually shut down.
         virtual void OnShutdown() { }
+
+    private:
+
+        uint32 const _hooks;
 };
 
 class FormulaScript : public ScriptObject
@@ -639,10 +706,13 @@ class PlayerScript : public ScriptObject
 {
     protected:
 
-        PlayerScript(const char* name);
+        PlayerScript(const char* name, uint32 hooks = SCRIPT_HOOK_MASK_ALL);
 
     public:
 
+        // Mask of the PlayerScriptHook this script is called for.
+        uint32 GetHooks() const { return _hooks; }
+
         // Called when a player kills another player
         virtual void OnPVPKill(Player* /*killer*/, Player* /*killed*/) { }
 
@@ -702,6 +772,10 @@ class PlayerScript : public ScriptObject
         // Called when a player start/end watch movie
         virtual void OnStartWatching(Player* /*guid*/) { }
         virtual void OnEndWatching(Player* /*guid*/) { }
+
+    private:
+
+        uint32 const _hooks;
 };
 
 
@@ -709,12 +783,15 @@ class GroupScript : public ScriptObject
 {
     protected:
 
-        GroupScript(const char* name);
+        GroupScript(const char* name, uint32 hooks = SCRIPT_HOOK_MASK_ALL);
 
     public:
 
         bool IsDatabaseBound() const { return false; }
 
+        // Mask of the GroupScriptHook this script is called for.
+        uint32 GetHooks() const { return _hooks; }
+
         // Called when a member is added to a group.
         virtual void OnAddMember(Group* /*group*/, uint64 /*guid*/) { }
 
@@ -729,6 +806,10 @@ class GroupScript : public ScriptObject
 
         // Called when a group is disbanded.
         virtual void OnDisband(Group* /*group*/) { }
+
+    private:
+
+        uint32 const _hooks;
 };
 
 // Placed here due to ScriptRegistry::AddScript dependency.
@@ -926,6 +1007,11 @@ class ScriptMgr
         void OnGroupChangeLeader(Group* group, uint64 newLeaderGuid, uint64 oldLeaderGuid);
         void OnGroupDisband(Group* group);
 
+    public: /* Hook statistics */
+
+        // Calls and time spent in the scripts of every hook with subscribers
+        std::string DumpHookStats() const;
+
     public: /* Scheduled scripts */
 
         uint32 IncreaseScheduledScriptsCount() { return ++_scheduledScripts; }
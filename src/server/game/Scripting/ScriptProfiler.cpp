@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ScriptProfiler.h"
+#include "ObjectMgr.h"
+
+#include <ace/OS_NS_sys_time.h>
+#include <fstream>
+#include <sstream>
+
+static char const* const ScriptProfileTypeNames[MAX_SCRIPT_PROFILE_TYPES] =
+{
+    "CreatureAI", "InstanceScript", "SpellScript", "AuraScript", "SmartAI"
+};
+
+// orders profile entries by time spent, most first
+class ScriptProfileTimeOrder
+{
+    public:
+        bool operator()(ScriptProfileContainer::const_iterator left, ScriptProfileContainer::const_iterator right) const
+        {
+            return left->second.time > right->second.time;
+        }
+};
+
+void ScriptProfileEntry::Add(uint32 callTime)
+{
+    ++calls;
+    time += callTime;
+    maxTime = std::max(maxTime, callTime);
+}
+
+void ScriptProfileEntry::Add(ScriptProfileEntry const& entry)
+{
+    calls += entry.calls;
+    time += entry.time;
+    maxTime = std::max(maxTime, entry.maxTime);
+}
+
+uint64 ScriptProfiler::GetTime()
+{
+    ACE_Time_Value now = ACE_OS::gettimeofday();
+    return uint64(now.sec()) * IN_MILLISECONDS * IN_MILLISECONDS + now.usec();
+}
+
+std::string ScriptProfiler::GetScriptName(ScriptProfileKey const& key) const
+{
+    std::ostringstream name;
+    switch (key.type)
+    {
+        case SCRIPT_PROFILE_CREATURE_AI:
+            if (CreatureTemplate const* creatureTemplate = sObjectMgr->GetCreatureTemplate(key.id))
+            {
+                if (creatureTemplate->ScriptID)
+                    name << sObjectMgr->GetScriptName(creatureTemplate->ScriptID);
+                else if (!creatureTemplate->AIName.empty())
+                    name << creatureTemplate->AIName;
+                else
+                    name << "default AI";
+            }
+            name << " (entry " << key.id << ")";
+            break;
+        case SCRIPT_PROFILE_INSTANCE:
+            name << sObjectMgr->GetScriptName(key.id);
+            break;
+        case SCRIPT_PROFILE_SPELL:
+        case SCRIPT_PROFILE_AURA:
+            name << (key.name ? key.name->c_str() : "") << " (spell " << key.id << ")";
+            break;
+        case SCRIPT_PROFILE_SMART_ACTION:
+            name << "action " << key.id;
+            break;
+        default:
+            break;
+    }
+
+    return name.str();
+}
+
+std::string ScriptProfiler::Dump(uint32 count)
+{
+    ScriptProfileContainer profile;
+    _profile.Merge(profile);
+
+    std::vector<ScriptProfileContainer::const_iterator> entries;
+    entries.reserve(profile.size());
+    for (ScriptProfileContainer::const_iterator itr = profile.begin(); itr != profile.end(); ++itr)
+        entries.push_back(itr);
+    std::sort(entries.begin(), entries.end(), ScriptProfileTimeOrder());
+
+    std::ostringstream o;
+    o << "Script profiler " << (_enabled ? "enabled" : "disabled") << ", " << uint32(entries.size()) << " scripts profiled\n";
+    for (uint32 i = 0; i < entries.size() && i < count; ++i)
+    {
+        ScriptProfileKey const& key = entries[i]->first;
+        ScriptProfileEntry const& entry = entries[i]->second;
+        o << "map " << key.mapId << " " << ScriptProfileTypeNames[key.type] << " " << GetScriptName(key) << ": " << entry.calls << " calls, "
+          << entry.time / IN_MILLISECONDS << " ms, " << entry.time / std::max<uint32>(entry.calls, 1) << " us avg, " << entry.maxTime << " us max\n";
+    }
+
+    return o.str();
+}
+
+bool ScriptProfiler::Export(std::string const& fileName)
+{
+    std::ofstream file(fileName.c_str());
+    if (!file)
+        return false;
+
+    ScriptProfileContainer profile;
+    _profile.Merge(profile);
+
+    for (ScriptProfileContainer::const_iterator itr = profile.begin(); itr != profile.end(); ++itr)
+    {
+        // spaces separate the count in folded stacks
+        std::string name = GetScriptName(itr->first);
+        std::replace(name.begin(), name.end(), ' ', '_');
+        file << "map_" << itr->first.mapId << ";" << ScriptProfileTypeNames[itr->first.type] << ";" << name << " " << itr->second.time << "\n";
+    }
+
+    return true;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SCRIPTPROFILER_H
+#define _SCRIPTPROFILER_H
+
+#include "Define.h"
+#include "PerThreadStats.h"
+#include <ace/Singleton.h>
+
+#include <map>
+#include <string>
+
+enum ScriptProfileType
+{
+    SCRIPT_PROFILE_CREATURE_AI,                            // CreatureAI::UpdateAI, id is the creature entry
+    SCRIPT_PROFILE_INSTANCE,                               // InstanceScript::Update, id is the map script id
+    SCRIPT_PROFILE_SPELL,                                  // SpellScript hooks, id is the spell id
+    SCRIPT_PROFILE_AURA,                                   // AuraScript hooks, id is the spell id
+    SCRIPT_PROFILE_SMART_ACTION,                           // SmartAI actions, id is the action type
+    MAX_SCRIPT_PROFILE_TYPES
+};
+
+struct ScriptProfileKey
+{
+    ScriptProfileKey(uint32 _mapId, ScriptProfileType _type, uint32 _id, std::string const* _name) :
+        mapId(_mapId), type(_type), id(_id), name(_name) { }
+
+    bool operator<(ScriptProfileKey const& right) const
+    {
+        if (mapId != right.mapId)
+            return mapId < right.mapId;
+        if (type != right.type)
+            return type < right.type;
+        if (id != right.id)
+            return id < right.id;
+        return name < right.name;
+    }
+
+    uint32 mapId;
+    ScriptProfileType type;
+    uint32 id;
+    std::string const* name;                               ///< Spell and aura scripts only, owned by their loader
+};
+
+struct ScriptProfileEntry
+{
+    ScriptProfileEntry() : calls(0), time(0), maxTime(0) { }
+
+    void Add(uint32 callTime);
+    void Add(ScriptProfileEntry const& entry);
+
+    uint32 calls;
+    uint64 time;                                           ///< Microseconds
+    uint32 maxTime;
+};
+
+typedef std::map<ScriptProfileKey, ScriptProfileEntry> ScriptProfileContainer;
+
+/**
+    Time spent in creature AI, instance, spell, aura and SmartAI scripts, per script and map,
+    recorded per thread. Does nothing until enabled.
+*/
+class ScriptProfiler
+{
+    friend class ACE_Singleton<ScriptProfiler, ACE_Thread_Mutex>;
+
+    private:
+        ScriptProfiler() : _enabled(false) { }
+        ~ScriptProfiler() { }
+
+    public:
+        bool IsEnabled() const { return _enabled; }
+        void SetEnabled(bool enabled) { _enabled = enabled; }
+        void Reset() { _profile.Reset(); }
+
+        void Record(ScriptProfileType type, uint32 mapId, uint32 id, std::string const* name, uint32 time)
+        {
+            _profile.Add(ScriptProfileKey(mapId, type, id, name), time);
+        }
+
+        /// The entries with the most time spent first, at most count of them
+        std::string Dump(uint32 count);
+        /// Writes the profile as folded stacks (map;type;script microseconds), the input of flamegraph.pl
+        bool Export(std::string const& fileName);
+
+        /// Microseconds since epoch, for the scopes
+        static uint64 GetTime();
+
+    private:
+        std::string GetScriptName(ScriptProfileKey const& key) const;
+
+        volatile bool _enabled;
+        PerThreadStats<ScriptProfileContainer> _profile;
+};
+
+#define sScriptProfiler ACE_Singleton<ScriptProfiler, ACE_Thread_Mutex>::instance()
+
+/// Times its scope if the profiler is enabled when it starts
+class ScriptProfileScope
+{
+    public:
+        ScriptProfileScope(ScriptProfileType type, uint32 mapId, uint32 id, std::string const* name = NULL) :
+            _type(type), _mapId(mapId), _id(id), _name(name), _start(sScriptProfiler->IsEnabled() ? ScriptProfiler::GetTime() : 0) { }
+
+        ~ScriptProfileScope()
+        {
+            if (_start)
+                sScriptProfiler->Record(_type, _mapId, _id, _name, uint32(ScriptProfiler::GetTime() - _start));
+        }
+
+    private:
+        ScriptProfileType _type;
+        uint32 _mapId;
+        uint32 _id;
+        std::string const* _name;
+        uint64 _start;
+};
+
+#endif
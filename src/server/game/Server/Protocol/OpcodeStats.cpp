@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OpcodeStats.h"
+#include "Opcodes.h"
+
+#include <sstream>
+
+uint32 const OpcodeLatencyStats::BucketLimits[OPCODE_LATENCY_BUCKETS - 1] =
+{
+    100, 500, 1000, 5000, 20000, 100000
+};
+
+static char const* const OpcodeLatencyBucketNames[OPCODE_LATENCY_BUCKETS] =
+{
+    "<0.1ms", "<0.5ms", "<1ms", "<5ms", "<20ms", "<100ms", "longer"
+};
+
+// orders opcodes by handling time, most first
+class OpcodeTimeOrder
+{
+    public:
+        bool operator()(OpcodeLatencyContainer::const_iterator left, OpcodeLatencyContainer::const_iterator right) const
+        {
+            return left->second.time > right->second.time;
+        }
+};
+
+void OpcodeLatencyStats::Add(uint32 handleTime)
+{
+    ++calls;
+    time += handleTime;
+    maxTime = std::max(maxTime, handleTime);
+
+    uint8 bucket = 0;
+    while (bucket < OPCODE_LATENCY_BUCKETS - 1 && handleTime >= BucketLimits[bucket])
+        ++bucket;
+    ++histogram[bucket];
+}
+
+void OpcodeLatencyStats::Add(OpcodeLatencyStats const& stats)
+{
+    calls += stats.calls;
+    time += stats.time;
+    maxTime = std::max(maxTime, stats.maxTime);
+    for (uint8 i = 0; i < OPCODE_LATENCY_BUCKETS; ++i)
+        histogram[i] += stats.histogram[i];
+}
+
+std::string OpcodeStatsMgr::Dump(uint32 count)
+{
+    OpcodeLatencyContainer opcodes;
+    uint32 threads = _stats.Merge(opcodes);
+
+    std::vector<OpcodeLatencyContainer::const_iterator> sorted;
+    sorted.reserve(opcodes.size());
+    for (OpcodeLatencyContainer::const_iterator itr = opcodes.begin(); itr != opcodes.end(); ++itr)
+        sorted.push_back(itr);
+    std::sort(sorted.begin(), sorted.end(), OpcodeTimeOrder());
+
+    std::ostringstream o;
+    o << uint32(opcodes.size()) << " opcodes handled by " << threads << " threads\n";
+    for (uint32 i = 0; i < sorted.size() && i < count; ++i)
+    {
+        OpcodeLatencyStats const& stats = sorted[i]->second;
+        o << GetOpcodeNameForLogging(Opcodes(sorted[i]->first)) << ": " << stats.calls << " calls, " << stats.time / IN_MILLISECONDS << " ms, "
+          << stats.time / std::max<uint32>(stats.calls, 1) << " us avg, " << stats.maxTime << " us max\n ";
+        for (uint8 bucket = 0; bucket < OPCODE_LATENCY_BUCKETS; ++bucket)
+            o << " " << OpcodeLatencyBucketNames[bucket] << " " << stats.histogram[bucket];
+        o << "\n";
+    }
+
+    return o.str();
+}
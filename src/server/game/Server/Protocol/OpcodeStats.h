@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _OPCODESTATS_H
+#define _OPCODESTATS_H
+
+#include "Define.h"
+#include "PerThreadStats.h"
+#include "UnorderedMap.h"
+#include <ace/Singleton.h>
+
+#include <cstring>
+#include <string>
+
+#define OPCODE_LATENCY_BUCKETS 7
+
+/// Calls and handling time of one opcode
+struct OpcodeLatencyStats
+{
+    OpcodeLatencyStats() : calls(0), time(0), maxTime(0)
+    {
+        memset(histogram, 0, sizeof(histogram));
+    }
+
+    void Add(uint32 handleTime);
+    void Add(OpcodeLatencyStats const& stats);
+
+    static uint32 const BucketLimits[OPCODE_LATENCY_BUCKETS - 1];
+
+    uint32 calls;
+    uint64 time;                                           ///< Microseconds
+    uint32 maxTime;
+    uint32 histogram[OPCODE_LATENCY_BUCKETS];              ///< Calls per handling time range, see BucketLimits
+};
+
+typedef UNORDERED_MAP<uint16, OpcodeLatencyStats> OpcodeLatencyContainer;
+
+/**
+    Always on count and handling time histogram of every client opcode, recorded per thread as
+    sessions are updated by the world and map threads.
+*/
+class OpcodeStatsMgr
+{
+    friend class ACE_Singleton<OpcodeStatsMgr, ACE_Thread_Mutex>;
+
+    private:
+        OpcodeStatsMgr() { }
+        ~OpcodeStatsMgr() { }
+
+    public:
+        void Record(uint16 opcode, uint32 handleTime) { _stats.Add(opcode, handleTime); }
+        void Reset() { _stats.Reset(); }
+
+        /// The opcodes with the most handling time first, at most count of them
+        std::string Dump(uint32 count);
+
+    private:
+        PerThreadStats<OpcodeLatencyContainer> _stats;
+};
+
+#define sOpcodeStatsMgr ACE_Singleton<OpcodeStatsMgr, ACE_Thread_Mutex>::instance()
+
+#endif
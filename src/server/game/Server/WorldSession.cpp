@@ -46,6 +46,7 @@
 #include "Transport.h"
 #include "WardenWin.h"
 #include "WardenMac.h"
+#include "OpcodeStats.h"
 
 bool MapSessionFilter::Process(WorldPacket* packet)
 {
@@ -99,7 +100,9 @@ m_inQueue(false), m_playerLoading(false), m_playerLogout(false),
 m_playerRecentlyLogout(false), m_playerSave(false),
 m_sessionDbcLocale(sWorld->GetAvailableDbcLocale(locale)),
 m_sessionDbLocaleIndex(locale),
-m_latency(0), m_TutorialsChanged(false), recruiterId(recruiter),
+m_latency(0), m_sentBytes(0), m_sentPackets(0), m_sentStatsStartTime(time(NULL)), m_movementHeartbeatCount(0),
+m_movementPacketsQueued(0), m_movementPacketsReplaced(0), m_movementBatchesSent(0),
+m_TutorialsChanged(false), recruiterId(recruiter),
 isRecruiter(isARecruiter), timeLastWhoCommand(0),
 timeLastChannelInviteCommand(0), timeLastGroupInviteCommand(0), timeLastGuildInviteCommand(0), timeLastChannelPassCommand(0),
 timeLastChannelMuteCommand(0), timeLastChannelBanCommand(0), timeLastChannelUnbanCommand(0), timeLastChannelAnnounceCommand(0),
@@ -110,6 +113,11 @@ m_uiAntispamMailSentCount(0), m_uiAntispamMailSentTimer(0)
 {
     _warden = NULL;
     _filterAddonMessages = false;
+    _mailboxLoading = false;
+    _mailboxLoadStale = false;
+    _mailboxLoadMap = NULL;
+    _mailListRequest = 0;
+    _nextMailTimeRequest = false;
 
     if (sock)
     {
@@ -245,10 +253,106 @@ void WorldSession::SendPacket(WorldPacket const* packet, bool forced /*= false*/
     }
 #endif                                                      // !TRINITY_DEBUG
 
+    m_sentBytes += packet->size();
+    ++m_sentPackets;
+
     if (m_Socket->SendPacket(packet) == -1)
         m_Socket->CloseSocket();
 }
 
+/// Queue movement of another unit, sent by SendMovementBatch at the end of the map's session update
+void WorldSession::QueueMovementPacket(uint64 moverGuid, WorldPacket const* packet, bool replaceable)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _movementBatchLock);
+
+    ++m_movementPacketsQueued;
+
+    if (replaceable)
+    {
+        // a heartbeat still waiting in the batch is outdated by the new one
+        UNORDERED_MAP<uint64, uint32>::const_iterator itr = _movementBatchReplaceable.find(moverGuid);
+        if (itr != _movementBatchReplaceable.end())
+        {
+            _movementBatch[itr->second] = *packet;
+            ++m_movementPacketsReplaced;
+            return;
+        }
+
+        _movementBatchReplaceable[moverGuid] = _movementBatch.size();
+    }
+    else
+        _movementBatchReplaceable.erase(moverGuid);             // keep start/stop/jump order intact
+
+    _movementBatch.push_back(*packet);
+    _movementBatchMovers.push_back(moverGuid);
+}
+
+/// Send the queued movement of one mover now, before a packet about it which is not batched
+void WorldSession::FlushMovementBatch(uint64 moverGuid)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _movementBatchLock);
+
+    if (_movementBatch.empty())
+        return;
+
+    for (size_t i = 0; i < _movementBatchMovers.size(); ++i)
+    {
+        if (_movementBatchMovers[i] != moverGuid)
+            continue;
+
+        SendPacket(&_movementBatch[i]);
+        _movementBatchMovers[i] = 0;                            // skipped by SendMovementBatch
+    }
+
+    _movementBatchReplaceable.erase(moverGuid);
+}
+
+/// Send movement gathered by QueueMovementPacket
+void WorldSession::SendMovementBatch()
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _movementBatchLock);
+
+    if (_movementBatch.empty())
+        return;
+
+    ++m_movementBatchesSent;
+
+    packetBlock block;
+    for (size_t i = 0; i < _movementBatch.size(); ++i)
+        if (_movementBatchMovers[i])
+            block.push_back(&_movementBatch[i]);
+
+    if (block.size() > 1 && sWorld->getBoolConfig(CONFIG_MOVEMENT_BATCHING_MULTIPLE_PACKETS))
+    {
+        packetBlock subBlock;
+        size_t blockSize = 0;
+        for (packetBlock::const_iterator itr = block.begin(); itr != block.end(); ++itr)
+        {
+            // sub packet sizes are sent as uint16
+            if (blockSize + (*itr)->size() + 4 > 0x7FFF)
+            {
+                WorldPacket data = BuildMultiplePackets(subBlock);
+                SendPacket(&data);
+                subBlock.clear();
+                blockSize = 0;
+            }
+
+            subBlock.push_back(*itr);
+            blockSize += (*itr)->size() + 4;
+        }
+
+        WorldPacket data = BuildMultiplePackets(subBlock);
+        SendPacket(&data);
+    }
+    else
+        for (packetBlock::const_iterator itr = block.begin(); itr != block.end(); ++itr)
+            SendPacket(*itr);
+
+    _movementBatch.clear();
+    _movementBatchMovers.clear();
+    _movementBatchReplaceable.clear();
+}
+
 /// Add an incoming packet to the queue
 void WorldSession::QueuePacket(WorldPacket* new_packet)
 {
@@ -270,6 +374,24 @@ void WorldSession::LogUnprocessedTail(WorldPacket* packet)
     packet->print_storage();
 }
 
+void WorldSession::ExecuteOpcode(OpcodeHandler const* opHandle, WorldPacket* packet)
+{
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+    (this->*opHandle->Handler)(*packet);
+    ACE_Time_Value elapsed = ACE_OS::gettimeofday() - start;
+
+    uint32 handleTime = uint32(elapsed.sec() * IN_MILLISECONDS * IN_MILLISECONDS + elapsed.usec());
+    sOpcodeStatsMgr->Record(packet->GetOpcode(), handleTime);
+
+    uint32 slowThreshold = sWorld->getIntConfig(CONFIG_SLOW_OPCODE_HANDLER_THRESHOLD);
+    if (slowThreshold && handleTime >= slowThreshold * IN_MILLISECONDS)
+        sLog->outWarn(LOG_FILTER_WORLDSERVER, "Slow handler: %s took %u ms, account %u, map %u", GetOpcodeNameForLogging(packet->GetOpcode()).c_str(),
+            handleTime / IN_MILLISECONDS, GetAccountId(), _player ? _player->GetMapId() : MAPID_INVALID);
+
+    if (sLog->ShouldLog(LOG_FILTER_NETWORKIO, LOG_LEVEL_TRACE) && packet->rpos() < packet->wpos())
+        LogUnprocessedTail(packet);
+}
+
 /// Update the WorldSession (triggered by World update)
 bool WorldSession::Update(uint32 diff, PacketFilter& updater)
 {
@@ -328,9 +450,7 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
                     }
                     else if (_player->IsInWorld())
                     {
-                        (this->*opHandle->Handler)(*packet);
-                        if (sLog->ShouldLog(LOG_FILTER_NETWORKIO, LOG_LEVEL_TRACE) && packet->rpos() < packet->wpos())
-                            LogUnprocessedTail(packet);
+                        ExecuteOpcode(opHandle, packet);
                     }
                     // lag can cause STATUS_LOGGEDIN opcodes to arrive after the player started a transfer
                     break;
@@ -341,9 +461,7 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
                     else
                     {
                         // not expected _player or must checked in packet hanlder
-                        (this->*opHandle->Handler)(*packet);
-                        if (sLog->ShouldLog(LOG_FILTER_NETWORKIO, LOG_LEVEL_TRACE) && packet->rpos() < packet->wpos())
-                            LogUnprocessedTail(packet);
+                        ExecuteOpcode(opHandle, packet);
                     }
                     break;
                 case STATUS_TRANSFER:
@@ -353,9 +471,7 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
                         LogUnexpectedOpcode(packet, "STATUS_TRANSFER", "the player is still in world");
                     else
                     {
-                        (this->*opHandle->Handler)(*packet);
-                        if (sLog->ShouldLog(LOG_FILTER_NETWORKIO, LOG_LEVEL_TRACE) && packet->rpos() < packet->wpos())
-                            LogUnprocessedTail(packet);
+                        ExecuteOpcode(opHandle, packet);
                     }
                     break;
                 case STATUS_AUTHED:
@@ -371,9 +487,7 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
                     if (packet->GetOpcode() == CMSG_CHAR_ENUM)
                         m_playerRecentlyLogout = false;
 
-                    (this->*opHandle->Handler)(*packet);
-                    if (sLog->ShouldLog(LOG_FILTER_NETWORKIO, LOG_LEVEL_TRACE) && packet->rpos() < packet->wpos())
-                        LogUnprocessedTail(packet);
+                    ExecuteOpcode(opHandle, packet);
                     break;
                 case STATUS_NEVER:
                         sLog->outError(LOG_FILTER_OPCODES, "Received not allowed opcode %s from %s", GetOpcodeNameForLogging(packet->GetOpcode()).c_str()
@@ -1157,6 +1271,17 @@ void WorldSession::ProcessQueryCallbacks()
         HandleGuildRenameCallback(param);
         _guildRenameCallback.FreeResult();
     }
+
+    //- HandleGetMailList, HandleQueryNextMailTime
+    if (_mailboxLoadCallback.IsReady())
+    {
+        uint64 param = _mailboxLoadCallback.GetParam();
+        _mailboxLoadCallback.GetResult(result);
+        _mailboxLoadCallback.FreeResult();
+        HandleMailboxLoadCallback(result, param);
+    }
+    else if ((_mailListRequest || _nextMailTimeRequest) && !_mailboxLoading && _player && _player->IsInWorld())
+        LoadMailbox();                                      // waiting for a mailbox load slot of the map
 }
 
 void WorldSession::InitWarden(BigNumber* k, std::string os)
@@ -38,6 +38,7 @@ class GameObject;
 class InstanceSave;
 class Item;
 class LoginQueryHolder;
+class Map;
 class Object;
 class Player;
 class Quest;
@@ -265,6 +266,11 @@ class WorldSession
         void SendPacket(WorldPacket const* packet, bool forced = false);
         WorldPacket BuildMultiplePackets(packetBlock packets);
 
+        // movement of other units gathered during a map update and sent in one go
+        void QueueMovementPacket(uint64 moverGuid, WorldPacket const* packet, bool replaceable);
+        void FlushMovementBatch(uint64 moverGuid);
+        void SendMovementBatch();
+
         void SendNotification(const char *format, ...) ATTR_PRINTF(2, 3);
         void SendNotification(uint32 string_id, ...);
         void SendPetNameInvalid(uint32 error, const std::string& name, DeclinedName *declinedName);
@@ -350,6 +356,17 @@ class WorldSession
         void SendStableResult(uint8 guid);
         bool CheckStableMaster(uint64 guid);
 
+        // Mail
+        void SendMailList();
+        void SendNextMailTime();
+        void LoadMailbox();
+        void HandleMailboxLoadCallback(PreparedQueryResult result, uint64 guid);
+        bool IsLoadingMailbox() const { return _mailboxLoading; }
+        /// Called when the mails of the player change in DB, a load in flight queries them again. May run on the map thread of the sender
+        void InvalidateMailboxLoad() { _mailboxLoadStale = true; }
+        /// Frees the mailbox load slot taken on the map of the player, once loaded or when leaving it
+        void ReleaseMailboxLoadSlot();
+
         // Account Data
         AccountData* GetAccountData(AccountDataType type) { return &m_accountData[type]; }
         void SetAccountData(AccountDataType type, time_t tm, std::string data);
@@ -409,6 +426,14 @@ class WorldSession
 
         uint32 GetLatency() const { return m_latency; }
         void SetLatency(uint32 latency) { m_latency = latency; }
+
+        // outgoing traffic since login, diagnostic only
+        uint64 GetSentBytes() const { return m_sentBytes; }
+        uint64 GetSentPackets() const { return m_sentPackets; }
+        time_t GetSentStatsStartTime() const { return m_sentStatsStartTime; }
+        uint64 GetMovementPacketsQueued() const { return m_movementPacketsQueued; }
+        uint64 GetMovementPacketsReplaced() const { return m_movementPacketsReplaced; }
+        uint64 GetMovementBatchesSent() const { return m_movementBatchesSent; }
         uint32 getDialogStatus(Player* player, Object* questgiver, uint32 defstatus);
 
         time_t m_timeOutTime;
@@ -1065,6 +1090,16 @@ class WorldSession
         QueryCallback<PreparedQueryResult, CharacterCreateInfo*, true> _charCreateCallback;
         QueryCallback<PreparedQueryResult, std::string> _guildRenameCallback;
         QueryResultHolderFuture _charLoginCallback;
+        QueryCallback<PreparedQueryResult, uint64> _mailboxLoadCallback;
+
+        // mailbox loading
+        void QueryMailbox();
+
+        bool _mailboxLoading;
+        ACE_Atomic_Op<ACE_Thread_Mutex, bool> _mailboxLoadStale;
+        Map* _mailboxLoadMap;                              ///< Map whose load slot is held, NULL once released
+        uint64 _mailListRequest;                           ///< Mailbox the list is sent for once the mails are loaded
+        bool _nextMailTimeRequest;
 
     private:
         // private trade methods
@@ -1074,6 +1109,9 @@ class WorldSession
         void LogUnexpectedOpcode(WorldPacket* packet, const char* status, const char *reason);
         void LogUnprocessedTail(WorldPacket* packet);
 
+        // calls the handler of the packet, recording how long it took
+        void ExecuteOpcode(OpcodeHandler const* opHandle, WorldPacket* packet);
+
         // EnumData helpers
         bool CharCanLogin(uint32 lowGUID)
         {
@@ -1108,6 +1146,17 @@ class WorldSession
         LocaleConstant m_sessionDbcLocale;
         LocaleConstant m_sessionDbLocaleIndex;
         uint32 m_latency;
+        uint64 m_sentBytes;
+        uint64 m_sentPackets;
+        time_t m_sentStatsStartTime;
+        uint32 m_movementHeartbeatCount;                    // received heartbeats, picks the ones sent to crowded observers
+        std::vector<WorldPacket> _movementBatch;
+        std::vector<uint64> _movementBatchMovers;           // mover of each batched packet, 0 once sent by FlushMovementBatch
+        UNORDERED_MAP<uint64, uint32> _movementBatchReplaceable; // mover -> its last batched heartbeat
+        ACE_Thread_Mutex _movementBatchLock;
+        uint64 m_movementPacketsQueued;
+        uint64 m_movementPacketsReplaced;
+        uint64 m_movementBatchesSent;
         AccountData m_accountData[NUM_ACCOUNT_DATA_TYPES];
         uint32 m_Tutorials[MAX_ACCOUNT_TUTORIAL_VALUES];
         bool   m_TutorialsChanged;
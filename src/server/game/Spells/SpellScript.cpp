@@ -22,6 +22,7 @@
 #include "SpellAuras.h"
 #include "SpellScript.h"
 #include "SpellMgr.h"
+#include "ScriptProfiler.h"
 
 bool _SpellScript::_Validate(SpellInfo const* entry)
 {
@@ -331,11 +332,14 @@ void SpellScript::_InitHit()
 void SpellScript::_PrepareScriptCall(SpellScriptHookType hookType)
 {
     m_currentScriptState = hookType;
+    m_profileStart = sScriptProfiler->IsEnabled() ? ScriptProfiler::GetTime() : 0;
 }
 
 void SpellScript::_FinishScriptCall()
 {
     m_currentScriptState = SPELL_SCRIPT_STATE_NONE;
+    if (m_profileStart && m_spell)
+        sScriptProfiler->Record(SCRIPT_PROFILE_SPELL, m_spell->GetCaster()->GetMapId(), m_scriptSpellId, m_scriptName, uint32(ScriptProfiler::GetTime() - m_profileStart));
 }
 
 bool SpellScript::IsInCheckCastHook() const
@@ -902,18 +906,24 @@ bool AuraScript::_Load(Aura* aura)
 
 void AuraScript::_PrepareScriptCall(AuraScriptHookType hookType, AuraApplication const* aurApp)
 {
-    m_scriptStates.push(ScriptStateStore(m_currentScriptState, m_auraApplication, m_defaultActionPrevented));
+    m_scriptStates.push(ScriptStateStore(m_currentScriptState, m_auraApplication, m_defaultActionPrevented, m_profileStart));
     m_currentScriptState = hookType;
     m_defaultActionPrevented = false;
     m_auraApplication = aurApp;
+    m_profileStart = sScriptProfiler->IsEnabled() ? ScriptProfiler::GetTime() : 0;
 }
 
 void AuraScript::_FinishScriptCall()
 {
+    // hooks may be nested, the time of the inner ones is also counted in the outer ones
+    if (m_profileStart && m_aura)
+        sScriptProfiler->Record(SCRIPT_PROFILE_AURA, m_aura->GetOwner()->GetMapId(), m_scriptSpellId, m_scriptName, uint32(ScriptProfiler::GetTime() - m_profileStart));
+
     ScriptStateStore stateStore = m_scriptStates.top();
     m_currentScriptState = stateStore._currentScriptState;
     m_auraApplication = stateStore._auraApplication;
     m_defaultActionPrevented = stateStore._defaultActionPrevented;
+    m_profileStart = stateStore._profileStart;
     m_scriptStates.pop();
 }
 
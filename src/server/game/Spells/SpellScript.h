@@ -61,7 +61,7 @@ class _SpellScript
         virtual bool _Validate(SpellInfo const* entry);
 
     public:
-        _SpellScript() : m_currentScriptState(SPELL_SCRIPT_STATE_NONE) {}
+        _SpellScript() : m_currentScriptState(SPELL_SCRIPT_STATE_NONE), m_profileStart(0) {}
         virtual ~_SpellScript() {}
         virtual void _Register();
         virtual void _Unload();
@@ -104,6 +104,7 @@ class _SpellScript
         uint8 m_currentScriptState;
         std::string const* m_scriptName;
         uint32 m_scriptSpellId;
+        uint64 m_profileStart;                              // start of the current hook call, if profiled
     public:
         //
         // SpellScript/AuraScript interface base
@@ -630,8 +631,9 @@ class AuraScript : public _SpellScript
             AuraApplication const* _auraApplication;
             uint8 _currentScriptState;
             bool _defaultActionPrevented;
-            ScriptStateStore(uint8 currentScriptState, AuraApplication const* auraApplication, bool defaultActionPrevented)
-                : _auraApplication(auraApplication), _currentScriptState(currentScriptState), _defaultActionPrevented(defaultActionPrevented)
+            uint64 _profileStart;
+            ScriptStateStore(uint8 currentScriptState, AuraApplication const* auraApplication, bool defaultActionPrevented, uint64 profileStart)
+                : _auraApplication(auraApplication), _currentScriptState(currentScriptState), _defaultActionPrevented(defaultActionPrevented), _profileStart(profileStart)
             {}
         };
         typedef std::stack<ScriptStateStore> ScriptStateStack;
@@ -71,6 +71,141 @@ bool FindWordInSequence(const std::string& str, const std::string& word, const s
 }
 */
 
+static uint32 const WORD_FILTER_NO_MATCH = uint32(-1);
+
+WordFilterAutomaton::WordFilterAutomaton() : m_symbolCount(1)
+{
+    memset(m_symbols, 0, sizeof(m_symbols));
+    AddState();                                             // root, matches nothing
+}
+
+uint32 WordFilterAutomaton::AddState()
+{
+    m_transitions.resize(m_transitions.size() + m_symbolCount, 0);
+    m_matches.push_back(WORD_FILTER_NO_MATCH);
+    m_mailMatches.push_back(WORD_FILTER_NO_MATCH);
+    return uint32(m_matches.size() - 1);
+}
+
+uint32 WordFilterAutomaton::AddWord(std::string const& word, uint16 const* wordSymbols)
+{
+    uint32 state = 0;
+    for (std::string::const_iterator itr = word.begin(); itr != word.end(); ++itr)
+    {
+        uint32 transition = state * m_symbolCount + wordSymbols[uint8(*itr)];
+        if (!m_transitions[transition])
+        {
+            uint32 next = AddState();
+            m_transitions[transition] = next;
+        }
+
+        state = m_transitions[transition];
+    }
+
+    return state;
+}
+
+void WordFilterAutomaton::Build(uint8 const* letterAnalogs, std::map<std::string, std::string> const& words, std::map<std::string, std::string> const& mailWords)
+{
+    typedef std::map<std::string, std::string> WordMap;
+
+    // one symbol per byte of the words, the symbol 0 stands for all the other bytes
+    uint16 wordSymbols[256];
+    memset(wordSymbols, 0, sizeof(wordSymbols));
+    m_symbolCount = 1;
+    WordMap const* maps[2] = { &words, &mailWords };
+    for (uint8 i = 0; i < 2; ++i)
+        for (WordMap::const_iterator itr = maps[i]->begin(); itr != maps[i]->end(); ++itr)
+            for (std::string::const_iterator c = itr->first.begin(); c != itr->first.end(); ++c)
+                if (!wordSymbols[uint8(*c)])
+                    wordSymbols[uint8(*c)] = uint16(m_symbolCount++);
+
+    // the text bytes are lowercased then converted to their letter as NormalizeWord and ConvertLettersToAnalogs do
+    for (uint32 byte = 0; byte < 256; ++byte)
+    {
+        uint8 letter = (byte >= 'A' && byte <= 'Z') ? uint8(byte - 'A' + 'a') : uint8(byte);
+        m_symbols[byte] = wordSymbols[letterAnalogs[letter]];
+    }
+    m_symbols[uint8(' ')] = SYMBOL_SKIP;
+
+    m_transitions.clear();
+    m_matches.clear();
+    m_mailMatches.clear();
+    m_words.clear();
+    m_mailWords.clear();
+    AddState();
+
+    for (WordMap::const_iterator itr = words.begin(); itr != words.end(); ++itr)
+    {
+        uint32 state = AddWord(itr->first, wordSymbols);
+        m_matches[state] = std::min(m_matches[state], uint32(m_words.size()));
+        m_words.push_back(itr->second);
+    }
+
+    for (WordMap::const_iterator itr = mailWords.begin(); itr != mailWords.end(); ++itr)
+    {
+        uint32 state = AddWord(itr->first, wordSymbols);
+        m_mailMatches[state] = std::min(m_mailMatches[state], uint32(m_mailWords.size()));
+        m_mailWords.push_back(itr->second);
+    }
+
+    // breadth first, the failure state of a state is always done before it
+    std::vector<uint32> failure(m_matches.size(), 0);
+    std::deque<uint32> queue;
+    for (uint32 symbol = 1; symbol < m_symbolCount; ++symbol)
+        if (uint32 child = m_transitions[symbol])
+            queue.push_back(child);
+
+    while (!queue.empty())
+    {
+        uint32 state = queue.front();
+        queue.pop_front();
+
+        m_matches[state] = std::min(m_matches[state], m_matches[failure[state]]);
+        m_mailMatches[state] = std::min(m_mailMatches[state], m_mailMatches[failure[state]]);
+
+        for (uint32 symbol = 1; symbol < m_symbolCount; ++symbol)
+        {
+            uint32& transition = m_transitions[state * m_symbolCount + symbol];
+            uint32 failureTransition = m_transitions[failure[state] * m_symbolCount + symbol];
+            if (transition)
+            {
+                failure[transition] = failureTransition;
+                queue.push_back(transition);
+            }
+            else
+                transition = failureTransition;
+        }
+    }
+}
+
+std::string WordFilterAutomaton::Find(std::string const& text, bool mail) const
+{
+    // a word normalized to nothing is in every text
+    uint32 found = m_matches[0];
+    uint32 mailFound = m_mailMatches[0];
+
+    uint32 state = 0;
+    for (std::string::const_iterator itr = text.begin(); itr != text.end() && found; ++itr)
+    {
+        uint16 symbol = m_symbols[uint8(*itr)];
+        if (symbol == SYMBOL_SKIP)
+            continue;
+
+        state = m_transitions[state * m_symbolCount + symbol];
+        found = std::min(found, m_matches[state]);
+        mailFound = std::min(mailFound, m_mailMatches[state]);
+    }
+
+    if (found != WORD_FILTER_NO_MATCH)
+        return m_words[found];
+
+    if (mail && mailFound != WORD_FILTER_NO_MATCH)
+        return m_mailWords[mailFound];
+
+    return "";
+}
+
 WordFilterMgr::WordFilterMgr() 
 {
 }
@@ -106,6 +241,8 @@ void WordFilterMgr::LoadLetterAnalogs()
     }
     while (result->NextRow());
 
+    BuildAutomaton();
+
     sLog->outInfo(LOG_FILTER_SERVER_LOADING,">> Loaded %u letter analogs in %u ms", count, GetMSTimeDiffToNow(oldMSTime));
 }
 
@@ -120,17 +257,20 @@ void WordFilterMgr::LoadBadWords()
     QueryResult result = WorldDatabase.Query("SELECT bad_word FROM bad_word");
     if (!result)
     {
+        BuildAutomaton();
         sLog->outInfo(LOG_FILTER_SERVER_LOADING,">> Loaded 0 bad words. DB table `bad_word` is empty!");
         return;
     }
 
+    // the automaton is built once all the words are in
+    std::string normalizedBadWord;
     uint32 count = 0;
     do
     {
         Field* fields = result->Fetch();
         std::string analog = fields[0].GetString();
 
-        AddBadWord(analog);
+        InsertBadWord(m_badWords, analog, normalizedBadWord);
 
         ++count;
     }
@@ -139,6 +279,7 @@ void WordFilterMgr::LoadBadWords()
     result = WorldDatabase.Query("SELECT bad_word FROM bad_word_mail");
     if (!result)
     {
+        BuildAutomaton();
         sLog->outInfo(LOG_FILTER_SERVER_LOADING,">> Loaded 0 bad words. DB table `bad_word_mail` is empty!");
         return;
     }
@@ -148,12 +289,14 @@ void WordFilterMgr::LoadBadWords()
         Field* fields = result->Fetch();
         std::string analog = fields[0].GetString();
 
-        AddBadWordMail(analog);
+        InsertBadWord(m_badWordsMail, analog, normalizedBadWord);
 
         ++count;
     }
     while (result->NextRow());
 
+    BuildAutomaton();
+
     sLog->outInfo(LOG_FILTER_SERVER_LOADING,">> Loaded %u bad words in %u ms", count, GetMSTimeDiffToNow(oldMSTime));
 }
 
@@ -169,7 +312,52 @@ inline void WordFilterMgr::ConvertLettersToAnalogs(std::string& text)
             }
 }
 
+void WordFilterMgr::BuildAutomaton()
+{
+    // first letter in map order having the byte as analog, as in ConvertLettersToAnalogs
+    uint8 letterAnalogs[256];
+    bool converted[256];
+    for (uint32 i = 0; i < 256; ++i)
+    {
+        letterAnalogs[i] = uint8(i);
+        converted[i] = false;
+    }
+
+    for (LetterAnalogMap::const_iterator itr = m_letterAnalogs.begin(); itr != m_letterAnalogs.end(); ++itr)
+    {
+        for (std::string::const_iterator analog = itr->second.begin(); analog != itr->second.end(); ++analog)
+        {
+            if (converted[uint8(*analog)])
+                continue;
+
+            letterAnalogs[uint8(*analog)] = uint8(itr->first);
+            converted[uint8(*analog)] = true;
+        }
+    }
+
+    m_automaton.Build(letterAnalogs, m_badWords, m_badWordsMail);
+}
+
 std::string WordFilterMgr::FindBadWord(const std::string& text, bool mail)
+{
+    if (text.empty() || m_badWords.empty())
+        return "";
+
+    // the automaton lowercases ascii and skips spaces itself, other texts need the utf8 lowercasing
+    for (std::string::const_iterator itr = text.begin(); itr != text.end(); ++itr)
+    {
+        if (uint8(*itr) & 0x80)
+        {
+            std::string normalizedText = text;
+            NormalizeWord(normalizedText);
+            return m_automaton.Find(normalizedText, mail);
+        }
+    }
+
+    return m_automaton.Find(text, mail);
+}
+
+std::string WordFilterMgr::FindBadWordLinear(const std::string& text, bool mail)
 {
     std::string _text = text;
 	
@@ -214,20 +402,30 @@ std::string WordFilterMgr::FindBadWord(const std::string& text, bool mail)
     return "";
 }
 
-bool WordFilterMgr::AddBadWord(const std::string& badWord, bool toDB)
+bool WordFilterMgr::InsertBadWord(BadWordMap& words, const std::string& badWord, std::string& normalizedBadWord)
 {
-    std::string _badWord = badWord;
-  
-    NormalizeWord(_badWord);
+    normalizedBadWord = badWord;
 
-    std::string convertedBadWord = _badWord;
+    NormalizeWord(normalizedBadWord);
+
+    std::string convertedBadWord = normalizedBadWord;
     ConvertLettersToAnalogs(convertedBadWord);
 
     // is already exist
-    if (m_badWords.find(convertedBadWord) != m_badWords.end())
+    if (words.find(convertedBadWord) != words.end())
         return false;
 
-    m_badWords[convertedBadWord] = _badWord;
+    words[convertedBadWord] = normalizedBadWord;
+    return true;
+}
+
+bool WordFilterMgr::AddBadWord(const std::string& badWord, bool toDB)
+{
+    std::string _badWord;
+    if (!InsertBadWord(m_badWords, badWord, _badWord))
+        return false;
+
+    BuildAutomaton();
 
     if (toDB)
         WorldDatabase.PQuery("REPLACE INTO bad_word VALUES ('%s')", _badWord.c_str()); 
@@ -237,18 +435,11 @@ bool WordFilterMgr::AddBadWord(const std::string& badWord, bool toDB)
 
 bool WordFilterMgr::AddBadWordMail(const std::string& badWord, bool toDB)
 {
-    std::string _badWord = badWord;
-
-    NormalizeWord(_badWord);
-
-    std::string convertedBadWord = _badWord;
-    ConvertLettersToAnalogs(convertedBadWord);
-
-    // is already exist
-    if (m_badWordsMail.find(convertedBadWord) != m_badWordsMail.end())
+    std::string _badWord;
+    if (!InsertBadWord(m_badWordsMail, badWord, _badWord))
         return false;
 
-    m_badWordsMail[convertedBadWord] = _badWord;
+    BuildAutomaton();
 
     if (toDB)
         WorldDatabase.PQuery("REPLACE INTO bad_word_mail VALUES ('%s')", _badWord.c_str());
@@ -271,6 +462,7 @@ bool WordFilterMgr::RemoveBadWord(const std::string& badWord, bool fromDB)
         return false;
 
     m_badWords.erase(it);
+    BuildAutomaton();
 
     if (fromDB)
         WorldDatabase.PExecute("DELETE FROM bad_word WHERE `bad_word` = '%s'", _badWord.c_str()); 
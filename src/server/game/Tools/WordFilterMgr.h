@@ -20,8 +20,45 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <ace/Singleton.h>
 
+#include "Define.h"
+
+/**
+    Aho-Corasick automaton matching all the bad words in one pass over the text. The letter analogs,
+    ascii lowercasing and the removal of spaces are folded into its alphabet, so the text is read as is.
+*/
+class WordFilterAutomaton
+{
+    public:
+        WordFilterAutomaton();
+
+        /// letterAnalogs maps every byte to the letter it is an analog of, words are already converted
+        void Build(uint8 const* letterAnalogs, std::map<std::string, std::string> const& words, std::map<std::string, std::string> const& mailWords);
+
+        /// The bad word found first in the word maps order, empty if none
+        std::string Find(std::string const& text, bool mail) const;
+
+    private:
+        enum
+        {
+            SYMBOL_SKIP     = 0xFFFF                        // spaces, normalized away from the words
+        };
+
+        uint32 AddState();
+
+        uint32 AddWord(std::string const& word, uint16 const* wordSymbols);
+
+        uint16 m_symbols[256];                              // byte to symbol, 0 for the bytes no word has
+        uint32 m_symbolCount;
+        std::vector<uint32> m_transitions;                  // [state * m_symbolCount + symbol], complete after Build
+        std::vector<uint32> m_matches;                      // smallest index of the words ending at the state or its suffixes
+        std::vector<uint32> m_mailMatches;
+        std::vector<std::string> m_words;                   // original words by index
+        std::vector<std::string> m_mailWords;
+};
+
 class WordFilterMgr
 {
     private:
@@ -44,6 +81,8 @@ class WordFilterMgr
 		
         inline void ConvertLettersToAnalogs(std::string& text);
         std::string FindBadWord(const std::string& text, bool mail = false);
+        /// Former word by word search, kept as reference for .wordfilter benchmark
+        std::string FindBadWordLinear(const std::string& text, bool mail = false);
 		
         // manipulations with container 
         bool AddBadWord(const std::string& badWord, bool toDB = false);
@@ -54,9 +93,13 @@ class WordFilterMgr
         BadWordMap GetBadWords() const { return m_badWords; }
 
     private:
+        bool InsertBadWord(BadWordMap& words, const std::string& badWord, std::string& normalizedBadWord);
+        void BuildAutomaton();
+
         LetterAnalogMap m_letterAnalogs;
         BadWordMap m_badWords; 
         BadWordMapMail m_badWordsMail;
+        WordFilterAutomaton m_automaton;                    // rebuilt whenever the words or analogs change
 };
 
 #define sWordFilterMgr ACE_Singleton<WordFilterMgr, ACE_Null_Mutex>::instance()
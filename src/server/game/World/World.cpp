@@ -36,6 +36,7 @@
 #include "World.h"
 #include "AccountMgr.h"
 #include "AchievementMgr.h"
+#include "AchievementSaveBuffer.h"
 #include "AuctionHouseMgr.h"
 #include "ObjectMgr.h"
 #include "ArenaTeamMgr.h"
@@ -82,6 +83,7 @@
 #include "CalendarMgr.h"
 #include "BattlefieldMgr.h"
 #include "CurrencyMgr.h"
+#include "NavMeshMgr.h"
 
 ACE_Atomic_Op<ACE_Thread_Mutex, bool> World::m_stopEvent = false;
 uint8 World::m_ExitCode = SHUTDOWN_EXIT_CODE;
@@ -95,8 +97,16 @@ int32 World::m_visibility_notify_periodOnContinents = DEFAULT_VISIBILITY_NOTIFY_
 int32 World::m_visibility_notify_periodInInstances  = DEFAULT_VISIBILITY_NOTIFY_PERIOD;
 int32 World::m_visibility_notify_periodInBGArenas   = DEFAULT_VISIBILITY_NOTIFY_PERIOD;
 
+uint32 World::m_visibility_density_thresholdOnContinents = 0;
+uint32 World::m_visibility_density_thresholdInInstances  = 0;
+uint32 World::m_visibility_density_thresholdInBGArenas   = 0;
+
 float World::Visibility_RelocationLowerLimit = 10.0f;
 uint32 World::Visibility_AINotifyDelay = 1000;
+uint32 World::Visibility_IncrementalFullPassInterval = 8;
+float World::Visibility_DensityNearDistance = 30.0f;
+uint32 World::Visibility_DensityValuesInterval = 1000;
+uint32 World::Visibility_DensityHeartbeatRatio = 3;
 
 /// World constructor
 World::World()
@@ -600,9 +610,14 @@ void World::LoadConfigSettings(bool reload)
     m_bool_configs[CONFIG_PRESERVE_CUSTOM_CHANNELS] = ConfigMgr::GetBoolDefault("PreserveCustomChannels", false);
     m_int_configs[CONFIG_PRESERVE_CUSTOM_CHANNEL_DURATION] = ConfigMgr::GetIntDefault("PreserveCustomChannelDuration", 14);
     m_bool_configs[CONFIG_GRID_UNLOAD] = ConfigMgr::GetBoolDefault("GridUnload", true);
+    m_int_configs[CONFIG_GRID_MAP_CACHE_SIZE] = ConfigMgr::GetIntDefault("GridMapCache.Size", 256);
+    m_int_configs[CONFIG_GRID_MAP_PREFETCH_DISTANCE] = ConfigMgr::GetIntDefault("GridMapCache.PrefetchDistance", 150);
+    m_int_configs[CONFIG_GRID_LOAD_AHEAD_DISTANCE] = ConfigMgr::GetIntDefault("GridLoad.AheadDistance", 200);
+    m_int_configs[CONFIG_GRID_LOAD_TIME_BUDGET] = ConfigMgr::GetIntDefault("GridLoad.TimeBudget", 2);
     m_int_configs[CONFIG_INTERVAL_SAVE] = ConfigMgr::GetIntDefault("PlayerSaveInterval", 15 * MINUTE * IN_MILLISECONDS);
     m_int_configs[CONFIG_INTERVAL_DISCONNECT_TOLERANCE] = ConfigMgr::GetIntDefault("DisconnectToleranceInterval", 0);
     m_bool_configs[CONFIG_STATS_SAVE_ONLY_ON_LOGOUT] = ConfigMgr::GetBoolDefault("PlayerSave.Stats.SaveOnlyOnLogout", true);
+    m_int_configs[CONFIG_ACHIEVEMENT_SAVE_INTERVAL] = ConfigMgr::GetIntDefault("Achievements.SaveInterval", MINUTE * IN_MILLISECONDS);
 
     m_int_configs[CONFIG_MIN_LEVEL_STAT_SAVE] = ConfigMgr::GetIntDefault("PlayerSave.Stats.MinLevel", 0);
     if (m_int_configs[CONFIG_MIN_LEVEL_STAT_SAVE] > MAX_LEVEL)
@@ -928,6 +943,7 @@ void World::LoadConfigSettings(bool reload)
     m_int_configs[CONFIG_GROUP_VISIBILITY] = ConfigMgr::GetIntDefault("Visibility.GroupMode", 1);
 
     m_int_configs[CONFIG_MAIL_DELIVERY_DELAY] = ConfigMgr::GetIntDefault("MailDeliveryDelay", HOUR);
+    m_int_configs[CONFIG_MAILBOX_LOADS_PER_MAP] = ConfigMgr::GetIntDefault("MailboxLoad.MaxPerMap", 20);
     m_int_configs[CONFIG_EXTERNAL_MAIL] = ConfigMgr::GetIntDefault("ExternalMail", 1);
     m_int_configs[CONFIG_EXTERNAL_MAIL_INTERVAL] = ConfigMgr::GetIntDefault("ExternalMailInterval", 5);
 
@@ -982,6 +998,7 @@ void World::LoadConfigSettings(bool reload)
     }
 
     m_bool_configs[CONFIG_SAVE_RESPAWN_TIME_IMMEDIATELY] = ConfigMgr::GetBoolDefault("SaveRespawnTimeImmediately", true);
+    m_int_configs[CONFIG_RESPAWN_TIME_SAVE_INTERVAL] = ConfigMgr::GetIntDefault("RespawnTimeSaveInterval", 10 * IN_MILLISECONDS);
     m_bool_configs[CONFIG_WEATHER] = ConfigMgr::GetBoolDefault("ActivateWeather", true);
 
     m_int_configs[CONFIG_DISABLE_BREATHING] = ConfigMgr::GetIntDefault("DisableWaterBreath", SEC_CONSOLE);
@@ -1009,6 +1026,7 @@ void World::LoadConfigSettings(bool reload)
     m_float_configs[CONFIG_CREATURE_FAMILY_ASSISTANCE_RADIUS] = ConfigMgr::GetFloatDefault("CreatureFamilyAssistanceRadius", 10.0f);
     m_int_configs[CONFIG_CREATURE_FAMILY_ASSISTANCE_DELAY]  = ConfigMgr::GetIntDefault("CreatureFamilyAssistanceDelay", 1500);
     m_int_configs[CONFIG_CREATURE_FAMILY_FLEE_DELAY]        = ConfigMgr::GetIntDefault("CreatureFamilyFleeDelay", 7000);
+    m_int_configs[CONFIG_CREATURE_DORMANT_SLEEP_TIME]       = ConfigMgr::GetIntDefault("CreatureDormantSleepTime", 5000);
 
     m_int_configs[CONFIG_WORLD_BOSS_LEVEL_DIFF] = ConfigMgr::GetIntDefault("WorldBossLevelDiff", 3);
 
@@ -1122,6 +1140,7 @@ void World::LoadConfigSettings(bool reload)
 
     Visibility_RelocationLowerLimit = ConfigMgr::GetFloatDefault("Visibility.RelocationLowerLimit", 10.f);
     Visibility_AINotifyDelay = ConfigMgr::GetFloatDefault("Visibility.AINotifyDelay", 1000);
+    Visibility_IncrementalFullPassInterval = ConfigMgr::GetIntDefault("Visibility.Incremental.FullPassInterval", 8);
 
     //visibility in instances
     m_MaxVisibleDistanceInInstances = ConfigMgr::GetFloatDefault("Visibility.Distance.Instances", DEFAULT_VISIBILITY_INSTANCE);
@@ -1153,6 +1172,16 @@ void World::LoadConfigSettings(bool reload)
     m_visibility_notify_periodInInstances = ConfigMgr::GetIntDefault("Visibility.Notify.Period.InInstances",   DEFAULT_VISIBILITY_NOTIFY_PERIOD);
     m_visibility_notify_periodInBGArenas = ConfigMgr::GetIntDefault("Visibility.Notify.Period.InBGArenas",    DEFAULT_VISIBILITY_NOTIFY_PERIOD);
 
+    m_visibility_density_thresholdOnContinents = ConfigMgr::GetIntDefault("Visibility.Density.Threshold.Continents", 0);
+    m_visibility_density_thresholdInInstances  = ConfigMgr::GetIntDefault("Visibility.Density.Threshold.Instances", 0);
+    m_visibility_density_thresholdInBGArenas   = ConfigMgr::GetIntDefault("Visibility.Density.Threshold.BGArenas", 0);
+
+    Visibility_DensityNearDistance = ConfigMgr::GetFloatDefault("Visibility.Density.NearDistance", 30.0f);
+    Visibility_DensityValuesInterval = ConfigMgr::GetIntDefault("Visibility.Density.ValuesInterval", 1000);
+    Visibility_DensityHeartbeatRatio = ConfigMgr::GetIntDefault("Visibility.Density.HeartbeatRatio", 3);
+    if (Visibility_DensityHeartbeatRatio < 1)
+        Visibility_DensityHeartbeatRatio = 1;
+
     ///- Load the CharDelete related config options
     m_int_configs[CONFIG_CHARDELETE_METHOD] = ConfigMgr::GetIntDefault("CharDelete.Method", 0);
     m_int_configs[CONFIG_CHARDELETE_MIN_LEVEL] = ConfigMgr::GetIntDefault("CharDelete.MinLevel", 0);
@@ -1192,6 +1221,23 @@ void World::LoadConfigSettings(bool reload)
     sLog->outInfo(LOG_FILTER_SERVER_LOADING, "VMap support included. LineOfSight:%i, getHeight:%i, indoorCheck:%i PetLOS:%i", enableLOS, enableHeight, enableIndoor, enablePetLOS);
     sLog->outInfo(LOG_FILTER_SERVER_LOADING, "VMap data directory is: %svmaps", m_dataPath.c_str());
 
+    m_bool_configs[CONFIG_NAVIGATION_ENABLE] = ConfigMgr::GetBoolDefault("Navigation.Enable", false);
+    m_int_configs[CONFIG_NAVIGATION_PATH_CACHE_SIZE] = ConfigMgr::GetIntDefault("Navigation.PathCacheSize", 512);
+    m_int_configs[CONFIG_NAVIGATION_MAX_SEARCH_NODES] = ConfigMgr::GetIntDefault("Navigation.MaxSearchNodes", 4096);
+    if (m_int_configs[CONFIG_NAVIGATION_MAX_SEARCH_NODES] < 64)
+    {
+        sLog->outError(LOG_FILTER_SERVER_LOADING, "Navigation.MaxSearchNodes (%u) must be >= 64. Using 64 instead.", m_int_configs[CONFIG_NAVIGATION_MAX_SEARCH_NODES]);
+        m_int_configs[CONFIG_NAVIGATION_MAX_SEARCH_NODES] = 64;
+    }
+
+    m_int_configs[CONFIG_CHASE_TOLERANCE_ANGLE] = ConfigMgr::GetIntDefault("Movement.Chase.ToleranceAngle", 15);
+    if (m_int_configs[CONFIG_CHASE_TOLERANCE_ANGLE] > 60)
+    {
+        sLog->outError(LOG_FILTER_SERVER_LOADING, "Movement.Chase.ToleranceAngle (%u) must be <= 60. Using 60 instead.", m_int_configs[CONFIG_CHASE_TOLERANCE_ANGLE]);
+        m_int_configs[CONFIG_CHASE_TOLERANCE_ANGLE] = 60;
+    }
+    m_int_configs[CONFIG_CHASE_PREDICTION_TIME] = ConfigMgr::GetIntDefault("Movement.Chase.PredictionTime", 500);
+
     m_int_configs[CONFIG_MAX_WHO] = ConfigMgr::GetIntDefault("MaxWhoListReturns", 49);
     m_bool_configs[CONFIG_PET_LOS] = ConfigMgr::GetBoolDefault("vmap.petLOS", true);
     m_bool_configs[CONFIG_START_ALL_SPELLS] = ConfigMgr::GetBoolDefault("PlayerStart.AllSpells", false);
@@ -1212,6 +1258,7 @@ void World::LoadConfigSettings(bool reload)
     m_bool_configs[CONFIG_SHOW_KICK_IN_WORLD] = ConfigMgr::GetBoolDefault("ShowKickInWorld", false);
     m_int_configs[CONFIG_INTERVAL_LOG_UPDATE] = ConfigMgr::GetIntDefault("RecordUpdateTimeDiffInterval", 60000);
     m_int_configs[CONFIG_MIN_LOG_UPDATE] = ConfigMgr::GetIntDefault("MinRecordUpdateTimeDiff", 100);
+    m_int_configs[CONFIG_SLOW_OPCODE_HANDLER_THRESHOLD] = ConfigMgr::GetIntDefault("SlowOpcodeHandlerThreshold", 50);
     m_int_configs[CONFIG_NUMTHREADS] = ConfigMgr::GetIntDefault("MapUpdate.Threads", 1);
     m_int_configs[CONFIG_MAX_RESULTS_LOOKUP_COMMANDS] = ConfigMgr::GetIntDefault("Command.LookupMaxResults", 0);
 
@@ -1238,6 +1285,14 @@ void World::LoadConfigSettings(bool reload)
     // Dungeon finder
     m_int_configs[CONFIG_LFG_OPTIONSMASK] = ConfigMgr::GetIntDefault("DungeonFinder.OptionsMask", 1);
     m_bool_configs[CONFIG_LFG_CASTDESERTER] = ConfigMgr::GetBoolDefault("DungeonFinder.CastDeserter", false);
+    if (reload)
+    {
+        bool val = ConfigMgr::GetBoolDefault("DungeonFinder.MatchmakingThread", true);
+        if (val != m_bool_configs[CONFIG_LFG_MATCHMAKING_THREAD])
+            sLog->outError(LOG_FILTER_SERVER_LOADING, "DungeonFinder.MatchmakingThread option can't be changed at worldserver.conf reload, using current value (%u).", m_bool_configs[CONFIG_LFG_MATCHMAKING_THREAD]);
+    }
+    else
+        m_bool_configs[CONFIG_LFG_MATCHMAKING_THREAD] = ConfigMgr::GetBoolDefault("DungeonFinder.MatchmakingThread", true);
 
     // DBC_ItemAttributes
     m_bool_configs[CONFIG_DBC_ENFORCE_ITEM_ATTRIBUTES] = ConfigMgr::GetBoolDefault("DBC.EnforceItemAttributes", true);
@@ -1325,6 +1380,10 @@ void World::LoadConfigSettings(bool reload)
     m_bool_configs[CONFIG_ANTISPAM_ENABLED] = ConfigMgr::GetBoolDefault("Antispam.Mail.Enabled", false);
     m_int_configs[CONFIG_ANTISPAM_MAIL_TIMER] = ConfigMgr::GetIntDefault("Antispam.Mail.Timer", 3600) * IN_MILLISECONDS;
     m_int_configs[CONFIG_ANTISPAM_MAIL_COUNT] = ConfigMgr::GetIntDefault("Antispam.Mail.Count", 10);
+
+    // Movement broadcast batching
+    m_bool_configs[CONFIG_MOVEMENT_BATCHING] = ConfigMgr::GetBoolDefault("Network.MovementBatching", true);
+    m_bool_configs[CONFIG_MOVEMENT_BATCHING_MULTIPLE_PACKETS] = ConfigMgr::GetBoolDefault("Network.MovementBatching.MultiplePackets", false);
 }
 
 extern void LoadGameObjectModelList();
@@ -1362,6 +1421,9 @@ void World::SetInitialWorldSettings()
         exit(1);
     }
 
+    ///- Initialize navigation data, tiles are loaded on demand
+    sNavMeshMgr->Initialize();
+
     ///- Initialize pool manager
     sPoolMgr->Initialize();
 
@@ -1849,6 +1911,7 @@ void World::SetInitialWorldSettings()
     m_timers[WUPDATE_PINGDB].SetInterval(getIntConfig(CONFIG_DB_PING_INTERVAL)*MINUTE*IN_MILLISECONDS);    // Mysql ping time in minutes
 
     m_timers[WUPDATE_GUILDSAVE].SetInterval(getIntConfig(CONFIG_GUILD_SAVE_INTERVAL) * MINUTE * IN_MILLISECONDS);
+    m_timers[WUPDATE_ACHIEVEMENTSAVE].SetInterval(getIntConfig(CONFIG_ACHIEVEMENT_SAVE_INTERVAL));
 
     //to set mailtimer to return mails every day between 4 and 5 am
     //mailtimer is increased when updating auctions
@@ -2174,6 +2237,9 @@ void World::Update(uint32 diff)
     sMapMgr->Update(diff);
     RecordTimeDiff("UpdateMapMgr");
 
+    // the map threads are done, no script can release a SmartAI program now
+    sSmartScriptMgr->FreeRetiredPrograms();
+
     if (sWorld->getBoolConfig(CONFIG_AUTOBROADCAST))
     {
         if (m_timers[WUPDATE_AUTOBROADCAST].Passed())
@@ -2237,6 +2303,13 @@ void World::Update(uint32 diff)
         sGuildMgr->SaveGuilds();
     }
 
+    ///- Write the buffered achievement progress, 0 writes it with its owner
+    if (getIntConfig(CONFIG_ACHIEVEMENT_SAVE_INTERVAL) && m_timers[WUPDATE_ACHIEVEMENTSAVE].Passed())
+    {
+        m_timers[WUPDATE_ACHIEVEMENTSAVE].Reset();
+        sAchievementSaveBuffer->Flush();
+    }
+
     // update the instance reset times
     sInstanceSaveMgr->Update();
 
@@ -2833,14 +2906,30 @@ void World::SendAutoBroadcast()
 
 void World::UpdateRealmCharCount(uint32 accountId)
 {
-    PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_CHARACTER_COUNT);
+    PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_SUM_CHARS);
     stmt->setUInt32(0, accountId);
-    PreparedQueryResultFuture result = CharacterDatabase.AsyncQuery(stmt);
-    m_realmCharCallbacks.insert(result);
+
+    RealmCharCountCallback callback;
+    callback.SetParam(accountId);
+    callback.SetFutureResult(CharacterDatabase.AsyncQuery(stmt));
+    m_realmCharCallbacks.push_back(callback);
+}
+
+void World::_UpdateRealmCharCount(PreparedQueryResult resultCharCount, uint32 accountId)
+{
+    // COUNT() always returns a row, even once the last character is deleted
+    if (resultCharCount)
+        SetRealmCharCount(accountId, uint8((*resultCharCount)[0].GetUInt64()));
 }
 
-void World::_UpdateRealmCharCount(PreparedQueryResult resultCharCount)
+void World::SetRealmCharCount(uint32 accountId, uint8 count)
 {
+    // the authserver reloads the counts of the accounts changed since its last check
+    PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_REP_REALM_CHARACTERS);
+    stmt->setUInt32(0, realmID);
+    stmt->setUInt32(1, accountId);
+    stmt->setUInt8(2, count);
+    LoginDatabase.Execute(stmt);
 }
 
 void World::InitWeeklyQuestResetTime()
@@ -3163,6 +3252,7 @@ void World::setWorldState(uint32 index, uint64 value)
         CharacterDatabase.Execute(stmt);
     }
     m_worldstates[index] = value;
+    sConditionMgr->InvalidateWorldConditions();
 }
 
 uint64 World::getWorldState(uint32 index) const
@@ -3173,21 +3263,19 @@ uint64 World::getWorldState(uint32 index) const
 
 void World::ProcessQueryCallbacks()
 {
-    PreparedQueryResult result;
-
-    while (!m_realmCharCallbacks.is_empty())
+    for (std::list<RealmCharCountCallback>::iterator itr = m_realmCharCallbacks.begin(); itr != m_realmCharCallbacks.end();)
     {
-        ACE_Future<PreparedQueryResult> lResult;
-        ACE_Time_Value timeout = ACE_Time_Value::zero;
-        if (m_realmCharCallbacks.next_readable(lResult, &timeout) != 1)
-            break;
-
-        if (lResult.ready())
+        if (!itr->IsReady())
         {
-            lResult.get(result);
-            _UpdateRealmCharCount(result);
-            lResult.cancel();
+            ++itr;
+            continue;
         }
+
+        PreparedQueryResult result;
+        itr->GetResult(result);
+        _UpdateRealmCharCount(result, itr->GetParam());
+        itr->FreeResult();
+        itr = m_realmCharCallbacks.erase(itr);
     }
 }
 
@@ -3213,6 +3301,16 @@ void World::LoadCharacterNameData()
     } while (result->NextRow());
 
     sLog->outInfo(LOG_FILTER_SERVER_LOADING, "Loaded name data for %u characters", count);
+
+    // mailbox sizes, checked when sending mails to players whose mails are not loaded
+    if (QueryResult mailResult = CharacterDatabase.Query("SELECT receiver, COUNT(*) FROM mail GROUP BY receiver"))
+    {
+        do
+        {
+            Field* fields = mailResult->Fetch();
+            UpdateCharacterNameDataMailCount(fields[0].GetUInt32(), uint32(fields[1].GetUInt64()));
+        } while (mailResult->NextRow());
+    }
 }
 
 void World::AddCharacterNameData(uint32 guid, std::string const& name, uint8 gender, uint8 race, uint8 playerClass, uint8 level)
@@ -3249,6 +3347,27 @@ void World::UpdateCharacterNameDataLevel(uint32 guid, uint8 level)
     itr->second.m_level = level;
 }
 
+void World::UpdateCharacterNameDataMailCount(uint32 guid, uint32 mailCount)
+{
+    std::map<uint32, CharacterNameData>::iterator itr = _characterNameDataMap.find(guid);
+    if (itr == _characterNameDataMap.end())
+        return;
+
+    itr->second.m_mailCount = mailCount;
+}
+
+void World::ModifyCharacterNameDataMailCount(uint32 guid, int32 diff)
+{
+    std::map<uint32, CharacterNameData>::iterator itr = _characterNameDataMap.find(guid);
+    if (itr == _characterNameDataMap.end())
+        return;
+
+    // only the part of diff taking the count below 0 is undone, mails are sent from several map threads
+    long count = (itr->second.m_mailCount += diff);
+    if (count < 0)
+        itr->second.m_mailCount += std::min<long>(-count, -diff);
+}
+
 CharacterNameData const* World::GetCharacterNameData(uint32 guid) const
 {
     std::map<uint32, CharacterNameData>::const_iterator itr = _characterNameDataMap.find(guid);
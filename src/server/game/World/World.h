@@ -87,6 +87,7 @@ enum WorldTimers
     WUPDATE_DELETECHARS,
     WUPDATE_PINGDB,
     WUPDATE_GUILDSAVE,
+    WUPDATE_ACHIEVEMENTSAVE,
     WUPDATE_RESETCAP,
     WUPDATE_COUNT
 };
@@ -167,6 +168,7 @@ enum WorldBoolConfigs
     CONFIG_AUTOBROADCAST,
     CONFIG_ALLOW_TICKETS,
     CONFIG_LFG_CASTDESERTER,
+    CONFIG_LFG_MATCHMAKING_THREAD,
     CONFIG_DBC_ENFORCE_ITEM_ATTRIBUTES,
     CONFIG_PRESERVE_CUSTOM_CHANNELS,
     CONFIG_PDUMP_NO_PATHS,
@@ -192,6 +194,9 @@ enum WorldBoolConfigs
     CONFIG_ANTISPAM_ENABLED,
     CONFIG_IS_TOURNAMENT_REALM,
     CONFIG_IS_TRIAL_ACCOUNTS,
+    CONFIG_MOVEMENT_BATCHING,
+    CONFIG_MOVEMENT_BATCHING_MULTIPLE_PACKETS,
+    CONFIG_NAVIGATION_ENABLE,
     BOOL_CONFIG_VALUE_COUNT
 };
 
@@ -215,6 +220,8 @@ enum WorldIntConfigs
 {
     CONFIG_COMPRESSION = 0,
     CONFIG_INTERVAL_SAVE,
+    CONFIG_ACHIEVEMENT_SAVE_INTERVAL,
+    CONFIG_RESPAWN_TIME_SAVE_INTERVAL,
     CONFIG_INTERVAL_GRIDCLEAN,
     CONFIG_INTERVAL_MAPUPDATE,
     CONFIG_INTERVAL_CHANGEWEATHER,
@@ -271,6 +278,7 @@ enum WorldIntConfigs
     CONFIG_START_GM_LEVEL,
     CONFIG_GROUP_VISIBILITY,
     CONFIG_MAIL_DELIVERY_DELAY,
+    CONFIG_MAILBOX_LOADS_PER_MAP,
     CONFIG_UPTIME_UPDATE,
     CONFIG_EXTERNAL_MAIL,
     CONFIG_EXTERNAL_MAIL_INTERVAL,
@@ -290,6 +298,7 @@ enum WorldIntConfigs
     CONFIG_EVENT_ANNOUNCE,
     CONFIG_CREATURE_FAMILY_ASSISTANCE_DELAY,
     CONFIG_CREATURE_FAMILY_FLEE_DELAY,
+    CONFIG_CREATURE_DORMANT_SLEEP_TIME,
     CONFIG_WORLD_BOSS_LEVEL_DIFF,
     CONFIG_QUEST_LOW_LEVEL_HIDE_DIFF,
     CONFIG_QUEST_HIGH_LEVEL_HIDE_DIFF,
@@ -327,6 +336,7 @@ enum WorldIntConfigs
     CONFIG_PVP_TOKEN_COUNT,
     CONFIG_INTERVAL_LOG_UPDATE,
     CONFIG_MIN_LOG_UPDATE,
+    CONFIG_SLOW_OPCODE_HANDLER_THRESHOLD,
     CONFIG_ENABLE_SINFO_LOGIN,
     CONFIG_PLAYER_ALLOW_COMMANDS,
     CONFIG_NUMTHREADS,
@@ -382,6 +392,14 @@ enum WorldIntConfigs
     CONFIG_TRIAL_MAX_LEVEL,
     CONFIG_TRIAL_MAX_MONEY,
     CONFIG_TRIAL_ACTIVATE_TIME,
+    CONFIG_GRID_MAP_CACHE_SIZE,
+    CONFIG_GRID_MAP_PREFETCH_DISTANCE,
+    CONFIG_GRID_LOAD_AHEAD_DISTANCE,
+    CONFIG_GRID_LOAD_TIME_BUDGET,
+    CONFIG_NAVIGATION_PATH_CACHE_SIZE,
+    CONFIG_NAVIGATION_MAX_SEARCH_NODES,
+    CONFIG_CHASE_TOLERANCE_ANGLE,
+    CONFIG_CHASE_PREDICTION_TIME,
     INT_CONFIG_VALUE_COUNT
 };
 
@@ -605,6 +623,7 @@ struct CharacterNameData
     uint8 m_race;
     uint8 m_gender;
     uint8 m_level;
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> m_mailCount;      // mails in DB, for receivers whose mailbox is not loaded, changed by the map threads
 };
 
 /// The World
@@ -809,15 +828,25 @@ class World
         static int32 GetVisibilityNotifyPeriodInInstances() { return m_visibility_notify_periodInInstances;  }
         static int32 GetVisibilityNotifyPeriodInBGArenas()  { return m_visibility_notify_periodInBGArenas;   }
 
+        static uint32 GetVisibilityDensityThresholdOnContinents() { return m_visibility_density_thresholdOnContinents; }
+        static uint32 GetVisibilityDensityThresholdInInstances()  { return m_visibility_density_thresholdInInstances;  }
+        static uint32 GetVisibilityDensityThresholdInBGArenas()   { return m_visibility_density_thresholdInBGArenas;   }
+
         static float Visibility_RelocationLowerLimit;
         static uint32 Visibility_AINotifyDelay;
+        static uint32 Visibility_IncrementalFullPassInterval;
+        static float Visibility_DensityNearDistance;
+        static uint32 Visibility_DensityValuesInterval;
+        static uint32 Visibility_DensityHeartbeatRatio;
 
         void ProcessCliCommands();
         void QueueCliCommand(CliCommandHolder* commandHolder) { cliCmdQueue.add(commandHolder); }
 
         void ForceGameEventUpdate();
 
+        /// Reports the character count of the account on this realm to the authserver
         void UpdateRealmCharCount(uint32 accid);
+        void SetRealmCharCount(uint32 accountId, uint8 count);
 
         LocaleConstant GetAvailableDbcLocale(LocaleConstant locale) const { if (m_availableDbcLocaleMask & (1 << locale)) return locale; else return m_defaultDbcLocale; }
 
@@ -841,6 +870,8 @@ class World
         void AddCharacterNameData(uint32 guid, std::string const& name, uint8 gender, uint8 race, uint8 playerClass, uint8 level);
         void UpdateCharacterNameData(uint32 guid, std::string const& name, uint8 gender = GENDER_NONE, uint8 race = RACE_NONE);
         void UpdateCharacterNameDataLevel(uint32 guid, uint8 level);
+        void UpdateCharacterNameDataMailCount(uint32 guid, uint32 mailCount);
+        void ModifyCharacterNameDataMailCount(uint32 guid, int32 diff);
 
         void DeleteCharacterNameData(uint32 guid) { _characterNameDataMap.erase(guid); }
         bool HasCharacterNameData(uint32 guid) { return _characterNameDataMap.find(guid) != _characterNameDataMap.end(); }
@@ -858,7 +889,7 @@ class World
     protected:
         void _UpdateGameTime();
         // callback for UpdateRealmCharacters
-        void _UpdateRealmCharCount(PreparedQueryResult resultCharCount);
+        void _UpdateRealmCharCount(PreparedQueryResult resultCharCount, uint32 accountId);
 
         void InitDailyQuestResetTime();
         void InitWeeklyQuestResetTime();
@@ -923,6 +954,10 @@ class World
         static int32 m_visibility_notify_periodInInstances;
         static int32 m_visibility_notify_periodInBGArenas;
 
+        static uint32 m_visibility_density_thresholdOnContinents;
+        static uint32 m_visibility_density_thresholdInInstances;
+        static uint32 m_visibility_density_thresholdInBGArenas;
+
         // CLI command holder to be thread safe
         ACE_Based::LockedQueue<CliCommandHolder*, ACE_Thread_Mutex> cliCmdQueue;
 
@@ -949,7 +984,8 @@ class World
         void LoadCharacterNameData();
 
         void ProcessQueryCallbacks();
-        ACE_Future_Set<PreparedQueryResult> m_realmCharCallbacks;
+        typedef QueryCallback<PreparedQueryResult, uint32> RealmCharCountCallback;
+        std::list<RealmCharCountCallback> m_realmCharCallbacks;   // param is the account id
 
         uint32 m_monsterSayDebugTimer;
         uint32 m_monsterSayDebugCounter;
@@ -33,6 +33,9 @@ EndScriptData */
 #include "GossipDef.h"
 #include "CurrencyMgr.h"
 #include "LFGMgr.h"
+#include "PathGenerator.h"
+#include "SmartAI.h"
+#include "ScriptProfiler.h"
 
 #include <fstream>
 
@@ -111,6 +114,15 @@ public:
             { "phase",          SEC_MODERATOR,      false, &HandleDebugPhaseCommand,           "", NULL },
             { "currencycap",    SEC_ADMINISTRATOR,  false, NULL,          "", debugResetCapCommandTable },
             { "hasaura",        SEC_ADMINISTRATOR,  false, &HandleDebugHasAuraCommand,         "", NULL },
+            { "visibility",     SEC_ADMINISTRATOR,  false, &HandleDebugVisibilityCommand,      "", NULL },
+            { "navbench",       SEC_ADMINISTRATOR,  false, &HandleDebugNavBenchCommand,        "", NULL },
+            { "splines",        SEC_ADMINISTRATOR,  false, &HandleDebugSplinesCommand,         "", NULL },
+            { "dormancy",       SEC_ADMINISTRATOR,  false, &HandleDebugDormancyCommand,        "", NULL },
+            { "smartai",        SEC_ADMINISTRATOR,  false, &HandleDebugSmartAICommand,         "", NULL },
+            { "condbench",      SEC_ADMINISTRATOR,  false, &HandleDebugCondBenchCommand,       "", NULL },
+            { "matchmaking",    SEC_ADMINISTRATOR,  false, &HandleDebugMatchmakingCommand,     "", NULL },
+            { "scripthooks",    SEC_ADMINISTRATOR,  true,  &HandleDebugScriptHooksCommand,     "", NULL },
+            { "scriptprofile",  SEC_ADMINISTRATOR,  true,  &HandleDebugScriptProfileCommand,   "", NULL },
 
             // stats debug
             { "spellpower",     SEC_ADMINISTRATOR,  false, &HandleDebugModifySpellpowerCommand,     "", NULL },
@@ -1191,6 +1203,257 @@ public:
         return true;
     }
 
+    static bool HandleDebugVisibilityCommand(ChatHandler* handler, char const* /*args*/)
+    {
+        Player* player = handler->GetSession()->GetPlayer();
+        Map* map = player->GetMap();
+        Map::VisibilityStats const& stats = map->GetLastTickVisibilityStats();
+
+        handler->PSendSysMessage("Map %u (instance %u), last tick visibility work:", map->GetId(), map->GetInstanceId());
+        handler->PSendSysMessage("Passes: %u full, %u incremental", stats.FullPasses, stats.IncrementalPasses);
+        handler->PSendSysMessage("Incremental cells: %u visited, %u skipped", stats.CellsVisited, stats.CellsSkipped);
+        handler->PSendSysMessage("Objects: %u checked, %u created, %u destroyed", stats.ObjectsChecked, stats.ObjectsCreated, stats.ObjectsDestroyed);
+        handler->PSendSysMessage("Objects at your client: %u", uint32(player->m_clientGUIDs.size()));
+        handler->PSendSysMessage("Crowded area throttling: %u values held back, %u flushed, %u messages skipped", stats.ValuesDeferred, stats.ValuesFlushed, stats.MessagesSkipped);
+        if (map->GetVisibilityDensityThreshold())
+            handler->PSendSysMessage("Visible units: %u (threshold %u), throttled: %s", player->GetVisibleUnitsCount(), map->GetVisibilityDensityThreshold(), player->IsInDenseVisibilityArea() ? "yes" : "no");
+
+        WorldSession* session = handler->GetSession();
+        uint32 seconds = uint32(std::max<time_t>(time(NULL) - session->GetSentStatsStartTime(), 1));
+        handler->PSendSysMessage("Sent to you: " UI64FMTD " packets, " UI64FMTD " bytes (%u bytes/sec)", session->GetSentPackets(), session->GetSentBytes(), uint32(session->GetSentBytes() / seconds));
+        handler->PSendSysMessage("Movement batching: " UI64FMTD " packets queued, " UI64FMTD " replaced, " UI64FMTD " batches sent", session->GetMovementPacketsQueued(), session->GetMovementPacketsReplaced(), session->GetMovementBatchesSent());
+        return true;
+    }
+
+    static bool HandleDebugNavBenchCommand(ChatHandler* handler, char const* args)
+    {
+        if (!sNavMeshMgr->IsEnabled())
+        {
+            handler->SendSysMessage("Navigation is disabled (Navigation.Enable = 0).");
+            handler->SetSentErrorMessage(true);
+            return false;
+        }
+
+        char* countStr = strtok((char*)args, " ");
+        char* radiusStr = strtok(NULL, " ");
+        uint32 count = countStr ? uint32(atoi(countStr)) : 100;
+        float radius = radiusStr ? float(atof(radiusStr)) : 60.0f;
+        if (!count || count > 10000 || radius <= 0.0f)
+            return false;
+
+        Player* player = handler->GetSession()->GetPlayer();
+        Map* map = player->GetMap();
+
+        std::vector<G3D::Vector3> destinations(count);
+        for (uint32 i = 0; i < count; ++i)
+        {
+            float angle = float(rand_norm()) * static_cast<float>(M_PI * 2.0f);
+            float dist = float(rand_norm()) * radius;
+            float x = player->GetPositionX() + dist * std::cos(angle);
+            float y = player->GetPositionY() + dist * std::sin(angle);
+            Trinity::NormalizeMapCoord(x);
+            Trinity::NormalizeMapCoord(y);
+            destinations[i] = G3D::Vector3(x, y, map->GetHeight(x, y, MAX_HEIGHT, false));
+        }
+
+        handler->PSendSysMessage("Navigation benchmark: %u queries within %.1f yards on map %u", count, radius, map->GetId());
+
+        // second pass repeats the same queries and is served by the path cache
+        for (uint8 pass = 0; pass < 2; ++pass)
+        {
+            uint32 types[PATHFIND_NOPATH + 1] = { 0 };
+            uint32 cacheHits = 0;
+            uint64 searchedNodes = 0;
+            uint64 totalTime = 0;
+            uint64 maxTime = 0;
+
+            for (uint32 i = 0; i < count; ++i)
+            {
+                PathGenerator path(player);
+                ACE_Time_Value start = ACE_OS::gettimeofday();
+                PathType type = path.CalculatePath(destinations[i].x, destinations[i].y, destinations[i].z);
+                ACE_Time_Value elapsed = ACE_OS::gettimeofday() - start;
+
+                uint64 usec = uint64(elapsed.sec()) * IN_MILLISECONDS * IN_MILLISECONDS + elapsed.usec();
+                totalTime += usec;
+                maxTime = std::max(maxTime, usec);
+                ++types[type];
+                searchedNodes += path.GetSearchedNodes();
+                if (path.IsCacheHit())
+                    ++cacheHits;
+            }
+
+            handler->PSendSysMessage("%s: avg " UI64FMTD " us, max " UI64FMTD " us, total " UI64FMTD " us, avg searched cells " UI64FMTD,
+                pass ? "Warm cache" : "Cold cache", totalTime / count, maxTime, totalTime, searchedNodes / count);
+            handler->PSendSysMessage("Results: %u found, %u incomplete, %u no path, %u straight line, %u cache hits",
+                types[PATHFIND_NORMAL], types[PATHFIND_INCOMPLETE], types[PATHFIND_NOPATH], types[PATHFIND_SHORTCUT], cacheHits);
+        }
+
+        NavPathCache const& cache = map->GetNavPathCache();
+        handler->PSendSysMessage("Map path cache: %u/%u paths, %u hits, %u misses. Navigation tiles loaded: %u",
+            cache.GetSize(), cache.GetMaxSize(), cache.GetHits(), cache.GetMisses(), sNavMeshMgr->GetLoadedTilesCount());
+        return true;
+    }
+
+    static bool HandleDebugSmartAICommand(ChatHandler* handler, char const* /*args*/)
+    {
+        handler->PSendSysMessage("SmartAI: %u shared programs using " SIZEFMTD " bytes, " SIZEFMTD " bytes per event definition, " SIZEFMTD " bytes per event state",
+            sSmartScriptMgr->GetProgramCount(), sSmartScriptMgr->GetProgramsMemoryUsage(), sizeof(SmartScriptHolder), sizeof(SmartEventState));
+
+        Creature* target = handler->getSelectedCreature();
+        SmartAI* ai = target ? dynamic_cast<SmartAI*>(target->AI()) : NULL;
+        if (!ai)
+            return true;
+
+        SmartScript* script = ai->GetScript();
+        SmartAIProgram const* program = script->GetProgram();
+
+        // a private copy of every definition with its timers, which is what each script held before programs were shared
+        size_t copySize = script->GetEventCount() * (sizeof(SmartScriptHolder) - sizeof(ConditionList const*) + sizeof(SmartEventState) - sizeof(SmartScriptHolder const*));
+
+        handler->PSendSysMessage("%s (entry %u): %u events, " SIZEFMTD " bytes of own state, shared program of " SIZEFMTD " bytes, a private copy would take " SIZEFMTD " bytes",
+            target->GetName(), target->GetEntry(), script->GetEventCount(), script->GetMemoryUsage(), program ? program->GetMemoryUsage() : 0, copySize);
+        return true;
+    }
+
+    static bool HandleDebugCondBenchCommand(ChatHandler* handler, char const* args)
+    {
+        Creature* target = handler->getSelectedCreature();
+        if (!target)
+        {
+            handler->SendSysMessage(LANG_SELECT_CREATURE);
+            handler->SetSentErrorMessage(true);
+            return false;
+        }
+
+        // every iteration stands for one player opening the gossip and looting the selected creature
+        uint32 count = *args ? uint32(atoi(args)) : 10000;
+        if (!count)
+            count = 10000;
+
+        Player* player = handler->GetSession()->GetPlayer();
+        CreatureTemplate const* cInfo = target->GetCreatureTemplate();
+        GossipMenusMapBounds menuBounds = sObjectMgr->GetGossipMenusMapBounds(cInfo->GossipMenuId);
+        GossipMenuItemsMapBounds itemBounds = sObjectMgr->GetGossipMenuItemsMapBounds(cInfo->GossipMenuId);
+
+        uint32 gossipShown = 0;
+        ACE_Time_Value start = ACE_OS::gettimeofday();
+        for (uint32 i = 0; i < count; ++i)
+        {
+            for (GossipMenusContainer::const_iterator itr = menuBounds.first; itr != menuBounds.second; ++itr)
+                if (sConditionMgr->IsObjectMeetToConditions(player, target, itr->second.conditions))
+                    ++gossipShown;
+
+            for (GossipMenuItemsContainer::const_iterator itr = itemBounds.first; itr != itemBounds.second; ++itr)
+                if (sConditionMgr->IsObjectMeetToConditions(player, target, itr->second.Conditions))
+                    ++gossipShown;
+        }
+        ACE_Time_Value elapsed = ACE_OS::gettimeofday() - start;
+        uint64 gossipTime = uint64(elapsed.sec()) * IN_MILLISECONDS * IN_MILLISECONDS + elapsed.usec();
+
+        uint32 lootItems = 0;
+        start = ACE_OS::gettimeofday();
+        if (cInfo->lootid)
+        {
+            for (uint32 i = 0; i < count; ++i)
+            {
+                Loot loot;
+                loot.FillLoot(cInfo->lootid, LootTemplates_Creature, player, true, true);
+                lootItems += loot.items.size();
+                loot.clear();
+            }
+        }
+        elapsed = ACE_OS::gettimeofday() - start;
+        uint64 lootTime = uint64(elapsed.sec()) * IN_MILLISECONDS * IN_MILLISECONDS + elapsed.usec();
+
+        handler->PSendSysMessage("%s (entry %u), %u players:", target->GetName(), target->GetEntry(), count);
+        handler->PSendSysMessage("Gossip menu %u: " UI64FMTD " us total, %.3f us per player, %u entries shown",
+            cInfo->GossipMenuId, gossipTime, float(gossipTime) / count, gossipShown);
+        handler->PSendSysMessage("Loot %u: " UI64FMTD " us total, %.3f us per player, %u items rolled",
+            cInfo->lootid, lootTime, float(lootTime) / count, lootItems);
+        return true;
+    }
+
+    static bool HandleDebugMatchmakingCommand(ChatHandler* handler, char const* /*args*/)
+    {
+        handler->SendSysMessage(sLFGMgr->DumpMatchmakingInfo().c_str());
+        handler->SendSysMessage(sBattlegroundMgr->DumpQueueUpdateInfo().c_str());
+        return true;
+    }
+
+    static bool HandleDebugScriptHooksCommand(ChatHandler* handler, char const* /*args*/)
+    {
+        handler->SendSysMessage(sScriptMgr->DumpHookStats().c_str());
+        return true;
+    }
+
+    static bool HandleDebugScriptProfileCommand(ChatHandler* handler, char const* args)
+    {
+        char* action = strtok((char*)args, " ");
+        if (!action || isdigit(*action))
+        {
+            uint32 count = action ? uint32(atoi(action)) : 20;
+            handler->SendSysMessage(sScriptProfiler->Dump(count ? count : 20).c_str());
+            return true;
+        }
+
+        std::string actionStr = action;
+        if (actionStr == "on" || actionStr == "off")
+        {
+            sScriptProfiler->SetEnabled(actionStr == "on");
+            handler->PSendSysMessage("Script profiler %s.", actionStr == "on" ? "enabled" : "disabled");
+        }
+        else if (actionStr == "reset")
+        {
+            sScriptProfiler->Reset();
+            handler->SendSysMessage("Script profile cleared.");
+        }
+        else if (actionStr == "export")
+        {
+            char* fileName = strtok(NULL, " ");
+            if (!fileName || !sScriptProfiler->Export(fileName))
+            {
+                handler->PSendSysMessage("Can't write the script profile to '%s'.", fileName ? fileName : "");
+                handler->SetSentErrorMessage(true);
+                return false;
+            }
+            handler->PSendSysMessage("Script profile written to '%s'.", fileName);
+        }
+        else
+            return false;
+
+        return true;
+    }
+
+    static bool HandleDebugSplinesCommand(ChatHandler* handler, char const* /*args*/)
+    {
+        Map* map = handler->GetSession()->GetPlayer()->GetMap();
+        Map::SplineStats const& stats = map->GetLastSecondSplineStats();
+        uint32 elapsed = std::max<uint32>(stats.Elapsed, 1);
+
+        handler->PSendSysMessage("Map %u (instance %u), spline movement over the last %u ms:", map->GetId(), map->GetInstanceId(), stats.Elapsed);
+        handler->PSendSysMessage("Splines launched: %u (%u/sec)", stats.SplinesLaunched, stats.SplinesLaunched * IN_MILLISECONDS / elapsed);
+        handler->PSendSysMessage("Chase and follow: %u launched (%u/sec), %u replans skipped in tolerance, %u launches coalesced",
+            stats.ChaseLaunches, stats.ChaseLaunches * IN_MILLISECONDS / elapsed, stats.ChaseReplansSkipped, stats.ChaseLaunchesCoalesced);
+        return true;
+    }
+
+    static bool HandleDebugDormancyCommand(ChatHandler* handler, char const* /*args*/)
+    {
+        Map* map = handler->GetSession()->GetPlayer()->GetMap();
+        uint32 awake = map->GetAwakeCreatureCount();
+        uint32 dormant = map->GetDormantCreatureCount();
+
+        handler->PSendSysMessage("Map %u (instance %u), creatures of the active cells at the last update: %u awake, %u dormant (%u%%)",
+            map->GetId(), map->GetInstanceId(), awake, dormant, dormant * 100 / std::max<uint32>(awake + dormant, 1));
+
+        handler->PSendSysMessage("Respawn queue: %u entries, %u respawn times waiting to be saved", map->GetRespawnQueueSize(), map->GetRespawnTimesToSaveCount());
+
+        if (Creature* target = handler->getSelectedCreature())
+            handler->PSendSysMessage("Selected creature is %s", target->IsDormant() ? "dormant" : "awake");
+        return true;
+    }
+
     static bool HandleDebugSetAuraStateCommand(ChatHandler* handler, char const* args)
     {
         if (!*args)
@@ -48,6 +48,7 @@ public:
             {   "queue",     SEC_GAMEMASTER, false,  &HandleLfgQueueInfoCommand, "", NULL },
             {   "clean",  SEC_ADMINISTRATOR, false,      &HandleLfgCleanCommand, "", NULL },
             { "options",  SEC_ADMINISTRATOR, false,    &HandleLfgOptionsCommand, "", NULL },
+            {   "bench",  SEC_ADMINISTRATOR, false,      &HandleLfgBenchCommand, "", NULL },
             {      NULL,         SEC_PLAYER, false,                        NULL, "", NULL }
         };
 
@@ -126,6 +127,78 @@ public:
         sLFGMgr->Clean();
         return true;
     }
+
+    static bool HandleLfgBenchCommand(ChatHandler* handler, char const* args)
+    {
+        uint32 count = *args ? uint32(atoi(args)) : 2000;
+        if (!count)
+            count = 2000;
+
+        // players joining a detached queue, it never touches the real queues nor players
+        LfgProposalList matches;
+        LFGQueue queue(0, &matches);
+        LfgGuidSet queued;
+        uint64 const firstGuid = 0x7F000000;
+        uint32 proposals = 0;
+        uint32 left = 0;
+        time_t now = time(NULL);
+
+        ACE_Time_Value start = ACE_OS::gettimeofday();
+        for (uint32 i = 0; i < count; ++i)
+        {
+            uint64 guid = firstGuid + i;
+            uint8 role;
+            switch (urand(0, 9))
+            {
+                case 0: role = PLAYER_ROLE_TANK; break;
+                case 1: role = PLAYER_ROLE_HEALER; break;
+                case 2: role = PLAYER_ROLE_TANK | PLAYER_ROLE_DAMAGE; break;
+                case 3: role = PLAYER_ROLE_HEALER | PLAYER_ROLE_DAMAGE; break;
+                default: role = PLAYER_ROLE_DAMAGE; break;
+            }
+
+            LfgRolesMap roles;
+            roles[guid] = role;
+
+            // one to three of eight dungeons
+            LfgDungeonSet dungeons;
+            for (uint8 j = urand(1, 3); j > 0; --j)
+                dungeons.insert(urand(1, 8));
+
+            queue.AddQueueData(guid, now, dungeons, roles);
+            queued.insert(guid);
+
+            // the longest waiting player gives up now and then
+            if (i % 20 == 19 && !queued.empty())
+            {
+                queue.RemoveFromQueue(*queued.begin());
+                queued.erase(queued.begin());
+                ++left;
+            }
+
+            // the queue is updated every few joins, matched players leave it
+            if (i % 5 == 4 || i + 1 == count)
+            {
+                proposals += queue.FindGroups();
+                for (LfgProposalList::const_iterator itr = matches.begin(); itr != matches.end(); ++itr)
+                {
+                    for (LfgGuidList::const_iterator itQueue = itr->queues.begin(); itQueue != itr->queues.end(); ++itQueue)
+                    {
+                        queue.RemoveFromQueue(*itQueue);
+                        queued.erase(*itQueue);
+                    }
+                }
+                matches.clear();
+            }
+        }
+        ACE_Time_Value elapsed = ACE_OS::gettimeofday() - start;
+        uint64 usec = std::max<uint64>(uint64(elapsed.sec()) * IN_MILLISECONDS * IN_MILLISECONDS + elapsed.usec(), 1);
+
+        handler->PSendSysMessage("LFG queue simulation: %u players joined, %u left, %u still queued, %u proposals in " UI64FMTD " us (" UI64FMTD " proposals/sec)",
+            count, left, uint32(queued.size()), proposals, usec, uint64(proposals) * IN_MILLISECONDS * IN_MILLISECONDS / usec);
+        handler->SendSysMessage(queue.DumpCompatibleInfo().c_str());
+        return true;
+    }
 };
 
 void AddSC_lfg_commandscript()
@@ -30,6 +30,8 @@
 #include "WeatherMgr.h"
 #include "ace/INET_Addr.h"
 #include "WordFilterMgr.h"
+#include <ace/OS_NS_sys_time.h>
+#include <fstream>
 
 class misc_commandscript : public CommandScript
 {
@@ -49,6 +51,7 @@ public:
         {
             { "badword",            SEC_ADMINISTRATOR,      true,  NULL,                                "", badWordCommandTable },
             { "mod",                SEC_ADMINISTRATOR,      true,  &HandleWordFilterModCommand,         "", NULL },
+            { "benchmark",          SEC_ADMINISTRATOR,      true,  &HandleWordFilterBenchmarkCommand,   "", NULL },
             { NULL,                 0,                      false, NULL,                                "", NULL }
         };
         static ChatCommand groupCommandTable[] =
@@ -243,6 +246,62 @@ public:
         return true;
     }
 
+    // .wordfilter benchmark $file [$repeat], one chat line per file line
+    static bool HandleWordFilterBenchmarkCommand(ChatHandler* handler, char const* args)
+    {
+        char* fileName = strtok((char*)args, " ");
+        if (!fileName)
+            return false;
+
+        char* repeatStr = strtok(NULL, " ");
+        uint32 repeat = repeatStr ? std::max(atoi(repeatStr), 1) : 1;
+
+        std::ifstream file(fileName);
+        if (!file)
+        {
+            handler->PSendSysMessage("WordFilter: can't open %s", fileName);
+            handler->SetSentErrorMessage(true);
+            return false;
+        }
+
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file, line))
+            lines.push_back(line);
+
+        uint32 matches = 0;
+        uint32 mismatches = 0;
+        for (std::vector<std::string>::const_iterator itr = lines.begin(); itr != lines.end(); ++itr)
+        {
+            std::string badWord = sWordFilterMgr->FindBadWord(*itr, true);
+            if (!badWord.empty())
+                ++matches;
+            if (badWord != sWordFilterMgr->FindBadWordLinear(*itr, true))
+                ++mismatches;
+        }
+
+        ACE_Time_Value start = ACE_OS::gettimeofday();
+        for (uint32 i = 0; i < repeat; ++i)
+            for (std::vector<std::string>::const_iterator itr = lines.begin(); itr != lines.end(); ++itr)
+                sWordFilterMgr->FindBadWord(*itr, true);
+        ACE_Time_Value automatonTime = ACE_OS::gettimeofday() - start;
+
+        start = ACE_OS::gettimeofday();
+        for (uint32 i = 0; i < repeat; ++i)
+            for (std::vector<std::string>::const_iterator itr = lines.begin(); itr != lines.end(); ++itr)
+                sWordFilterMgr->FindBadWordLinear(*itr, true);
+        ACE_Time_Value linearTime = ACE_OS::gettimeofday() - start;
+
+        uint64 calls = std::max<uint64>(uint64(lines.size()) * repeat, 1);
+        uint64 automatonUsec = uint64(automatonTime.sec()) * IN_MILLISECONDS * IN_MILLISECONDS + automatonTime.usec();
+        uint64 linearUsec = uint64(linearTime.sec()) * IN_MILLISECONDS * IN_MILLISECONDS + linearTime.usec();
+
+        handler->PSendSysMessage("WordFilter: %u lines, %u with bad words, %u mismatches", uint32(lines.size()), matches, mismatches);
+        handler->PSendSysMessage("WordFilter: automaton " UI64FMTD " us (%.3f us per line), linear " UI64FMTD " us (%.3f us per line)",
+            automatonUsec, double(automatonUsec) / calls, linearUsec, double(linearUsec) / calls);
+        return true;
+    }
+
     static bool HandleDevCommand(ChatHandler* handler, char const* args)
     {
         if (!*args)
@@ -1898,6 +1957,9 @@ public:
         TypeContainerVisitor<Trinity::WorldObjectWorker<Trinity::RespawnDo>, GridTypeMapContainer > obj_worker(worker);
         cell.Visit(p, obj_worker, *player->GetMap(), *player, player->GetGridActivationRange());
 
+        // dead spawns waiting unloaded in the map's respawn queue
+        player->GetMap()->RespawnUnloadedCreatures(player, player->GetGridActivationRange());
+
         return true;
     }
     // mute player for some times
@@ -27,6 +27,7 @@ EndScriptData */
 #include "SystemConfig.h"
 #include "Config.h"
 #include "ObjectAccessor.h"
+#include "OpcodeStats.h"
 
 class server_commandscript : public CommandScript
 {
@@ -80,6 +81,7 @@ public:
             { "idleshutdown",   SEC_ADMINISTRATOR,  true,  NULL,                                    "", serverIdleShutdownCommandTable },
             { "info",           SEC_PLAYER,         true,  &HandleServerInfoCommand,                "", NULL },
             { "motd",           SEC_PLAYER,         true,  &HandleServerMotdCommand,                "", NULL },
+            { "opcodes",        SEC_ADMINISTRATOR,  true,  &HandleServerOpcodesCommand,             "", NULL },
             { "plimit",         SEC_ADMINISTRATOR,  true,  &HandleServerPLimitCommand,              "", NULL },
             { "restart",        SEC_ADMINISTRATOR,  true,  NULL,                                    "", serverRestartCommandTable },
             { "shutdown",       SEC_ADMINISTRATOR,  true,  NULL,                                    "", serverShutdownCommandTable },
@@ -129,6 +131,20 @@ public:
         return true;
     }
 
+    static bool HandleServerOpcodesCommand(ChatHandler* handler, char const* args)
+    {
+        if (!strcmp(args, "reset"))
+        {
+            sOpcodeStatsMgr->Reset();
+            handler->SendSysMessage("Opcode handling stats cleared.");
+            return true;
+        }
+
+        uint32 count = *args ? uint32(atoi(args)) : 20;
+        handler->SendSysMessage(sOpcodeStatsMgr->Dump(count ? count : 20).c_str());
+        return true;
+    }
+
     static bool HandleServerPLimitCommand(ChatHandler* handler, char const* args)
     {
         if (*args)
@@ -16,7 +16,7 @@
 class PlayerLoginScript : public PlayerScript
 {
 public:
-    PlayerLoginScript() : PlayerScript("PlayerLoginScript") { }
+    PlayerLoginScript() : PlayerScript("PlayerLoginScript", SCRIPT_HOOK_MASK(PLAYERHOOK_ON_END_WATCHING) | SCRIPT_HOOK_MASK(PLAYERHOOK_ON_LOGIN)) { }
 
     void OnEndWatching(Player* player)
     {
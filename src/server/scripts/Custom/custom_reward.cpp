@@ -22,7 +22,7 @@
 class CustomRewardScript : public PlayerScript
 {
 public:
-    CustomRewardScript() : PlayerScript("CustomRewardScript") { }
+    CustomRewardScript() : PlayerScript("CustomRewardScript", SCRIPT_HOOK_MASK(PLAYERHOOK_ON_LOGIN)) { }
 
     void OnLogin(Player* player)
     {
@@ -305,7 +305,7 @@ public:
 class AchievementRewardCheck : public PlayerScript
 {
 public:
-    AchievementRewardCheck() : PlayerScript("AchievementRewardCheck") { }
+    AchievementRewardCheck() : PlayerScript("AchievementRewardCheck", SCRIPT_HOOK_MASK(PLAYERHOOK_ON_LOGIN)) { }
 
     void OnLogin(Player* pPlayer)
     {
@@ -23,7 +23,8 @@
 class ChatLogScript : public PlayerScript
 {
 public:
-    ChatLogScript() : PlayerScript("ChatLogScript") { }
+    ChatLogScript() : PlayerScript("ChatLogScript", SCRIPT_HOOK_MASK(PLAYERHOOK_ON_CHAT) | SCRIPT_HOOK_MASK(PLAYERHOOK_ON_CHAT_WHISPER)
+        | SCRIPT_HOOK_MASK(PLAYERHOOK_ON_CHAT_GROUP) | SCRIPT_HOOK_MASK(PLAYERHOOK_ON_CHAT_GUILD) | SCRIPT_HOOK_MASK(PLAYERHOOK_ON_CHAT_CHANNEL)) { }
 
     void OnChat(Player* player, uint32 type, uint32 lang, std::string& msg)
     {
@@ -3,7 +3,7 @@
 class on_duel : public PlayerScript
 {
     public:
-        on_duel() : PlayerScript("on_duel") {}
+        on_duel() : PlayerScript("on_duel", SCRIPT_HOOK_MASK(PLAYERHOOK_ON_DUEL_START) | SCRIPT_HOOK_MASK(PLAYERHOOK_ON_DUEL_END)) {}
 
     void OnDuelStart(Player* player1, Player* player2)
     {
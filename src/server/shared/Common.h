@@ -62,6 +62,7 @@
 #include "Define.h"
 
 #include "Dynamic/UnorderedMap.h"
+#include "Dynamic/UnorderedSet.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2009 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OpenSSLCrypto.h"
+#include <openssl/crypto.h>
+#include <ace/Thread_Mutex.h>
+
+#include <vector>
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+
+static std::vector<ACE_Thread_Mutex*> CryptoLocks;
+
+static void LockingCallback(int mode, int type, char const* /*file*/, int /*line*/)
+{
+    if (mode & CRYPTO_LOCK)
+        CryptoLocks[type]->acquire();
+    else
+        CryptoLocks[type]->release();
+}
+
+// no thread id callback is needed, OpenSSL 1.0 identifies the threads by the address of errno
+void OpenSSLCrypto::ThreadsSetup()
+{
+    CryptoLocks.resize(CRYPTO_num_locks());
+    for (size_t i = 0; i < CryptoLocks.size(); ++i)
+        CryptoLocks[i] = new ACE_Thread_Mutex();
+
+    CRYPTO_set_locking_callback(LockingCallback);
+}
+
+void OpenSSLCrypto::ThreadsCleanup()
+{
+    CRYPTO_set_locking_callback(NULL);
+
+    for (size_t i = 0; i < CryptoLocks.size(); ++i)
+        delete CryptoLocks[i];
+    CryptoLocks.clear();
+}
+
+#else
+
+// OpenSSL 1.1 locks internally
+void OpenSSLCrypto::ThreadsSetup() { }
+void OpenSSLCrypto::ThreadsCleanup() { }
+
+#endif
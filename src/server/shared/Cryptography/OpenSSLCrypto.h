@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2009 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _OPENSSLCRYPTO_H
+#define _OPENSSLCRYPTO_H
+
+/// OpenSSL before 1.1 is only thread safe with locking callbacks set by the application.
+/// The servers run BigNumber and hash code on several network threads, so both set them at startup.
+namespace OpenSSLCrypto
+{
+    /// Needs to be called before the network threads are started
+    void ThreadsSetup();
+    /// Needs to be called after the network threads are stopped
+    void ThreadsCleanup();
+}
+
+#endif
@@ -116,6 +116,7 @@ enum CharacterDatabaseStatements
     CHAR_SEL_CHARACTER_QUESTSTATUSREW,
     CHAR_SEL_ACCOUNT_INSTANCELOCKTIMES,
     CHAR_SEL_MAILITEMS,
+    CHAR_SEL_MAILBOX,
     CHAR_SEL_AUCTION_ITEMS,
     CHAR_INS_AUCTION,
     CHAR_DEL_AUCTION,
@@ -153,7 +154,6 @@ enum CharacterDatabaseStatements
     CHAR_SEL_CHARACTER_NAME_CLASS,
     CHAR_SEL_CHARACTER_NAME,
     CHAR_SEL_MATCH_MAKER_RATING,
-    CHAR_SEL_CHARACTER_COUNT,
     CHAR_UPD_NAME,
     CHAR_DEL_DECLINED_NAME,
     CHAR_SEL_ACCOUNT_NAME_BY_GUID,
@@ -226,10 +226,10 @@ enum CharacterDatabaseStatements
     CHAR_UPD_GUILD_RANK_BANK_TIME7,
     CHAR_UPD_GUILD_MEMBER_XP,
     CHAR_SEL_CHAR_DATA_FOR_GUILD,
-    CHAR_DEL_GUILD_ACHIEVEMENT,
-    CHAR_INS_GUILD_ACHIEVEMENT,
+    CHAR_REP_GUILD_ACHIEVEMENT,
     CHAR_DEL_GUILD_ACHIEVEMENT_CRITERIA,
-    CHAR_INS_GUILD_ACHIEVEMENT_CRITERIA,
+    CHAR_REP_GUILD_ACHIEVEMENT_CRITERIA,
+    CHAR_REP_GUILD_ACHIEVEMENT_CRITERIA_BATCH,
     CHAR_DEL_ALL_GUILD_ACHIEVEMENTS,
     CHAR_DEL_ALL_GUILD_ACHIEVEMENT_CRITERIA,
     CHAR_SEL_GUILD_ACHIEVEMENT,
@@ -446,6 +446,10 @@ enum CharacterDatabaseStatements
     CHAR_SEL_CHAR_PET_BY_SLOT,
     CHAR_DEL_CHAR_ACHIEVEMENT,
     CHAR_DEL_CHAR_ACHIEVEMENT_PROGRESS,
+    CHAR_REP_CHAR_ACHIEVEMENT,
+    CHAR_DEL_CHAR_ACHIEVEMENT_PROGRESS_BY_CRITERIA,
+    CHAR_REP_CHAR_ACHIEVEMENT_PROGRESS,
+    CHAR_REP_CHAR_ACHIEVEMENT_PROGRESS_BATCH,
     CHAR_DEL_CHAR_REPUTATION_BY_FACTION,
     CHAR_INS_CHAR_REPUTATION_BY_FACTION,
     CHAR_DEL_ITEM_REFUND_INSTANCE,
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PERTHREADSTATS_H
+#define _PERTHREADSTATS_H
+
+#include "Define.h"
+#include <ace/Guard_T.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/TSS_T.h>
+
+#include <list>
+
+/**
+    Stats recorded by many threads without contending on a shared lock. Every thread adds to its
+    own container, registered on its first record, and the containers are merged when read. The
+    stats of a thread are kept when it exits.
+
+    Container maps a key to an entry, the entry has an Add() overload for every recorded value and
+    one taking another entry, used for merging.
+*/
+template<class Container>
+class PerThreadStats
+{
+    private:
+        /// Stats of one thread, only that thread writes them
+        struct Buffer
+        {
+            Buffer() : owner(NULL) { }
+            ~Buffer()
+            {
+                if (owner)
+                    owner->Unregister(this);
+            }
+
+            PerThreadStats* owner;                         ///< Set once registered
+            ACE_Thread_Mutex lock;
+            Container entries;
+        };
+
+        friend struct Buffer;
+
+    public:
+        template<class Key, class Value>
+        void Add(Key const& key, Value const& value)
+        {
+            Buffer* buffer = _buffer;
+            if (!buffer->owner)
+                Register(buffer);
+
+            // only contended while the stats are merged or reset
+            ACE_Guard<ACE_Thread_Mutex> guard(buffer->lock);
+            buffer->entries[key].Add(value);
+        }
+
+        /// Copies the stats of all threads into merged, returns the number of threads still recording
+        uint32 Merge(Container& merged)
+        {
+            ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+            merged = _retired;
+            for (typename std::list<Buffer*>::const_iterator itr = _buffers.begin(); itr != _buffers.end(); ++itr)
+            {
+                ACE_Guard<ACE_Thread_Mutex> bufferGuard((*itr)->lock);
+                for (typename Container::const_iterator entry = (*itr)->entries.begin(); entry != (*itr)->entries.end(); ++entry)
+                    merged[entry->first].Add(entry->second);
+            }
+
+            return uint32(_buffers.size());
+        }
+
+        void Reset()
+        {
+            ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+            _retired.clear();
+            for (typename std::list<Buffer*>::const_iterator itr = _buffers.begin(); itr != _buffers.end(); ++itr)
+            {
+                ACE_Guard<ACE_Thread_Mutex> bufferGuard((*itr)->lock);
+                (*itr)->entries.clear();
+            }
+        }
+
+    private:
+        void Register(Buffer* buffer)
+        {
+            ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+            buffer->owner = this;
+            _buffers.push_back(buffer);
+        }
+
+        void Unregister(Buffer* buffer)
+        {
+            ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+            _buffers.remove(buffer);
+            for (typename Container::const_iterator itr = buffer->entries.begin(); itr != buffer->entries.end(); ++itr)
+                _retired[itr->first].Add(itr->second);
+        }
+
+        ACE_Thread_Mutex _lock;
+        std::list<Buffer*> _buffers;
+        Container _retired;                                ///< Stats of the threads which exited
+        ACE_TSS<Buffer> _buffer;                           ///< Declared last, destroyed first as its destructor unregisters
+};
+
+#endif
@@ -60,6 +60,7 @@ class EventProcessor
         void KillAllEvents(bool force);
         void AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime = true);
         uint64 CalculateTime(uint64 t_offset) const;
+        bool HasEvents() const { return !m_events.empty(); }
     protected:
         uint64 m_time;
         EventList m_events;
@@ -29,6 +29,7 @@
 #include "Configuration/Config.h"
 
 #include "Log.h"
+#include "OpenSSLCrypto.h"
 #include "Master.h"
 
 #ifndef _TRINITY_CORE_CONFIG
@@ -139,10 +140,12 @@ extern int main(int argc, char **argv)
 
     sLog->outInfo(LOG_FILTER_WORLDSERVER, "Using SSL version: %s (library: %s)", OPENSSL_VERSION_TEXT, SSLeay_version(SSLEAY_VERSION));
     sLog->outInfo(LOG_FILTER_WORLDSERVER, "Using ACE version: %s", ACE_VERSION);
+    OpenSSLCrypto::ThreadsSetup();
 
     ///- and run the 'Master'
     /// \todo Why do we need this 'Master'? Can't all of this be in the Main as for Realmd?
     int ret = sMaster->Run();
+    OpenSSLCrypto::ThreadsCleanup();
 
     // at sMaster return function exist with codes
     // 0 - normal shutdown
@@ -31,6 +31,9 @@
 #include "Timer.h"
 #include "WorldRunnable.h"
 #include "OutdoorPvPMgr.h"
+#include "LFGMgr.h"
+#include "GuildMgr.h"
+#include "AchievementSaveBuffer.h"
 
 #define WORLD_SLEEP_CONST 25
 
@@ -81,10 +84,15 @@ void WorldRunnable::run()
 
     sWorld->KickAll();                                       // save and kick all players
     sWorld->UpdateSessions( 1 );                             // real players unload required UpdateSessions call
+    sGuildMgr->SaveGuilds();
+    sAchievementSaveBuffer->Flush();                         // write the progress saved by the players and guilds above
 
     // unload battleground templates before different singletons destroyed
     sBattlegroundMgr->DeleteAllBattlegrounds();
 
+    // join the matchmaking thread while the singletons it uses still exist
+    sLFGMgr->StopMatchmaker();
+
     sWorldSocketMgr->StopNetwork();
 
     sMapMgr->UnloadAll();                     // unload all grids (including locked in memory)
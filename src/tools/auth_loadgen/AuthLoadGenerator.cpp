@@ -0,0 +1,481 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file AuthLoadGenerator.cpp
+* @brief Logon load generator for the authserver
+*
+* Opens many connections to an authserver and runs the logon of a 4.3.4
+* client on each of them: challenge, SRP6 proof and realm list. The test
+* accounts are printed as SQL with --sql.
+*/
+
+#include <ace/Atomic_Op.h>
+#include <ace/INET_Addr.h>
+#include <ace/SOCK_Connector.h>
+#include <ace/SOCK_Stream.h>
+#include <ace/Task.h>
+#include <iomanip>
+
+#include "Common.h"
+#include "ByteBuffer.h"
+#include "BigNumber.h"
+#include "SHA1.h"
+#include "Timer.h"
+
+#define LOADGEN_CLIENT_BUILD 15595
+
+enum LoadGenAuthCmd
+{
+    AUTH_LOGON_CHALLENGE                         = 0x00,
+    AUTH_LOGON_PROOF                             = 0x01,
+    REALM_LIST                                   = 0x10
+};
+
+struct LoadGenConfig
+{
+    LoadGenConfig() : host("127.0.0.1"), port(3724), clients(100), threads(4), prefix("LOADTEST"), password("LOADTEST"), sql(false) { }
+
+    std::string host;
+    uint16 port;
+    uint32 clients;
+    uint32 threads;
+    std::string prefix;
+    std::string password;
+    bool sql;
+};
+
+static std::string UpperString(std::string str)
+{
+    std::transform(str.begin(), str.end(), str.begin(), ::toupper);
+    return str;
+}
+
+static std::string GetAccountName(LoadGenConfig const& config, uint32 index)
+{
+    std::ostringstream name;
+    name << UpperString(config.prefix) << index + 1;
+    return name.str();
+}
+
+/// One client logging on, its steps are run in turn with the other clients of the thread
+class LogonClient
+{
+public:
+    LogonClient(std::string const& login, std::string const& password) : _login(login), _password(UpperString(password)), _startTime(0), _latency(0)
+    {
+        _N.SetHexStr("894B645E89E1535BBDAD5B8B290650530801B18EBFBF5E8FAB3C82872A3E9BB7");
+        _g.SetDword(7);
+    }
+
+    ~LogonClient() { _stream.close(); }
+
+    bool SendChallenge(ACE_INET_Addr const& address)
+    {
+        _startTime = getMSTime();
+
+        ACE_SOCK_Connector connector;
+        ACE_Time_Value timeout(30);
+        if (connector.connect(_stream, address, &timeout) == -1)
+            return false;
+
+        ByteBuffer pkt;
+        pkt << uint8(AUTH_LOGON_CHALLENGE);
+        pkt << uint8(0);
+        pkt << uint16(30 + _login.size());                  // body size, the header is 4 bytes
+        pkt.append("WoW", 4);
+        pkt << uint8(4) << uint8(3) << uint8(4);
+        pkt << uint16(LOADGEN_CLIENT_BUILD);
+        pkt.append("68x", 4);                               // platform, os and locale are reversed
+        pkt.append("niW", 4);
+        pkt.append("SUne", 4);
+        pkt << uint32(0);                                   // timezone bias
+        pkt << uint32(0x0100007F);                          // 127.0.0.1
+        pkt << uint8(_login.size());
+        pkt.append(_login.c_str(), _login.size());
+        return Send(pkt);
+    }
+
+    bool HandleChallenge()
+    {
+        uint8 header[3];
+        if (!Receive(header, sizeof(header)) || header[0] != AUTH_LOGON_CHALLENGE || header[2] != 0)
+            return false;
+
+        // B, g, N, s, unknown and security flags
+        uint8 body[32 + 2 + 33 + 32 + 16 + 1];
+        if (!Receive(body, sizeof(body)))
+            return false;
+
+        BigNumber B;
+        B.SetBinary(body, 32);
+        _s.SetBinary(body + 67, 32);
+
+        _a.SetRand(19 * 8);
+        BigNumber A = _g.ModExp(_a, _N);
+
+        SHA1Hash sha;
+        sha.UpdateData(_login + ":" + _password);
+        sha.Finalize();
+        uint8 passHash[SHA_DIGEST_LENGTH];
+        memcpy(passHash, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+        sha.Initialize();
+        sha.UpdateData(_s.AsByteArray(), _s.GetNumBytes());
+        sha.UpdateData(passHash, SHA_DIGEST_LENGTH);
+        sha.Finalize();
+        BigNumber x;
+        x.SetBinary(sha.GetDigest(), sha.GetLength());
+
+        sha.Initialize();
+        sha.UpdateBigNumbers(&A, &B, NULL);
+        sha.Finalize();
+        BigNumber u;
+        u.SetBinary(sha.GetDigest(), 20);
+
+        // S = (B - 3 * g^x) ^ (a + u * x)
+        BigNumber v = _g.ModExp(x, _N);
+        BigNumber kv = (v * BigNumber(3)) % _N;
+        BigNumber base = (B + _N - kv) % _N;
+        BigNumber S = base.ModExp(_a + u * x, _N);
+
+        // session key, same interleaving as the server
+        uint8 t[32];
+        uint8 t1[16];
+        uint8 vK[40];
+        memcpy(t, S.AsByteArray(32), 32);
+
+        for (int i = 0; i < 16; ++i)
+            t1[i] = t[i * 2];
+
+        sha.Initialize();
+        sha.UpdateData(t1, 16);
+        sha.Finalize();
+
+        for (int i = 0; i < 20; ++i)
+            vK[i * 2] = sha.GetDigest()[i];
+
+        for (int i = 0; i < 16; ++i)
+            t1[i] = t[i * 2 + 1];
+
+        sha.Initialize();
+        sha.UpdateData(t1, 16);
+        sha.Finalize();
+
+        for (int i = 0; i < 20; ++i)
+            vK[i * 2 + 1] = sha.GetDigest()[i];
+
+        _K.SetBinary(vK, 40);
+
+        uint8 hash[20];
+
+        sha.Initialize();
+        sha.UpdateBigNumbers(&_N, NULL);
+        sha.Finalize();
+        memcpy(hash, sha.GetDigest(), 20);
+        sha.Initialize();
+        sha.UpdateBigNumbers(&_g, NULL);
+        sha.Finalize();
+
+        for (int i = 0; i < 20; ++i)
+            hash[i] ^= sha.GetDigest()[i];
+
+        BigNumber t3;
+        t3.SetBinary(hash, 20);
+
+        sha.Initialize();
+        sha.UpdateData(_login);
+        sha.Finalize();
+        uint8 t4[SHA_DIGEST_LENGTH];
+        memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+        sha.Initialize();
+        sha.UpdateBigNumbers(&t3, NULL);
+        sha.UpdateData(t4, SHA_DIGEST_LENGTH);
+        sha.UpdateBigNumbers(&_s, &A, &B, &_K, NULL);
+        sha.Finalize();
+        BigNumber M;
+        M.SetBinary(sha.GetDigest(), 20);
+
+        ByteBuffer pkt;
+        pkt << uint8(AUTH_LOGON_PROOF);
+        pkt.append(A.AsByteArray(32), 32);
+        pkt.append(sha.GetDigest(), 20);                    // M1
+        for (int i = 0; i < 20; ++i)                        // crc hash
+            pkt << uint8(0);
+        pkt << uint8(0);                                    // number of keys
+        pkt << uint8(0);                                    // security flags
+
+        // the server answers with SHA1(A, M1, K)
+        sha.Initialize();
+        sha.UpdateBigNumbers(&A, &M, &_K, NULL);
+        sha.Finalize();
+        memcpy(_M2, sha.GetDigest(), 20);
+
+        return Send(pkt);
+    }
+
+    bool HandleProof()
+    {
+        uint8 header[2];
+        if (!Receive(header, sizeof(header)) || header[0] != AUTH_LOGON_PROOF)
+            return false;
+
+        // wrong password or account banned meanwhile
+        if (header[1] != 0)
+            return false;
+
+        // M2, account flags, survey id and unknown
+        uint8 body[20 + 4 + 4 + 2];
+        if (!Receive(body, sizeof(body)) || memcmp(body, _M2, 20))
+            return false;
+
+        ByteBuffer pkt;
+        pkt << uint8(REALM_LIST);
+        pkt << uint32(0);
+        return Send(pkt);
+    }
+
+    bool HandleRealmList()
+    {
+        uint8 header[3];
+        if (!Receive(header, sizeof(header)) || header[0] != REALM_LIST)
+            return false;
+
+        std::vector<uint8> body(header[1] | (header[2] << 8));
+        if (!body.empty() && !Receive(&body[0], body.size()))
+            return false;
+
+        _latency = GetMSTimeDiffToNow(_startTime);
+        _stream.close();
+        return true;
+    }
+
+    void Close() { _stream.close(); }
+
+    /// Milliseconds from the connection to the realm list
+    uint32 GetLatency() const { return _latency; }
+
+private:
+    bool Send(ByteBuffer const& pkt)
+    {
+        return _stream.send_n(pkt.contents(), pkt.size()) == ssize_t(pkt.size());
+    }
+
+    bool Receive(uint8* buffer, size_t size)
+    {
+        ACE_Time_Value timeout(30);
+        return _stream.recv_n(buffer, size, &timeout) == ssize_t(size);
+    }
+
+    ACE_SOCK_Stream _stream;
+    std::string _login;
+    std::string _password;
+    uint32 _startTime;
+    uint32 _latency;
+
+    BigNumber _N;
+    BigNumber _g;
+    BigNumber _a;
+    BigNumber _s;
+    BigNumber _K;
+    uint8 _M2[20];
+};
+
+/// Threads running the logons, every thread sends a step of all its clients before waiting for the answers
+class LoadGenerator : protected ACE_Task_Base
+{
+public:
+    LoadGenerator(LoadGenConfig const& config) : _config(config), _address(config.port, config.host.c_str()), _nextThread(0), _failures(0) { }
+
+    void Run()
+    {
+        uint32 startTime = getMSTime();
+
+        activate(THR_NEW_LWP | THR_JOINABLE, int(_config.threads));
+        wait();
+
+        uint32 duration = std::max<uint32>(GetMSTimeDiffToNow(startTime), 1);
+
+        printf("%u logons, %u succeeded, %u failed in %u ms (%.1f logons/s)\n", _config.clients, uint32(_latencies.size()), _failures.value(),
+            duration, float(_latencies.size()) * IN_MILLISECONDS / duration);
+
+        if (_latencies.empty())
+            return;
+
+        std::sort(_latencies.begin(), _latencies.end());
+        uint64 total = 0;
+        for (std::vector<uint32>::const_iterator itr = _latencies.begin(); itr != _latencies.end(); ++itr)
+            total += *itr;
+
+        printf("latency: min %u ms, avg %u ms, p50 %u ms, p95 %u ms, p99 %u ms, max %u ms\n", _latencies.front(), uint32(total / _latencies.size()),
+            GetPercentile(50), GetPercentile(95), GetPercentile(99), _latencies.back());
+    }
+
+private:
+    virtual int svc()
+    {
+        uint32 thread = _nextThread++;
+
+        std::vector<LogonClient*> clients;
+        for (uint32 i = thread; i < _config.clients; i += _config.threads)
+            clients.push_back(new LogonClient(GetAccountName(_config, i), _config.password));
+
+        // a client is removed from the list once a step failed
+        std::vector<LogonClient*> active;
+        for (std::vector<LogonClient*>::const_iterator itr = clients.begin(); itr != clients.end(); ++itr)
+            if ((*itr)->SendChallenge(_address))
+                active.push_back(*itr);
+
+        RunStep(active, &LogonClient::HandleChallenge);
+        RunStep(active, &LogonClient::HandleProof);
+        RunStep(active, &LogonClient::HandleRealmList);
+
+        _failures += uint32(clients.size() - active.size());
+
+        {
+            ACE_Guard<ACE_Thread_Mutex> guard(_lock);
+            for (std::vector<LogonClient*>::const_iterator itr = active.begin(); itr != active.end(); ++itr)
+                _latencies.push_back((*itr)->GetLatency());
+        }
+
+        for (std::vector<LogonClient*>::const_iterator itr = clients.begin(); itr != clients.end(); ++itr)
+            delete *itr;
+
+        return 0;
+    }
+
+    void RunStep(std::vector<LogonClient*>& clients, bool (LogonClient::*step)())
+    {
+        std::vector<LogonClient*> succeeded;
+        for (std::vector<LogonClient*>::const_iterator itr = clients.begin(); itr != clients.end(); ++itr)
+        {
+            if (((*itr)->*step)())
+                succeeded.push_back(*itr);
+            else
+                (*itr)->Close();
+        }
+
+        clients.swap(succeeded);
+    }
+
+    uint32 GetPercentile(uint32 percent) const
+    {
+        return _latencies[std::min<size_t>(_latencies.size() * percent / 100, _latencies.size() - 1)];
+    }
+
+    LoadGenConfig const& _config;
+    ACE_INET_Addr _address;
+    ACE_Atomic_Op<ACE_Thread_Mutex, uint32> _nextThread;
+    ACE_Atomic_Op<ACE_Thread_Mutex, uint32> _failures;
+
+    ACE_Thread_Mutex _lock;
+    std::vector<uint32> _latencies;                         // milliseconds, of the logons which succeeded
+};
+
+/// Prints the accounts used by the load generator, to be run against the auth database
+void PrintAccounts(LoadGenConfig const& config)
+{
+    std::string password = UpperString(config.password);
+    for (uint32 i = 0; i < config.clients; ++i)
+    {
+        std::string name = GetAccountName(config, i);
+
+        SHA1Hash sha;
+        sha.UpdateData(name + ":" + password);
+        sha.Finalize();
+
+        std::ostringstream hash;
+        for (int j = 0; j < SHA_DIGEST_LENGTH; ++j)
+            hash << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << uint32(sha.GetDigest()[j]);
+
+        // v and s are cleared, the authserver computes them again from the new hash
+        printf("INSERT INTO `account` (`username`, `sha_pass_hash`, `expansion`) VALUES ('%s', '%s', 3) ON DUPLICATE KEY UPDATE `sha_pass_hash` = VALUES(`sha_pass_hash`), `v` = '', `s` = '';\n",
+            name.c_str(), hash.str().c_str());
+    }
+}
+
+void usage(char const* prog)
+{
+    printf("Usage: %s [<options>]\n"
+        "    -h host          authserver address (default 127.0.0.1)\n"
+        "    -p port          authserver port (default 3724)\n"
+        "    -n clients       number of logons (default 100)\n"
+        "    -t threads       number of client threads (default 4)\n"
+        "    -u prefix        account name prefix, accounts are prefix1 to prefixN (default LOADTEST)\n"
+        "    -w password      password of the accounts (default LOADTEST)\n"
+        "    --sql            print the SQL creating the accounts and exit\n",
+        prog);
+}
+
+int main(int argc, char** argv)
+{
+    LoadGenConfig config;
+
+    for (int c = 1; c < argc; ++c)
+    {
+        if (strcmp(argv[c], "--sql") == 0)
+        {
+            config.sql = true;
+            continue;
+        }
+
+        if (argv[c][0] != '-' || strlen(argv[c]) != 2 || c + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+
+        char const* value = argv[++c];
+        switch (argv[c - 1][1])
+        {
+            case 'h':
+                config.host = value;
+                break;
+            case 'p':
+                config.port = uint16(atoi(value));
+                break;
+            case 'n':
+                config.clients = uint32(atoi(value));
+                break;
+            case 't':
+                config.threads = std::max(uint32(atoi(value)), uint32(1));
+                break;
+            case 'u':
+                config.prefix = value;
+                break;
+            case 'w':
+                config.password = value;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (config.sql)
+    {
+        PrintAccounts(config);
+        return 0;
+    }
+
+    printf("Running %u logons against %s:%u with %u threads\n", config.clients, config.host.c_str(), config.port, config.threads);
+
+    LoadGenerator generator(config);
+    generator.Run();
+    return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+
+#include <ace/Dirent.h>
+#include <ace/OS_NS_sys_stat.h>
+
+#include "TileBuilder.h"
+
+static void PrintUsage(char const* name)
+{
+    printf("usage: %s [options] <data dir>\n", name);
+    printf("  <data dir> contains the extracted maps/ and vmaps/ directories, tiles are written to <data dir>/navmesh/\n");
+    printf("  --map <id>           build only this map\n");
+    printf("  --tile <x>,<y>       build only this tile (requires --map)\n");
+    printf("  --maxSlope <degrees> steepest walkable terrain (default 50)\n");
+    printf("  --skipVMaps          ignore vmap collision (terrain only)\n");
+}
+
+int main(int argc, char* argv[])
+{
+    int32 mapFilter = -1;
+    int32 tileXFilter = -1;
+    int32 tileYFilter = -1;
+    float maxSlope = 50.0f;
+    bool useVMaps = true;
+    std::string dataDir;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--map") && i + 1 < argc)
+            mapFilter = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--tile") && i + 1 < argc)
+        {
+            if (sscanf(argv[++i], "%d,%d", &tileXFilter, &tileYFilter) != 2)
+            {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--maxSlope") && i + 1 < argc)
+            maxSlope = float(atof(argv[++i]));
+        else if (!strcmp(argv[i], "--skipVMaps"))
+            useVMaps = false;
+        else if (argv[i][0] != '-' && dataDir.empty())
+            dataDir = argv[i];
+        else
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (dataDir.empty() || maxSlope <= 0.0f || maxSlope >= 90.0f || (tileXFilter >= 0 && mapFilter < 0))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (dataDir[dataDir.length() - 1] != '/' && dataDir[dataDir.length() - 1] != '\\')
+        dataDir.push_back('/');
+
+    // tiles to build, from the names of the extracted map files: MMMXXYY.map
+    ACE_Dirent dir;
+    if (dir.open((dataDir + "maps").c_str()) == -1)
+    {
+        printf("Can't open '%smaps'\n", dataDir.c_str());
+        return 1;
+    }
+
+    std::set<uint32> tiles;
+    while (ACE_DIRENT* entry = dir.read())
+    {
+        char const* name = entry->d_name;
+        uint32 mapId, tileX, tileY;
+        if (strlen(name) != 11 || strcmp(name + 7, ".map") || sscanf(name, "%03u%02u%02u", &mapId, &tileX, &tileY) != 3)
+            continue;
+
+        if (mapFilter >= 0 && mapId != uint32(mapFilter))
+            continue;
+
+        if (tileXFilter >= 0 && (tileX != uint32(tileXFilter) || tileY != uint32(tileYFilter)))
+            continue;
+
+        tiles.insert((mapId << 12) | (tileX << 6) | tileY);
+    }
+    dir.close();
+
+    ACE_OS::mkdir((dataDir + "navmesh").c_str());
+
+    printf("Building %u navigation tiles from '%s', max slope %.1f degrees%s\n", uint32(tiles.size()), dataDir.c_str(), maxSlope, useVMaps ? "" : ", vmaps skipped");
+
+    TileBuilder builder(dataDir, maxSlope, useVMaps);
+    uint32 built = 0;
+    for (std::set<uint32>::const_iterator itr = tiles.begin(); itr != tiles.end(); ++itr)
+        if (builder.BuildTile(*itr >> 12, (*itr >> 6) & 63, *itr & 63))
+            ++built;
+
+    printf("Done, %u of %u tiles built\n", built, uint32(tiles.size()));
+    return built == tiles.size() ? 0 : 1;
+}
@@ -0,0 +1,425 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TileBuilder.h"
+#include "VMapManager2.h"
+#include "DisableMgr.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// ******************************************
+// Map file format, keep in sync with game/Maps/Map.h
+// ******************************************
+struct map_fileheader
+{
+    uint32 mapMagic;
+    uint32 versionMagic;
+    uint32 buildMagic;
+    uint32 areaMapOffset;
+    uint32 areaMapSize;
+    uint32 heightMapOffset;
+    uint32 heightMapSize;
+    uint32 liquidMapOffset;
+    uint32 liquidMapSize;
+};
+
+#define MAP_HEIGHT_NO_HEIGHT  0x0001
+#define MAP_HEIGHT_AS_INT16   0x0002
+#define MAP_HEIGHT_AS_INT8    0x0004
+
+struct map_heightHeader
+{
+    uint32 fourcc;
+    uint32 flags;
+    float  gridHeight;
+    float  gridMaxHeight;
+};
+
+#define MAP_LIQUID_NO_TYPE    0x0001
+#define MAP_LIQUID_NO_HEIGHT  0x0002
+
+struct map_liquidHeader
+{
+    uint32 fourcc;
+    uint16 flags;
+    uint16 liquidType;
+    uint8  offsetX;
+    uint8  offsetY;
+    uint8  width;
+    uint8  height;
+    float  liquidLevel;
+};
+
+#define MAP_LIQUID_TYPE_MAGMA       0x04
+#define MAP_LIQUID_TYPE_SLIME       0x08
+
+static char const* MAP_MAGIC         = "MAPS";
+static char const* MAP_VERSION_MAGIC = "v1.2";
+static char const* MAP_HEIGHT_MAGIC  = "MHGT";
+static char const* MAP_LIQUID_MAGIC  = "MLIQ";
+static char const* NAV_MAGIC         = "NAVT";
+static char const* NAV_VERSION_MAGIC = "n1.0";
+
+#define INVALID_TERRAIN_HEIGHT  -100000.0f
+#define SWIM_DEPTH              1.6f                        // deeper water can only be crossed swimming
+#define LOS_HEIGHT_OFFSET       2.0f                        // collision is checked at about waist height
+
+// vmaps reference the core for disables and liquid types, the generator uses neither
+namespace DisableMgr
+{
+    bool IsDisabledFor(DisableType /*type*/, uint32 /*entry*/, Unit const* /*unit*/, uint8 /*flags*/)
+    {
+        return false;
+    }
+}
+
+uint32 GetLiquidFlags(uint32 /*liquidType*/)
+{
+    return 0;
+}
+
+static inline uint32 CellIndex(uint32 x, uint32 y)
+{
+    return x * GRID_RESOLUTION + y;
+}
+
+static inline float CellCenter(uint32 tile, uint32 cell)
+{
+    return (GRID_CENTER_ID - (tile * GRID_RESOLUTION + cell + 0.5f) / GRID_RESOLUTION) * GRID_SIZE;
+}
+
+TileBuilder::TileBuilder(std::string const& dataDir, float maxSlope, bool useVMaps) : _dataDir(dataDir), _vmapMgr(NULL)
+{
+    float slope = std::tan(maxSlope * 3.14159265f / 180.0f);
+    _maxStepHeight = GRID_CELL_SIZE * slope;
+    _maxRoughness = GRID_CELL_SIZE * 0.7071f * slope;
+
+    if (useVMaps)
+    {
+        _vmapMgr = new VMAP::VMapManager2();
+        _vmapMgr->setEnableLineOfSightCalc(true);
+        _vmapMgr->setEnableHeightCalc(false);
+    }
+}
+
+TileBuilder::~TileBuilder()
+{
+    delete _vmapMgr;
+}
+
+bool TileBuilder::LoadTerrain(uint32 mapId, uint32 tileX, uint32 tileY, TerrainTile& terrain) const
+{
+    char fileName[512];
+    snprintf(fileName, sizeof(fileName), "%smaps/%03u%02u%02u.map", _dataDir.c_str(), mapId, tileX, tileY);
+
+    FILE* file = fopen(fileName, "rb");
+    if (!file)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    std::vector<uint8> data(size > 0 ? size : 0);
+    bool read = !data.empty() && fread(&data[0], data.size(), 1, file) == 1;
+    fclose(file);
+
+    map_fileheader header;
+    if (!read || data.size() < sizeof(header))
+        return false;
+
+    memcpy(&header, &data[0], sizeof(header));
+    if (header.mapMagic != *((uint32 const*)(MAP_MAGIC)) || header.versionMagic != *((uint32 const*)(MAP_VERSION_MAGIC)))
+    {
+        printf("Map file '%s' is from an incompatible clientversion, skipped\n", fileName);
+        return false;
+    }
+
+    for (uint32 i = 0; i < GRID_RESOLUTION * GRID_RESOLUTION; ++i)
+    {
+        terrain.Heights[i] = INVALID_TERRAIN_HEIGHT;
+        terrain.Flags[i] = 0;
+    }
+
+    // heights at cell centers, that is V8; V9 corners give the roughness inside a cell
+    map_heightHeader heightHeader;
+    if (header.heightMapOffset && header.heightMapOffset + sizeof(heightHeader) <= data.size())
+    {
+        memcpy(&heightHeader, &data[header.heightMapOffset], sizeof(heightHeader));
+        if (heightHeader.fourcc != *((uint32 const*)(MAP_HEIGHT_MAGIC)))
+            return false;
+
+        std::vector<float> v9(129 * 129, heightHeader.gridHeight);
+        std::vector<float> v8(128 * 128, heightHeader.gridHeight);
+        if (!(heightHeader.flags & MAP_HEIGHT_NO_HEIGHT))
+        {
+            uint8 const* values = &data[header.heightMapOffset + sizeof(heightHeader)];
+            uint32 valueSize = (heightHeader.flags & MAP_HEIGHT_AS_INT16) ? sizeof(uint16) : ((heightHeader.flags & MAP_HEIGHT_AS_INT8) ? sizeof(uint8) : sizeof(float));
+            if (header.heightMapOffset + sizeof(heightHeader) + valueSize * (129 * 129 + 128 * 128) > data.size())
+                return false;
+
+            float multiplier = 1.0f;
+            if (heightHeader.flags & MAP_HEIGHT_AS_INT16)
+                multiplier = (heightHeader.gridMaxHeight - heightHeader.gridHeight) / 65535;
+            else if (heightHeader.flags & MAP_HEIGHT_AS_INT8)
+                multiplier = (heightHeader.gridMaxHeight - heightHeader.gridHeight) / 255;
+
+            for (uint32 i = 0; i < 129 * 129 + 128 * 128; ++i)
+            {
+                float value;
+                if (heightHeader.flags & MAP_HEIGHT_AS_INT16)
+                    value = ((uint16 const*)values)[i] * multiplier + heightHeader.gridHeight;
+                else if (heightHeader.flags & MAP_HEIGHT_AS_INT8)
+                    value = values[i] * multiplier + heightHeader.gridHeight;
+                else
+                    memcpy(&value, values + i * sizeof(float), sizeof(float));
+
+                if (i < 129 * 129)
+                    v9[i] = value;
+                else
+                    v8[i - 129 * 129] = value;
+            }
+        }
+
+        for (uint32 x = 0; x < GRID_RESOLUTION; ++x)
+        {
+            for (uint32 y = 0; y < GRID_RESOLUTION; ++y)
+            {
+                float center = v8[x * 128 + y];
+                float roughness = std::max(std::max(std::fabs(v9[x * 129 + y] - center), std::fabs(v9[(x + 1) * 129 + y] - center)),
+                    std::max(std::fabs(v9[x * 129 + y + 1] - center), std::fabs(v9[(x + 1) * 129 + y + 1] - center)));
+
+                terrain.Heights[CellIndex(x, y)] = center;
+                if (roughness <= _maxRoughness)
+                    terrain.Flags[CellIndex(x, y)] = NAV_CELL_WALKABLE;
+            }
+        }
+    }
+
+    // deep water is marked for swimmers only, magma and slime are never walkable
+    map_liquidHeader liquidHeader;
+    if (header.liquidMapOffset && header.liquidMapOffset + sizeof(liquidHeader) <= data.size())
+    {
+        memcpy(&liquidHeader, &data[header.liquidMapOffset], sizeof(liquidHeader));
+        if (liquidHeader.fourcc != *((uint32 const*)(MAP_LIQUID_MAGIC)))
+            return false;
+
+        uint32 offset = header.liquidMapOffset + sizeof(liquidHeader);
+        uint8 const* liquidFlags = NULL;
+        if (!(liquidHeader.flags & MAP_LIQUID_NO_TYPE))
+        {
+            if (offset + (sizeof(uint16) + sizeof(uint8)) * 16 * 16 > data.size())
+                return false;
+            liquidFlags = &data[offset + sizeof(uint16) * 16 * 16];
+            offset += (sizeof(uint16) + sizeof(uint8)) * 16 * 16;
+        }
+
+        float const* liquidMap = NULL;
+        if (!(liquidHeader.flags & MAP_LIQUID_NO_HEIGHT))
+        {
+            if (offset + sizeof(float) * liquidHeader.width * liquidHeader.height > data.size())
+                return false;
+            liquidMap = reinterpret_cast<float const*>(&data[offset]);
+        }
+
+        for (uint32 x = 0; x < GRID_RESOLUTION; ++x)
+        {
+            for (uint32 y = 0; y < GRID_RESOLUTION; ++y)
+            {
+                uint8 type = liquidFlags ? liquidFlags[(x >> 3) * 16 + (y >> 3)] : uint8(liquidHeader.liquidType);
+                if (!type)
+                    continue;
+
+                int32 lx = int32(x) - liquidHeader.offsetY;
+                int32 ly = int32(y) - liquidHeader.offsetX;
+                if (lx < 0 || lx >= liquidHeader.height || ly < 0 || ly >= liquidHeader.width)
+                    continue;
+
+                float level = liquidHeader.liquidLevel;
+                if (liquidMap)
+                    memcpy(&level, &liquidMap[lx * liquidHeader.width + ly], sizeof(float));
+
+                uint8& flags = terrain.Flags[CellIndex(x, y)];
+                if (type & (MAP_LIQUID_TYPE_MAGMA | MAP_LIQUID_TYPE_SLIME))
+                    flags = 0;
+                else if (level - terrain.Heights[CellIndex(x, y)] > SWIM_DEPTH)
+                    flags = NAV_CELL_WALKABLE | NAV_CELL_WATER;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool TileBuilder::CanStep(uint32 mapId, float x1, float y1, float z1, float x2, float y2, float z2) const
+{
+    if (std::fabs(z2 - z1) > _maxStepHeight)
+        return false;
+
+    if (_vmapMgr && !_vmapMgr->isInLineOfSight(mapId, x1, y1, z1 + LOS_HEIGHT_OFFSET, x2, y2, z2 + LOS_HEIGHT_OFFSET))
+        return false;
+
+    return true;
+}
+
+void TileBuilder::LoadVMaps(uint32 mapId, uint32 tileX, uint32 tileY)
+{
+    if (!_vmapMgr)
+        return;
+
+    std::string vmapsDir = _dataDir + "vmaps";
+    for (int32 x = int32(tileX) - 1; x <= int32(tileX) + 1; ++x)
+        for (int32 y = int32(tileY) - 1; y <= int32(tileY) + 1; ++y)
+            if (x >= 0 && y >= 0 && x < 64 && y < 64)
+                _vmapMgr->loadMap(vmapsDir.c_str(), mapId, x, y);
+}
+
+void TileBuilder::UnloadVMaps(uint32 mapId, uint32 tileX, uint32 tileY)
+{
+    if (!_vmapMgr)
+        return;
+
+    for (int32 x = int32(tileX) - 1; x <= int32(tileX) + 1; ++x)
+        for (int32 y = int32(tileY) - 1; y <= int32(tileY) + 1; ++y)
+            if (x >= 0 && y >= 0 && x < 64 && y < 64)
+                _vmapMgr->unloadMap(mapId, x, y);
+}
+
+bool TileBuilder::BuildTile(uint32 mapId, uint32 tileX, uint32 tileY)
+{
+    TerrainTile* terrain = new TerrainTile();
+    if (!LoadTerrain(mapId, tileX, tileY, *terrain))
+    {
+        delete terrain;
+        return false;
+    }
+
+    // neighbour tiles, for links crossing the tile border
+    TerrainTile* nextX = new TerrainTile();
+    TerrainTile* prevX = new TerrainTile();
+    TerrainTile* nextY = new TerrainTile();
+    TerrainTile* prevY = new TerrainTile();
+    bool hasNextX = tileX < 63 && LoadTerrain(mapId, tileX + 1, tileY, *nextX);
+    bool hasPrevX = tileX > 0 && LoadTerrain(mapId, tileX - 1, tileY, *prevX);
+    bool hasNextY = tileY < 63 && LoadTerrain(mapId, tileX, tileY + 1, *nextY);
+    bool hasPrevY = tileY > 0 && LoadTerrain(mapId, tileX, tileY - 1, *prevY);
+
+    LoadVMaps(mapId, tileX, tileY);
+
+    static int32 const directions[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+    static uint8 const links[4] = { NAV_CELL_LINK_XP, NAV_CELL_LINK_XN, NAV_CELL_LINK_YP, NAV_CELL_LINK_YN };
+
+    uint8 cells[GRID_RESOLUTION * GRID_RESOLUTION];
+    uint32 walkable = 0;
+    for (uint32 x = 0; x < GRID_RESOLUTION; ++x)
+    {
+        for (uint32 y = 0; y < GRID_RESOLUTION; ++y)
+        {
+            uint8 flags = terrain->Flags[CellIndex(x, y)];
+            cells[CellIndex(x, y)] = flags;
+            if (!(flags & NAV_CELL_WALKABLE))
+                continue;
+
+            ++walkable;
+            float height = terrain->Heights[CellIndex(x, y)];
+            for (uint8 i = 0; i < 4; ++i)
+            {
+                int32 nx = int32(x) + directions[i][0];
+                int32 ny = int32(y) + directions[i][1];
+
+                TerrainTile const* neighbour = terrain;
+                uint32 neighbourTileX = tileX;
+                uint32 neighbourTileY = tileY;
+                if (nx == GRID_RESOLUTION)
+                {
+                    if (!hasNextX)
+                        continue;
+                    neighbour = nextX;
+                    ++neighbourTileX;
+                    nx = 0;
+                }
+                else if (nx < 0)
+                {
+                    if (!hasPrevX)
+                        continue;
+                    neighbour = prevX;
+                    --neighbourTileX;
+                    nx = GRID_RESOLUTION - 1;
+                }
+                else if (ny == GRID_RESOLUTION)
+                {
+                    if (!hasNextY)
+                        continue;
+                    neighbour = nextY;
+                    ++neighbourTileY;
+                    ny = 0;
+                }
+                else if (ny < 0)
+                {
+                    if (!hasPrevY)
+                        continue;
+                    neighbour = prevY;
+                    --neighbourTileY;
+                    ny = GRID_RESOLUTION - 1;
+                }
+
+                if (!(neighbour->Flags[CellIndex(nx, ny)] & NAV_CELL_WALKABLE))
+                    continue;
+
+                if (CanStep(mapId, CellCenter(tileX, x), CellCenter(tileY, y), height,
+                    CellCenter(neighbourTileX, nx), CellCenter(neighbourTileY, ny), neighbour->Heights[CellIndex(nx, ny)]))
+                    cells[CellIndex(x, y)] |= links[i];
+            }
+        }
+    }
+
+    UnloadVMaps(mapId, tileX, tileY);
+
+    delete terrain;
+    delete nextX;
+    delete prevX;
+    delete nextY;
+    delete prevY;
+
+    char fileName[512];
+    snprintf(fileName, sizeof(fileName), "%snavmesh/%03u%02u%02u.nav", _dataDir.c_str(), mapId, tileX, tileY);
+
+    FILE* file = fopen(fileName, "wb");
+    if (!file)
+    {
+        printf("Can't create the output file '%s'\n", fileName);
+        return false;
+    }
+
+    nav_fileheader header;
+    header.navMagic = *((uint32 const*)(NAV_MAGIC));
+    header.versionMagic = *((uint32 const*)(NAV_VERSION_MAGIC));
+    header.mapId = mapId;
+    header.tileX = tileX;
+    header.tileY = tileY;
+    header.cellsPerSide = GRID_RESOLUTION;
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(cells, sizeof(cells), 1, file);
+    fclose(file);
+
+    printf("[Map %03u] Tile %02u,%02u: %u walkable cells\n", mapId, tileX, tileY, walkable);
+    return true;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2008-2015 TrinityCore <http://www.trinitycore.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _NAVMESH_TILEBUILDER_H
+#define _NAVMESH_TILEBUILDER_H
+
+#include "Define.h"
+#include <string>
+
+namespace VMAP
+{
+    class VMapManager2;
+}
+
+#define GRID_SIZE           533.33333f
+#define GRID_CENTER_ID      32
+#define GRID_RESOLUTION     128
+#define GRID_CELL_SIZE      (GRID_SIZE / GRID_RESOLUTION)
+
+// keep in sync with game/Movement/Navigation/NavMeshMgr.h
+enum NavCellFlags
+{
+    NAV_CELL_WALKABLE   = 0x01,
+    NAV_CELL_LINK_XP    = 0x02,
+    NAV_CELL_LINK_XN    = 0x04,
+    NAV_CELL_LINK_YP    = 0x08,
+    NAV_CELL_LINK_YN    = 0x10,
+    NAV_CELL_WATER      = 0x20
+};
+
+struct nav_fileheader
+{
+    uint32 navMagic;
+    uint32 versionMagic;
+    uint32 mapId;
+    uint32 tileX;
+    uint32 tileY;
+    uint32 cellsPerSide;
+};
+
+// terrain of one .map tile sampled at cell centers, same layout as V8 heights
+struct TerrainTile
+{
+    float Heights[GRID_RESOLUTION * GRID_RESOLUTION];
+    uint8 Flags[GRID_RESOLUTION * GRID_RESOLUTION];         // NAV_CELL_WALKABLE and NAV_CELL_WATER
+};
+
+class TileBuilder
+{
+    public:
+        TileBuilder(std::string const& dataDir, float maxSlope, bool useVMaps);
+        ~TileBuilder();
+
+        bool BuildTile(uint32 mapId, uint32 tileX, uint32 tileY);
+
+    private:
+        bool LoadTerrain(uint32 mapId, uint32 tileX, uint32 tileY, TerrainTile& terrain) const;
+        bool CanStep(uint32 mapId, float x1, float y1, float z1, float x2, float y2, float z2) const;
+        void LoadVMaps(uint32 mapId, uint32 tileX, uint32 tileY);
+        void UnloadVMaps(uint32 mapId, uint32 tileX, uint32 tileY);
+
+        std::string _dataDir;
+        float _maxStepHeight;                               // between two neighbour cell centers
+        float _maxRoughness;                                // between a cell center and its corners
+        VMAP::VMapManager2* _vmapMgr;
+};
+
+#endif